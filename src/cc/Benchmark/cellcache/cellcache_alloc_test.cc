@@ -0,0 +1,188 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cstdio>
+#include <vector>
+
+#include <boost/random.hpp>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/Serialization.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "Hypertable/RangeServer/CellCache.h"
+#include "Hypertable/RangeServer/CellCachePagePool.h"
+#include "Hypertable/RangeServer/Global.h"
+#include "Hypertable/RangeServer/ScanContext.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "Usage: cellcache_alloc_test [options]\n\n"
+    "Description:\n"
+    "  This program measures CellCache insert and scan throughput with\n"
+    "  arena pages from malloc and then from the huge page pool selected\n"
+    "  with --huge-pages.  It inserts --keys random keys into a CellCache\n"
+    "  and scans it --scans times for each allocator.\n\n"
+    "Options";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("keys", i32()->default_value(1000000), "Number of keys to insert")
+        ("row-size", i32()->default_value(16), "Size of each row key")
+        ("value-size", i32()->default_value(100), "Size of each value")
+        ("scans", i32()->default_value(3), "Number of full scans")
+        ("huge-pages", str()->default_value("transparent"),
+         "Huge page mode to compare against malloc: transparent or explicit")
+        ("numa-aware", boo()->default_value(false),
+         "Keep huge page chunks per NUMA node")
+        ("seed", i32()->default_value(1234), "Random number generator seed")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DefaultPolicy> Policies;
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>data</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  struct Result {
+    double insert_rate;
+    double scan_rate;
+    size_t memory;
+  };
+
+  void run(const vector<SerializedKey> &keys, ByteString &value,
+           SchemaPtr &schema, int scans, Result *result) {
+    CellCachePtr cache = new CellCache();
+    Key key;
+
+    Stopwatch insert_watch;
+    for (size_t i=0; i<keys.size(); i++) {
+      key.load(keys[i]);
+      cache->add(key, value);
+    }
+    insert_watch.stop();
+
+    ByteString scan_value;
+    size_t cells = 0;
+    Stopwatch scan_watch;
+    for (int i=0; i<scans; i++) {
+      ScanContextPtr scan_ctx = new ScanContext(schema);
+      CellListScannerPtr scanner = cache->create_scanner(scan_ctx);
+      while (scanner->get(key, scan_value)) {
+        cells++;
+        scanner->forward();
+      }
+    }
+    scan_watch.stop();
+
+    result->insert_rate = (double)keys.size() / insert_watch.elapsed();
+    result->scan_rate = (double)cells / scan_watch.elapsed();
+    result->memory = cache->memory_allocated();
+  }
+
+  void report(const char *label, const Result &result) {
+    printf("%12s:  insert %.0f cells/s, scan %.0f cells/s, %llu bytes\n",
+           label, result.insert_rate, result.scan_rate,
+           (Llu)result.memory);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    int nkeys = get_i32("keys");
+    int row_size = get_i32("row-size");
+    int value_size = get_i32("value-size");
+    int scans = get_i32("scans");
+    int mode = CellCachePagePool::parse_mode(get_str("huge-pages"));
+    boost::mt19937 rng(get_i32("seed"));
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+
+    if (mode == 0)
+      HT_THROW(Error::CONFIG_BAD_VALUE, "--huge-pages must be transparent or explicit");
+
+    Global::block_cache = new FileBlockCache(1000000LL, 1000000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    // pre-generate keys so that only CellCache work is timed
+    DynamicBuffer key_buf(nkeys * (row_size + 32));
+    vector<SerializedKey> keys;
+    String row(row_size, ' ');
+    keys.reserve(nkeys);
+    for (int i=0; i<nkeys; i++) {
+      for (int j=0; j<row_size; j++)
+        row[j] = 'a' + (rng() % 26);
+      keys.push_back(SerializedKey(key_buf.ptr));
+      create_key_and_append(key_buf, FLAG_INSERT, row.c_str(), 1, "", i+1, i+1);
+    }
+
+    DynamicBuffer value_buf(value_size + 8);
+    Serialization::encode_vi32(&value_buf.ptr, value_size);
+    memset(value_buf.ptr, 'v', value_size);
+    value_buf.ptr += value_size;
+    ByteString value(value_buf.base);
+
+    Result before, after;
+
+    run(keys, value, schema, scans, &before);
+
+    Global::cell_cache_page_pool = new CellCachePagePool(
+        get_i32("Hypertable.RangeServer.AccessGroup.CellCache.PageSize"),
+        mode, get_bool("numa-aware"));
+    run(keys, value, schema, scans, &after);
+
+    printf("        Keys:  %d\n", nkeys);
+    report("malloc", before);
+    report(get_str("huge-pages").c_str(), after);
+    printf("     Speedup:  insert %.2fx, scan %.2fx\n",
+           after.insert_rate / before.insert_rate,
+           after.scan_rate / before.scan_rate);
+    fflush(stdout);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0);
+}
@@ -0,0 +1,144 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cstdio>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include "Common/Init.h"
+#include "Common/Random.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include "AsyncComm/Config.h"
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/HqlInterpreter.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "Usage: ht_load_data_test [options]\n\n"
+    "Description:\n"
+    "  This program writes a tab delimited file of --rows rows with\n"
+    "  --columns columns of --value-size byte values and loads it into\n"
+    "  --table with LOAD DATA INFILE once for each of the --threads values\n"
+    "  (see Hypertable.HqlInterpreter.LoadData.Threads).  The table is\n"
+    "  recreated before each load.  Reports load throughput.\n\n"
+    "Options";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("rows", i32()->default_value(1000000), "Number of rows to load")
+        ("columns", i32()->default_value(4), "Number of columns per row")
+        ("value-size", i32()->default_value(100), "Size of each value")
+        ("threads", str()->default_value("1,2,4,8"),
+         "Comma separated list of load thread counts to run")
+        ("table", str()->default_value("LoadDataTest"), "Table to load into")
+        ("file", str()->default_value("/tmp/ht_load_data_test.tsv"),
+         "Input file to generate")
+        ("seed", i32()->default_value(1234), "Random number generator seed")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
+
+  void generate_file(const String &fname, int rows, int columns,
+                     int value_size) {
+    FILE *fp = fopen(fname.c_str(), "w");
+    if (fp == 0)
+      HT_THROWF(Error::EXTERNAL, "Unable to open '%s' - %s", fname.c_str(),
+                strerror(errno));
+
+    std::vector<char> value(value_size + 1);
+    fprintf(fp, "row\tcolumn\tvalue\n");
+    for (int i=0; i<rows; i++) {
+      for (int j=0; j<columns; j++) {
+        Random::fill_buffer_with_random_ascii(&value[0], value_size);
+        value[value_size] = 0;
+        fprintf(fp, "row%010d\tField:q%d\t%s\n", i, j, &value[0]);
+      }
+    }
+    fclose(fp);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    int rows = get_i32("rows");
+    int columns = get_i32("columns");
+    String table = get_str("table");
+    String fname = get_str("file");
+    std::vector<String> threads;
+
+    Random::seed(get_i32("seed"));
+    boost::split(threads, get_str("threads"), boost::is_any_of(","));
+
+    generate_file(fname, rows, columns, get_i32("value-size"));
+
+    ClientPtr client = new Hypertable::Client();
+    HqlInterpreterPtr hql = client->create_hql_interpreter(true);
+    hql->set_namespace("/");
+
+    printf("Threads  Cells       Elapsed (s)  Cells/s      MB/s\n");
+
+    foreach(const String &count, threads) {
+      hql->execute(format("DROP TABLE IF EXISTS %s", table.c_str()));
+      hql->execute(format("CREATE TABLE %s ( Field )", table.c_str()));
+
+      properties->set("Hypertable.HqlInterpreter.LoadData.Threads",
+                      (int32_t)atoi(count.c_str()));
+
+      HqlInterpreter::Callback cb(false);
+      Stopwatch stopwatch;
+      hql->execute(format("LOAD DATA INFILE \"%s\" INTO TABLE %s",
+                          fname.c_str(), table.c_str()), cb);
+      stopwatch.stop();
+
+      double bytes = (double)(cb.total_keys_size + cb.total_values_size);
+      printf("%-8s %-11llu %-12.2f %-12.2f %.2f\n", count.c_str(),
+             (Llu)cb.total_cells, stopwatch.elapsed(),
+             (double)cb.total_cells / stopwatch.elapsed(),
+             bytes / (1048576.0 * stopwatch.elapsed()));
+      fflush(stdout);
+    }
+
+    unlink(fname.c_str());
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0); // don't bother with static objects
+}
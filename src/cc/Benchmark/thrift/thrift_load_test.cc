@@ -0,0 +1,213 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/random.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "Common/Init.h"
+#include "Common/Mutex.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include "ThriftBroker/Client.h"
+#include "ThriftBroker/Config.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "Usage: thrift_load_test [options]\n\n"
+    "Description:\n"
+    "  This program opens --connections concurrent connections to the\n"
+    "  ThriftBroker and issues --requests requests on each one.  With\n"
+    "  --table, each request fetches a random row 'row<N>' (N < --rows) of\n"
+    "  that table, otherwise it checks for the existence of --namespace.\n"
+    "  With --reconnect-every, connections are closed and reopened after\n"
+    "  that many requests to simulate short-lived clients.  Reports request\n"
+    "  throughput and latency percentiles.\n\n"
+    "Options";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("connections", i32()->default_value(1000),
+         "Number of concurrent client connections")
+        ("requests", i32()->default_value(100),
+         "Number of requests per connection")
+        ("reconnect-every", i32()->default_value(0),
+         "Reopen the connection after this many requests (0 = never)")
+        ("namespace", str()->default_value("/"), "Namespace to open")
+        ("table", str(), "Table to read rows from")
+        ("rows", i32()->default_value(1000), "Number of rows in table")
+        ("seed", i32()->default_value(1234), "Random number generator seed")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, ThriftClientPolicy, DefaultCommPolicy>
+          Policies;
+
+  struct LoadStats {
+    LoadStats() : requests(0), errors(0), connects(0) { }
+    Mutex mutex;
+    vector<double> latencies;
+    size_t requests;
+    size_t errors;
+    size_t connects;
+  };
+
+  void load_thread(int index, boost::barrier *start, LoadStats *stats,
+                   int requests, int reconnect_every) {
+    String host = get_str("thrift-host");
+    int port = get_i16("thrift-port");
+    String ns_name = get_str("namespace");
+    String table = has("table") ? get_str("table") : String();
+    int rows = get_i32("rows");
+    vector<double> latencies;
+    size_t errors = 0, connects = 0;
+    boost::shared_ptr<Thrift::Client> client;
+    ThriftGen::Namespace ns = 0;
+    boost::mt19937 rng(get_i32("seed") + index);
+
+    latencies.reserve(requests);
+    start->wait();
+
+    for (int i=0; i<requests; i++) {
+      Stopwatch stopwatch;
+      try {
+        if (!client || (reconnect_every && i % reconnect_every == 0)) {
+          if (client && ns)
+            client->close_namespace(ns);
+          client.reset();
+          client.reset(new Thrift::Client(host, port));
+          ns = client->open_namespace(ns_name);
+          connects++;
+        }
+        if (table.empty())
+          client->exists_namespace(ns_name);
+        else {
+          vector<ThriftGen::Cell> cells;
+          client->get_row(cells, ns, table,
+                          format("row%d", (int)(rng() % rows)));
+        }
+        stopwatch.stop();
+        latencies.push_back(stopwatch.elapsed());
+      }
+      catch (ThriftGen::ClientException &e) {
+        HT_ERRORF("%s", e.message.c_str());
+        errors++;
+      }
+      catch (std::exception &e) {
+        HT_ERRORF("%s", e.what());
+        // drop the connection, it is reopened by the next request
+        client.reset();
+        ns = 0;
+        errors++;
+      }
+    }
+
+    try {
+      if (client && ns)
+        client->close_namespace(ns);
+    }
+    catch (std::exception &e) {
+    }
+
+    ScopedLock lock(stats->mutex);
+    stats->latencies.insert(stats->latencies.end(), latencies.begin(),
+                            latencies.end());
+    stats->requests += requests;
+    stats->errors += errors;
+    stats->connects += connects;
+  }
+
+  double percentile(const vector<double> &sorted, double p) {
+    if (sorted.empty())
+      return 0.0;
+    size_t i = (size_t)(p * (sorted.size() - 1));
+    return sorted[i];
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    int connections = get_i32("connections");
+    int requests = get_i32("requests");
+    int reconnect_every = get_i32("reconnect-every");
+    LoadStats stats;
+    boost::barrier start(connections + 1);
+    boost::thread_group threads;
+
+    for (int i=0; i<connections; i++)
+      threads.create_thread(boost::bind(load_thread, i, &start, &stats,
+                                        requests, reconnect_every));
+
+    start.wait();
+    Stopwatch stopwatch;
+    threads.join_all();
+    stopwatch.stop();
+
+    sort(stats.latencies.begin(), stats.latencies.end());
+
+    double total_latency = 0.0;
+    foreach(double latency, stats.latencies)
+      total_latency += latency;
+
+    size_t succeeded = stats.latencies.size();
+
+    printf("   Connections:  %d\n", connections);
+    printf("      Connects:  %llu\n", (Llu)stats.connects);
+    printf("      Requests:  %llu\n", (Llu)stats.requests);
+    printf("        Errors:  %llu\n", (Llu)stats.errors);
+    printf("  Elapsed time:  %.2f s\n", stopwatch.elapsed());
+    printf("    Throughput:  %.2f requests/s\n",
+           (double)succeeded / stopwatch.elapsed());
+    printf("  Latency mean:  %.3f ms\n",
+           succeeded ? 1000.0 * total_latency / succeeded : 0.0);
+    printf("   Latency p50:  %.3f ms\n",
+           1000.0 * percentile(stats.latencies, 0.50));
+    printf("   Latency p99:  %.3f ms\n",
+           1000.0 * percentile(stats.latencies, 0.99));
+    printf("   Latency max:  %.3f ms\n",
+           1000.0 * percentile(stats.latencies, 1.0));
+    fflush(stdout);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0); // don't bother with static objects
+}
@@ -272,6 +272,13 @@ void DefaultPolicy::init_options() {
         "load balancer to be overloaded")
     ("Hypertable.HqlInterpreter.Mutator.NoLogSync", boo()->default_value(false),
         "Suspends CommitLog sync operation on updates until command completion")
+    ("Hypertable.HqlInterpreter.LoadData.Threads", i32()->default_value(1),
+        "Number of threads parsing and loading the input of LOAD DATA INFILE "
+        "into a table, each with its own mutator; with more than one, updates "
+        "to the same cell from different chunks may be applied in any order")
+    ("Hypertable.HqlInterpreter.LoadData.ChunkSize", i32()->default_value(1*M),
+        "Size, in bytes, of the chunks of input lines handed to LOAD DATA "
+        "INFILE threads")
     ("Hypertable.Mutator.FlushDelay", i32()->default_value(0), "Number of "
         "milliseconds to wait prior to flushing scatter buffers (for testing)")
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.PerServer",
@@ -280,8 +287,27 @@ void DefaultPolicy::init_options() {
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate",
      i64()->default_value(50*M), "Amount of updates (bytes) accumulated for "
         "all servers to trigger a scatter buffer flush")
+    ("Hypertable.Mutator.ScatterBuffer.MaxOutstanding",
+     i32()->default_value(4), "Maximum number of scatter buffers a mutator "
+        "keeps in flight; buffers touching rows of an outstanding buffer "
+        "wait for it to complete")
+    ("Hypertable.Client.RowCache.MaxMemory", i64()->default_value(0),
+        "Memory used per table to cache the results of single row scans "
+        "on the client (0 disables the row cache)")
+    ("Hypertable.Client.RowCache.TTL", i32()->default_value(1000),
+        "Time, in milliseconds, results stay in the client row cache; "
+        "bounds the staleness of rows written by other clients")
+    ("Hypertable.Client.WireCompression", str()->default_value("none"),
+        "Codec for compressing update payloads sent to RangeServers "
+        "(e.g. lz4, zlib, none); compressed scan results are accepted "
+        "regardless of this setting")
+    ("Hypertable.WireCompression.MinPayloadSize", i32()->default_value(1*K),
+        "Update and scan payloads smaller than this are not compressed")
     ("Hypertable.Scanner.QueueSize",
      i32()->default_value(5), "Size of Scanner ScanBlock queue")
+    ("Hypertable.Scanner.ParallelRanges", i32()->default_value(8),
+     "Maximum number of ranges scanned concurrently by scanners created "
+     "with the parallel ranges flag")
     ("Hypertable.LocationCache.MaxEntries", i64()->default_value(1*M),
         "Size of range location cache in number of entries")
     ("Hypertable.Master.Host", str(),
@@ -311,8 +337,22 @@ void DefaultPolicy::init_options() {
         "Port number on which range servers are or should be listening")
     ("Hypertable.RangeServer.AccessGroup.CellCache.PageSize",
      i32()->default_value(512*KiB), "Page size for CellCache pool allocator")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.HugePages",
+     str()->default_value("none"), "Serve CellCache pages from 2MB huge "
+     "pages: none, transparent (madvise) or explicit (hugetlbfs pool, falls "
+     "back to transparent when exhausted)")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.NumaAware",
+     boo()->default_value(false), "Serve CellCache pages from memory local "
+     "to the NUMA node of the updating thread (requires HugePages)")
     ("Hypertable.RangeServer.AccessGroup.CellCache.ScannerCacheSize",
      i32()->default_value(1024), "CellCache scanner cache size")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.Compaction.Threshold",
+     i32()->default_value(40), "Rebuild a CellCache in memory, dropping "
+     "obsolete versions and deletes, when they account for this percentage "
+     "of its cells (0 disables)")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.Compaction.MinimumMemory",
+     i64()->default_value(4*M), "Only rebuild CellCaches that use at least "
+     "this much memory")
     ("Hypertable.RangeServer.AccessGroup.ShadowCache",
      boo()->default_value(false), "Enable CellStore shadow caching")
     ("Hypertable.RangeServer.AccessGroup.MaxMemory", i64()->default_value(1*G),
@@ -324,12 +364,30 @@ void DefaultPolicy::init_options() {
         "CellStores in which merges will be considered")
     ("Hypertable.RangeServer.CellStore.Merge.RunLengthThreshold", i32()->default_value(10),
         "Trigger a merge if an adjacent run of merge candidate CellStores exceeds this length")
+    ("Hypertable.RangeServer.CellStore.AsyncReads", i32()->default_value(4),
+        "Number of blocks following the one being read that a CellStore "
+        "scan reads asynchronously on a block cache miss; a scan fetch "
+        "waiting on one of these reads releases its worker (0 disables)")
     ("Hypertable.RangeServer.CellStore.DefaultBlockSize",
         i32()->default_value(64*KiB), "Default block size for cell stores")
     ("Hypertable.RangeServer.CellStore.DefaultReplication",
         i32(), "Default replication for cell stores")
     ("Hypertable.RangeServer.CellStore.DefaultCompressor",
         str()->default_value("lzo"), "Default compressor for cell stores")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.MinSavings",
+        i32()->default_value(10), "Store CellStore data blocks uncompressed "
+        "if compression saves less than this percentage of their size "
+        "(0 disables)")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.Codecs",
+        str()->default_value(""), "Comma separated list of cheaper codecs, "
+        "fastest first, that are tried ahead of the access group compressor "
+        "for CellStore data blocks (e.g. \"lz4,lzo\")")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.Tolerance",
+        i32()->default_value(10), "Pick the first AdaptiveCompression codec "
+        "whose output is within this percentage of the smallest output")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.SampleInterval",
+        i32()->default_value(16), "Number of data blocks between "
+        "re-evaluations of the AdaptiveCompression codec choice")
     ("Hypertable.RangeServer.CellStore.DefaultBloomFilter",
         str()->default_value("rows"), "Default bloom filter for cell stores")
     ("Hypertable.RangeServer.CellStore.SkipNotFound",
@@ -340,8 +398,26 @@ void DefaultPolicy::init_options() {
         "Minimum size of block cache")
     ("Hypertable.RangeServer.BlockCache.MaxMemory", i64(),
         "Maximum (target) size of block cache")
+    ("Hypertable.RangeServer.BlockCache.CompactionWarmupBudget",
+        i64()->default_value(64*M), "Maximum number of bytes of newly "
+        "compacted CellStore blocks to load into the block cache, covering "
+        "rows that were cached from the replaced CellStores (0 disables)")
+    ("Hypertable.RangeServer.WireCompression", str()->default_value("lz4"),
+        "Codec for compressing scan results sent to clients that accept "
+        "compressed responses (none disables)")
     ("Hypertable.RangeServer.QueryCache.MaxMemory", i64()->default_value(50*M),
         "Maximum size of query cache")
+    ("Hypertable.RangeServer.MemoryGovernor.Enable", boo()->default_value(false),
+        "Rebalance memory between the block cache, query cache and CellStore "
+        "indexes each maintenance interval based on their measured benefit, "
+        "instead of growing the block cache when there are few updates")
+    ("Hypertable.RangeServer.MemoryGovernor.StepPercentage",
+        i32()->default_value(2), "Percentage of the memory limit moved "
+        "between consumers per maintenance interval")
+    ("Hypertable.RangeServer.MemoryGovernor.IdleIntervals",
+        i32()->default_value(4), "Number of maintenance intervals without "
+        "scans after which the CellStore indexes of a range may be purged "
+        "to make room for caches")
     ("Hypertable.RangeServer.Range.SplitSize", i64()->default_value(256*MiB),
         "Size of range in bytes before splitting")
     ("Hypertable.RangeServer.Range.MaximumSize", i64()->default_value(3*G),
@@ -350,6 +426,22 @@ void DefaultPolicy::init_options() {
         "range in bytes before splitting (for testing)")
     ("Hypertable.RangeServer.Range.SplitOff", str()->default_value("high"),
         "Portion of range to split off (high or low)")
+    ("Hypertable.RangeServer.Range.LoadSplit.CellRate", i32()->default_value(0),
+        "Split a range that reads and writes more than this many cells per "
+        "second, at the median of its recently accessed rows (0 = disabled)")
+    ("Hypertable.RangeServer.Range.LoadSplit.ByteRate", i64()->default_value(0),
+        "Split a range that reads and writes more than this many bytes per "
+        "second, at the median of its recently accessed rows (0 = disabled)")
+    ("Hypertable.RangeServer.Range.LoadSplit.Intervals", i32()->default_value(3),
+        "Number of consecutive maintenance intervals a range must exceed the "
+        "load split rates before it is split")
+    ("Hypertable.RangeServer.Range.LoadSplit.MinimumSize",
+        i64()->default_value(16*MiB), "Ranges smaller than this are not split "
+        "because of load")
+    ("Hypertable.RangeServer.Range.Move.ShipCellCaches",
+        boo()->default_value(false), "Relinquish ranges by writing their "
+        "cell caches to a log that the destination replays, instead of "
+        "compacting them first (all RangeServers must support it)")
     ("Hypertable.RangeServer.ClockSkew.Max", i32()->default_value(3*M),
         "Maximum amount of clock skew (microseconds) the system will tolerate")
     ("Hypertable.RangeServer.CommitLog.DfsBroker.Host", str(),
@@ -367,13 +459,13 @@ void DefaultPolicy::init_options() {
         "Roll commit log after this many bytes")
     ("Hypertable.RangeServer.CommitLog.Compressor",
         str()->default_value("quicklz"),
-        "Commit log compressor to use (zlib, lzo, quicklz, bmz, none)")
+        "Commit log compressor to use (zlib, lzo, lz4, lz4hc, quicklz, bmz, none)")
     ("Hypertable.CommitLog.Replication", i32(),
         "Replication factor for commit log files")
     ("Hypertable.CommitLog.RollLimit", i64()->default_value(100*M),
         "Roll commit log after this many bytes")
     ("Hypertable.CommitLog.Compressor", str()->default_value("quicklz"),
-        "Commit log compressor to use (zlib, lzo, quicklz, bmz, none)")
+        "Commit log compressor to use (zlib, lzo, lz4, lz4hc, quicklz, bmz, none)")
     ("Hypertable.CommitLog.SkipErrors", boo()->default_value(false),
         "Skip over any corruption encountered in the commit log")
     ("Hypertable.RangeServer.Scanner.Ttl", i32()->default_value(1800*K),
@@ -390,6 +482,11 @@ void DefaultPolicy::init_options() {
         "Millisecond delay before scheduling merging compactions in non-low memory mode")
     ("Hypertable.RangeServer.Maintenance.MoveCompactionsPerInterval", i32()->default_value(2),
         "Limit on number of major compactions due to move per maintenance interval")
+    ("Hypertable.RangeServer.Maintenance.StatsRefreshInterval",
+        i32()->default_value(300000), "Maximum time, in milliseconds, the "
+        "maintenance statistics of a range without updates, scans or "
+        "maintenance are reused before they are gathered again (0 = gather "
+        "every range on every pass)")
     ("Hypertable.RangeServer.Monitoring.DataDirectories", str()->default_value("/"),
         "Comma-separated list of directory mount points of disk volumes to monitor")
     ("Hypertable.RangeServer.Workers", i32()->default_value(50),
@@ -400,6 +497,21 @@ void DefaultPolicy::init_options() {
         "Number of maintenance threads.  Default is min(2, number-of-cores).")
     ("Hypertable.RangeServer.UpdateDelay", i32()->default_value(0),
         "Number of milliseconds to wait before carrying out an update (TESTING)")
+    ("Hypertable.RangeServer.UpdateThrottle.Enable", boo()->default_value(false),
+        "Pace updates to the rate at which maintenance drains memory")
+    ("Hypertable.RangeServer.UpdateThrottle.MemoryThreshold",
+        i32()->default_value(80), "Percentage of the memory limit beyond "
+        "which updates are throttled")
+    ("Hypertable.RangeServer.UpdateThrottle.MaxDelay",
+        i32()->default_value(2000), "Maximum number of milliseconds an "
+        "update is delayed by the throttle")
+    ("Hypertable.RangeServer.UpdateThrottle.MinimumRate",
+        i64()->default_value(1*M), "Update rate (bytes/s) that is always "
+        "admitted, regardless of load")
+    ("Hypertable.RangeServer.UpdateThrottle.BlockingPercentage",
+        i32()->default_value(200), "Size of a range, as a percentage of "
+        "Range.MaximumSize, beyond which updates block until the range "
+        "is split")
     ("Hypertable.RangeServer.ProxyName", str()->default_value(""),
         "Use this value for the proxy name (if set) instead of reading from run dir.")
     ("ThriftBroker.Timeout", i32(), "Timeout (ms) for thrift broker")
@@ -415,6 +527,10 @@ void DefaultPolicy::init_options() {
         "Maximum flush interval in milliseconds")
     ("ThriftBroker.Workers", i32()->default_value(50), "Number of "
         "worker threads for thrift broker")
+    ("ThriftBroker.Server", str()->default_value("threaded"), "Thrift "
+        "broker server type, 'threaded' for one thread per connection or "
+        "'nonblocking' for an event loop serving all connections with "
+        "ThriftBroker.Workers threads")
     ("ThriftBroker.Hyperspace.Session.Reconnect", boo()->default_value(true),
         "ThriftBroker will reconnect to Hyperspace on session expiry")
     ;
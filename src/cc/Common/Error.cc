@@ -246,6 +246,7 @@ namespace {
     { Error::RANGESERVER_RANGE_BUSY, "RANGE SERVER range busy" },
     { Error::RANGESERVER_BAD_CELL_INTERVAL, "RANGE SERVER bad cell interval" },
     { Error::RANGESERVER_SHORT_CELLSTORE_READ, "RANGE SERVER short cellstore read" },
+    { Error::RANGESERVER_UPDATE_THROTTLED, "RANGE SERVER update throttled" },
     { Error::HQL_BAD_LOAD_FILE_FORMAT,         "HQL bad load file format" },
     { Error::METALOG_BAD_RS_HEADER, "METALOG bad range server metalog header" },
     { Error::METALOG_BAD_HEADER,  "METALOG bad metalog header" },
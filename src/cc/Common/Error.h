@@ -195,6 +195,7 @@ namespace Hypertable {
       RANGESERVER_RANGE_BUSY             = 0x00050019,
       RANGESERVER_BAD_CELL_INTERVAL      = 0x0005001A,
       RANGESERVER_SHORT_CELLSTORE_READ   = 0x0005001B,
+      RANGESERVER_UPDATE_THROTTLED       = 0x0005001C,
 
       HQL_BAD_LOAD_FILE_FORMAT  = 0x00060001,
 
@@ -293,7 +293,9 @@ namespace Hypertable {
      * Issues a pread request.  The caller will get notified of successful
      * completion or error via the given dispatch handler.  It's up to the
      * caller to deserialize the returned data in the MESSAGE event object.
-     * EOF is indicated by a short read.
+     * EOF is indicated by a short read.  Passing a PreadFuture as the
+     * handler does the deserialization and lets the caller wait for the
+     * data when it needs it.
      *
      * @param fd open file descriptor
      * @param offset starting offset of read
@@ -0,0 +1,106 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+
+#include "Filesystem.h"
+#include "PreadFuture.h"
+
+using namespace Hypertable;
+
+
+PreadFuture::PreadFuture(size_t len)
+  : m_buf(len), m_error(Error::OK), m_outstanding(false) {
+}
+
+
+PreadFuture::~PreadFuture() {
+  ScopedLock lock(m_mutex);
+  while (m_outstanding)
+    m_cond.wait(lock);
+}
+
+
+void PreadFuture::cancel() {
+  std::vector<boost::function<void ()> > callbacks;
+  {
+    ScopedLock lock(m_mutex);
+    m_outstanding = false;
+    m_error = Error::CANCELLED;
+    m_callbacks.swap(callbacks);
+    m_cond.notify_all();
+  }
+  for (size_t i=0; i<callbacks.size(); i++)
+    callbacks[i]();
+}
+
+
+void PreadFuture::handle(EventPtr &event) {
+  std::vector<boost::function<void ()> > callbacks;
+  {
+    ScopedLock lock(m_mutex);
+
+    if (event->type == Event::MESSAGE) {
+      try {
+        m_buf.ptr = m_buf.base +
+          Filesystem::decode_response_pread(event, m_buf.base, m_buf.size);
+      }
+      catch (Exception &e) {
+        m_error = e.code();
+        m_error_msg = e.what();
+      }
+    }
+    else {
+      m_error = event->error ? event->error : Error::REQUEST_TIMEOUT;
+      m_error_msg = Error::get_text(m_error);
+    }
+
+    m_outstanding = false;
+    m_callbacks.swap(callbacks);
+    m_cond.notify_all();
+  }
+  // run outside the lock, a callback may drop the last reference to this
+  for (size_t i=0; i<callbacks.size(); i++)
+    callbacks[i]();
+}
+
+
+bool PreadFuture::when_ready(const boost::function<void ()> &callback) {
+  ScopedLock lock(m_mutex);
+  if (!m_outstanding)
+    return false;
+  m_callbacks.push_back(callback);
+  return true;
+}
+
+
+DynamicBuffer &PreadFuture::get() {
+  ScopedLock lock(m_mutex);
+
+  while (m_outstanding)
+    m_cond.wait(lock);
+
+  if (m_error != Error::OK)
+    HT_THROW(m_error, m_error_msg);
+
+  return m_buf;
+}
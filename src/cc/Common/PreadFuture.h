@@ -0,0 +1,120 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_PREADFUTURE_H
+#define HYPERTABLE_PREADFUTURE_H
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Mutex.h"
+#include "Common/String.h"
+
+#include "AsyncComm/DispatchHandler.h"
+
+namespace Hypertable {
+
+  /**
+   * Result of an asynchronous pread.  Passed as the dispatch handler to
+   * Filesystem::pread(int, size_t, uint64_t, DispatchHandler *), it copies
+   * the data out of the response when it arrives, so that a caller can
+   * keep several reads in flight and collect each one with get() when it
+   * needs the data.  A caller that must not block can instead have a
+   * callback run when the response arrives, see when_ready().  The
+   * destructor waits for an outstanding response, since the filesystem
+   * holds on to the handler until then.
+   */
+  class PreadFuture : public DispatchHandler {
+  public:
+
+    /**
+     * Constructor.
+     *
+     * @param len amount of data the read was issued for
+     */
+    PreadFuture(size_t len);
+
+    virtual ~PreadFuture();
+
+    /**
+     * Marks the read as issued.  Call before passing this object to
+     * Filesystem::pread(), and call cancel() if that throws.
+     */
+    void issue() {
+      ScopedLock lock(m_mutex);
+      m_outstanding = true;
+    }
+
+    /**
+     * Withdraws a read whose request could not be sent.
+     */
+    void cancel();
+
+    virtual void handle(EventPtr &event);
+
+    /**
+     * Returns true if the response has arrived.
+     */
+    bool is_ready() {
+      ScopedLock lock(m_mutex);
+      return !m_outstanding;
+    }
+
+    /**
+     * Arranges for <code>callback</code> to be called once the response
+     * has arrived or the read was cancelled.  The callback runs on the
+     * thread that delivers the response, so it should only hand work off,
+     * e.g. to an application queue.
+     *
+     * @param callback function to call when the read completes
+     * @return false, without registering the callback, if the read has
+     *         already completed
+     */
+    bool when_ready(const boost::function<void ()> &callback);
+
+    /**
+     * Waits for the response and returns the data read, with
+     * <code>ptr</code> positioned after the last byte.  A short read
+     * indicates EOF.
+     *
+     * @return buffer holding the data read
+     * @throws Exception carrying the error of a failed read
+     */
+    DynamicBuffer &get();
+
+  private:
+    Mutex             m_mutex;
+    boost::condition  m_cond;
+    DynamicBuffer     m_buf;
+    int               m_error;
+    String            m_error_msg;
+    bool              m_outstanding;
+    std::vector<boost::function<void ()> > m_callbacks;
+  };
+
+  typedef boost::intrusive_ptr<PreadFuture> PreadFuturePtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_PREADFUTURE_H
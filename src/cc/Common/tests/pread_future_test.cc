@@ -0,0 +1,161 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Serialization.h"
+#include "Common/PreadFuture.h"
+
+#include <cstring>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace Hypertable;
+using namespace Serialization;
+
+namespace {
+
+  /** Builds the response to a pread of <code>data</code> at offset 0 */
+  EventPtr make_response(const char *data, size_t len) {
+    EventPtr event = new Event(Event::MESSAGE);
+    uint8_t *payload = new uint8_t[4 + 8 + 4 + len];
+    uint8_t *ptr = payload;
+    encode_i32(&ptr, Error::OK);
+    encode_i64(&ptr, 0);
+    encode_i32(&ptr, len);
+    memcpy(ptr, data, len);
+    event->payload = payload;
+    event->payload_len = 4 + 8 + 4 + len;
+    return event;
+  }
+
+  void deliver(PreadFuture *future, EventPtr event) {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    future->handle(event);
+  }
+
+  void test_ready() {
+    PreadFuturePtr future = new PreadFuture(5);
+    HT_ASSERT(future->is_ready());
+    future->issue();
+    HT_ASSERT(!future->is_ready());
+    EventPtr event = make_response("hello", 5);
+    future->handle(event);
+    HT_ASSERT(future->is_ready());
+    DynamicBuffer &buf = future->get();
+    HT_ASSERT(buf.fill() == 5);
+    HT_ASSERT(!memcmp(buf.base, "hello", 5));
+  }
+
+  void test_short_read() {
+    PreadFuturePtr future = new PreadFuture(16);
+    future->issue();
+    EventPtr event = make_response("eof", 3);
+    future->handle(event);
+    HT_ASSERT(future->get().fill() == 3);
+  }
+
+  void test_wait() {
+    PreadFuturePtr future = new PreadFuture(4);
+    future->issue();
+    boost::thread thread(boost::bind(deliver, future.get(),
+                                     make_response("data", 4)));
+    DynamicBuffer &buf = future->get();
+    HT_ASSERT(buf.fill() == 4);
+    HT_ASSERT(!memcmp(buf.base, "data", 4));
+    thread.join();
+  }
+
+  void test_error() {
+    PreadFuturePtr future = new PreadFuture(4);
+    future->issue();
+    EventPtr event = new Event(Event::ERROR, Error::REQUEST_TIMEOUT);
+    future->handle(event);
+    try {
+      future->get();
+      HT_ASSERT(!"expected exception");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::REQUEST_TIMEOUT);
+    }
+  }
+
+  void test_cancel() {
+    PreadFuturePtr future = new PreadFuture(4);
+    future->issue();
+    future->cancel();
+    HT_ASSERT(future->is_ready());
+    try {
+      future->get();
+      HT_ASSERT(!"expected exception");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::CANCELLED);
+    }
+  }
+
+  void count(int *calls) {
+    (*calls)++;
+  }
+
+  void test_when_ready() {
+    PreadFuturePtr future = new PreadFuture(4);
+    int calls = 0;
+    HT_ASSERT(!future->when_ready(boost::bind(count, &calls)));
+    future->issue();
+    HT_ASSERT(future->when_ready(boost::bind(count, &calls)));
+    HT_ASSERT(future->when_ready(boost::bind(count, &calls)));
+    HT_ASSERT(calls == 0);
+    EventPtr event = make_response("done", 4);
+    future->handle(event);
+    HT_ASSERT(calls == 2);
+    HT_ASSERT(!future->when_ready(boost::bind(count, &calls)));
+    HT_ASSERT(!memcmp(future->get().base, "done", 4));
+
+    future = new PreadFuture(4);
+    future->issue();
+    HT_ASSERT(future->when_ready(boost::bind(count, &calls)));
+    future->cancel();
+    HT_ASSERT(calls == 3);
+  }
+
+  void test_destructor_waits() {
+    PreadFuture *future = new PreadFuture(4);
+    future->issue();
+    boost::thread thread(boost::bind(deliver, future,
+                                     make_response("late", 4)));
+    delete future;
+    thread.join();
+  }
+
+} // local namespace
+
+int main(int argc, char **argv) {
+  test_ready();
+  test_short_read();
+  test_wait();
+  test_error();
+  test_cancel();
+  test_when_ready();
+  test_destructor_waits();
+  return 0;
+}
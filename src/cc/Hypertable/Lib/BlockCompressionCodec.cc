@@ -31,7 +31,9 @@ namespace {
     "bmz",
     "zlib",
     "lzo",
-    "quicklz"
+    "quicklz",
+    "lz4",
+    "lz4hc"
   };
 }
 
@@ -39,7 +39,7 @@ namespace Hypertable {
   class BlockCompressionCodec : public ReferenceCount {
   public:
     enum Type { UNKNOWN=-1, NONE=0, BMZ=1, ZLIB=2, LZO=3, QUICKLZ=4,
-                COMPRESSION_TYPE_LIMIT=5 };
+                LZ4=5, LZ4HC=6, COMPRESSION_TYPE_LIMIT=7 };
     typedef std::vector<String> Args;
 
     static const char *get_compressor_name(uint16_t algo);
@@ -0,0 +1,77 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "BlockCompressionCodecAdaptive.h"
+#include "CompressorFactory.h"
+
+using namespace Hypertable;
+
+
+BlockCompressionCodecAdaptive::BlockCompressionCodecAdaptive(Type default_type,
+    const Args &args) : m_default_type(default_type), m_default_args(args) {
+  memset(m_codecs, 0, sizeof(m_codecs));
+}
+
+
+BlockCompressionCodecAdaptive::~BlockCompressionCodecAdaptive() {
+  for (size_t i=0; i<COMPRESSION_TYPE_LIMIT; i++)
+    delete m_codecs[i];
+}
+
+
+BlockCompressionCodec *BlockCompressionCodecAdaptive::get_codec(uint16_t type) {
+  if (type >= COMPRESSION_TYPE_LIMIT)
+    HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE,
+              "Invalid compression type '%d'", (int)type);
+  if (m_codecs[type] == 0) {
+    if (type == (uint16_t)m_default_type)
+      m_codecs[type] = CompressorFactory::create_block_codec(m_default_type,
+                                                             m_default_args);
+    else
+      m_codecs[type] = CompressorFactory::create_block_codec((Type)type);
+  }
+  return m_codecs[type];
+}
+
+
+void
+BlockCompressionCodecAdaptive::deflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockCompressionHeader &header, size_t reserve) {
+  get_codec(m_default_type)->deflate(input, output, header, reserve);
+}
+
+
+void BlockCompressionCodecAdaptive::inflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockCompressionHeader &header) {
+  const uint8_t *ptr = input.base;
+  size_t remaining = input.fill();
+
+  // peek at the compression type, the codec decodes the header again
+  header.decode(&ptr, &remaining);
+
+  get_codec(header.get_compression_type())->inflate(input, output, header);
+}
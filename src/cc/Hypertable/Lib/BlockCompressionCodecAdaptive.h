@@ -0,0 +1,57 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BLOCKCOMPRESSIONCODECADAPTIVE_H
+#define HYPERTABLE_BLOCKCOMPRESSIONCODECADAPTIVE_H
+
+#include "BlockCompressionCodec.h"
+
+namespace Hypertable {
+
+  /**
+   * Codec for files whose blocks may each be compressed with a different
+   * codec.  Inflate dispatches on the compression type recorded in the
+   * block header; codecs are created on first use.  Deflate uses the
+   * default codec.
+   */
+  class BlockCompressionCodecAdaptive : public BlockCompressionCodec {
+
+  public:
+    BlockCompressionCodecAdaptive(Type default_type, const Args &args=Args());
+    virtual ~BlockCompressionCodecAdaptive();
+
+    virtual void deflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockCompressionHeader &header, size_t reserve=0);
+    virtual void inflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockCompressionHeader &header);
+    virtual int get_type() { return m_default_type; }
+
+  private:
+    BlockCompressionCodec *get_codec(uint16_t type);
+
+    Type m_default_type;
+    Args m_default_args;
+    BlockCompressionCodec *m_codecs[COMPRESSION_TYPE_LIMIT];
+  };
+
+}
+
+#endif // HYPERTABLE_BLOCKCOMPRESSIONCODECADAPTIVE_H
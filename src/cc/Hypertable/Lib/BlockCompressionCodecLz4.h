@@ -0,0 +1,55 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4_H
+#define HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4_H
+
+#include "BlockCompressionCodec.h"
+#include "lz4/lz4.h"
+
+namespace Hypertable {
+
+  /**
+   * LZ4 block format codec.  Trades some compression ratio against LZO for
+   * considerably faster decompression.
+   */
+  class BlockCompressionCodecLz4 : public BlockCompressionCodec {
+
+  public:
+    BlockCompressionCodecLz4(const Args &args);
+    virtual ~BlockCompressionCodecLz4();
+
+    virtual void deflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockCompressionHeader &header, size_t reserve=0);
+    virtual void inflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockCompressionHeader &header);
+    virtual int get_type() { return LZ4; }
+
+  protected:
+    virtual size_t compress(const uint8_t *src, size_t len, uint8_t *dst);
+
+  private:
+    lz4_state *m_state;
+  };
+
+}
+
+#endif // HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4_H
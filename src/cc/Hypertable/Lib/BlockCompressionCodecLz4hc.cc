@@ -0,0 +1,91 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cstdlib>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "BlockCompressionCodecLz4hc.h"
+
+using namespace Hypertable;
+
+
+/**
+ *
+ */
+BlockCompressionCodecLz4hc::BlockCompressionCodecLz4hc(const Args &args)
+  : BlockCompressionCodecLz4(args), m_hc_state(0),
+    m_level(LZ4HC_DEFAULT_LEVEL) {
+  if (!args.empty())
+    set_args(args);
+}
+
+
+/**
+ *
+ */
+BlockCompressionCodecLz4hc::~BlockCompressionCodecLz4hc() {
+  delete m_hc_state;
+}
+
+
+void BlockCompressionCodecLz4hc::set_args(const Args &args) {
+  Args::const_iterator it = args.begin(), arg_end = args.end();
+  String level;
+
+  for (; it != arg_end; ++it) {
+    if (*it == "--level" || *it == "-l") {
+      if (++it == arg_end)
+        HT_THROW(Error::BLOCK_COMPRESSOR_INVALID_ARG,
+                 "Missing value for Lz4hc codec argument --level");
+      level = *it;
+    }
+    else if (it->compare(0, 8, "--level=") == 0)
+      level = it->substr(8);
+    else if (*it == "--best") {
+      m_level = LZ4HC_MAX_LEVEL;
+      continue;
+    }
+    else if (*it == "-9") {
+      m_level = 9;
+      continue;
+    }
+    else
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unrecognized argument "
+                "to Lz4hc codec: '%s'", (*it).c_str());
+
+    m_level = atoi(level.c_str());
+    if (m_level < 1 || m_level > LZ4HC_MAX_LEVEL)
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Invalid Lz4hc level "
+                "'%s' (must be 1..%d)", level.c_str(), LZ4HC_MAX_LEVEL);
+  }
+}
+
+
+size_t BlockCompressionCodecLz4hc::compress(const uint8_t *src, size_t len,
+                                            uint8_t *dst) {
+  if (m_hc_state == 0)
+    m_hc_state = new lz4hc_state;
+  return lz4_compress_hc(m_hc_state, src, len, dst, m_level);
+}
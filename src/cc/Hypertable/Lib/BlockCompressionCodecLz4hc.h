@@ -0,0 +1,53 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4HC_H
+#define HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4HC_H
+
+#include "BlockCompressionCodecLz4.h"
+
+namespace Hypertable {
+
+  /**
+   * High compression LZ4 codec.  Deflate searches hash chains for longer
+   * matches (bounded by --level), output is inflated by the LZ4 decoder
+   * at the same speed.
+   */
+  class BlockCompressionCodecLz4hc : public BlockCompressionCodecLz4 {
+
+  public:
+    BlockCompressionCodecLz4hc(const Args &args);
+    virtual ~BlockCompressionCodecLz4hc();
+
+    virtual void set_args(const Args &args);
+    virtual int get_type() { return LZ4HC; }
+
+  protected:
+    virtual size_t compress(const uint8_t *src, size_t len, uint8_t *dst);
+
+  private:
+    lz4hc_state *m_hc_state;
+    int m_level;
+  };
+
+}
+
+#endif // HYPERTABLE_BLOCKCOMPRESSIONCODECLZ4HC_H
@@ -48,6 +48,10 @@ public:
     return m_arena.used();
   }
 
+  size_t memory_allocated() const {
+    return m_arena.total();
+  }
+
   void get_cell(Cell &cc, size_t ii) {
     cc = m_cells[ii];
   }
@@ -27,6 +27,8 @@
 #include "BlockCompressionCodecZlib.h"
 #include "BlockCompressionCodecLzo.h"
 #include "BlockCompressionCodecQuicklz.h"
+#include "BlockCompressionCodecLz4.h"
+#include "BlockCompressionCodecLz4hc.h"
 
 using namespace Hypertable;
 using namespace std;
@@ -59,6 +61,12 @@ CompressorFactory::parse_block_codec_spec(const std::string &spec,
   if (name == "quicklz")
     return BlockCompressionCodec::QUICKLZ;
 
+  if (name == "lz4")
+    return BlockCompressionCodec::LZ4;
+
+  if (name == "lz4hc")
+    return BlockCompressionCodec::LZ4HC;
+
   HT_ERRORF("unknown codec type: %s", name.c_str());
   return BlockCompressionCodec::UNKNOWN;
 }
@@ -77,6 +85,10 @@ CompressorFactory::create_block_codec(BlockCompressionCodec::Type type,
     return new BlockCompressionCodecLzo(args);
   case BlockCompressionCodec::QUICKLZ:
     return new BlockCompressionCodecQuicklz(args);
+  case BlockCompressionCodec::LZ4:
+    return new BlockCompressionCodecLz4(args);
+  case BlockCompressionCodec::LZ4HC:
+    return new BlockCompressionCodecLz4hc(args);
   default:
     HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE, "Invalid compression "
               "type: '%d'", (int)type);
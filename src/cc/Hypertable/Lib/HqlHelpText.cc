@@ -338,6 +338,7 @@ namespace {
     "    access_group_option:",
     "      IN_MEMORY",
     "      | BLOCKSIZE '=' int",
+    "      | BLOB_THRESHOLD '=' int",
     "      | REPLICATION '=' int",
     "      | COMPRESSOR '=' compressor_spec",
     "      | BLOOMFILTER '=' bloom_filter_spec",
@@ -345,6 +346,8 @@ namespace {
     "    compressor_spec:",
     "      bmz [ bmz_options ]",
     "      | lzo",
+    "      | lz4",
+    "      | lz4hc [ lz4hc_options ]",
     "      | quicklz",
     "      | zlib [ zlib_options ]",
     "      | none",
@@ -358,6 +361,11 @@ namespace {
     "      | --best",
     "      | --normal",
     "",
+    "    lz4hc_options:",
+    "      -9",
+    "      | --best",
+    "      | --level int",
+    "",
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
     "      | rows+cols [ bloom_filter_options ]",
@@ -498,6 +506,7 @@ namespace {
     "      COUNTER",
     "      | IN_MEMORY",
     "      | BLOCKSIZE '=' int",
+    "      | BLOB_THRESHOLD '=' int",
     "      | REPLICATION '=' int",
     "      | COMPRESSOR '=' compressor_spec",
     "      | BLOOMFILTER '=' bloom_filter_spec",
@@ -505,6 +514,8 @@ namespace {
     "    compressor_spec:",
     "      bmz [ bmz_options ]",
     "      | lzo",
+    "      | lz4",
+    "      | lz4hc [ lz4hc_options ]",
     "      | quicklz",
     "      | zlib [ zlib_options ]",
     "      | none",
@@ -518,6 +529,11 @@ namespace {
     "      | --best",
     "      | --normal",
     "",
+    "    lz4hc_options:",
+    "      -9",
+    "      | --best",
+    "      | --level int",
+    "",
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
     "      | rows+cols [ bloom_filter_options ]",
@@ -682,6 +698,7 @@ namespace {
     "  * COUNTER",
     "  * IN_MEMORY",
     "  * BLOCKSIZE '=' int",
+    "  * BLOB_THRESHOLD '=' int",
     "  * REPLICATION '=' int",
     "  * COMPRESSOR '=' compressor_spec",
     "  * BLOOMFILTER '=' bloom_filter_spec",
@@ -708,6 +725,13 @@ namespace {
     "from disk and decompressed for a key lookup at the expense of a larger block",
     "index which consumes memory.  The default value for the block size is 65K.",
     "",
+    "The BLOB_THRESHOLD option enables key/value separation for the access group.",
+    "When cell data is compacted out of the cell cache, values that are at least",
+    "this many bytes long are appended to a separate blob log file and the cell",
+    "store records only a small reference to them.  Subsequent merging and major",
+    "compactions only rewrite the references, which substantially reduces",
+    "compaction I/O for tables with large values.  The default is 0 (disabled).",
+    "",
     "The REPLICATION option controls the replication level in the underlying",
     "distributed file system (DFS) for cell store files created for this access",
     "group.  The default is unspecified, which translates to whatever the default",
@@ -769,6 +793,8 @@ namespace {
     "",
     "  * bmz",
     "  * lzo",
+    "  * lz4",
+    "  * lz4hc",
     "  * quicklz",
     "  * zlib",
     "  * none",
@@ -780,6 +806,10 @@ namespace {
     "  bmz --offset arg    Starting fingerprint offset (default = 0)",
     "  zlib -9 [ --best ]  Highest compression ratio (at the cost of speed)",
     "  zlib --normal       Normal compression ratio",
+    "  lz4hc --level arg   Compression level, 1 (fastest) to 12 (smallest)",
+    "                      (default = 9)",
+    "  lz4hc -9            Compression level 9",
+    "  lz4hc --best        Highest compression level (12)",
     "",
     0
   };
@@ -1383,6 +1413,27 @@ namespace {
     "it is read from the local FS (this is the default in the absence of a location ",
     " specifier)."
     "",
+    "Load from a parallel dump",
+    "-------------------------",
+    "",
+    "If the file name is a MANIFEST written by DUMP TABLE ... PARALLEL, all of the",
+    "files listed in it are loaded into the table.  A manifest is recognized by its",
+    "first line, other files named MANIFEST are loaded as ordinary input.",
+    "",
+    "Parallel loading",
+    "----------------",
+    "",
+    "When Hypertable.HqlInterpreter.LoadData.Threads is greater than one, the",
+    "input is read in chunks of Hypertable.HqlInterpreter.LoadData.ChunkSize bytes",
+    "which are parsed and loaded concurrently by that many threads.  Loads into a",
+    "file and loads with ROW_UNIQUIFY_CHARS are not parallelized.",
+    "",
+    "Each thread has its own mutator, so cells of different chunks may reach the",
+    "table in any order.  Within a chunk the input order is kept, but if the same",
+    "cell is inserted or deleted in more than one chunk without explicit",
+    "timestamps, which of those updates wins is undefined.  Use a single thread",
+    "for input that depends on the order of updates to the same cell.",
+    "",
     0
   };
 
@@ -1656,6 +1707,7 @@ namespace {
     "      (REVS revision_count",
     "      | INTO FILE filename[.gz]",
     "      | BUCKETS <n>",
+    "      | PARALLEL <n>",
     "      | NO_ESCAPE)*",
     "",
     "    timestamp:",
@@ -1704,6 +1756,18 @@ namespace {
     "20.  It is recommended that <n> is at least as large as the number of nodes",
     "in the cluster that the backup with be restored to.",
     "",
+    "PARALLEL <n>",
+    "",
+    "This option dumps the ranges of the table concurrently on <n> threads and",
+    "requires INTO FILE.  The file name names a directory that receives one",
+    "file per range, part-NNNNN.tsv, and a MANIFEST file listing them.  If the",
+    "name ends in .gz, the .gz is dropped from the directory name and each",
+    "part file is compressed with gzip.  The backup is restored by passing the",
+    "manifest to LOAD DATA INFILE, for example:",
+    "",
+    "  DUMP TABLE foo PARALLEL 8 INTO FILE 'dfs:///backup/foo.gz';",
+    "  LOAD DATA INFILE 'dfs:///backup/foo/MANIFEST' INTO TABLE foo;",
+    "",
     "NO_ESCAPE",
     "",
     "The output format of a DUMP TABLE command comprises tab delimited lines, one",
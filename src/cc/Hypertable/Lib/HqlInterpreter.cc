@@ -31,7 +31,12 @@ extern "C" {
 #include <time.h>
 }
 
+#include <deque>
+
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
@@ -40,6 +45,7 @@ extern "C" {
 #include "Common/Config.h"
 #include "Common/Error.h"
 #include "Common/FileUtils.h"
+#include "Common/Mutex.h"
 #include "Common/Stopwatch.h"
 #include "Common/ScopeGuard.h"
 #include "Common/String.h"
@@ -53,6 +59,7 @@ extern "C" {
 #include "LoadDataEscape.h"
 #include "LoadDataFlags.h"
 #include "LoadDataSource.h"
+#include "LoadDataSourceChunk.h"
 #include "LoadDataSourceFactory.h"
 #include "ScanSpec.h"
 #include "TableSplit.h"
@@ -66,6 +73,11 @@ using namespace Hql;
 
 namespace {
 
+/// File name of the manifest written by DUMP TABLE ... PARALLEL
+const char *DUMP_MANIFEST = "MANIFEST";
+/// First line of a dump manifest, includes the manifest format version
+const char *DUMP_MANIFEST_MAGIC = "#hypertable-dump-manifest 1";
+
 void close_file(int fd) {
   if (fd >= 0)
     close(fd);
@@ -305,7 +317,7 @@ cmd_select(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
   String localfs = "file://";
 
   table = ns->open_table(state.table_name);
-  scanner = table->create_scanner(state.scan.builder.get(), 0, true);
+  scanner = table->create_scanner(state.scan.builder.get());
 
   // whether it's select into file
   if (!state.scan.outfile.empty()) {
@@ -444,6 +456,252 @@ cmd_select(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
 }
 
 
+/**
+ * Writes cell as a line of DUMP TABLE output
+ */
+void
+dump_cell(std::ostream &fout, const Cell &cell, bool escape,
+          LoadDataEscape &row_escaper, LoadDataEscape &escaper) {
+  const char *unescaped_buf, *row_unescaped_buf;
+  size_t unescaped_len, row_unescaped_len;
+
+  fout << cell.timestamp << "\t";
+
+  if (escape)
+    row_escaper.escape(cell.row_key, strlen(cell.row_key),
+                       &row_unescaped_buf, &row_unescaped_len);
+  else
+    row_unescaped_buf = cell.row_key;
+
+  if (cell.column_family) {
+    fout << row_unescaped_buf << "\t" << cell.column_family;
+    if (cell.column_qualifier && *cell.column_qualifier) {
+      if (escape)
+        escaper.escape(cell.column_qualifier, strlen(cell.column_qualifier),
+                       &unescaped_buf, &unescaped_len);
+      else
+        unescaped_buf = cell.column_qualifier;
+      fout << ":" << unescaped_buf;
+    }
+  }
+  else
+    fout << row_unescaped_buf;
+
+  if (escape)
+    escaper.escape((const char *)cell.value, (size_t)cell.value_len,
+                   &unescaped_buf, &unescaped_len);
+  else {
+    unescaped_buf = (const char *)cell.value;
+    unescaped_len = (size_t)cell.value_len;
+  }
+
+  HT_ASSERT(cell.flag == FLAG_INSERT);
+
+  fout << "\t" ;
+  fout.write(unescaped_buf, unescaped_len);
+  fout << "\n";
+}
+
+/**
+ * Dumps a table into a directory with one output file per range.  The
+ * ranges are scanned concurrently by a pool of threads, each taking the
+ * next range not yet dumped.  A manifest listing the output files is
+ * written last; LOAD DATA INFILE restores the table from it.
+ */
+class ParallelDumper {
+public:
+  ParallelDumper(NamespacePtr &ns, DfsBroker::ClientPtr &dfs_client,
+                 ParserState &state, const String &dir, bool dfs,
+                 bool compress)
+    : m_dfs_client(dfs_client), m_scan_spec(state.scan.builder.get()),
+      m_escape(state.escape), m_dir(dir), m_dfs(dfs), m_compress(compress),
+      m_next(0), m_error(Error::OK), m_total_cells(0), m_total_keys_size(0),
+      m_total_values_size(0) {
+    ns->get_table_splits(state.table_name, m_splits);
+    m_table = ns->open_table(state.table_name);
+    m_parts.resize(m_splits.size());
+  }
+
+  /**
+   * Dumps the table on threads threads, writes the manifest and adds the
+   * dump statistics to cb
+   */
+  void run(size_t threads, HqlInterpreter::Callback &cb) {
+    boost::thread_group workers;
+
+    if (m_dfs)
+      m_dfs_client->mkdirs(m_dir);
+    else if (!FileUtils::mkdirs(m_dir))
+      HT_THROWF(Error::EXTERNAL, "Unable to create directory '%s'",
+                m_dir.c_str());
+
+    for (size_t i=0; i<threads && i<m_splits.size(); i++)
+      workers.create_thread(boost::bind(&ParallelDumper::dump, this));
+    workers.join_all();
+
+    if (m_error != Error::OK)
+      HT_THROW(m_error, m_error_msg);
+
+    write_manifest();
+
+    if (cb.normal_mode) {
+      cb.total_cells += m_total_cells;
+      cb.total_keys_size += m_total_keys_size;
+      cb.total_values_size += m_total_values_size;
+    }
+  }
+
+private:
+  struct Part {
+    Part() : cells(0) { }
+    String name;
+    ::uint64_t cells;
+  };
+
+  void open_output(boost::iostreams::filtering_ostream &fout,
+                   const String &name) {
+    String path = m_dir + "/" + name;
+    if (m_compress)
+      fout.push(boost::iostreams::gzip_compressor());
+    if (m_dfs)
+      fout.push(DfsBroker::FileSink(m_dfs_client, path));
+    else
+      fout.push(boost::iostreams::file_descriptor_sink(path));
+  }
+
+  void dump() {
+    Cell cell;
+    LoadDataEscape row_escaper;
+    LoadDataEscape escaper;
+    ::uint64_t cells = 0, keys_size = 0, values_size = 0;
+    size_t index;
+
+    try {
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_next == m_splits.size() || m_error != Error::OK)
+            break;
+          index = m_next++;
+        }
+
+        Part &part = m_parts[index];
+        // the scan spec vectors allocate from the arena of their builder,
+        // so every range is scanned with a deep copy of its own
+        ScanSpecBuilder ssb(m_scan_spec);
+        ssb.get().row_intervals.clear();
+        ssb.add_row_interval(m_splits[index].start_row, false,
+                             m_splits[index].end_row, true);
+        TableScannerPtr scanner = m_table->create_scanner(ssb.get());
+
+        part.name = format("part-%05u.tsv%s", (unsigned)index,
+                           m_compress ? ".gz" : "");
+        boost::iostreams::filtering_ostream fout;
+        open_output(fout, part.name);
+        fout << "#timestamp\trow\tcolumn\tvalue\n";
+
+        while (scanner->next(cell)) {
+          ++part.cells;
+          keys_size += strlen(cell.row_key);
+          if (cell.column_family && cell.column_qualifier)
+            keys_size += strlen(cell.column_qualifier) + 1;
+          values_size += cell.value_len;
+          dump_cell(fout, cell, m_escape, row_escaper, escaper);
+        }
+        fout.strict_sync();
+        cells += part.cells;
+      }
+    }
+    catch (Exception &e) {
+      ScopedLock lock(m_mutex);
+      if (m_error == Error::OK) {
+        m_error = e.code();
+        m_error_msg = e.what();
+      }
+    }
+    catch (std::exception &e) {
+      ScopedLock lock(m_mutex);
+      if (m_error == Error::OK) {
+        m_error = Error::EXTERNAL;
+        m_error_msg = e.what();
+      }
+    }
+
+    ScopedLock lock(m_mutex);
+    m_total_cells += cells;
+    m_total_keys_size += keys_size;
+    m_total_values_size += values_size;
+  }
+
+  void write_manifest() {
+    boost::iostreams::filtering_ostream fout;
+    String path = m_dir + "/" + DUMP_MANIFEST;
+
+    if (m_dfs)
+      fout.push(DfsBroker::FileSink(m_dfs_client, path));
+    else
+      fout.push(boost::iostreams::file_descriptor_sink(path));
+
+    fout << DUMP_MANIFEST_MAGIC << "\n";
+    fout << "#file\tcells\n";
+    foreach(const Part &part, m_parts)
+      fout << part.name << "\t" << part.cells << "\n";
+    fout.strict_sync();
+  }
+
+  DfsBroker::ClientPtr &m_dfs_client;
+  const ScanSpec &m_scan_spec;
+  bool m_escape;
+  String m_dir;
+  bool m_dfs;
+  bool m_compress;
+  TablePtr m_table;
+  TableSplitsContainer m_splits;
+  std::vector<Part> m_parts;
+  Mutex m_mutex;
+  size_t m_next;
+  int m_error;
+  String m_error_msg;
+  ::uint64_t m_total_cells;
+  ::uint64_t m_total_keys_size;
+  ::uint64_t m_total_values_size;
+};
+
+/**
+ * DUMP TABLE ... PARALLEL n INTO FILE "dir[.gz]"
+ */
+void
+dump_table_parallel(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
+                    DfsBroker::ClientPtr &dfs_client, ParserState &state,
+                    HqlInterpreter::Callback &cb) {
+  String dir = state.scan.outfile;
+  bool dfs = false;
+  bool compress = false;
+
+  if (dir.empty())
+    HT_THROW(Error::HQL_PARSE_ERROR,
+             "DUMP TABLE ... PARALLEL requires INTO FILE");
+
+  FileUtils::expand_tilde(dir);
+  if (boost::algorithm::ends_with(dir, ".gz")) {
+    compress = true;
+    dir.resize(dir.length() - 3);
+  }
+  if (boost::algorithm::starts_with(dir, "dfs://")) {
+    dfs = true;
+    dir = dir.substr(6);
+    if (!dfs_client)
+      dfs_client = new DfsBroker::Client(conn_manager, Config::properties);
+  }
+  else if (boost::algorithm::starts_with(dir, "file://"))
+    dir = dir.substr(7);
+
+  ParallelDumper dumper(ns, dfs_client, state, dir, dfs, compress);
+  dumper.run(state.scan.parallel, cb);
+
+  cb.on_finish((TableMutator*)0);
+}
+
 void
 cmd_dump_table(NamespacePtr &ns,
                ConnectionManagerPtr &conn_manager, DfsBroker::ClientPtr &dfs_client,
@@ -459,6 +717,11 @@ cmd_dump_table(NamespacePtr &ns,
 
   // verify parameters
 
+  if (state.scan.parallel > 0) {
+    dump_table_parallel(ns, conn_manager, dfs_client, state, cb);
+    return;
+  }
+
   TableDumperPtr dumper = new TableDumper(ns, state.table_name, state.scan.builder.get());
 
   // whether it's select into file
@@ -493,8 +756,6 @@ cmd_dump_table(NamespacePtr &ns,
   Cell cell;
   LoadDataEscape row_escaper;
   LoadDataEscape escaper;
-  const char *unescaped_buf, *row_unescaped_buf;
-  size_t unescaped_len, row_unescaped_len;
 
   while (dumper->next(cell)) {
     if (cb.normal_mode) {
@@ -508,46 +769,351 @@ cmd_dump_table(NamespacePtr &ns,
       cb.total_values_size += cell.value_len;
     }
 
-    fout << cell.timestamp << "\t";
+    dump_cell(fout, cell, state.escape, row_escaper, escaper);
+  }
+
+  fout.strict_sync();
 
-    if (state.escape)
-      row_escaper.escape(cell.row_key, strlen(cell.row_key),
-			 &row_unescaped_buf, &row_unescaped_len);
-    else
-      row_unescaped_buf = cell.row_key;
+  cb.on_finish((TableMutator*)0);
+}
 
-    if (cell.column_family) {
-      fout << row_unescaped_buf << "\t" << cell.column_family;
-      if (cell.column_qualifier && *cell.column_qualifier) {
-	if (state.escape)
-	  escaper.escape(cell.column_qualifier, strlen(cell.column_qualifier),
-			 &unescaped_buf, &unescaped_len);
-	else
-	  unescaped_buf = cell.column_qualifier;
-	fout << ":" << unescaped_buf;
+/**
+ * Loads chunks of input lines into a table on a pool of threads.  Each
+ * thread parses the chunks it takes with its own LoadDataSourceChunk and
+ * writes the cells with its own mutator.
+ */
+class ParallelLoader {
+public:
+  ParallelLoader(TablePtr &table, ::uint32_t mutator_flags,
+                 LoadDataSourcePtr &lds, ParserState &state, size_t threads)
+    : m_escape(state.escape), m_queue_limit(2 * threads), m_finished(false),
+      m_error(Error::OK), m_total_cells(0), m_total_keys_size(0),
+      m_total_values_size(0) {
+    for (size_t i=0; i<threads; i++) {
+      LoadDataSourceChunkPtr parser =
+          new LoadDataSourceChunk(*lds, state.load_flags);
+      TableMutatorPtr mutator = table->create_mutator(0, mutator_flags);
+      m_threads.create_thread(boost::bind(&ParallelLoader::load, this,
+                                          parser, mutator));
+    }
+  }
+
+  /**
+   * Queues the lines of chunk for loading and clears them, waits while
+   * the queue is full
+   *
+   * @return false if loading failed, see finish()
+   */
+  bool add(String &lines, int64_t first_line) {
+    ScopedLock lock(m_mutex);
+    while (m_queue.size() >= m_queue_limit && m_error == Error::OK)
+      m_cond.wait(lock);
+    if (m_error != Error::OK)
+      return false;
+    m_queue.push_back(Chunk());
+    m_queue.back().lines.swap(lines);
+    m_queue.back().first_line = first_line;
+    m_cond.notify_all();
+    return true;
+  }
+
+  /**
+   * Waits for all chunks to be loaded and the mutators to be flushed,
+   * adds the load statistics to cb and throws the first error encountered
+   */
+  void finish(HqlInterpreter::Callback &cb) {
+    {
+      ScopedLock lock(m_mutex);
+      m_finished = true;
+      m_cond.notify_all();
+    }
+    m_threads.join_all();
+    cb.total_cells += m_total_cells;
+    cb.total_keys_size += m_total_keys_size;
+    cb.total_values_size += m_total_values_size;
+    if (m_error != Error::OK)
+      HT_THROW(m_error, m_error_msg);
+  }
+
+private:
+  struct Chunk {
+    String lines;
+    int64_t first_line;
+  };
+
+  bool next_chunk(Chunk &chunk) {
+    ScopedLock lock(m_mutex);
+    while (m_queue.empty() && !m_finished && m_error == Error::OK)
+      m_cond.wait(lock);
+    if (m_queue.empty() || m_error != Error::OK)
+      return false;
+    chunk.lines.swap(m_queue.front().lines);
+    chunk.first_line = m_queue.front().first_line;
+    m_queue.pop_front();
+    m_cond.notify_all();
+    return true;
+  }
+
+  /**
+   * Records the first error of any thread, finish() throws it
+   */
+  void set_error(int error, const String &msg) {
+    ScopedLock lock(m_mutex);
+    if (m_error == Error::OK) {
+      m_error = error;
+      m_error_msg = msg;
+    }
+    m_cond.notify_all();
+  }
+
+  void load(LoadDataSourceChunkPtr parser, TableMutatorPtr mutator) {
+    Chunk chunk;
+    KeySpec key;
+    ::uint8_t *value;
+    ::uint32_t value_len;
+    bool is_delete;
+    LoadDataEscape row_escaper;
+    LoadDataEscape qualifier_escaper;
+    LoadDataEscape value_escaper;
+    const char *escaped_buf;
+    size_t escaped_len;
+    ::uint64_t cells = 0, keys_size = 0, values_size = 0;
+
+    try {
+      while (next_chunk(chunk)) {
+        parser->load(chunk.lines.data(), chunk.lines.length(),
+                     chunk.first_line);
+        try {
+          while (parser->next(&key, &value, &value_len, &is_delete, 0)) {
+            ++cells;
+            values_size += value_len;
+            keys_size += key.row_len;
+
+            if (m_escape) {
+              row_escaper.unescape((const char *)key.row, (size_t)key.row_len,
+                  &escaped_buf, &escaped_len);
+              key.row = escaped_buf;
+              key.row_len = escaped_len;
+              qualifier_escaper.unescape(key.column_qualifier,
+                  (size_t)key.column_qualifier_len, &escaped_buf, &escaped_len);
+              key.column_qualifier = escaped_buf;
+              key.column_qualifier_len = escaped_len;
+              value_escaper.unescape((const char *)value, (size_t)value_len,
+                  &escaped_buf, &escaped_len);
+            }
+            else {
+              escaped_buf = (const char *)value;
+              escaped_len = (size_t)value_len;
+            }
+
+            try {
+              if (is_delete)
+                mutator->set_delete(key);
+              else
+                mutator->set(key, escaped_buf, escaped_len);
+            }
+            catch (Exception &e) {
+              do {
+                mutator->show_failed(e);
+              } while (!mutator->retry());
+            }
+          }
+        }
+        catch (Exception &e) {
+          HT_THROW2F(e.code(), e, "line number %lld",
+                     (Lld)parser->get_current_lineno());
+        }
+      }
+
+      try {
+        mutator->flush();
+      }
+      catch (Exception &e) {
+        do {
+          mutator->show_failed(e);
+        } while (!mutator->retry());
       }
     }
-    else
-      fout << row_unescaped_buf;
+    catch (Exception &e) {
+      set_error(e.code(), e.what());
+    }
+    catch (std::exception &e) {
+      set_error(Error::EXTERNAL, e.what());
+    }
+    catch (...) {
+      set_error(Error::EXTERNAL, "caught unknown exception");
+    }
 
-    if (state.escape)
-      escaper.escape((const char *)cell.value, (size_t)cell.value_len,
-		     &unescaped_buf, &unescaped_len);
-    else {
-      unescaped_buf = (const char *)cell.value;
-      unescaped_len = (size_t)cell.value_len;
+    ScopedLock lock(m_mutex);
+    m_total_cells += cells;
+    m_total_keys_size += keys_size;
+    m_total_values_size += values_size;
+  }
+
+  bool m_escape;
+  size_t m_queue_limit;
+  Mutex m_mutex;
+  boost::condition m_cond;
+  std::deque<Chunk> m_queue;
+  bool m_finished;
+  int m_error;
+  String m_error_msg;
+  ::uint64_t m_total_cells;
+  ::uint64_t m_total_keys_size;
+  ::uint64_t m_total_values_size;
+  boost::thread_group m_threads;
+};
+
+/**
+ * Reads the input of lds in chunks of whole lines and hands them to loader
+ *
+ * @return false if loading failed
+ */
+bool
+read_chunks(ParallelLoader &loader, LoadDataSourcePtr &lds,
+            ParserState &state, HqlInterpreter::Callback &cb,
+            bool largefile_mode, int64_t &last_total) {
+  size_t chunk_size =
+      Config::properties->get_i32("Hypertable.HqlInterpreter.LoadData.ChunkSize");
+  String line, lines;
+  int64_t first_line = 0;
+  ::uint32_t consumed;
+  int64_t new_total;
+
+  lines.reserve(chunk_size + 1024);
+
+  while (lds->next_line(line, &consumed)) {
+    if (lines.empty())
+      first_line = lds->get_current_lineno();
+    lines.append(line);
+    lines.append(1, '\n');
+
+    if (lines.length() >= chunk_size) {
+      if (!loader.add(lines, first_line))
+        return false;
+      lines.reserve(chunk_size + 1024);
     }
 
-    HT_ASSERT(cell.flag == FLAG_INSERT);
+    if (cb.normal_mode && state.input_file_src != STDIN) {
+      if (largefile_mode == true) {
+        new_total = last_total + consumed;
+        consumed = (unsigned long)((new_total / 1048576LL) - (last_total / 1048576LL));
+        last_total = new_total;
+      }
+      cb.on_progress(consumed);
+    }
+  }
 
-    fout << "\t" ;
-    fout.write(unescaped_buf, unescaped_len);
-    fout << "\n";
+  if (!lines.empty())
+    return loader.add(lines, first_line);
+  return true;
+}
+
+/**
+ * Loads the input of LOAD DATA INFILE with a ParallelLoader
+ */
+void
+load_data_parallel(TablePtr &table, ::uint32_t mutator_flags,
+                   LoadDataSourcePtr &lds, ParserState &state,
+                   HqlInterpreter::Callback &cb, size_t threads,
+                   bool largefile_mode) {
+  ParallelLoader loader(table, mutator_flags, lds, state, threads);
+  int64_t last_total = 0;
+
+  read_chunks(loader, lds, state, cb, largefile_mode, last_total);
+  loader.finish(cb);
+}
+
+/**
+ * Returns true if fname is named like a dump manifest and starts with the
+ * manifest magic line, so that an input file that just happens to be
+ * called MANIFEST is loaded as is
+ */
+bool is_dump_manifest(DfsBroker::ClientPtr &dfs_client, const String &fname,
+                      int src) {
+  if (fname != DUMP_MANIFEST &&
+      !boost::algorithm::ends_with(fname, String("/") + DUMP_MANIFEST))
+    return false;
+
+  boost::iostreams::filtering_istream fin;
+  String line;
+  try {
+    if (src == DFS_FILE)
+      fin.push(DfsBroker::FileSource(dfs_client, fname));
+    else
+      fin.push(boost::iostreams::file_descriptor_source(fname));
+    if (!getline(fin, line))
+      return false;
+  }
+  catch (Exception &e) {
+    return false;
   }
+  catch (std::exception &e) {
+    return false;
+  }
+  return line == DUMP_MANIFEST_MAGIC;
+}
 
-  fout.strict_sync();
+/**
+ * Restores the output of DUMP TABLE ... PARALLEL, the files listed in the
+ * manifest state.input_file are loaded with a ParallelLoader
+ */
+void
+load_dump_manifest(TablePtr &table, ::uint32_t mutator_flags,
+                   DfsBroker::ClientPtr &dfs_client, ParserState &state,
+                   HqlInterpreter::Callback &cb, size_t threads) {
+  bool dfs = state.input_file_src == DFS_FILE;
+  String dir = state.input_file.substr(0, state.input_file.length()
+                                       - strlen(DUMP_MANIFEST));
+  std::vector<String> parts;
+  boost::iostreams::filtering_istream fin;
+  String line;
+  int64_t last_total = 0;
+  bool largefile_mode = false;
 
-  cb.on_finish((TableMutator*)0);
+  if (dfs)
+    fin.push(DfsBroker::FileSource(dfs_client, state.input_file));
+  else
+    fin.push(boost::iostreams::file_descriptor_source(state.input_file));
+
+  cb.file_size = 0;
+  while (getline(fin, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    parts.push_back(dir + line.substr(0, line.find('\t')));
+    cb.file_size += dfs ? dfs_client->length(parts.back())
+                        : FileUtils::size(parts.back());
+  }
+
+  if (parts.empty())
+    HT_THROWF(Error::HQL_PARSE_ERROR, "No files listed in manifest '%s'",
+              state.input_file.c_str());
+
+  if (cb.file_size > std::numeric_limits<unsigned long>::max()) {
+    largefile_mode = true;
+    cb.on_update((unsigned long)(cb.file_size / 1048576LL));
+  }
+  else
+    cb.on_update(cb.file_size);
+
+  // the files of a dump share the format of the first one
+  LoadDataSourcePtr lds = LoadDataSourceFactory::create(dfs_client,
+      parts[0], state.input_file_src, state.header_file,
+      state.header_file_src, state.columns, state.timestamp_column,
+      state.row_uniquify_chars, state.load_flags);
+  ParallelLoader loader(table, mutator_flags, lds, state, threads);
+
+  for (size_t i=0; i<parts.size(); i++) {
+    if (i > 0)
+      lds = LoadDataSourceFactory::create(dfs_client,
+          parts[i], state.input_file_src, state.header_file,
+          state.header_file_src, state.columns, state.timestamp_column,
+          state.row_uniquify_chars, state.load_flags);
+    if (!read_chunks(loader, lds, state, cb, largefile_mode, last_total))
+      break;
+  }
+
+  loader.finish(cb);
 }
 
 void
@@ -565,6 +1131,8 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   int out_fd = -1;
   bool largefile_mode = false;
   int64_t last_total = 0, new_total;
+  size_t load_threads = 1;
+  bool manifest = false;
 
   if (LoadDataFlags::ignore_unknown_cfs(state.load_flags))
     mutator_flags |= Table::MUTATOR_FLAG_IGNORE_UNKNOWN_CFS;
@@ -572,6 +1140,10 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   // Turn on no-log-sync unconditionally for LOAD DATA INFILE
   mutator_flags |= Table::MUTATOR_FLAG_NO_LOG_SYNC;
 
+  // init Dfs client if not done yet, is_dump_manifest() reads from it
+  if (state.input_file_src == DFS_FILE && !dfs_client)
+    dfs_client = new DfsBroker::Client(conn_manager, Config::properties);
+
   if (state.table_name.empty()) {
     if (state.output_file.empty())
       HT_THROW(Error::HQL_PARSE_ERROR,
@@ -587,7 +1159,18 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
     else
       fout.push(boost::iostreams::null_sink());
     table = ns->open_table(state.table_name);
-    mutator = table->create_mutator(0, mutator_flags);
+    // row keys are uniquified with a generator that is not thread safe
+    if (state.row_uniquify_chars == 0)
+      load_threads = Config::properties->get_i32(
+          "Hypertable.HqlInterpreter.LoadData.Threads");
+    if (state.input_file_src != STDIN &&
+        is_dump_manifest(dfs_client, state.input_file, state.input_file_src)) {
+      manifest = true;
+      if (load_threads < 1)
+        load_threads = 1;
+    }
+    else if (load_threads <= 1)
+      mutator = table->create_mutator(0, mutator_flags);
   }
 
   HT_ON_SCOPE_EXIT(&close_file, out_fd);
@@ -596,9 +1179,13 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   LoadDataSourcePtr lds;
   bool is_delete;
 
-  // init Dfs client if not done yet
-  if(state.input_file_src == DFS_FILE && !dfs_client)
-    dfs_client = new DfsBroker::Client(conn_manager, Config::properties);
+  if (manifest) {
+    load_dump_manifest(table, mutator_flags, dfs_client, state, cb,
+                       load_threads);
+    fout.strict_sync();
+    cb.on_finish();
+    return;
+  }
 
   lds = LoadDataSourceFactory::create(dfs_client, state.input_file, state.input_file_src,
       state.header_file, state.header_file_src,
@@ -622,6 +1209,14 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
       fout << "row\tcolumn\tvalue\n";
   }
 
+  if (load_threads > 1) {
+    load_data_parallel(table, mutator_flags, lds, state, cb, load_threads,
+                       largefile_mode);
+    fout.strict_sync();
+    cb.on_finish();
+    return;
+  }
+
   KeySpec key;
   ::uint8_t *value;
   ::uint32_t value_len;
@@ -216,7 +216,7 @@ namespace Hypertable {
       ScanState() : display_timestamps(false), keys_only(false),
           current_rowkey_set(false), start_time_set(false),
           end_time_set(false), current_timestamp_set(false),
-	  current_relop(0), buckets(0) { }
+	  current_relop(0), buckets(0), parallel(0) { }
 
       void set_time_interval(::int64_t start, ::int64_t end) {
         HQL_DEBUG("("<< start <<", "<< end <<")");
@@ -252,6 +252,7 @@ namespace Hypertable {
       bool    current_timestamp_set;
       int current_relop;
       int buckets;
+      int parallel;
     };
 
     class ParserState {
@@ -650,6 +651,14 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_access_group_blob_threshold {
+      set_access_group_blob_threshold(ParserState &state) : state(state) { }
+      void operator()(size_t threshold) const {
+        state.ag->blob_threshold = threshold;
+      }
+      ParserState &state;
+    };
+
     struct set_access_group_replication {
       set_access_group_replication(ParserState &state) : state(state) { }
       void operator()(size_t replication) const {
@@ -1102,6 +1111,17 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct scan_set_parallel {
+      scan_set_parallel(ParserState &state) : state(state) { }
+      void operator()(int ival) const {
+        if (state.scan.parallel != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR,
+                   "DUMP TABLE PARALLEL predicate multiply defined.");
+        state.scan.parallel = ival;
+      }
+      ParserState &state;
+    };
+
     struct scan_set_max_versions {
       scan_set_max_versions(ParserState &state) : state(state) { }
       void operator()(int ival) const {
@@ -1672,6 +1692,7 @@ namespace Hypertable {
           Token SECOND       = as_lower_d["second"];
           Token IN_MEMORY    = as_lower_d["in_memory"];
           Token BLOCKSIZE    = as_lower_d["blocksize"];
+          Token BLOB_THRESHOLD = as_lower_d["blob_threshold"];
           Token ACCESS       = as_lower_d["access"];
           Token GROUP        = as_lower_d["group"];
           Token DESCRIBE     = as_lower_d["describe"];
@@ -1756,6 +1777,7 @@ namespace Hypertable {
           Token NOKEYS       = as_lower_d["nokeys"];
           Token SINGLE_CELL_FORMAT = as_lower_d["single_cell_format"];
           Token BUCKETS      = as_lower_d["buckets"];
+          Token PARALLEL     = as_lower_d["parallel"];
           Token REPLICATION  = as_lower_d["replication"];
           Token WAIT         = as_lower_d["wait"];
           Token FOR          = as_lower_d["for"];
@@ -1967,6 +1989,7 @@ namespace Hypertable {
           dump_table_option_spec
             = MAX_VERSIONS >> EQUAL >> uint_p[scan_set_max_versions(self.state)]
             | BUCKETS >> uint_p[scan_set_buckets(self.state)]
+            | PARALLEL >> !EQUAL >> uint_p[scan_set_parallel(self.state)]
             | REVS >> !EQUAL >> uint_p[scan_set_max_versions(self.state)]
             | INTO >> FILE >> string_literal[scan_set_outfile(self.state)]
             ;
@@ -2197,6 +2220,7 @@ namespace Hypertable {
             = COUNTER[set_access_group_counter(self.state)]
             | in_memory_option[set_access_group_in_memory(self.state)]
             | blocksize_option
+            | blob_threshold_option
             | replication_option
             | COMPRESSOR >> EQUAL >> string_literal[
                 set_access_group_compressor(self.state)]
@@ -2217,6 +2241,11 @@ namespace Hypertable {
                 set_access_group_blocksize(self.state)]
             ;
 
+          blob_threshold_option
+            = BLOB_THRESHOLD >> EQUAL >> uint_p[
+                set_access_group_blob_threshold(self.state)]
+            ;
+
           replication_option
             = REPLICATION >> EQUAL >> uint_p[
                 set_access_group_replication(self.state)]
@@ -2425,6 +2454,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(bloom_filter_option);
           BOOST_SPIRIT_DEBUG_RULE(in_memory_option);
           BOOST_SPIRIT_DEBUG_RULE(blocksize_option);
+          BOOST_SPIRIT_DEBUG_RULE(blob_threshold_option);
           BOOST_SPIRIT_DEBUG_RULE(replication_option);
           BOOST_SPIRIT_DEBUG_RULE(help_statement);
           BOOST_SPIRIT_DEBUG_RULE(describe_table_statement);
@@ -2508,7 +2538,7 @@ namespace Hypertable {
           single_string_literal, double_string_literal, string_literal, regexp_literal,
           ttl_option, counter_option, access_group_definition, access_group_option,
           bloom_filter_option, in_memory_option,
-          blocksize_option, replication_option, help_statement,
+          blocksize_option, blob_threshold_option, replication_option, help_statement,
           describe_table_statement, show_statement, select_statement,
           where_clause, where_predicate,
           time_predicate, relop, row_interval, row_predicate, column_predicate,
@@ -29,6 +29,7 @@
 #include "Key.h"
 #include "IntervalScannerAsync.h"
 #include "Table.h"
+#include "TableScannerAsync.h"
 
 extern "C" {
 #include <poll.h>
@@ -452,7 +453,7 @@ void IntervalScannerAsync::load_result(ScanCellsPtr &cells) {
 
   eos = cells->load(m_schema, m_end_row, m_end_inclusive,
                     m_scan_spec_builder.get().row_limit, &m_rows_seen, m_cur_row,
-                    m_rowset, &m_bytes_scanned);
+                    m_rowset, &m_bytes_scanned, m_scanner->get_cells_encoder());
 
   m_eos = m_eos || eos;
 
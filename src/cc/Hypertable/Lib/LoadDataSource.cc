@@ -287,6 +287,27 @@ LoadDataSource::parse_header(const String &header, const std::vector<String> &ke
   m_cur_line = 1;
 }
 
+bool LoadDataSource::next_line(String &line, uint32_t *consumedp) {
+  if (!get_next_line(line))
+    return false;
+  m_cur_line++;
+  *consumedp = m_zipped ? incr_consumed() : line.length() + 1;
+  return true;
+}
+
+void LoadDataSource::copy_format(const LoadDataSource &other) {
+  m_column_info = other.m_column_info;
+  m_key_comps = other.m_key_comps;
+  delete [] m_type_mask;
+  m_type_mask = new uint32_t [257];
+  memcpy(m_type_mask, other.m_type_mask, 257*sizeof(uint32_t));
+  m_hyperformat = other.m_hyperformat;
+  m_leading_timestamps = other.m_leading_timestamps;
+  m_timestamp_index = other.m_timestamp_index;
+  m_next_value = m_column_info.size();
+  m_limit = 0;
+}
+
 /**
  *
  */
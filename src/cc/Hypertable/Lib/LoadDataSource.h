@@ -66,6 +66,17 @@ namespace Hypertable {
 
     virtual void init(const std::vector<String> &key_columns, const String &timestamp_column);
 
+    /**
+     * Reads the next input line without parsing it, e.g. to hand lines
+     * to LoadDataSourceChunk parsers running on other threads
+     *
+     * @param line string to receive the line, without newline
+     * @param consumedp address of variable to receive the number of input
+     *        bytes consumed
+     * @return false at end of input
+     */
+    bool next_line(String &line, uint32_t *consumedp);
+
     int64_t get_current_lineno() { return m_cur_line; }
     unsigned long get_source_size() const { return m_source_size; }
 
@@ -86,6 +97,9 @@ namespace Hypertable {
     virtual void init_src()=0;
     virtual uint64_t incr_consumed()=0;
 
+    /** Copies the input format parsed by init() from another source */
+    void copy_format(const LoadDataSource &other);
+
     bool should_skip(int idx, const uint32_t *masks) {
       uint32_t bm = masks[idx];
       return bm && ((bm & TIMESTAMP) ||
@@ -0,0 +1,59 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_LOADDATASOURCECHUNK_H
+#define HYPERTABLE_LOADDATASOURCECHUNK_H
+
+#include "LoadDataSource.h"
+
+namespace Hypertable {
+
+  /**
+   * Parses a chunk of complete input lines held in memory, in the input
+   * format of another LoadDataSource.  Used to parse the lines read by
+   * LoadDataSource::next_line() on several threads.
+   */
+  class LoadDataSourceChunk : public LoadDataSource {
+
+  public:
+    LoadDataSourceChunk(const LoadDataSource &source, int load_flags = 0);
+
+    /**
+     * Sets the lines returned by subsequent calls to next()
+     *
+     * @param buf newline terminated lines, must stay valid until next()
+     *        returns false
+     * @param len length of buf
+     * @param first_line line number of the first line, for messages
+     */
+    void load(const char *buf, size_t len, int64_t first_line);
+
+    uint64_t incr_consumed() { return 0; }
+
+  protected:
+    void init_src() { }
+  };
+
+  typedef boost::intrusive_ptr<LoadDataSourceChunk> LoadDataSourceChunkPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_LOADDATASOURCECHUNK_H
@@ -38,7 +38,7 @@ using namespace std;
 void
 LocationCache::insert(const char *table_name, RangeLocationInfo &range_loc_info,
                       bool pegged) {
-  ScopedLock lock(m_mutex);
+  WriteLock lock(m_stripes);
   Value *newval = new Value;
   LocationMap::iterator iter;
   LocationCacheKey key;
@@ -53,6 +53,7 @@ LocationCache::insert(const char *table_name, RangeLocationInfo &range_loc_info,
   newval->start_row = range_loc_info.start_row;
   newval->end_row = range_loc_info.end_row;
   newval->addrp = get_constant_address(range_loc_info.addr);
+  atomic_set(&newval->referenced, 0);
   newval->pegged = pegged;
 
   key.table_name = m_strings.get(table_name);
@@ -62,10 +63,15 @@ LocationCache::insert(const char *table_name, RangeLocationInfo &range_loc_info,
   if ((iter = m_location_map.find(key)) != m_location_map.end())
     remove((*iter).second);
 
-  // make room for the new entry
+  // make room for the new entry, giving entries that were looked up since
+  // the last sweep a second chance
   while (m_location_map.size() >= m_max_entries) {
     if (m_tail->pegged)
       move_to_head(m_tail);
+    else if (atomic_read(&m_tail->referenced)) {
+      atomic_set(&m_tail->referenced, 0);
+      move_to_head(m_tail);
+    }
     else
       remove(m_tail);
   }
@@ -113,7 +119,7 @@ LocationCache::~LocationCache() {
 bool
 LocationCache::lookup(const char * table_name, const char *rowkey,
                       RangeLocationInfo *rane_loc_infop, bool inclusive) {
-  ScopedLock lock(m_mutex);
+  ReadLock lock(m_stripes);
   LocationMap::iterator iter;
   LocationCacheKey key;
 
@@ -139,7 +145,10 @@ LocationCache::lookup(const char * table_name, const char *rowkey,
       return false;
   }
 
-  move_to_head((*iter).second);
+  // only write the flag when it changes to avoid bouncing the cache line
+  // between reader threads
+  if (!atomic_read(&(*iter).second->referenced))
+    atomic_set(&(*iter).second->referenced, 1);
 
   rane_loc_infop->start_row = (*iter).second->start_row;
   rane_loc_infop->end_row   = (*iter).second->end_row;
@@ -149,7 +158,7 @@ LocationCache::lookup(const char * table_name, const char *rowkey,
 }
 
 bool LocationCache::invalidate(const char * table_name, const char *rowkey) {
-  ScopedLock lock(m_mutex);
+  WriteLock lock(m_stripes);
   LocationMap::iterator iter;
   LocationCacheKey key;
 
@@ -27,6 +27,9 @@
 #include <map>
 #include <set>
 
+#include <pthread.h>
+
+#include "Common/atomic.h"
 #include "Common/Mutex.h"
 #include "Common/FlyweightString.h"
 #include "Common/InetAddr.h"
@@ -81,7 +84,14 @@ namespace Hypertable {
 
 
   /**
-   *  This class acts as a cache of Range location information.  It
+   *  This class acts as a cache of Range location information.  The lock
+   *  is striped: a lookup locks only the stripe its thread hashes to, while
+   *  insert and invalidate lock every stripe, so mutator and scanner threads
+   *  reading the cache don't contend on one process-wide lock.  Since a
+   *  reader can't relink the recency list, it just marks the entry as
+   *  referenced and eviction does a CLOCK (second chance) sweep from the
+   *  tail: referenced entries are cleared and moved back to the head,
+   *  unreferenced ones are removed.
    */
   class LocationCache : public ReferenceCount {
   public:
@@ -93,10 +103,11 @@ namespace Hypertable {
       std::string start_row;
       std::string end_row;
       const CommAddress *addrp;
+      atomic_t referenced;
       bool pegged;
     };
 
-    LocationCache(uint32_t max_entries) : m_mutex(), m_location_map(),
+    LocationCache(uint32_t max_entries) : m_location_map(),
         m_head(0), m_tail(0), m_max_entries(max_entries) { return; }
     ~LocationCache();
 
@@ -109,6 +120,43 @@ namespace Hypertable {
     void display(std::ostream &);
 
   private:
+    enum { LOCK_STRIPES = 16 };
+
+    /** One stripe of the cache lock, padded to its own cache line */
+    struct LockStripe {
+      Mutex mutex;
+      char pad[64];
+    };
+
+    /** Locks the stripe of the calling thread */
+    class ReadLock {
+    public:
+      ReadLock(LockStripe *stripes)
+        : m_lock(stripes[stripe_of(pthread_self())].mutex) { }
+    private:
+      static size_t stripe_of(pthread_t thread) {
+        // thread ids are aligned addresses, so mix the high bits in
+        uint64_t h = (uint64_t)thread * 0x9E3779B97F4A7C15ULL;
+        return (size_t)(h >> 60) % LOCK_STRIPES;
+      }
+      ScopedLock m_lock;
+    };
+
+    /** Locks every stripe, in order */
+    class WriteLock {
+    public:
+      WriteLock(LockStripe *stripes) : m_stripes(stripes) {
+        for (size_t i=0; i<LOCK_STRIPES; i++)
+          m_stripes[i].mutex.lock();
+      }
+      ~WriteLock() {
+        for (size_t i=LOCK_STRIPES; i>0; i--)
+          m_stripes[i-1].mutex.unlock();
+      }
+    private:
+      LockStripe *m_stripes;
+    };
+
     void move_to_head(Value *cacheval);
     void remove(Value *cacheval);
 
@@ -124,7 +172,7 @@ namespace Hypertable {
     typedef std::map<LocationCacheKey, Value *> LocationMap;
     typedef std::set<const CommAddress *, CommAddressPointerLt> AddressSet;
 
-    Mutex          m_mutex;
+    LockStripe     m_stripes[LOCK_STRIPES];
     LocationMap    m_location_map;
     AddressSet     m_addresses;
     Value         *m_head;
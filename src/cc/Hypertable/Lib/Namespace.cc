@@ -134,6 +134,7 @@ void Namespace::alter_table(const String &table_name, const String &alter_schema
       final_ag->name = alter_ag->name;
       final_ag->in_memory = alter_ag->in_memory;
       final_ag->blocksize = alter_ag->blocksize;
+      final_ag->blob_threshold = alter_ag->blob_threshold;
       final_ag->compressor = alter_ag->compressor;
       final_ag->bloom_filter = alter_ag->bloom_filter;
       if (!final_schema->add_access_group(final_ag)) {
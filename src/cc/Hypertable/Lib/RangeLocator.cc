@@ -450,21 +450,191 @@ RangeLocator::find(const TableIdentifier *table, const char *row_key,
 }
 
 
+int RangeLocator::prefetch(const TableIdentifier *table, const char *start_row,
+                           const char *end_row, Timer &timer,
+                           size_t max_ranges, size_t *nrangesp) {
+  std::vector<RangeLocationInfo> meta_ranges;
+  std::vector<RangeLocationInfo> ranges;
+  RangeSpec range;
+  RowInterval ri;
+  String meta_start, meta_stop, meta_end, root_start;
+  CommAddress addr;
+  int error;
+
+  if (nrangesp)
+    *nrangesp = 0;
+
+  if (m_root_stale) {
+    if ((error = read_root_location(timer)) != Error::OK)
+      return error;
+  }
+
+  {
+    ScopedLock lock(m_mutex);
+    addr = m_root_range_info.addr;
+  }
+
+  if (start_row == 0)
+    start_row = "";
+  if (end_row && *end_row == 0)
+    end_row = 0;
+
+  /**
+   * Second-level METADATA rows are keyed "<table id>:<end row>", if the
+   * table is METADATA itself its ranges are all listed in the root range
+   */
+  if (table->is_metadata()) {
+    meta_start = start_row;
+    meta_stop = end_row ? end_row : Key::END_ROW_MARKER;
+  }
+  else {
+    meta_start = format("%s:%s", table->id, start_row);
+    meta_end = format("%s:%s", table->id, Key::END_ROW_MARKER);
+    meta_stop = end_row ? format("%s:%s", table->id, end_row) : meta_end;
+  }
+
+  /**
+   * Read the second-level METADATA ranges from root, stopping at the one
+   * that contains the last row of the interval
+   */
+  root_start = format("%s:%s", TableIdentifier::METADATA_ID,
+                      meta_start.c_str());
+  range.start_row = 0;
+  range.end_row = Key::END_ROOT_ROW;
+  ri.start = root_start.c_str();
+  ri.start_inclusive = true;
+  ri.end = 0;
+  ri.end_inclusive = false;
+
+  if ((error = scan_metadata_range(addr, range, ri, meta_stop.c_str(),
+                                   meta_ranges, timer,
+                                   table->is_metadata() ? max_ranges : 0))
+      != Error::OK) {
+    if (error == Error::RANGESERVER_RANGE_NOT_FOUND)
+      m_root_stale = true;
+    return error;
+  }
+
+  if (table->is_metadata()) {
+    if (nrangesp)
+      *nrangesp = meta_ranges.size();
+    return Error::OK;
+  }
+
+  /**
+   * Scan each second-level METADATA range for the table's ranges
+   */
+  ri.start = meta_start.c_str();
+  ri.start_inclusive = true;
+  ri.end = meta_end.c_str();
+  ri.end_inclusive = true;
+
+  foreach (RangeLocationInfo &meta_range, meta_ranges) {
+    range.start_row = meta_range.start_row.c_str();
+    range.end_row = meta_range.end_row.c_str();
+    if ((error = scan_metadata_range(meta_range.addr, range, ri, end_row,
+                                     ranges, timer, max_ranges)) != Error::OK) {
+      if (error == Error::RANGESERVER_RANGE_NOT_FOUND)
+        m_cache->invalidate(TableIdentifier::METADATA_ID,
+                            meta_range.end_row.c_str());
+      return error;
+    }
+    if (end_row && !ranges.empty() &&
+        strcmp(ranges.back().end_row.c_str(), end_row) >= 0)
+      break;
+    if (max_ranges && ranges.size() >= max_ranges)
+      break;
+  }
+
+  if (nrangesp)
+    *nrangesp = ranges.size();
+
+  HT_DEBUGF("Prefetched %u range locations for table %s",
+            (unsigned)ranges.size(), table->id);
+
+  return Error::OK;
+}
+
+
+/**
+ * Scans the METADATA range at addr for the locations in ri, fetching
+ * blocks until the scan is exhausted, a location with an end row at or
+ * past stop_row has been cached or infos holds max_infos locations.
+ */
+int RangeLocator::scan_metadata_range(const CommAddress &addr,
+    const RangeSpec &range, const RowInterval &ri, const char *stop_row,
+    std::vector<RangeLocationInfo> &infos, Timer &timer, size_t max_infos) {
+  ScanSpec meta_scan_spec;
+  ScanBlock scan_block;
+  MetadataRecord record;
+  int error = Error::OK;
+
+  meta_scan_spec.max_versions = 1;
+  meta_scan_spec.columns.push_back("StartRow");
+  meta_scan_spec.columns.push_back("Location");
+  meta_scan_spec.row_intervals.push_back(ri);
+  meta_scan_spec.return_deletes = false;
+
+  try {
+    if (m_conn_manager &&
+        !m_conn_manager->wait_for_connection(addr, timer.remaining())) {
+      if (timer.expired())
+        HT_THROW_(Error::REQUEST_TIMEOUT);
+    }
+
+    m_range_server.create_scanner(addr, m_metadata_table, range,
+                                  meta_scan_spec, scan_block, timer);
+    while (true) {
+      if ((error = process_metadata_scanblock(scan_block, record,
+               scan_block.eos(), &infos, timer)) != Error::OK)
+        break;
+      if (scan_block.eos())
+        return Error::OK;
+      if (stop_row && !infos.empty() &&
+          strcmp(infos.back().end_row.c_str(), stop_row) >= 0)
+        break;
+      if (max_infos && infos.size() >= max_infos)
+        break;
+      m_range_server.fetch_scanblock(addr, scan_block.get_scanner_id(),
+                                     scan_block, timer);
+    }
+    m_range_server.destroy_scanner(addr, scan_block.get_scanner_id(), 0);
+  }
+  catch (Exception &e) {
+    SAVE_ERR2(e.code(), e, format("Problem scanning METADATA[%s..%s] "
+              "(start row = %s)", range.start_row ? range.start_row : "",
+              range.end_row, ri.start));
+    return e.code();
+  }
+  catch (std::exception &e) {
+    HT_INFOF("std::exception - %s", e.what());
+    SAVE_ERR(Error::COMM_SEND_ERROR, e.what());
+    return Error::COMM_SEND_ERROR;
+  }
+
+  return error;
+}
+
+
 int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block, Timer &timer) {
-  RangeLocationInfo range_loc_info;
+  MetadataRecord record;
+  return process_metadata_scanblock(scan_block, record, true, 0, timer);
+}
+
+
+/**
+ * Caches the METADATA records in scan_block.  The record still being
+ * assembled when the block runs out is left in record unless last_block
+ * is set, so that it can be completed by the next block of the scan.
+ */
+int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block,
+    MetadataRecord &record, bool last_block,
+    std::vector<RangeLocationInfo> *infos, Timer &timer) {
+  RangeLocationInfo &range_loc_info = record.range_loc_info;
   SerializedKey serkey;
   ByteString value;
   Key key;
   const char *stripped_key;
-  String table_name;
-
-  range_loc_info.start_row = "";
-  range_loc_info.end_row = "";
-  range_loc_info.addr.clear();
-
-  bool got_start_row = false;
-  bool got_end_row = false;
-  bool got_location = false;
 
   while (scan_block.next(serkey, value)) {
 
@@ -484,48 +654,26 @@ int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block, Timer &timer
     }
     stripped_key++;
 
-    if (got_end_row) {
+    if (record.got_end_row) {
       if (strcmp(stripped_key, range_loc_info.end_row.c_str())) {
-        if (got_start_row && got_location) {
-
-          /**
-           * Add this location (address) to the connection manager
-           */
-          if (m_conn_manager) {
-            m_conn_manager->add(range_loc_info.addr, METADATA_RETRY_INTERVAL, "RangeServer");
-	    if (!m_conn_manager->wait_for_connection(range_loc_info.addr, timer.remaining())) {
-	      if (timer.expired())
-		HT_THROW_(Error::REQUEST_TIMEOUT);
-	    }
-	  }
-
-          m_cache->insert(table_name.c_str(), range_loc_info);
-          /*
-          HT_DEBUG_OUT << "(1) cache insert table=" << table_name << " start="
-              << range_loc_info.start_row << " end=" << range_loc_info.end_row
-              << " loc=" << range_loc_info.addr.to_str() << HT_END;
-          */
-        }
+        if (record.got_start_row && record.got_location)
+          cache_metadata_record(record, infos, timer);
         else {
           SAVE_ERR(Error::INVALID_METADATA, format("Incomplete METADATA record "
                    "found under row key '%s' (got_location=%s)", range_loc_info
-                   .end_row.c_str(), got_location ? "true" : "false"));
+                   .end_row.c_str(), record.got_location ? "true" : "false"));
         }
-        range_loc_info.start_row = "";
-        range_loc_info.end_row = "";
-        range_loc_info.addr.clear();
-        got_start_row = false;
-        got_end_row = false;
-        got_location = false;
+        record.clear();
       }
     }
-    else {
+
+    if (!record.got_end_row) {
       const char *colon = strchr(key.row, ':');
       assert(colon);
-      table_name.clear();
-      table_name.append(key.row, colon-key.row);
+      record.table_name.clear();
+      record.table_name.append(key.row, colon-key.row);
       range_loc_info.end_row = stripped_key;
-      got_end_row = true;
+      record.got_end_row = true;
     }
 
     if (key.column_family_code == m_startrow_cid) {
@@ -533,7 +681,7 @@ int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block, Timer &timer
       size_t len = value.decode_length(&str);
       //cout << "TS=" << key.timestamp << endl;
       range_loc_info.start_row = String((const char *)str, len);
-      got_start_row = true;
+      record.got_start_row = true;
     }
     else if (key.column_family_code == m_location_cid) {
       const uint8_t *str;
@@ -541,7 +689,7 @@ int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block, Timer &timer
       if (str[0] == '!' && len == 1)
 	return Error::TABLE_NOT_FOUND;
       range_loc_info.addr.set_proxy( String((const char *)str, len));
-      got_location = true;
+      record.got_location = true;
     }
     else {
       HT_ERRORF("METADATA lookup on row '%s' returned incorrect column (id=%d)",
@@ -549,37 +697,52 @@ int RangeLocator::process_metadata_scanblock(ScanBlock &scan_block, Timer &timer
     }
   }
 
-  if (got_start_row && got_end_row && got_location) {
-
-    /**
-     * Add this location (address) to the connection manager
-     */
-    if (m_conn_manager) {
-      m_conn_manager->add(range_loc_info.addr, METADATA_RETRY_INTERVAL, "RangeServer");
-      if (!m_conn_manager->wait_for_connection(range_loc_info.addr, timer.remaining())) {
-	if (timer.expired())
-	  HT_THROW_(Error::REQUEST_TIMEOUT);
-      }
-    }
-
-    m_cache->insert(table_name.c_str(), range_loc_info);
+  if (!last_block)
+    return Error::OK;
 
-    /*
-    HT_DEBUG_OUT << "(2) cache insert table=" << table_name << " start="
-        << range_loc_info.start_row << " end=" << range_loc_info.end_row
-        << " loc=" << range_loc_info.addr.to_str() << HT_END;
-    */
-  }
-  else if (got_end_row) {
+  if (record.got_start_row && record.got_end_row && record.got_location)
+    cache_metadata_record(record, infos, timer);
+  else if (record.got_end_row) {
     SAVE_ERR(Error::INVALID_METADATA, format("Incomplete METADATA record found "
              "under row key '%s' (got_location=%s)", range_loc_info
-             .end_row.c_str(), got_location ? "true" : "false"));
+             .end_row.c_str(), record.got_location ? "true" : "false"));
   }
+  record.clear();
 
   return Error::OK;
 }
 
 
+void RangeLocator::cache_metadata_record(MetadataRecord &record,
+    std::vector<RangeLocationInfo> *infos, Timer &timer) {
+
+  /**
+   * Add this location (address) to the connection manager
+   */
+  if (m_conn_manager) {
+    m_conn_manager->add(record.range_loc_info.addr, METADATA_RETRY_INTERVAL,
+                        "RangeServer");
+    if (!m_conn_manager->wait_for_connection(record.range_loc_info.addr,
+                                             timer.remaining())) {
+      if (timer.expired())
+        HT_THROW_(Error::REQUEST_TIMEOUT);
+    }
+  }
+
+  m_cache->insert(record.table_name.c_str(), record.range_loc_info);
+
+  /*
+  HT_DEBUG_OUT << "cache insert table=" << record.table_name << " start="
+      << record.range_loc_info.start_row << " end="
+      << record.range_loc_info.end_row << " loc="
+      << record.range_loc_info.addr.to_str() << HT_END;
+  */
+
+  if (infos)
+    infos->push_back(record.range_loc_info);
+}
+
+
 int RangeLocator::read_root_location(Timer &timer) {
   DynamicBuffer value(0);
   String addr_str;
@@ -23,6 +23,7 @@
 #define HYPERTABLE_RANGELOCATOR_H
 
 #include <deque>
+#include <vector>
 
 #include "Common/Mutex.h"
 #include "Common/Error.h"
@@ -104,6 +105,25 @@ namespace Hypertable {
     int find(const TableIdentifier *table, const char *row_key,
              RangeLocationInfo *range_loc_infop, Timer &timer, bool hard);
 
+    /** Loads the locations of all ranges of a table that intersect the row
+     * interval [start_row, end_row] into the location cache.  Instead of
+     * one METADATA lookup per range, the second-level METADATA ranges
+     * covering the interval are read from the root range with one scan,
+     * and each of them is then scanned once.
+     *
+     * @param table pointer to table identifier structure
+     * @param start_row first row of interval (0 or "" for table start)
+     * @param end_row last row of interval (0 or "" for table end)
+     * @param timer reference to timer object
+     * @param max_ranges stop after this many range locations (0 for no
+     *        limit), the rest are located on demand
+     * @param nrangesp if not 0, receives the number of locations loaded
+     * @return Error::OK on success or error code on failure
+     */
+    int prefetch(const TableIdentifier *table, const char *start_row,
+                 const char *end_row, Timer &timer, size_t max_ranges=0,
+                 size_t *nrangesp=0);
+
     /**
      * Invalidates the cached entry for the given row key
      *
@@ -151,7 +171,35 @@ namespace Hypertable {
     void initialize(Timer &timer);
     void hyperspace_disconnected();
     void hyperspace_reconnected();
+
+    /** Holds the METADATA row being assembled by
+     * process_metadata_scanblock, which may be split across scan blocks
+     */
+    struct MetadataRecord {
+      MetadataRecord() { clear(); }
+      void clear() {
+        range_loc_info.start_row = "";
+        range_loc_info.end_row = "";
+        range_loc_info.addr.clear();
+        got_start_row = got_end_row = got_location = false;
+      }
+      RangeLocationInfo range_loc_info;
+      String table_name;
+      bool got_start_row;
+      bool got_end_row;
+      bool got_location;
+    };
+
     int process_metadata_scanblock(ScanBlock &scan_block, Timer &timer);
+    int process_metadata_scanblock(ScanBlock &scan_block,
+        MetadataRecord &record, bool last_block,
+        std::vector<RangeLocationInfo> *infos, Timer &timer);
+    void cache_metadata_record(MetadataRecord &record,
+        std::vector<RangeLocationInfo> *infos, Timer &timer);
+    int scan_metadata_range(const CommAddress &addr, const RangeSpec &range,
+        const RowInterval &ri, const char *stop_row,
+        std::vector<RangeLocationInfo> &infos, Timer &timer,
+        size_t max_infos=0);
     int read_root_location(Timer &timer);
     void initialize();
 
@@ -610,6 +610,22 @@ namespace Hypertable {
     void relinquish_range(const CommAddress &addr, const TableIdentifier &table,
                           const RangeSpec &range, Timer &timer);
 
+    /** Issues an "adopt cellstores" request synchronously.  The given
+     * CellStore files, which must already live in the table's directory
+     * on the DFS, are added to the corresponding access groups of the range.
+     *
+     * @param addr address of RangeServer
+     * @param table table identifier
+     * @param range range specification
+     * @param access_groups access group of each file
+     * @param files absolute pathnames of CellStore files
+     * @param timer timer
+     */
+    void adopt_cellstores(const CommAddress &addr, const TableIdentifier &table,
+                          const RangeSpec &range,
+                          const std::vector<String> &access_groups,
+                          const std::vector<String> &files, Timer &timer);
+
     /** Issues a "heapcheck" request.  This call blocks until it receives a
      * response from the server.
      *
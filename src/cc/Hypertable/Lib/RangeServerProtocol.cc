@@ -24,6 +24,7 @@
 #include "AsyncComm/CommHeader.h"
 
 #include "RangeServerProtocol.h"
+#include "WireCompressor.h"
 
 namespace Hypertable {
 
@@ -54,6 +55,7 @@ namespace Hypertable {
     "relinquish range",
     "heapcheck",
     "metadata sync",
+    "adopt cellstores",
     (const char *)0
   };
 
@@ -147,7 +149,15 @@ namespace Hypertable {
     CommHeader header(COMMAND_UPDATE);
     if (table.is_system()) // If system table, set the urgent bit
       header.flags |= CommHeader::FLAGS_BIT_URGENT;
-    CommBuf *cbuf = new CommBuf(header, 8 + table.encoded_length(), buffer);
+    CommBuf *cbuf;
+    DynamicBuffer zbuf;
+    if (WireCompressor::client()->deflate(buffer.base, buffer.size, zbuf)) {
+      StaticBuffer zext(zbuf);
+      header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED;
+      cbuf = new CommBuf(header, 8 + table.encoded_length(), zext);
+    }
+    else
+      cbuf = new CommBuf(header, 8 + table.encoded_length(), buffer);
     table.encode(cbuf->get_data_ptr_address());
     cbuf->append_i32(count);
     cbuf->append_i32(flags);
@@ -182,6 +192,7 @@ namespace Hypertable {
     CommHeader header(COMMAND_CREATE_SCANNER);
     if (table.is_system()) // If system table, set the urgent bit
       header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    header.flags |= CommHeader::FLAGS_BIT_ACCEPT_COMPRESSION;
     CommBuf *cbuf = new CommBuf(header, table.encoded_length()
         + range.encoded_length() + scan_spec.encoded_length());
     table.encode(cbuf->get_data_ptr_address());
@@ -201,6 +212,7 @@ namespace Hypertable {
   CommBuf *RangeServerProtocol::create_request_fetch_scanblock(int scanner_id) {
     CommHeader header(COMMAND_FETCH_SCANBLOCK);
     header.gid = scanner_id;
+    header.flags |= CommHeader::FLAGS_BIT_ACCEPT_COMPRESSION;
     CommBuf *cbuf = new CommBuf(header, 4);
     cbuf->append_i32(scanner_id);
     return cbuf;
@@ -334,5 +346,26 @@ namespace Hypertable {
     return cbuf;
   }
 
+  CommBuf *
+  RangeServerProtocol::create_request_adopt_cellstores(const TableIdentifier &table,
+      const RangeSpec &range, const std::vector<String> &access_groups,
+      const std::vector<String> &files) {
+    HT_ASSERT(access_groups.size() == files.size());
+    CommHeader header(COMMAND_ADOPT_CELLSTORES);
+    size_t length = table.encoded_length() + range.encoded_length() + 4;
+    for (size_t i=0; i<files.size(); i++)
+      length += Serialization::encoded_length_vstr(access_groups[i])
+        + Serialization::encoded_length_vstr(files[i]);
+    CommBuf *cbuf = new CommBuf(header, length);
+    table.encode(cbuf->get_data_ptr_address());
+    range.encode(cbuf->get_data_ptr_address());
+    Serialization::encode_i32(cbuf->get_data_ptr_address(), files.size());
+    for (size_t i=0; i<files.size(); i++) {
+      Serialization::encode_vstr(cbuf->get_data_ptr_address(), access_groups[i]);
+      Serialization::encode_vstr(cbuf->get_data_ptr_address(), files[i]);
+    }
+    return cbuf;
+  }
+
 
 } // namespace Hypertable
@@ -60,7 +60,8 @@ namespace Hypertable {
     static const uint64_t COMMAND_RELINQUISH_RANGE     = 21;
     static const uint64_t COMMAND_HEAPCHECK            = 22;
     static const uint64_t COMMAND_METADATA_SYNC        = 23;
-    static const uint64_t COMMAND_MAX                  = 24;
+    static const uint64_t COMMAND_ADOPT_CELLSTORES     = 24;
+    static const uint64_t COMMAND_MAX                  = 25;
 
     static const char *m_command_strings[];
 
@@ -75,7 +76,9 @@ namespace Hypertable {
     enum {
       /* Don't force a commit log sync on update */
       UPDATE_FLAG_NO_LOG_SYNC        = 0x0001,
-      UPDATE_FLAG_IGNORE_UNKNOWN_CFS = 0x0002
+      UPDATE_FLAG_IGNORE_UNKNOWN_CFS = 0x0002,
+      /* Client paces itself on RANGESERVER_UPDATE_THROTTLED send-backs */
+      UPDATE_FLAG_THROTTLE_HINTS     = 0x0004
     };
 
     // Flags for 
@@ -283,6 +286,18 @@ namespace Hypertable {
      */
     static CommBuf *create_request_heapcheck(const String &outfile);
 
+    /** Creates an "adopt cellstores" request message.
+     *
+     * @param table table identifier
+     * @param range range specification
+     * @param access_groups access group of each file
+     * @param files absolute pathnames of CellStore files to adopt
+     * @return protocol message
+     */
+    static CommBuf *create_request_adopt_cellstores(const TableIdentifier &table,
+        const RangeSpec &range, const std::vector<String> &access_groups,
+        const std::vector<String> &files);
+
 
 
     virtual const char *command_text(uint64_t command);
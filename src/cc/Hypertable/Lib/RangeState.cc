@@ -81,6 +81,8 @@ std::ostream& Hypertable::operator<<(std::ostream &out, const RangeState &st) {
   case RangeState::STEADY: out <<"STEADY";              break;
   case RangeState::SPLIT_LOG_INSTALLED: out <<"SLI";    break;
   case RangeState::SPLIT_SHRUNK: out <<"SHRUNK";        break;
+  case RangeState::RELINQUISH_LOG_INSTALLED: out <<"RLI"; break;
+  case RangeState::RELINQUISH_CACHE_SHIPPED: out <<"RCS"; break;
   default:
     out <<"unknown ("<< st.state;
   }
@@ -0,0 +1,134 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Time.h"
+
+#include "RowCache.h"
+#include "TableMutatorAsyncScatterBuffer.h"
+
+using namespace Hypertable;
+
+#define OVERHEAD 128
+
+bool RowCache::lookup(const String &key, CellsBuilderPtr &cells) {
+  ScopedLock lock(m_mutex);
+  LookupHashIndex &hash_index = m_cache.get<1>();
+  LookupHashIndex::iterator iter;
+
+  m_stats.lookups++;
+
+  if ((iter = hash_index.find(key)) == hash_index.end())
+    return false;
+
+  if (iter->expires <= get_ts64()) {
+    m_stats.expirations++;
+    erase(m_cache.project<0>(iter));
+    return false;
+  }
+
+  // move to most recently used end
+  m_cache.relocate(m_cache.end(), m_cache.project<0>(iter));
+
+  cells = iter->cells;
+  m_stats.hits++;
+  return true;
+}
+
+
+bool RowCache::insert(const String &key, const char *row,
+                      CellsBuilderPtr &cells, uint64_t generation) {
+  ScopedLock lock(m_mutex);
+  LookupHashIndex &hash_index = m_cache.get<1>();
+  LookupHashIndex::iterator lookup_iter;
+  // cells and their vector are allocated from the builder's arena
+  uint64_t length = OVERHEAD + key.length() + strlen(row) +
+      cells->memory_allocated();
+
+  if (generation != m_generation || length > m_max_memory)
+    return false;
+
+  if ((lookup_iter = hash_index.find(key)) != hash_index.end())
+    erase(m_cache.project<0>(lookup_iter));
+
+  // make room
+  Sequence::iterator iter = m_cache.begin();
+  while (m_avail_memory < length && iter != m_cache.end())
+    iter = erase(iter);
+
+  m_cache.push_back(Entry(key, row, cells, get_ts64() + m_ttl, length));
+  m_avail_memory -= length;
+  return true;
+}
+
+
+void RowCache::invalidate(const char *row) {
+  ScopedLock lock(m_mutex);
+  InvalidateHashIndex &hash_index = m_cache.get<2>();
+  std::pair<InvalidateHashIndex::iterator, InvalidateHashIndex::iterator> p
+      = hash_index.equal_range(String(row));
+
+  m_generation++;
+
+  while (p.first != p.second) {
+    m_avail_memory += p.first->length;
+    m_stats.invalidations++;
+    p.first = hash_index.erase(p.first);
+  }
+}
+
+
+void RowCache::invalidate(const TableMutatorAsyncScatterBuffer &buffer) {
+  ScopedLock lock(m_mutex);
+
+  m_generation++;
+
+  for (Sequence::iterator iter = m_cache.begin(); iter != m_cache.end(); ) {
+    if (buffer.may_contain_row(iter->row.c_str())) {
+      m_stats.invalidations++;
+      iter = erase(iter);
+    }
+    else
+      ++iter;
+  }
+}
+
+
+void RowCache::clear() {
+  ScopedLock lock(m_mutex);
+  m_generation++;
+  m_cache.clear();
+  m_avail_memory = m_max_memory;
+}
+
+
+void RowCache::get_stats(Stats &stats) {
+  ScopedLock lock(m_mutex);
+  stats = m_stats;
+  stats.max_memory = m_max_memory;
+  stats.available_memory = m_avail_memory;
+}
+
+
+RowCache::Sequence::iterator RowCache::erase(Sequence::iterator iter) {
+  m_avail_memory += iter->length;
+  return m_cache.erase(iter);
+}
@@ -0,0 +1,147 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_ROWCACHE_H
+#define HYPERTABLE_ROWCACHE_H
+
+#include <boost/functional/hash.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+#include "Cells.h"
+
+namespace Hypertable {
+  using namespace boost::multi_index;
+
+  class TableMutatorAsyncScatterBuffer;
+
+  /**
+   * Client side cache of single row scan results of a table.  Results are
+   * keyed by the encoded ScanSpec, expire after a fixed time to live and
+   * are evicted least recently used first once the memory limit is
+   * reached.  Writes through mutators of the same table invalidate the
+   * rows they touch when they complete; results of scans that were in
+   * flight at that time are not cached.
+   */
+  class RowCache : public ReferenceCount {
+  public:
+
+    struct Stats {
+      uint64_t max_memory;
+      uint64_t available_memory;
+      uint64_t lookups;
+      uint64_t hits;
+      uint64_t expirations;
+      uint64_t invalidations;
+    };
+
+    RowCache(uint64_t max_memory, uint32_t ttl_ms)
+      : m_max_memory(max_memory), m_avail_memory(max_memory),
+        m_ttl((int64_t)ttl_ms * 1000000LL), m_generation(0) {
+      memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    /**
+     * Returns the invalidation generation.  Must be fetched before the
+     * scan whose result is passed to insert() is started.
+     */
+    uint64_t generation() {
+      ScopedLock lock(m_mutex);
+      return m_generation;
+    }
+
+    bool lookup(const String &key, CellsBuilderPtr &cells);
+
+    /**
+     * Caches the result of a scan of row.  The result is dropped if rows
+     * were invalidated since generation was fetched.
+     *
+     * @param key encoded ScanSpec of the scan
+     * @param row row that was scanned
+     * @param cells scan result, must not be modified afterwards
+     * @param generation value of generation() before the scan started
+     * @return true if the result was cached
+     */
+    bool insert(const String &key, const char *row, CellsBuilderPtr &cells,
+                uint64_t generation);
+
+    void invalidate(const char *row);
+
+    /** Invalidates the rows of a completed mutator buffer */
+    void invalidate(const TableMutatorAsyncScatterBuffer &buffer);
+
+    void clear();
+
+    uint64_t max_memory() const { return m_max_memory; }
+
+    void get_stats(Stats &stats);
+
+  private:
+
+    class Entry {
+    public:
+      Entry(const String &k, const char *r, CellsBuilderPtr &c,
+            int64_t exp, uint64_t len)
+        : key(k), row(r), cells(c), expires(exp), length(len) { }
+      String key;
+      String row;
+      CellsBuilderPtr cells;
+      int64_t expires;
+      uint64_t length;
+    };
+
+    typedef boost::multi_index_container<
+      Entry,
+      indexed_by<
+        sequenced<>,
+        hashed_unique<member<Entry, String, &Entry::key>,
+                      boost::hash<String> >,
+        hashed_non_unique<member<Entry, String, &Entry::row>,
+                          boost::hash<String> >
+      >
+    > Cache;
+
+    typedef Cache::nth_index<0>::type Sequence;
+    typedef Cache::nth_index<1>::type LookupHashIndex;
+    typedef Cache::nth_index<2>::type InvalidateHashIndex;
+
+    Sequence::iterator erase(Sequence::iterator iter);
+
+    Mutex     m_mutex;
+    Cache     m_cache;
+    uint64_t  m_max_memory;
+    uint64_t  m_avail_memory;
+    int64_t   m_ttl;
+    uint64_t  m_generation;
+    Stats     m_stats;
+  };
+
+  typedef intrusive_ptr<RowCache> RowCachePtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_ROWCACHE_H
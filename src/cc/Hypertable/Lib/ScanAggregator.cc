@@ -0,0 +1,108 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Serialization.h"
+
+#include "ScanAggregator.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+void AggregateValue::merge(const AggregateValue &other) {
+  count += other.count;
+  values += other.values;
+  sum += other.sum;
+  if (other.min < min)
+    min = other.min;
+  if (other.max > max)
+    max = other.max;
+}
+
+void AggregateValue::encode(uint8_t **bufp) const {
+  encode_i64(bufp, count);
+  encode_i64(bufp, values);
+  encode_i64(bufp, sum);
+  encode_i64(bufp, min);
+  encode_i64(bufp, max);
+}
+
+void AggregateValue::decode(const uint8_t **bufp, size_t *remainp) {
+  HT_TRY("decoding aggregate value",
+    count = decode_i64(bufp, remainp);
+    values = decode_i64(bufp, remainp);
+    sum = decode_i64(bufp, remainp);
+    min = decode_i64(bufp, remainp);
+    max = decode_i64(bufp, remainp));
+}
+
+bool AggregateValue::parse(const uint8_t *ptr, size_t len, int64_t *valuep) {
+  const uint8_t *end = ptr + len;
+  bool negative = false;
+  uint64_t value = 0;
+
+  if (ptr < end && (*ptr == '-' || *ptr == '+'))
+    negative = *ptr++ == '-';
+
+  // 19 digits can't overflow value
+  if (ptr == end || end - ptr > 19)
+    return false;
+
+  for (; ptr < end; ++ptr) {
+    if (*ptr < '0' || *ptr > '9')
+      return false;
+    value = value * 10 + (*ptr - '0');
+  }
+
+  if (value > (uint64_t)std::numeric_limits<int64_t>::max())
+    return false;
+
+  *valuep = negative ? -(int64_t)value : (int64_t)value;
+  return true;
+}
+
+
+void ScanAggregator::add(const Cell &cell) {
+  const uint8_t *ptr = cell.value;
+  size_t remain = cell.value_len;
+  AggregateValue partial;
+
+  if (remain != AggregateValue::ENCODED_LENGTH)
+    HT_THROWF(Error::BAD_KEY, "Bad aggregate value length %u for row '%s'",
+              (unsigned)remain, cell.row_key);
+
+  partial.decode(&ptr, &remain);
+
+  if (m_mode == ScanSpec::AGGREGATE_ROW)
+    m_groups[cell.row_key].merge(partial);
+  else if (m_mode == ScanSpec::AGGREGATE_COLUMN_FAMILY)
+    m_groups[cell.column_family].merge(partial);
+  else
+    m_groups[""].merge(partial);
+}
+
+AggregateValue ScanAggregator::total() const {
+  AggregateValue total;
+  for (GroupMap::const_iterator iter = m_groups.begin();
+       iter != m_groups.end(); ++iter)
+    total.merge(iter->second);
+  return total;
+}
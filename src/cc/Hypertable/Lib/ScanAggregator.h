@@ -0,0 +1,109 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_SCANAGGREGATOR_H
+#define HYPERTABLE_SCANAGGREGATOR_H
+
+#include <limits>
+#include <map>
+
+#include "Common/String.h"
+
+#include "Cell.h"
+#include "ScanSpec.h"
+
+namespace Hypertable {
+
+  /**
+   * Aggregate of a group of cells.  count is the number of cells in the
+   * group; sum, min and max are computed over the cells with a numeric
+   * value, i.e. counter cells and cells whose value is a decimal integer,
+   * and values is the number of such cells.
+   */
+  class AggregateValue {
+  public:
+    static const size_t ENCODED_LENGTH = 40;
+
+    AggregateValue() : count(0), values(0), sum(0),
+      min(std::numeric_limits<int64_t>::max()),
+      max(std::numeric_limits<int64_t>::min()) { }
+
+    void add(int64_t value) {
+      values++;
+      sum += value;
+      if (value < min)
+        min = value;
+      if (value > max)
+        max = value;
+    }
+
+    void merge(const AggregateValue &other);
+
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+    /**
+     * Parses a cell value holding a decimal integer
+     *
+     * @param ptr value
+     * @param len value length
+     * @param valuep address of integer to receive the value
+     * @return true if the value is a decimal integer
+     */
+    static bool parse(const uint8_t *ptr, size_t len, int64_t *valuep);
+
+    int64_t count;
+    int64_t values;
+    int64_t sum;
+    int64_t min;
+    int64_t max;
+  };
+
+  /**
+   * Combines the partial aggregates returned by an aggregate scan (see
+   * ScanSpec::aggregate).  Each RangeServer returns partial aggregates for
+   * the part of the scan it serves; pass every cell returned by the
+   * scanner to add() to obtain the aggregate of each group.
+   */
+  class ScanAggregator {
+  public:
+    /** Groups keyed by row, column family or "" for AGGREGATE_TOTAL */
+    typedef std::map<String, AggregateValue> GroupMap;
+
+    ScanAggregator(int32_t mode) : m_mode(mode) { }
+
+    void add(const Cell &cell);
+
+    const GroupMap &groups() const { return m_groups; }
+
+    /** Aggregate of all cells, regardless of the grouping */
+    AggregateValue total() const;
+
+    void clear() { m_groups.clear(); }
+
+  private:
+    int32_t m_mode;
+    GroupMap m_groups;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_SCANAGGREGATOR_H
@@ -27,6 +27,7 @@
 #include "Common/Serialization.h"
 
 #include "ScanBlock.h"
+#include "WireCompressor.h"
 
 using namespace Hypertable;
 using namespace Serialization;
@@ -65,6 +66,19 @@ int ScanBlock::load(EventPtr &event_ptr) {
     return e.code();
   }
   uint8_t *p = (uint8_t *)decode_ptr;
+
+  if (event_ptr->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED) {
+    try {
+      WireCompressor::client()->inflate(p, len, m_inflated);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
+      return e.code();
+    }
+    p = m_inflated.base;
+    len = m_inflated.fill();
+  }
+
   uint8_t *endp = p + len;
   SerializedKey key;
   ByteString value;
@@ -27,6 +27,7 @@
 #include "AsyncComm/Event.h"
 #include "Common/ReferenceCount.h"
 #include "Common/ByteString.h"
+#include "Common/DynamicBuffer.h"
 #include "SerializedKey.h"
 
 namespace Hypertable {
@@ -93,7 +94,7 @@ namespace Hypertable {
      */
     size_t memory_used() const {
       if (m_event_ptr)
-        return m_event_ptr->payload_len;
+        return m_event_ptr->payload_len + m_inflated.size;
       return 0;
     }
 
@@ -109,6 +110,7 @@ namespace Hypertable {
     Vector m_vec;
     Vector::iterator m_iter;
     EventPtr m_event_ptr;
+    DynamicBuffer m_inflated;
   };
   typedef intrusive_ptr<ScanBlock> ScanBlockPtr;
 }
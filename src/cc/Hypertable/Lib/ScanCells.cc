@@ -36,19 +36,22 @@ bool ScanCells::add(EventPtr &event, int *scanner_id) {
 bool ScanCells::load(SchemaPtr &schema,
                      const String &end_row, bool end_inclusive, int row_limit,
                      int *rows_seen, String &cur_row, CstrSet &rowset,
-                     int64_t *bytes_scanned) {
+                     int64_t *bytes_scanned, ScanCellsEncoder *encoder) {
   SerializedKey serkey;
   ByteString value;
   Key key;
   Cell cell;
   ScanBlock *scanblock;
-  Schema::ColumnFamily *cf;
   size_t total_cells=0;
 
-  for(size_t ii=0; ii < m_scanblocks.size(); ++ii)
-    total_cells += m_scanblocks[ii]->size();
+  m_schema = schema;
+  m_encoded_cells = encoder != 0;
 
-  m_cells = new CellsBuilder(total_cells);
+  if (!m_encoded_cells) {
+    for(size_t ii=0; ii < m_scanblocks.size(); ++ii)
+      total_cells += m_scanblocks[ii]->size();
+    m_cells = new CellsBuilder(total_cells);
+  }
 
   for (size_t ii=0; ii < m_scanblocks.size(); ++ii) {
     scanblock = m_scanblocks[ii].get();
@@ -81,22 +84,12 @@ bool ScanCells::load(SchemaPtr &schema,
         }
       }
 
-      cell.row_key = key.row;
-      cell.column_qualifier = key.column_qualifier;
-      if ((cf = schema->get_column_family(key.column_family_code)) == 0) {
-        if (key.flag != FLAG_DELETE_ROW)
-          HT_THROWF(Error::BAD_KEY, "Unexpected column family code %d",
-              (int)key.column_family_code);
-        cell.column_family = "";
-      }
+      fill_cell(key, value, cell);
+      if (encoder)
+        encoder->encode(m_encoded, cell);
       else
-        cell.column_family = cf->name.c_str();
-
-      cell.timestamp = key.timestamp;
-      cell.revision = key.revision;
-      cell.value_len = value.decode_length(&cell.value);
-      cell.flag = key.flag;
-      m_cells->add(cell, false);
+        m_cells->add(cell, false);
+      m_count++;
       *bytes_scanned += key.length + cell.value_len;
 
       // if rowset scan remove scanned row
@@ -107,3 +100,43 @@ bool ScanCells::load(SchemaPtr &schema,
   return false;
 }
 
+void ScanCells::fill_cell(const Key &key, ByteString value, Cell &cell) {
+  Schema::ColumnFamily *cf;
+
+  cell.row_key = key.row;
+  cell.column_qualifier = key.column_qualifier;
+  if ((cf = m_schema->get_column_family(key.column_family_code)) == 0) {
+    if (key.flag != FLAG_DELETE_ROW)
+      HT_THROWF(Error::BAD_KEY, "Unexpected column family code %d",
+          (int)key.column_family_code);
+    cell.column_family = "";
+  }
+  else
+    cell.column_family = cf->name.c_str();
+
+  cell.timestamp = key.timestamp;
+  cell.revision = key.revision;
+  cell.value_len = value.decode_length(&cell.value);
+  cell.flag = key.flag;
+}
+
+void ScanCells::build_cells() {
+  SerializedKey serkey;
+  ByteString value;
+  Key key;
+  Cell cell;
+
+  // the loaded cells are the first m_count key/value pairs of the blocks
+  m_cells = new CellsBuilder(m_count);
+  for (size_t ii=0; ii < m_scanblocks.size() && m_cells->size() < m_count;
+       ++ii) {
+    m_scanblocks[ii]->reset();
+    while (m_cells->size() < m_count &&
+           m_scanblocks[ii]->next(serkey, value)) {
+      if (!key.load(serkey))
+        HT_THROW(Error::BAD_KEY, "");
+      fill_cell(key, value, cell);
+      m_cells->add(cell, false);
+    }
+  }
+}
@@ -38,6 +38,27 @@ namespace Hypertable {
 using namespace std;
 class IntervalScannerAsync;
 
+/**
+ * Encodes scan results into an application wire format.  A scanner given
+ * an encoder (see TableScanner::set_cells_encoder) encodes each cell as it
+ * is loaded from the scan block it arrived in, instead of collecting the
+ * cells, so the encoded results can be handed out without another pass.
+ */
+class ScanCellsEncoder : public ReferenceCount {
+public:
+  virtual ~ScanCellsEncoder() { }
+
+  /**
+   * Appends a cell to an encoded buffer
+   *
+   * @param buf buffer to append the encoded cell to
+   * @param cell cell to encode
+   */
+  virtual void encode(String &buf, const Cell &cell) = 0;
+};
+
+typedef intrusive_ptr<ScanCellsEncoder> ScanCellsEncoderPtr;
+
 /**
  * This class takes allows vector access to a set of cells contained in an EventPtr without
  * any copying.
@@ -45,9 +66,11 @@ class IntervalScannerAsync;
 class ScanCells : public ReferenceCount {
 
 public:
-  ScanCells() : m_eos(false){}
+  ScanCells() : m_encoded_cells(false), m_count(0), m_eos(false){}
 
   void get(Cells &cells) {
+    if (m_count && !m_cells)
+      build_cells();
     if (m_cells) {
       m_cells->get(cells);
     }
@@ -55,18 +78,29 @@ public:
       cells.clear();
     }
   }
-  void get_cell_unchecked(Cell &cc, size_t ii) { m_cells->get_cell(cc, ii); }
+  void get_cell_unchecked(Cell &cc, size_t ii) {
+    if (!m_cells)
+      build_cells();
+    m_cells->get_cell(cc, ii);
+  }
   void set_eos() { m_eos = true; }
   bool get_eos() const { return m_eos; }
-  size_t size() const {
-    if (m_cells)
-      return m_cells->size();
-    else
-      return 0;
-  }
+  size_t size() const { return m_count; }
+
+  /**
+   * Returns true if the cells were encoded with a ScanCellsEncoder
+   * while they were loaded
+   */
+  bool encoded() const { return m_encoded_cells; }
+
+  /**
+   * Returns the encoded cells.  The caller may take the buffer over by
+   * swapping it, the cells can still be read with #get_cell_unchecked.
+   */
+  String &get_encoded() { return m_encoded; }
 
   size_t memory_used() const {
-    size_t mem_used=0;
+    size_t mem_used=m_encoded.size();
     foreach(const ScanBlockPtr &v, m_scanblocks) {
       mem_used += v->memory_used();
     }
@@ -94,14 +128,32 @@ protected:
    * @param cur_row current/last row seen by scanner
    * @param eos true if these results have the eos bit set
    * @param bytes_scanned number of bytes read
+   * @param encoder if not null, cells are encoded with it instead of
+   *        being collected
    * @return true if scan has reached end
    */
   bool load(SchemaPtr &schema,
             const String &end_row, bool end_inclusive, int row_limit,
-            int *rows_seen, String &cur_row, CstrSet &rowset, int64_t *bytes_scanned);
+            int *rows_seen, String &cur_row, CstrSet &rowset, int64_t *bytes_scanned,
+            ScanCellsEncoder *encoder=0);
+
+private:
+
+  /** Fills a cell from a loaded key and its value */
+  void fill_cell(const Key &key, ByteString value, Cell &cell);
+
+  /**
+   * Collects the cells of an encoded result from its scan blocks, for
+   * callers that read it cell by cell
+   */
+  void build_cells();
 
   vector<ScanBlockPtr> m_scanblocks;
   CellsBuilderPtr m_cells;
+  SchemaPtr m_schema;
+  String m_encoded;
+  bool m_encoded_cells;
+  size_t m_count;
   bool m_eos;
 }; // ScanCells
 
@@ -88,7 +88,8 @@ size_t ScanSpec::encoded_length() const {
                encoded_length_vi32(row_intervals.size()) +
                encoded_length_vi32(cell_intervals.size()) +
                encoded_length_vstr(row_regexp) +
-               encoded_length_vstr(value_regexp);
+               encoded_length_vstr(value_regexp) +
+               encoded_length_vi32(aggregate);
 
   foreach(const char *c, columns) len += encoded_length_vstr(c);
   foreach(const RowInterval &ri, row_intervals) len += ri.encoded_length();
@@ -114,6 +115,7 @@ void ScanSpec::encode(uint8_t **bufp) const {
   encode_vstr(bufp, row_regexp);
   encode_vstr(bufp, value_regexp);
   encode_bool(bufp, scan_and_filter_rows);
+  encode_vi32(bufp, aggregate);
 }
 
 void ScanSpec::decode(const uint8_t **bufp, size_t *remainp) {
@@ -139,7 +141,8 @@ void ScanSpec::decode(const uint8_t **bufp, size_t *remainp) {
     keys_only = decode_bool(bufp, remainp);
     row_regexp = decode_vstr(bufp, remainp);
     value_regexp = decode_vstr(bufp, remainp);
-    scan_and_filter_rows = decode_bool(bufp, remainp));
+    scan_and_filter_rows = decode_bool(bufp, remainp);
+    aggregate = decode_vi32(bufp, remainp));
 }
 
 
@@ -197,6 +200,7 @@ ostream &Hypertable::operator<<(ostream &os, const ScanSpec &scan_spec) {
   os << " row_regexp=" << scan_spec.row_regexp;
   os << " value_regexp=" << scan_spec.value_regexp;
   os << " scan_and_filter_rows=" << scan_spec.scan_and_filter_rows;
+  os << " aggregate=" << scan_spec.aggregate;
 
   if (!scan_spec.row_intervals.empty()) {
     os << "\n rows=";
@@ -227,7 +231,7 @@ ScanSpec::ScanSpec(CharArena &arena, const ScanSpec &ss)
     cell_intervals(CellIntervalAlloc(arena)),
     time_interval(ss.time_interval.first, ss.time_interval.second),
     return_deletes(ss.return_deletes), keys_only(ss.keys_only),
-    scan_and_filter_rows(ss.scan_and_filter_rows) {
+    scan_and_filter_rows(ss.scan_and_filter_rows), aggregate(ss.aggregate) {
   columns.reserve(ss.columns.size());
   row_intervals.reserve(ss.row_intervals.size());
   cell_intervals.reserve(ss.cell_intervals.size());
@@ -102,18 +102,34 @@ typedef std::vector<const char *, CstrAlloc> CstrColumns;
  */
 class ScanSpec {
 public:
+  /**
+   * Aggregation modes.  An aggregate scan returns, instead of the cells,
+   * one cell per group whose value is an encoded AggregateValue (see
+   * ScanAggregator.h) holding the count, sum, min and max of the group.
+   * RangeServers return partial aggregates per (row, column family) or
+   * per column family, which are combined by ScanAggregator.
+   */
+  enum {
+    AGGREGATE_NONE = 0,
+    AGGREGATE_ROW,
+    AGGREGATE_COLUMN_FAMILY,
+    AGGREGATE_TOTAL
+  };
+
   ScanSpec()
     : row_limit(0), cell_limit(0), max_versions(0),
       time_interval(TIMESTAMP_MIN, TIMESTAMP_MAX),
       return_deletes(false), keys_only(false),
-      row_regexp(0), value_regexp(0),scan_and_filter_rows(false) { }
+      row_regexp(0), value_regexp(0),scan_and_filter_rows(false),
+      aggregate(AGGREGATE_NONE) { }
   ScanSpec(CharArena &arena)
     : row_limit(0), cell_limit(0), max_versions(0), columns(CstrAlloc(arena)),
       row_intervals(RowIntervalAlloc(arena)),
       cell_intervals(CellIntervalAlloc(arena)),
       time_interval(TIMESTAMP_MIN, TIMESTAMP_MAX),
       return_deletes(false), keys_only(false),
-      row_regexp(0), value_regexp(0), scan_and_filter_rows(false) { }
+      row_regexp(0), value_regexp(0), scan_and_filter_rows(false),
+      aggregate(AGGREGATE_NONE) { }
   ScanSpec(CharArena &arena, const ScanSpec &);
   ScanSpec(const uint8_t **bufp, size_t *remainp) { decode(bufp, remainp); }
 
@@ -135,6 +151,7 @@ public:
     row_regexp = 0;
     value_regexp = 0;
     scan_and_filter_rows = false;
+    aggregate = AGGREGATE_NONE;
   }
 
   /** Initialize 'other' ScanSpec with this copy sans the intervals */
@@ -151,6 +168,7 @@ public:
     other.row_regexp = row_regexp;
     other.value_regexp = value_regexp;
     other.scan_and_filter_rows = scan_and_filter_rows;
+    other.aggregate = aggregate;
   }
 
   bool cacheable() {
@@ -281,6 +299,7 @@ public:
   const char *row_regexp;
   const char *value_regexp;
   bool scan_and_filter_rows;
+  int32_t aggregate;
 };
 
 /**
@@ -333,6 +352,15 @@ public:
    */
   void set_value_regexp(const char* regexp) { m_scan_spec.set_value_regexp(m_arena, regexp); }
 
+  /**
+   * Sets the aggregation mode, one of ScanSpec::AGGREGATE_ROW,
+   * ScanSpec::AGGREGATE_COLUMN_FAMILY or ScanSpec::AGGREGATE_TOTAL.  The
+   * cells returned by the scan are then to be fed to a ScanAggregator.
+   *
+   * @param mode aggregation mode
+   */
+  void set_aggregate(int32_t mode) { m_scan_spec.aggregate = mode; }
+
   /**
    * Adds a column family to be returned by the scan.
    *
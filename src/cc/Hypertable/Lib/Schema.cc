@@ -72,7 +72,7 @@ Mutex desc_mutex;
 bool desc_inited = false;
 
 PropertiesDesc
-  compressor_desc("  bmz|lzo|quicklz|zlib|none [compressor_options]\n\n"
+  compressor_desc("  bmz|lzo|lz4|lz4hc|quicklz|zlib|none [compressor_options]\n\n"
       "compressor_options"),
   bloom_filter_desc("  rows|rows+cols|none [bloom_filter_options]\n\n"
       "  Default bloom filter is defined by the config property:\n"
@@ -89,13 +89,15 @@ void init_schema_options_desc() {
     return;
 
   compressor_desc.add_options()
-    ("best,9", "Highest setting (probably slower) for zlib")
+    ("best,9", "Highest setting (probably slower) for zlib; for lz4hc "
+     "--best selects level 12 and -9 level 9")
+    ("level,l", i16(), "Compression level (1-12) for lz4hc")
     ("normal", "Normal setting for zlib")
     ("fp-len", i16()->default_value(19), "Minimum fingerprint length for bmz")
     ("offset", i16()->default_value(0), "Starting fingerprint offset for bmz")
     ;
   compressor_hidden_desc.add_options()
-    ("compressor-type", str(), "Compressor type (bmz|lzo|quicklz|zlib|none)")
+    ("compressor-type", str(), "Compressor type (bmz|lzo|lz4|lz4hc|quicklz|zlib|none)")
     ;
   compressor_pos_desc.add("compressor-type", 1);
 
@@ -152,6 +154,7 @@ Schema::Schema(const Schema &src_schema)
     ag->counter = src_ag->counter;
     ag->replication = src_ag->replication;
     ag->blocksize = src_ag->blocksize;
+    ag->blob_threshold = src_ag->blob_threshold;
     ag->compressor = src_ag->compressor;
     ag->bloom_filter = src_ag->bloom_filter;
 
@@ -471,6 +474,14 @@ void Schema::set_access_group_parameter(const char *param, const char *value) {
       else
         m_open_access_group->blocksize = (uint32_t)blocksize;
     }
+    else if (!strcasecmp(param, "blobThreshold")) {
+      long long threshold = strtoll(value, 0, 10);
+      if (threshold < 0 || threshold >= 4294967296LL)
+        set_error_string((String)"Invalid value (" + value
+                          + ") for AccessGroup attribute '" + param + "'");
+      else
+        m_open_access_group->blob_threshold = (uint32_t)threshold;
+    }
     else if (!strcasecmp(param, "replication")) {
       long long replication = strtoll(value, 0, 10);
       if (replication < 0 || replication >= 32768LL)
@@ -644,6 +655,9 @@ void Schema::render(String &output, bool with_ids) {
     if (ag->blocksize > 0)
       output += format(" blksz=\"%u\"", ag->blocksize);
 
+    if (ag->blob_threshold > 0)
+      output += format(" blobThreshold=\"%u\"", ag->blob_threshold);
+
     if (ag->compressor != "")
       output += format(" compressor=\"%s\"", ag->compressor.c_str());
 
@@ -754,6 +768,9 @@ void Schema::render_hql_create_table(const String &table_name, String &output) {
     if (ag->blocksize != 0)
       ag_string += format(" BLOCKSIZE=%u", ag->blocksize);
 
+    if (ag->blob_threshold != 0)
+      ag_string += format(" BLOB_THRESHOLD=%u", ag->blob_threshold);
+
     if (ag->compressor != "")
       ag_string += format(" COMPRESSOR=\"%s\"", ag->compressor.c_str());
 
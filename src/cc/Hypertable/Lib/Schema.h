@@ -62,13 +62,14 @@ namespace Hypertable {
 
     struct AccessGroup {
       AccessGroup() : name(), in_memory(false), counter(false), replication(-1), blocksize(0),
-          bloom_filter(), columns() { }
+          blob_threshold(0), bloom_filter(), columns() { }
 
       String   name;
       bool     in_memory;
       bool     counter;
       int16_t  replication;
       uint32_t blocksize;
+      uint32_t blob_threshold;
       String compressor;
       String bloom_filter;
       ColumnFamilies columns;
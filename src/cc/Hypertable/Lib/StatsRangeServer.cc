@@ -28,16 +28,44 @@ using namespace Hypertable;
 
 namespace {
   enum Group {
-    PRIMARY_GROUP = 0
+    PRIMARY_GROUP = 0,
+    WIRE_GROUP = 1,
+    MEMORY_GROUP = 2,
+    MAINTENANCE_GROUP = 3,
+    THROTTLE_GROUP = 4
   };
 }
 
-StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 5), timestamp(TIMESTAMP_MIN),
+  wire_update_raw_bytes(0), wire_update_bytes(0), wire_scan_raw_bytes(0), wire_scan_bytes(0),
+  wire_client_update_raw_bytes(0), wire_client_update_bytes(0),
+  wire_client_scan_raw_bytes(0), wire_client_scan_bytes(0),
+  cell_cache_memory(0), block_index_memory(0), bloom_filter_memory(0),
+  shadow_cache_memory(0), idle_index_memory(0), block_cache_limit(0),
+  query_cache_limit(0), memory_rebalances(0), memory_rebalanced_bytes(0),
+  maintenance_passes(0), maintenance_time(0), maintenance_last_time(0),
+  maintenance_last_gather_time(0), maintenance_last_prioritize_time(0),
+  maintenance_ranges_gathered(0), maintenance_ranges_reused(0),
+  throttled_updates(0), throttle_delay_time(0), throttle_drain_rate(0) {
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = WIRE_GROUP;
+  group_ids[2] = MEMORY_GROUP;
+  group_ids[3] = MAINTENANCE_GROUP;
+  group_ids[4] = THROTTLE_GROUP;
 }
 
 
-StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 5), timestamp(TIMESTAMP_MIN),
+  wire_update_raw_bytes(0), wire_update_bytes(0), wire_scan_raw_bytes(0), wire_scan_bytes(0),
+  wire_client_update_raw_bytes(0), wire_client_update_bytes(0),
+  wire_client_scan_raw_bytes(0), wire_client_scan_bytes(0),
+  cell_cache_memory(0), block_index_memory(0), bloom_filter_memory(0),
+  shadow_cache_memory(0), idle_index_memory(0), block_cache_limit(0),
+  query_cache_limit(0), memory_rebalances(0), memory_rebalanced_bytes(0),
+  maintenance_passes(0), maintenance_time(0), maintenance_last_time(0),
+  maintenance_last_gather_time(0), maintenance_last_prioritize_time(0),
+  maintenance_ranges_gathered(0), maintenance_ranges_reused(0),
+  throttled_updates(0), throttle_delay_time(0), throttle_drain_rate(0) {
   const char *base, *ptr;
   String datadirs = props->get_str("Hypertable.RangeServer.Monitoring.DataDirectories");
   String dir;
@@ -60,6 +88,10 @@ StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RAN
                         StatsSystem::DISK|StatsSystem::SWAP|StatsSystem::NET|
                         StatsSystem::PROC | StatsSystem::FS, dirs);
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = WIRE_GROUP;
+  group_ids[2] = MEMORY_GROUP;
+  group_ids[3] = MAINTENANCE_GROUP;
+  group_ids[4] = THROTTLE_GROUP;
 }
 
 StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSerializable(other.id, other.group_count) {
@@ -86,6 +118,34 @@ StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSeriali
   block_cache_hits = other.block_cache_hits;
   tracked_memory = other.tracked_memory;
   live = other.live;
+  wire_update_raw_bytes = other.wire_update_raw_bytes;
+  wire_update_bytes = other.wire_update_bytes;
+  wire_scan_raw_bytes = other.wire_scan_raw_bytes;
+  wire_scan_bytes = other.wire_scan_bytes;
+  wire_client_update_raw_bytes = other.wire_client_update_raw_bytes;
+  wire_client_update_bytes = other.wire_client_update_bytes;
+  wire_client_scan_raw_bytes = other.wire_client_scan_raw_bytes;
+  wire_client_scan_bytes = other.wire_client_scan_bytes;
+  cell_cache_memory = other.cell_cache_memory;
+  block_index_memory = other.block_index_memory;
+  bloom_filter_memory = other.bloom_filter_memory;
+  shadow_cache_memory = other.shadow_cache_memory;
+  idle_index_memory = other.idle_index_memory;
+  block_cache_limit = other.block_cache_limit;
+  query_cache_limit = other.query_cache_limit;
+  memory_rebalances = other.memory_rebalances;
+  memory_rebalanced_bytes = other.memory_rebalanced_bytes;
+  memory_governor_decision = other.memory_governor_decision;
+  maintenance_passes = other.maintenance_passes;
+  maintenance_time = other.maintenance_time;
+  maintenance_last_time = other.maintenance_last_time;
+  maintenance_last_gather_time = other.maintenance_last_gather_time;
+  maintenance_last_prioritize_time = other.maintenance_last_prioritize_time;
+  maintenance_ranges_gathered = other.maintenance_ranges_gathered;
+  maintenance_ranges_reused = other.maintenance_ranges_reused;
+  throttled_updates = other.throttled_updates;
+  throttle_delay_time = other.throttle_delay_time;
+  throttle_drain_rate = other.throttle_drain_rate;
   system = other.system;
   tables = other.tables;
 }
@@ -113,6 +173,34 @@ bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
       block_cache_hits != other.block_cache_hits ||
       tracked_memory != other.tracked_memory ||
       live != other.live ||
+      wire_update_raw_bytes != other.wire_update_raw_bytes ||
+      wire_update_bytes != other.wire_update_bytes ||
+      wire_scan_raw_bytes != other.wire_scan_raw_bytes ||
+      wire_scan_bytes != other.wire_scan_bytes ||
+      wire_client_update_raw_bytes != other.wire_client_update_raw_bytes ||
+      wire_client_update_bytes != other.wire_client_update_bytes ||
+      wire_client_scan_raw_bytes != other.wire_client_scan_raw_bytes ||
+      wire_client_scan_bytes != other.wire_client_scan_bytes ||
+      cell_cache_memory != other.cell_cache_memory ||
+      block_index_memory != other.block_index_memory ||
+      bloom_filter_memory != other.bloom_filter_memory ||
+      shadow_cache_memory != other.shadow_cache_memory ||
+      idle_index_memory != other.idle_index_memory ||
+      block_cache_limit != other.block_cache_limit ||
+      query_cache_limit != other.query_cache_limit ||
+      memory_rebalances != other.memory_rebalances ||
+      memory_rebalanced_bytes != other.memory_rebalanced_bytes ||
+      memory_governor_decision != other.memory_governor_decision ||
+      maintenance_passes != other.maintenance_passes ||
+      maintenance_time != other.maintenance_time ||
+      maintenance_last_time != other.maintenance_last_time ||
+      maintenance_last_gather_time != other.maintenance_last_gather_time ||
+      maintenance_last_prioritize_time != other.maintenance_last_prioritize_time ||
+      maintenance_ranges_gathered != other.maintenance_ranges_gathered ||
+      maintenance_ranges_reused != other.maintenance_ranges_reused ||
+      throttled_updates != other.throttled_updates ||
+      throttle_delay_time != other.throttle_delay_time ||
+      throttle_drain_rate != other.throttle_drain_rate ||
       system != other.system)
     return false;
   if (tables.size() != other.tables.size())
@@ -135,6 +223,14 @@ size_t StatsRangeServer::encoded_length_group(int group) const {
       len += tables[i].encoded_length();
     return len;
   }
+  else if (group == WIRE_GROUP)
+    return 8*8;
+  else if (group == MEMORY_GROUP)
+    return 8*9 + Serialization::encoded_length_vstr(memory_governor_decision);
+  else if (group == MAINTENANCE_GROUP)
+    return 8*7;
+  else if (group == THROTTLE_GROUP)
+    return 8*3;
   else
     HT_FATALF("Invalid group number (%d)", group);
   return 0;
@@ -169,6 +265,42 @@ void StatsRangeServer::encode_group(int group, uint8_t **bufp) const {
     for (size_t i=0; i<tables.size(); i++)
       tables[i].encode(bufp);
   }
+  else if (group == WIRE_GROUP) {
+    Serialization::encode_i64(bufp, wire_update_raw_bytes);
+    Serialization::encode_i64(bufp, wire_update_bytes);
+    Serialization::encode_i64(bufp, wire_scan_raw_bytes);
+    Serialization::encode_i64(bufp, wire_scan_bytes);
+    Serialization::encode_i64(bufp, wire_client_update_raw_bytes);
+    Serialization::encode_i64(bufp, wire_client_update_bytes);
+    Serialization::encode_i64(bufp, wire_client_scan_raw_bytes);
+    Serialization::encode_i64(bufp, wire_client_scan_bytes);
+  }
+  else if (group == MEMORY_GROUP) {
+    Serialization::encode_i64(bufp, cell_cache_memory);
+    Serialization::encode_i64(bufp, block_index_memory);
+    Serialization::encode_i64(bufp, bloom_filter_memory);
+    Serialization::encode_i64(bufp, shadow_cache_memory);
+    Serialization::encode_i64(bufp, idle_index_memory);
+    Serialization::encode_i64(bufp, block_cache_limit);
+    Serialization::encode_i64(bufp, query_cache_limit);
+    Serialization::encode_i64(bufp, memory_rebalances);
+    Serialization::encode_i64(bufp, memory_rebalanced_bytes);
+    Serialization::encode_vstr(bufp, memory_governor_decision);
+  }
+  else if (group == MAINTENANCE_GROUP) {
+    Serialization::encode_i64(bufp, maintenance_passes);
+    Serialization::encode_i64(bufp, maintenance_time);
+    Serialization::encode_i64(bufp, maintenance_last_time);
+    Serialization::encode_i64(bufp, maintenance_last_gather_time);
+    Serialization::encode_i64(bufp, maintenance_last_prioritize_time);
+    Serialization::encode_i64(bufp, maintenance_ranges_gathered);
+    Serialization::encode_i64(bufp, maintenance_ranges_reused);
+  }
+  else if (group == THROTTLE_GROUP) {
+    Serialization::encode_i64(bufp, throttled_updates);
+    Serialization::encode_i64(bufp, throttle_delay_time);
+    Serialization::encode_i64(bufp, throttle_drain_rate);
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
 }
@@ -206,6 +338,42 @@ void StatsRangeServer::decode_group(int group, uint16_t len, const uint8_t **buf
       tables.push_back(table);
     }
   }
+  else if (group == WIRE_GROUP) {
+    wire_update_raw_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_update_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_scan_raw_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_scan_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_client_update_raw_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_client_update_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_client_scan_raw_bytes = Serialization::decode_i64(bufp, remainp);
+    wire_client_scan_bytes = Serialization::decode_i64(bufp, remainp);
+  }
+  else if (group == MEMORY_GROUP) {
+    cell_cache_memory = Serialization::decode_i64(bufp, remainp);
+    block_index_memory = Serialization::decode_i64(bufp, remainp);
+    bloom_filter_memory = Serialization::decode_i64(bufp, remainp);
+    shadow_cache_memory = Serialization::decode_i64(bufp, remainp);
+    idle_index_memory = Serialization::decode_i64(bufp, remainp);
+    block_cache_limit = Serialization::decode_i64(bufp, remainp);
+    query_cache_limit = Serialization::decode_i64(bufp, remainp);
+    memory_rebalances = Serialization::decode_i64(bufp, remainp);
+    memory_rebalanced_bytes = Serialization::decode_i64(bufp, remainp);
+    memory_governor_decision = Serialization::decode_vstr(bufp, remainp);
+  }
+  else if (group == MAINTENANCE_GROUP) {
+    maintenance_passes = Serialization::decode_i64(bufp, remainp);
+    maintenance_time = Serialization::decode_i64(bufp, remainp);
+    maintenance_last_time = Serialization::decode_i64(bufp, remainp);
+    maintenance_last_gather_time = Serialization::decode_i64(bufp, remainp);
+    maintenance_last_prioritize_time = Serialization::decode_i64(bufp, remainp);
+    maintenance_ranges_gathered = Serialization::decode_i64(bufp, remainp);
+    maintenance_ranges_reused = Serialization::decode_i64(bufp, remainp);
+  }
+  else if (group == THROTTLE_GROUP) {
+    throttled_updates = Serialization::decode_i64(bufp, remainp);
+    throttle_delay_time = Serialization::decode_i64(bufp, remainp);
+    throttle_drain_rate = Serialization::decode_i64(bufp, remainp);
+  }
   else {
     HT_WARNF("Unrecognized StatsRangeServer group %d, skipping...", group);
     (*bufp) += len;
@@ -80,6 +80,43 @@ namespace Hypertable {
     uint64_t block_cache_hits;
     uint64_t tracked_memory;
     bool     live;
+    // raw and on-the-wire bytes of update requests and scan responses
+    // since server start, as received and sent by the server and as sent
+    // and received by the client library in the RangeServer process
+    uint64_t wire_update_raw_bytes;
+    uint64_t wire_update_bytes;
+    uint64_t wire_scan_raw_bytes;
+    uint64_t wire_scan_bytes;
+    uint64_t wire_client_update_raw_bytes;
+    uint64_t wire_client_update_bytes;
+    uint64_t wire_client_scan_raw_bytes;
+    uint64_t wire_client_scan_bytes;
+    // memory of the RangeServer consumers and the last decision of the
+    // memory governor
+    uint64_t cell_cache_memory;
+    uint64_t block_index_memory;
+    uint64_t bloom_filter_memory;
+    uint64_t shadow_cache_memory;
+    uint64_t idle_index_memory;
+    uint64_t block_cache_limit;
+    uint64_t query_cache_limit;
+    uint64_t memory_rebalances;
+    uint64_t memory_rebalanced_bytes;
+    String memory_governor_decision;
+    // time spent scheduling maintenance, in microseconds, and the ranges
+    // gathered afresh or reused by the last pass
+    uint64_t maintenance_passes;
+    uint64_t maintenance_time;
+    uint64_t maintenance_last_time;
+    uint64_t maintenance_last_gather_time;
+    uint64_t maintenance_last_prioritize_time;
+    uint64_t maintenance_ranges_gathered;
+    uint64_t maintenance_ranges_reused;
+    // updates paced by the update throttle, their total delay in
+    // milliseconds and the estimated CellCache drain rate in bytes/second
+    uint64_t throttled_updates;
+    uint64_t throttle_delay_time;
+    uint64_t throttle_drain_rate;
 
     StatsSystem system;
     std::vector<StatsTable> tables;
@@ -84,6 +84,17 @@ void Table::initialize() {
 
   m_scanner_queue_size = m_props->get_i32("Hypertable.Scanner.QueueSize");
   HT_ASSERT(m_scanner_queue_size > 0);
+  m_scanner_parallel_ranges =
+      m_props->get_i32("Hypertable.Scanner.ParallelRanges");
+
+  // cached rows may predate a schema change
+  int64_t row_cache_memory =
+      m_props->get_i64("Hypertable.Client.RowCache.MaxMemory");
+  if (m_row_cache)
+    m_row_cache->clear();
+  else if (row_cache_memory > 0)
+    m_row_cache = new RowCache(row_cache_memory,
+        m_props->get_i32("Hypertable.Client.RowCache.TTL"));
 
 
   // Convert table name to ID string
@@ -188,12 +199,33 @@ TableScanner *
 Table::create_scanner(const ScanSpec &scan_spec, uint32_t timeout_ms,
                       int32_t flags) {
   return new TableScanner(m_comm, this, m_range_locator, scan_spec,
-                          timeout_ms ? timeout_ms : m_timeout_ms);
+                          timeout_ms ? timeout_ms : m_timeout_ms, flags,
+                          m_scanner_parallel_ranges);
 }
 
 TableScannerAsync *
 Table::create_scanner_async(ResultCallback *cb, const ScanSpec &scan_spec, uint32_t timeout_ms,
                             int32_t flags) {
   return  new TableScannerAsync(m_comm, m_app_queue, this, m_range_locator, scan_spec,
-                                timeout_ms ? timeout_ms : m_timeout_ms, cb);
+                                timeout_ms ? timeout_ms : m_timeout_ms, cb, flags,
+                                m_scanner_parallel_ranges);
+}
+
+void
+Table::prefetch_locations(const char *start_row, const char *end_row,
+                          uint32_t timeout_ms) {
+  TableIdentifierManaged table_identifier;
+  SchemaPtr schema;
+  Timer timer(timeout_ms ? timeout_ms : m_timeout_ms, true);
+  int error;
+
+  get(table_identifier, schema);
+
+  if ((error = m_range_locator->prefetch(&table_identifier, start_row,
+                                         end_row, timer)) != Error::OK) {
+    m_range_locator->dump_error_history();
+    HT_THROWF(error, "Prefetching range locations for table '%s'",
+              table_identifier.id);
+  }
+  m_range_locator->clear_error_history();
 }
@@ -30,6 +30,7 @@
 #include "NameIdMapper.h"
 #include "Schema.h"
 #include "RangeLocator.h"
+#include "RowCache.h"
 #include "Types.h"
 #include "RangeServerProtocol.h"
 
@@ -63,6 +64,13 @@ namespace Hypertable {
       MUTATOR_FLAG_IGNORE_UNKNOWN_CFS = RangeServerProtocol::UPDATE_FLAG_IGNORE_UNKNOWN_CFS
     };
 
+    // 0x01 is not used, older callers passed 'true' as the scanner flags
+    enum {
+      SCANNER_FLAG_PARALLEL_RANGES    = 0x02,
+      SCANNER_FLAG_UNORDERED          = 0x04,
+      SCANNER_FLAG_BYPASS_ROW_CACHE   = 0x08
+    };
+
     Table(PropertiesPtr &, ConnectionManagerPtr &, Hyperspace::SessionPtr &,
           NameIdMapperPtr &namemap, const String &name, int32_t flags=0);
     Table(PropertiesPtr &, RangeLocatorPtr &, ConnectionManagerPtr &,
@@ -100,7 +108,10 @@ namespace Hypertable {
      * @param scan_spec scan specification
      * @param timeout_ms maximum time in milliseconds to allow
      *        scanner methods to execute before throwing an exception
-     * @param scanner flags
+     * @param flags scanner flags (SCANNER_FLAG_*); single row scans are
+     *        served from the row cache, if enabled with
+     *        Hypertable.Client.RowCache.MaxMemory, unless
+     *        SCANNER_FLAG_BYPASS_ROW_CACHE is given
      * @return pointer to scanner object
      */
     TableScanner *create_scanner(const ScanSpec &scan_spec,
@@ -114,7 +125,10 @@ namespace Hypertable {
      * @param scan_spec scan specification
      * @param timeout_ms maximum time in milliseconds to allow
      *        scanner methods to execute before throwing an exception
-     * @param scanner flags
+     * @param flags scanner flags (SCANNER_FLAG_*); with
+     *        SCANNER_FLAG_PARALLEL_RANGES up to Hypertable.Scanner.ParallelRanges
+     *        ranges are scanned concurrently, with SCANNER_FLAG_UNORDERED
+     *        results of different ranges are delivered as they arrive
      * @return pointer to scanner object
      */
     TableScannerAsync *create_scanner_async(ResultCallback *cb,
@@ -122,6 +136,19 @@ namespace Hypertable {
                                             uint32_t timeout_ms = 0,
                                             int32_t flags = 0);
 
+    /**
+     * Loads the locations of all ranges that intersect the row interval
+     * [start_row, end_row] into the location cache with one METADATA
+     * scan, e.g. before a bulk load into a table with many ranges
+     *
+     * @param start_row first row of interval (0 or "" for table start)
+     * @param end_row last row of interval (0 or "" for table end)
+     * @param timeout_ms maximum time in milliseconds to allow
+     */
+    void prefetch_locations(const char *start_row = 0,
+                            const char *end_row = 0,
+                            uint32_t timeout_ms = 0);
+
     void get_identifier(TableIdentifier *table_id_p) {
       memcpy(table_id_p, &m_table, sizeof(TableIdentifier));
     }
@@ -165,6 +192,11 @@ namespace Hypertable {
 
     int32_t get_flags() { return m_flags; }
 
+    /**
+     * Returns the row cache of this table or 0 if it is disabled
+     */
+    RowCachePtr row_cache() { return m_row_cache; }
+
   private:
     void initialize();
 
@@ -184,6 +216,8 @@ namespace Hypertable {
     bool                   m_stale;
     String                 m_toplevel_dir;
     size_t                 m_scanner_queue_size;
+    int32_t                m_scanner_parallel_ranges;
+    RowCachePtr            m_row_cache;
   };
 
   typedef intrusive_ptr<Table> TablePtr;
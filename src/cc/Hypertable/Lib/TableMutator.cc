@@ -144,7 +144,7 @@ void TableMutator::auto_flush() {
   try {
     if (!m_mutator->needs_flush())
       return;
-    while(m_mutator->has_outstanding()) {
+    while(!m_mutator->flush_ready()) {
       m_queue->wait_for_buffer();
       if (m_last_error != Error::OK)
         HT_THROW(m_last_error, "");
@@ -166,7 +166,7 @@ void TableMutator::auto_flush() {
 void TableMutator::flush() {
   try {
     m_last_error = Error::OK;
-    while(m_mutator->has_outstanding()) {
+    while(!m_mutator->flush_ready()) {
       m_queue->wait_for_buffer();
       if (m_last_error != Error::OK)
         HT_THROW(m_last_error, "");
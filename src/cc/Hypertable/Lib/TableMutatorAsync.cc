@@ -27,11 +27,13 @@ extern "C" {
 
 #include "Common/Config.h"
 #include "Common/StringExt.h"
+#include "Common/Time.h"
 
 #include "Key.h"
 #include "TableMutatorAsync.h"
 #include "ResultCallback.h"
 #include "TableMutatorSyncDispatchHandler.h"
+#include "TableMutatorThrottleHandler.h"
 #include "Table.h"
 
 using namespace Hypertable;
@@ -61,13 +63,16 @@ TableMutatorAsync::TableMutatorAsync(PropertiesPtr &props, Comm *comm,
     uint32_t timeout_ms, ResultCallback *cb,  uint32_t flags,
     bool explicit_block_only)
   : m_comm(comm), m_app_queue(app_queue), m_table(table), m_range_locator(range_locator),
-    m_memory_used(0), m_resends(0), m_timeout_ms(timeout_ms), m_cb(cb), m_flags(flags),
+    m_memory_used(0), m_outstanding_memory(0), m_resends(0), m_timeout_ms(timeout_ms), m_cb(cb), m_flags(flags),
     m_explicit_block_only(explicit_block_only), m_next_buffer_id(0), m_cancelled(false),
-    m_mutated(false) {
+    m_mutated(false), m_throttle_deadline(0) {
   HT_ASSERT(timeout_ms);
   table->get(m_table_identifier, m_schema);
 
   m_max_memory = props->get_i64("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate");
+  m_max_outstanding_buffers =
+      props->get_i32("Hypertable.Mutator.ScatterBuffer.MaxOutstanding");
+  HT_ASSERT(m_max_outstanding_buffers > 0);
 
   uint32_t buffer_id = ++m_next_buffer_id;
   m_current_buffer = new TableMutatorAsyncScatterBuffer(m_comm, app_queue, this,
@@ -247,6 +252,29 @@ bool TableMutatorAsync::needs_flush() {
   return false;
 }
 
+bool TableMutatorAsync::flush_ready() {
+  ScopedLock lock(m_buffer_mutex);
+
+  if (m_outstanding_buffers.empty())
+    return true;
+
+  if (m_outstanding_buffers.size() >= m_max_outstanding_buffers)
+    return false;
+
+  // A buffer flushed because it reached the aggregate limit exceeds that
+  // limit on its own, so one outstanding buffer is always allowed to overlap
+  // with the current one; beyond that the aggregate limit applies
+  if (m_outstanding_buffers.size() > 1 &&
+      m_outstanding_memory + m_current_buffer->memory_used() > m_max_memory)
+    return false;
+
+  foreach (ScatterBufferAsyncMap::value_type &v, m_outstanding_buffers)
+    if (m_current_buffer->conflicts_with(*v.second))
+      return false;
+
+  return true;
+}
+
 void TableMutatorAsync::flush(bool sync) {
 
   if (is_cancelled())
@@ -258,10 +286,27 @@ void TableMutatorAsync::flush(bool sync) {
     if (m_current_buffer->memory_used() > 0) {
       ScopedLock lock(m_buffer_mutex);
       uint32_t buffer_id = ++m_next_buffer_id;
-      m_current_buffer->send(flags);
+
+      /**
+       * Honor the pacing requested by the RangeServers without blocking the
+       * caller: the buffer is sent by a timer once the delay has passed.
+       * Buffers flushed while others are deferred queue up behind them, so
+       * they are sent in the order they were flushed.
+       */
+      int64_t delay = (m_throttle_deadline - get_ts64()) / 1000000LL;
+      if (delay > 0 || !m_deferred_sends.empty()) {
+        if (m_deferred_sends.empty())
+          m_comm->set_timer((uint32_t)delay,
+                            new TableMutatorThrottleHandler(m_app_queue, this));
+        m_deferred_sends.push_back(std::make_pair(m_current_buffer->get_id(),
+                                                  flags));
+      }
+      else
+        m_current_buffer->send(flags);
       if (m_outstanding_buffers.size() == 0 && m_cb)
         m_cb->increment_outstanding();
       m_outstanding_buffers[m_current_buffer->get_id()] = m_current_buffer;
+      m_outstanding_memory += m_current_buffer->memory_used();
       m_current_buffer = new TableMutatorAsyncScatterBuffer(m_comm, m_app_queue, this,
           &m_table_identifier, m_schema, m_range_locator, m_table->auto_refresh(),
           m_timeout_ms, buffer_id);
@@ -275,6 +320,18 @@ void TableMutatorAsync::flush(bool sync) {
   HT_RETHROW("flushing")
 }
 
+void TableMutatorAsync::send_deferred() {
+  ScopedLock lock(m_buffer_mutex);
+  std::vector<std::pair<uint32_t, uint32_t> > sends;
+
+  sends.swap(m_deferred_sends);
+  for (size_t i=0; i<sends.size(); i++) {
+    ScatterBufferAsyncMap::iterator it = m_outstanding_buffers.find(sends[i].first);
+    HT_ASSERT(it != m_outstanding_buffers.end());
+    it->second->send(sends[i].second);
+  }
+}
+
 void TableMutatorAsync::get_unsynced_rangeservers(std::vector<CommAddress> &unsynced) {
   unsynced.clear();
   foreach (const CommAddress &comm_addr, m_unsynced_rangeservers)
@@ -352,6 +409,7 @@ void TableMutatorAsync::update_unsynced_rangeservers(const CommAddressSet &unsyn
 
 void TableMutatorAsync::update_outstanding(TableMutatorAsyncScatterBufferPtr &buffer) {
   m_outstanding_buffers.erase(buffer->get_id());
+  m_outstanding_memory -= buffer->memory_used();
   if (m_outstanding_buffers.size()==0) {
     m_cond.notify_one();
     if (m_cb)
@@ -371,6 +429,15 @@ void TableMutatorAsync::buffer_finish(uint32_t id, int error, bool retry) {
 
   buffer = it->second;
   m_failed_mutations.clear();
+
+  uint32_t throttle_delay = buffer->get_throttle_delay();
+  if (throttle_delay)
+    m_throttle_deadline = std::max(m_throttle_deadline,
+                                   get_ts64() + (int64_t)throttle_delay * (int64_t)1000000);
+
+  RowCachePtr row_cache = m_table->row_cache();
+  if (row_cache)
+    row_cache->invalidate(*buffer);
   update_unsynced_rangeservers(buffer->get_unsynced_rangeservers());
 
   if (cancelled) {
@@ -419,8 +486,10 @@ void TableMutatorAsync::buffer_finish(uint32_t id, int error, bool retry) {
       HT_ASSERT(redo);
       m_resends += buffer->get_resend_count();
       m_outstanding_buffers.erase(it);
+      m_outstanding_memory -= buffer->memory_used();
       redo->send(buffer->get_send_flags());
       m_outstanding_buffers[next_id] = redo;
+      m_outstanding_memory += redo->memory_used();
     }
   }
   else {
@@ -161,6 +161,13 @@ namespace Hypertable {
      * @param retry true if buffer has retries
      */
     void buffer_finish(uint32_t id, int error, bool retry);
+
+    /**
+     * Sends the buffers that flush() deferred to honor the pacing requested
+     * by the RangeServers, in the order they were flushed.  Called from the
+     * application queue when the throttle timer fires.
+     */
+    void send_deferred();
     void cancel();
     bool is_cancelled();
     void get_unsynced_rangeservers(std::vector<CommAddress> &unsynced);
@@ -176,6 +183,20 @@ namespace Hypertable {
     }
     bool needs_flush();
 
+    /**
+     * Returns true if the current buffer can be flushed without waiting for
+     * outstanding buffers to complete.  At most
+     * Hypertable.Mutator.ScatterBuffer.MaxOutstanding buffers are kept in
+     * flight.  One outstanding buffer may always overlap with the current
+     * one; with more than that, their combined size is bounded by
+     * Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate.  The current
+     * buffer must not touch a row held by an outstanding buffer, so updates
+     * to a row are applied in the order they were made.
+     *
+     * @return true if flush() can be called without reordering updates
+     */
+    bool flush_ready();
+
   protected:
     void wait_for_completion();
 
@@ -214,6 +235,8 @@ namespace Hypertable {
     TableIdentifierManaged m_table_identifier;
     uint64_t             m_memory_used;
     uint64_t             m_max_memory;
+    uint64_t             m_outstanding_memory;
+    size_t               m_max_outstanding_buffers;
     ScatterBufferAsyncMap  m_outstanding_buffers;
     TableMutatorAsyncScatterBufferPtr m_current_buffer;
     uint64_t             m_resends;
@@ -237,6 +260,8 @@ namespace Hypertable {
     uint32_t   m_next_buffer_id;
     bool       m_cancelled;
     bool       m_mutated;
+    int64_t    m_throttle_deadline;
+    std::vector<std::pair<uint32_t, uint32_t> > m_deferred_sends;
     FailedMutations m_failed_mutations;
   };
 
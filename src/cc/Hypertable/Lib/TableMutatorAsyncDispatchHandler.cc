@@ -65,6 +65,7 @@ void TableMutatorAsyncDispatchHandler::handle(EventPtr &event_ptr) {
       const uint8_t *decode_ptr = event_ptr->payload + 4;
       size_t decode_remain = event_ptr->payload_len - 4;
       uint32_t count, offset, len;
+      bool hints_only = true;
 
       if (decode_remain == 0) {
         m_send_buffer->clear();
@@ -81,12 +82,21 @@ void TableMutatorAsyncDispatchHandler::handle(EventPtr &event_ptr) {
             HT_ERROR_OUT << e << HT_END;
             break;
           }
+          if (error == Error::RANGESERVER_UPDATE_THROTTLED) {
+            // throttle hint, count holds the requested delay
+            if (count > m_send_buffer->throttle_delay)
+              m_send_buffer->throttle_delay = count;
+            continue;
+          }
+          hints_only = false;
           if (error == Error::RANGESERVER_OUT_OF_RANGE)
             m_send_buffer->add_retries(count, offset, len);
           else {
             m_send_buffer->add_errors(error, count, offset, len);
           }
         }
+        if (hints_only)
+          m_send_buffer->clear();
       }
     }
   }
@@ -20,7 +20,11 @@
  */
 
 #include "Common/Compat.h"
+
+#include <algorithm>
+
 #include "Common/Config.h"
+#include "Common/MurmurHash.h"
 #include "Common/Timer.h"
 
 #include "Key.h"
@@ -43,7 +47,7 @@ TableMutatorAsyncScatterBuffer::TableMutatorAsyncScatterBuffer(Comm *comm,
     m_table_identifier(*table_identifier),
     m_full(false), m_resends(0), m_auto_refresh(auto_refresh), m_timeout_ms(timeout_ms),
     m_counter_value(9), m_timer(timeout_ms), m_id(id), m_memory_used(0), m_outstanding(false),
-    m_send_flags(0), m_wait_time(ms_init_redo_wait_time) {
+    m_send_flags(0), m_wait_time(ms_init_redo_wait_time), m_rows_sorted(true) {
 
   m_loc_cache = m_range_locator->location_cache();
 
@@ -79,6 +83,7 @@ TableMutatorAsyncScatterBuffer::set(const Key &key, const void *value, uint32_t
   (*iter).second->key_offsets.push_back((*iter).second->accum.fill());
   create_key_and_append((*iter).second->accum, key.flag, key.row,
       key.column_family_code, key.column_qualifier, key.timestamp);
+  add_row(key.row);
 
   // if the CF is a counter then re-encode value to 64 bit int
   if (key.column_family_code && m_schema->get_column_family(key.column_family_code)->counter) {
@@ -163,6 +168,7 @@ void TableMutatorAsyncScatterBuffer::set_delete(const Key &key, size_t incr_mem)
   create_key_and_append((*iter).second->accum, key.flag, key.row,
       key.column_family_code, key.column_qualifier, key.timestamp);
   append_as_byte_string((*iter).second->accum, 0, 0);
+  add_row(key.row);
 
   if ((*iter).second->accum.fill() > m_server_flush_limit)
     m_full = true;
@@ -196,6 +202,7 @@ TableMutatorAsyncScatterBuffer::set(SerializedKey key, ByteString value, size_t
   (*iter).second->key_offsets.push_back((*iter).second->accum.fill());
   (*iter).second->accum.add(key.ptr, (ptr-key.ptr)+len);
   (*iter).second->accum.add(value.ptr, value.length());
+  add_row((const char *)ptr+1);
 
   if ((*iter).second->accum.fill() > m_server_flush_limit)
     m_full = true;
@@ -203,6 +210,56 @@ TableMutatorAsyncScatterBuffer::set(SerializedKey key, ByteString value, size_t
 }
 
 
+namespace {
+  inline uint64_t row_hash(const char *row) {
+    size_t len = strlen(row);
+    return ((uint64_t)murmurhash2(row, len, 0) << 32) |
+      (uint64_t)murmurhash2(row, len, 0x9747b28c);
+  }
+}
+
+
+void TableMutatorAsyncScatterBuffer::add_row(const char *row) {
+  uint64_t hash = row_hash(row);
+  // mutations usually arrive grouped by row, skip the obvious repeats
+  if (m_row_hashes.empty() || m_row_hashes.back() != hash) {
+    m_row_hashes.push_back(hash);
+    m_rows_sorted = false;
+  }
+}
+
+
+void TableMutatorAsyncScatterBuffer::sort_rows() {
+  if (m_rows_sorted)
+    return;
+  std::sort(m_row_hashes.begin(), m_row_hashes.end());
+  m_row_hashes.erase(std::unique(m_row_hashes.begin(), m_row_hashes.end()),
+                     m_row_hashes.end());
+  m_rows_sorted = true;
+}
+
+
+bool TableMutatorAsyncScatterBuffer::may_contain_row(const char *row) const {
+  HT_ASSERT(m_rows_sorted);
+  return std::binary_search(m_row_hashes.begin(), m_row_hashes.end(),
+                            row_hash(row));
+}
+
+
+bool
+TableMutatorAsyncScatterBuffer::conflicts_with(
+    const TableMutatorAsyncScatterBuffer &other) const {
+  HT_ASSERT(other.m_rows_sorted);
+  if (m_row_hashes.empty() || other.m_row_hashes.empty())
+    return false;
+  for (size_t i=0; i<m_row_hashes.size(); i++)
+    if (std::binary_search(other.m_row_hashes.begin(),
+                           other.m_row_hashes.end(), m_row_hashes[i]))
+      return true;
+  return false;
+}
+
+
 namespace {
 
   struct SendRec {
@@ -232,6 +289,7 @@ void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
   bool outstanding=false;
 
   HT_ASSERT(!m_outstanding);
+  sort_rows();
   m_completion_counter.set(m_buffer_map.size());
 
   for (TableMutatorAsyncSendBufferMap::const_iterator iter = m_buffer_map.begin();
@@ -287,7 +345,8 @@ void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
       m_send_flags = flags;
       send_buffer->pending_updates.own = false;
       m_range_server.update(send_buffer->addr, m_table_identifier,
-          send_buffer->send_count, send_buffer->pending_updates, flags,
+          send_buffer->send_count, send_buffer->pending_updates,
+          flags | RangeServerProtocol::UPDATE_FLAG_THROTTLE_HINTS,
           send_buffer->dispatch_handler.get());
 
       outstanding = true;
@@ -316,6 +375,15 @@ void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
 }
 
 
+uint32_t TableMutatorAsyncScatterBuffer::get_throttle_delay() const {
+  uint32_t delay = 0;
+  for (TableMutatorAsyncSendBufferMap::const_iterator iter = m_buffer_map.begin();
+       iter != m_buffer_map.end(); ++iter)
+    delay = std::max(delay, (*iter).second->throttle_delay);
+  return delay;
+}
+
+
 bool TableMutatorAsyncScatterBuffer::completed() {
   ScopedLock lock(m_mutex);
   return m_outstanding;
@@ -483,6 +551,8 @@ void TableMutatorAsyncScatterBuffer::reset() {
   m_failed_mutations.clear();
   m_wait_time = ms_init_redo_wait_time;
   m_unsynced_rangeservers.clear();
+  m_row_hashes.clear();
+  m_rows_sorted = true;
 }
 
 void TableMutatorAsyncScatterBuffer::finish() {
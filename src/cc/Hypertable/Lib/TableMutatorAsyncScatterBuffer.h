@@ -81,6 +81,14 @@ namespace Hypertable {
 
     uint32_t get_id() const { return m_id; }
     uint32_t get_send_flags() const { return m_send_flags; }
+
+    /**
+     * Returns the largest delay, in milliseconds, that the RangeServers
+     * asked for in response to this buffer's updates.
+     *
+     * @return throttle delay in milliseconds
+     */
+    uint32_t get_throttle_delay() const;
     const CommAddressSet &get_unsynced_rangeservers() { return m_unsynced_rangeservers; }
     /**
      * Returns the amount of memory used by the collected mutations.
@@ -91,7 +99,29 @@ namespace Hypertable {
     void set_memory_used(size_t mem) { m_memory_used = mem; }
     void finish();
 
+    /**
+     * Returns true if this buffer may hold mutations for a row that is also
+     * mutated by <code>other</code>.  Rows are tracked as 64-bit hashes,
+     * so apart from a hash collision the answer is exact.  <code>other</code>
+     * must already have been sent.
+     *
+     * @param other buffer to check against
+     * @return true if the buffers might share a row
+     */
+    bool conflicts_with(const TableMutatorAsyncScatterBuffer &other) const;
+
+    /**
+     * Returns true if this buffer may hold mutations for <code>row</code>.
+     * Only valid once the buffer has been sent.
+     *
+     * @param row row key
+     * @return true if the buffer might mutate the row
+     */
+    bool may_contain_row(const char *row) const;
+
   private:
+    void add_row(const char *row);
+    void sort_rows();
     void set_retries_to_fail(int error);
     int set_failed_mutations();
     typedef CommAddressMap<TableMutatorAsyncSendBufferPtr> TableMutatorAsyncSendBufferMap;
@@ -124,6 +154,8 @@ namespace Hypertable {
     bool                 m_outstanding;
     uint32_t             m_send_flags;
     uint32_t             m_wait_time;
+    std::vector<uint64_t> m_row_hashes;
+    bool                 m_rows_sorted;
     const static uint32_t ms_init_redo_wait_time=1000;
   };
 
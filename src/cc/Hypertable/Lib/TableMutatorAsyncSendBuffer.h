@@ -42,7 +42,7 @@ namespace Hypertable {
     TableMutatorAsyncSendBuffer(const TableIdentifier *tid,
         TableMutatorAsyncCompletionCounter *counterp_, RangeLocator *rl)
       : counterp(counterp_),
-        send_count(0), retry_count(0), m_table_identifier(tid),
+        send_count(0), retry_count(0), throttle_delay(0), m_table_identifier(tid),
         m_range_locator(rl) { }
 
     void add_retries(uint32_t count, uint32_t offset, uint32_t len) {
@@ -115,6 +115,8 @@ namespace Hypertable {
     std::vector<FailedRegionAsync> failed_regions;
     uint32_t send_count;
     uint32_t retry_count;
+    /* Delay (ms) requested by the RangeServer before the next update */
+    uint32_t throttle_delay;
 
   private:
     const TableIdentifier *m_table_identifier;
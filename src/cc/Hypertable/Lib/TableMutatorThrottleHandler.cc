@@ -0,0 +1,58 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "AsyncComm/ApplicationHandler.h"
+
+#include "TableMutatorThrottleHandler.h"
+#include "TableMutatorAsync.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  class DeferredSendHandler : public ApplicationHandler {
+  public:
+    DeferredSendHandler(TableMutatorAsync *mutator)
+      : ApplicationHandler(0), m_mutator(mutator) { }
+
+    virtual void run() {
+      try {
+        m_mutator->send_deferred();
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << e << HT_END;
+      }
+    }
+
+  private:
+    TableMutatorAsync *m_mutator;
+  };
+
+}
+
+
+void TableMutatorThrottleHandler::handle(EventPtr &event) {
+  m_app_queue->add(new DeferredSendHandler(m_mutator));
+}
@@ -0,0 +1,53 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_TABLEMUTATORTHROTTLEHANDLER_H
+#define HYPERTABLE_TABLEMUTATORTHROTTLEHANDLER_H
+
+#include "AsyncComm/ApplicationQueue.h"
+#include "AsyncComm/DispatchHandler.h"
+
+namespace Hypertable {
+
+  class TableMutatorAsync;
+
+  /**
+   * Timer handler for the scatter buffers that TableMutatorAsync::flush()
+   * holds back to honor the pacing requested by the RangeServers.  When
+   * the timer fires, the deferred buffers are sent from the application
+   * queue.
+   */
+  class TableMutatorThrottleHandler : public DispatchHandler {
+
+  public:
+    TableMutatorThrottleHandler(ApplicationQueuePtr &app_queue,
+                                TableMutatorAsync *mutator)
+      : m_app_queue(app_queue), m_mutator(mutator) { }
+
+    virtual void handle(EventPtr &event);
+
+  private:
+    ApplicationQueuePtr m_app_queue;
+    TableMutatorAsync *m_mutator;
+  };
+}
+
+#endif // HYPERTABLE_TABLEMUTATORTHROTTLEHANDLER_H
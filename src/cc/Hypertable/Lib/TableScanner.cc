@@ -37,15 +37,20 @@ using namespace Hypertable;
 
 TableScanner::TableScanner(Comm *comm, Table *table,
     RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
-    uint32_t timeout_ms)
+    uint32_t timeout_ms, int32_t flags, int32_t parallel_ranges)
   : m_callback(this), m_cur_cells(0), m_cur_cells_index(0), m_cur_cells_size(0),
     m_error(Error::OK),
-    m_eos(false), m_bytes_scanned(0) {
+    m_eos(false), m_bytes_scanned(0), m_cache_generation(0),
+    m_cached_index(0) {
+
+  if ((flags & Table::SCANNER_FLAG_BYPASS_ROW_CACHE) == 0 &&
+      lookup_row_cache(table, scan_spec))
+    return;
 
   m_queue = new TableScannerQueue;
   ApplicationQueuePtr app_queue = (ApplicationQueue *)m_queue.get();
   m_scanner = new TableScannerAsync(comm, app_queue, table, range_locator, scan_spec,
-                                    timeout_ms, &m_callback);
+                                    timeout_ms, &m_callback, flags, parallel_ranges);
 }
 
 
@@ -60,28 +65,105 @@ bool TableScanner::next(Cell &cell) {
   if (m_eos)
     return false;
 
+  if (m_cached_cells) {
+    if (m_cached_index < m_cached_cells->size()) {
+      m_cached_cells->get_cell(cell, m_cached_index++);
+      return true;
+    }
+    m_eos = true;
+    return false;
+  }
+
   while (true) {
 
     // serve out ready results
     if (m_cur_cells_index < m_cur_cells_size) {
       m_cur_cells->get_cell_unchecked(cell, m_cur_cells_index);
       m_cur_cells_index++;
+      if (m_fill_cells) {
+        m_fill_cells->add(cell);
+        // too large to be cached
+        if (m_fill_cells->memory_used() > m_row_cache->max_memory())
+          m_fill_cells = 0;
+      }
       return true;
     }
 
-    if (m_cur_cells != 0) {
-      m_eos = m_cur_cells->get_eos();
-      if (m_eos)
-        return false;
+    if (!load_next_result())
+      return false;
+  }
+}
+
+bool TableScanner::load_next_result() {
+
+  if (m_cur_cells != 0) {
+    m_eos = m_cur_cells->get_eos();
+    if (m_eos) {
+      if (m_fill_cells) {
+        m_row_cache->insert(m_cache_key, m_cache_row.c_str(),
+                            m_fill_cells, m_cache_generation);
+        m_fill_cells = 0;
+      }
+      return false;
     }
+  }
 
-    m_queue->next_result(m_cur_cells, &m_error, m_error_msg);
-    if (m_error != Error::OK) {
-      m_eos = true;
-      HT_THROW(m_error, m_error_msg);
+  m_queue->next_result(m_cur_cells, &m_error, m_error_msg);
+  if (m_error != Error::OK) {
+    m_eos = true;
+    HT_THROW(m_error, m_error_msg);
+  }
+  m_cur_cells_size = m_cur_cells->size();
+  m_cur_cells_index=0;
+  return true;
+}
+
+void TableScanner::set_cells_encoder(ScanCellsEncoderPtr encoder) {
+  if (m_encoder == encoder)
+    return;
+  m_encoder = encoder;
+  if (m_scanner)
+    m_scanner->set_cells_encoder(encoder);
+}
+
+bool TableScanner::next_encoded(String &buf, size_t limit) {
+  Cell cell;
+
+  HT_ASSERT(m_encoder);
+
+  while (true) {
+
+    // hand out results that were encoded as they were loaded; cells
+    // going into the row cache are taken one by one
+    if (!m_ungot.row_key && !m_cached_cells && !m_fill_cells && !m_eos) {
+      if (m_cur_cells_index == 0 && m_cur_cells_size > 0 &&
+          m_cur_cells->encoded()) {
+        String &encoded = m_cur_cells->get_encoded();
+        if (!buf.empty() && buf.size() + encoded.size() > limit)
+          return true;
+        if (buf.empty())
+          buf.swap(encoded);
+        else
+          buf.append(encoded);
+        m_cur_cells_index = m_cur_cells_size;
+        continue;
+      }
+      if (m_cur_cells_index >= m_cur_cells_size) {
+        if (!load_next_result())
+          return false;
+        continue;
+      }
+    }
+
+    if (!next(cell))
+      return false;
+    size_t mark = buf.size();
+    m_encoder->encode(buf, cell);
+    if (mark > 0 && buf.size() > limit) {
+      buf.resize(mark);
+      unget(cell);
+      return true;
     }
-    m_cur_cells_size = m_cur_cells->size();
-    m_cur_cells_index=0;
   }
 }
 
@@ -92,6 +174,45 @@ void TableScanner::unget(const Cell &cell) {
   m_ungot = cell;
 }
 
+bool TableScanner::lookup_row_cache(Table *table, const ScanSpec &scan_spec) {
+  const char *row = 0;
+
+  if (!(m_row_cache = table->row_cache()))
+    return false;
+
+  if (scan_spec.row_intervals.size() == 1) {
+    const RowInterval &ri = scan_spec.row_intervals[0];
+    if (ri.start && ri.end && ri.start_inclusive && ri.end_inclusive &&
+        !strcmp(ri.start, ri.end))
+      row = ri.start;
+  }
+  else if (scan_spec.cell_intervals.size() == 1) {
+    const CellInterval &ci = scan_spec.cell_intervals[0];
+    if (ci.start_row && ci.end_row && !strcmp(ci.start_row, ci.end_row))
+      row = ci.start_row;
+  }
+
+  if (row == 0) {
+    m_row_cache = 0;
+    return false;
+  }
+
+  m_cache_key.resize(scan_spec.encoded_length());
+  uint8_t *ptr = (uint8_t *)&m_cache_key[0];
+  scan_spec.encode(&ptr);
+  m_cache_key.resize(ptr - (uint8_t *)m_cache_key.data());
+
+  if (m_row_cache->lookup(m_cache_key, m_cached_cells))
+    return true;
+
+  // fetched before the scan starts so writes completing while it is in
+  // flight keep its result out of the cache
+  m_cache_row = row;
+  m_cache_generation = m_row_cache->generation();
+  m_fill_cells = new CellsBuilder(8);
+  return false;
+}
+
 void TableScanner::scan_ok(ScanCellsPtr &cells) {
   m_queue->add_cells(cells);
 }
@@ -28,6 +28,7 @@
 #include "TableScannerAsync.h"
 #include "TableCallback.h"
 #include "ScanCells.h"
+#include "RowCache.h"
 
 namespace Hypertable {
 
@@ -46,15 +47,20 @@ namespace Hypertable {
      * @param scan_spec reference to scan specification object
      * @param timeout_ms maximum time in milliseconds to allow scanner
      *        methods to execute before throwing an exception
+     * @param flags scanner flags (Table::SCANNER_FLAG_*)
+     * @param parallel_ranges maximum number of ranges to scan concurrently
      */
     TableScanner(Comm *comm, Table *table,  RangeLocatorPtr &range_locator,
-                 const ScanSpec &scan_spec, uint32_t timeout_ms);
+                 const ScanSpec &scan_spec, uint32_t timeout_ms,
+                 int32_t flags=0, int32_t parallel_ranges=0);
 
     /**
      * Cancel asynchronous scanner and keep dealing with RangeServer responses
      * till async scanner is done
      */
     ~TableScanner() {
+      if (!m_scanner)
+        return;
       m_scanner->cancel();
       if (!m_scanner->is_complete()) {
         ScanCellsPtr cells;
@@ -85,6 +91,28 @@ namespace Hypertable {
      */
     void unget(const Cell &cell);
 
+    /**
+     * Sets the encoder for #next_encoded.  Scan results that arrive from
+     * then on are encoded while they are loaded from their scan blocks.
+     *
+     * @param encoder cell encoder
+     */
+    void set_cells_encoder(ScanCellsEncoderPtr encoder);
+
+    /**
+     * Appends the next cells, encoded with the encoder given to
+     * #set_cells_encoder, to a buffer.  Results that were encoded while
+     * they were loaded are appended as a whole; cells already handed out
+     * by #next or read from the row cache are encoded one by one.  At
+     * least one cell is appended unless the scan is over, then results are
+     * appended as long as the buffer stays within limit.
+     *
+     * @param buf buffer receiving the encoded cells
+     * @param limit size that buf should not grow beyond
+     * @return false if the scan is over
+     */
+    bool next_encoded(String &buf, size_t limit);
+
     /**
      * Returns number of bytes scanned
      *
@@ -111,6 +139,21 @@ namespace Hypertable {
      */
     void scan_error(int error, const String &error_msg);
 
+    /**
+     * Serves the scan from the row cache of the table if it scans a
+     * single row, otherwise sets up caching of the result
+     *
+     * @return true if the result was found in the cache
+     */
+    bool lookup_row_cache(Table *table, const ScanSpec &scan_spec);
+
+    /**
+     * Waits for the next scan results once the current ones are consumed
+     *
+     * @return false if the scan is over
+     */
+    bool load_next_result();
+
     TableScannerQueuePtr m_queue;
     TableScannerAsyncPtr m_scanner;
     TableCallback m_callback;
@@ -122,6 +165,14 @@ namespace Hypertable {
     bool m_eos;
     Cell m_ungot;
     int64_t m_bytes_scanned;
+    RowCachePtr m_row_cache;
+    String m_cache_key;
+    String m_cache_row;
+    uint64_t m_cache_generation;
+    CellsBuilderPtr m_cached_cells;
+    size_t m_cached_index;
+    CellsBuilderPtr m_fill_cells;
+    ScanCellsEncoderPtr m_encoder;
   };
   typedef intrusive_ptr<TableScanner> TableScannerPtr;
 
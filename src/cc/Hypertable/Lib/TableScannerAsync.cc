@@ -20,11 +20,14 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <vector>
 
 #include "Common/Error.h"
 #include "Common/String.h"
 
+#include "AsyncComm/ApplicationHandler.h"
+
 #include "Table.h"
 #include "TableScannerAsync.h"
 
@@ -40,10 +43,16 @@ using namespace Hypertable;
  */
 TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue, Table *table,
     RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
-    uint32_t timeout_ms, ResultCallback *cb)
-  : m_bytes_scanned(0), m_cb(cb), m_current_scanner(0),
-    m_outstanding(0), m_error(Error::OK), m_table(table), m_scan_spec_builder(scan_spec),
-    m_cancelled(false) {
+    uint32_t timeout_ms, ResultCallback *cb, int32_t flags,
+    int32_t parallel_ranges)
+  : m_comm(comm), m_app_queue(app_queue), m_range_locator(range_locator),
+    m_timeout_ms(timeout_ms), m_bytes_scanned(0), m_cb(cb), m_current_scanner(0),
+    m_outstanding(0), m_error(Error::OK), m_table(table),
+    m_scan_spec_builder(scan_spec), m_cancelled(false),
+    m_unordered((flags & Table::SCANNER_FLAG_UNORDERED) != 0),
+    m_parallel(false), m_parallel_ranges(parallel_ranges),
+    m_split_interval(0), m_split_row_inclusive(true), m_split_done(false),
+    m_split_lookup_pending(false), m_split_range_found(false) {
 
   ScopedLock lock(m_mutex);
 
@@ -58,12 +67,61 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
   m_cb->increment_outstanding();
   m_cb->register_scanner(this);
 
+  // Ranges are only scanned in parallel if the result does not depend on
+  // the order in which they are read (no row or cell limits)
+  if ((flags & Table::SCANNER_FLAG_PARALLEL_RANGES) && m_parallel_ranges > 1 &&
+      scan_spec.cell_intervals.empty() && !scan_spec.scan_and_filter_rows &&
+      scan_spec.row_limit == 0 && scan_spec.cell_limit == 0) {
+    SchemaPtr schema;
+    table->get(m_table_identifier, schema);
+    m_parallel = true;
+    if (scan_spec.row_intervals.empty())
+      m_scan_spec_builder.add_row_interval("", false, Key::END_ROW_MARKER, false);
+    const RowInterval &ri = m_scan_spec_builder.get().row_intervals[0];
+    m_split_row = ri.start ? ri.start : "";
+    m_split_row_inclusive = ri.start_inclusive;
+
+    // Load the locations of the first ranges the intervals are split on
+    // with one METADATA scan per interval whose start is not cached yet.
+    // Only enough locations for a few rounds of parallel scanners are
+    // fetched, the rest (and any that failed) are located on demand.
+    LocationCachePtr loc_cache = m_range_locator->location_cache();
+    size_t prefetch_budget = 4 * (size_t)m_parallel_ranges;
+    foreach (const RowInterval &interval,
+             m_scan_spec_builder.get().row_intervals) {
+      RangeLocationInfo loc_info;
+      if (prefetch_budget == 0)
+        break;
+      if (loc_cache->lookup(m_table_identifier.id,
+                            interval.start ? interval.start : "",
+                            &loc_info, true))
+        continue;
+      Timer prefetch_timer(timeout_ms, true);
+      size_t nranges = 0;
+      int error;
+      try {
+        error = m_range_locator->prefetch(&m_table_identifier, interval.start,
+                                          interval.end, prefetch_timer,
+                                          prefetch_budget, &nranges);
+      }
+      catch (Exception &e) {
+        error = e.code();
+      }
+      if (error != Error::OK)
+        HT_WARNF("Problem prefetching range locations for table %s - %s",
+                 m_table_identifier.id, Error::get_text(error));
+      prefetch_budget -= std::min(nranges, prefetch_budget);
+    }
+  }
+
   try {
-    if (scan_spec.row_intervals.empty()) {
+    if (m_parallel)
+      add_parallel_scanners();
+    else if (scan_spec.row_intervals.empty()) {
       if (scan_spec.cell_intervals.empty()) {
         ri_scanner = 0;
         ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator, scan_spec,
-                                              timeout_ms, !current_set, this, scanner_id++);
+                                              timeout_ms, m_unordered || !current_set, this, scanner_id++);
 
         current_set = true;
         m_interval_scanners.push_back(ri_scanner);
@@ -77,7 +135,8 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
           ri_scanner = 0;
           ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator,
                                                 interval_scan_spec, timeout_ms,
-                                                !current_set, this, scanner_id++);
+                                                m_unordered || !current_set, this,
+                                                scanner_id++);
           current_set = true;
           m_interval_scanners.push_back(ri_scanner);
           m_outstanding++;
@@ -94,8 +153,9 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
           interval_scan_spec.row_intervals.push_back(ri);
           ri_scanner = 0;
           ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator,
-                                                interval_scan_spec, timeout_ms, !current_set,
-                                                this, scanner_id++);
+                                                interval_scan_spec, timeout_ms,
+                                                m_unordered || !current_set, this,
+                                                scanner_id++);
           current_set = true;
           m_interval_scanners.push_back(ri_scanner);
           m_outstanding++;
@@ -106,7 +166,8 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
       if (rowset_scan_spec.row_intervals.size()) {
        ri_scanner = 0;
        ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator,
-                                             rowset_scan_spec, timeout_ms, !current_set,
+                                             rowset_scan_spec, timeout_ms,
+                                             m_unordered || !current_set,
             this, scanner_id++);
         current_set = true;
         m_interval_scanners.push_back(ri_scanner);
@@ -119,7 +180,8 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
         interval_scan_spec.row_intervals.push_back(scan_spec.row_intervals[i]);
         ri_scanner = 0;
         ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator,
-                                              interval_scan_spec, timeout_ms, !current_set,
+                                              interval_scan_spec, timeout_ms,
+                                              m_unordered || !current_set,
                                               this, scanner_id++);
         current_set = true;
         m_interval_scanners.push_back(ri_scanner);
@@ -134,9 +196,9 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
       m_interval_scanners.push_back(ri_scanner);
       m_outstanding++;
     }
-    if (m_outstanding == 0)
-      maybe_callback_error(0, false);
   }
+  if (m_error != Error::OK && m_outstanding == 0)
+    maybe_callback_error(0, false);
 }
 
 TableScannerAsync::~TableScannerAsync() {
@@ -206,7 +268,7 @@ void TableScannerAsync::handle_error(int scanner_id, int error, const String &er
   // if we've seen an error before then don't bother with callback
   if (m_error != Error::OK || cancelled) {
     maybe_callback_error(scanner_id, next);
-    if (next && scanner_id == m_current_scanner)
+    if (next && !m_unordered && scanner_id == m_current_scanner)
       move_to_next_interval_scanner(scanner_id, cancelled);
     return;
   }
@@ -216,10 +278,10 @@ void TableScannerAsync::handle_error(int scanner_id, int error, const String &er
     m_error_msg = error_msg;
     HT_ERROR_OUT << e << HT_END;
     maybe_callback_error(scanner_id, next);
-    if (next && scanner_id == m_current_scanner)
+    if (next && !m_unordered && scanner_id == m_current_scanner)
       move_to_next_interval_scanner(scanner_id, cancelled);
   }
-  else if (next && scanner_id == m_current_scanner) {
+  else if (next && !m_unordered && scanner_id == m_current_scanner) {
     move_to_next_interval_scanner(scanner_id, cancelled);
   }
 }
@@ -240,7 +302,7 @@ void TableScannerAsync::handle_timeout(int scanner_id, const String &error_msg,
                << " - " << error_msg << HT_END;
   m_error = Error::REQUEST_TIMEOUT;
   maybe_callback_error(scanner_id, next);
-  if (next && scanner_id == m_current_scanner)
+  if (next && !m_unordered && scanner_id == m_current_scanner)
     move_to_next_interval_scanner(scanner_id, cancelled);
 
 }
@@ -282,7 +344,7 @@ void TableScannerAsync::handle_result(int scanner_id, EventPtr &event, bool is_c
       maybe_callback_ok(scanner_id, next, do_callback, cells);
     }
 
-    if (next)
+    if (next && !m_unordered)
       move_to_next_interval_scanner(current_scanner, cancelled);
   }
   catch (Exception &e) {
@@ -324,6 +386,9 @@ void TableScannerAsync::maybe_callback_ok(int scanner_id, bool next, bool do_cal
     HT_ASSERT(m_outstanding>0 && m_interval_scanners[scanner_id] != 0);
     m_outstanding--;
     m_interval_scanners[scanner_id] = 0;
+    // replace the finished range with the next one in the split
+    if (m_parallel)
+      add_parallel_scanners();
   }
 
   if (m_outstanding == 0) {
@@ -331,13 +396,16 @@ void TableScannerAsync::maybe_callback_ok(int scanner_id, bool next, bool do_cal
   }
 
   if (do_callback) {
-    if (eos)
+    // a failed split lookup is reported via scan_error below
+    if (eos && m_error == Error::OK)
       cells->set_eos();
     HT_ASSERT(cells != 0);
     m_cb->scan_ok(this, cells);
   }
 
   if (m_outstanding==0) {
+    if (m_error != Error::OK)
+      m_cb->scan_error(this, m_error, m_error_msg, true);
     m_cb->deregister_scanner(this);
     m_cb->decrement_outstanding();
     m_cond.notify_all();
@@ -384,3 +452,179 @@ void TableScannerAsync::move_to_next_interval_scanner(int current_scanner, bool
   }
 }
 
+
+namespace {
+
+  /**
+   * Looks up the range that the next split interval starts in, off the
+   * scanner mutex, and resumes adding interval scanners
+   */
+  class SplitLookupHandler : public ApplicationHandler {
+  public:
+    SplitLookupHandler(TableScannerAsync *scanner) : m_scanner(scanner) { }
+    virtual void run() { m_scanner->handle_split_lookup(); }
+  private:
+    TableScannerAsync *m_scanner;
+  };
+
+}
+
+
+void TableScannerAsync::add_parallel_scanners() {
+  IntervalScannerAsyncPtr ri_scanner;
+  ScanSpec interval_scan_spec;
+  String start_row, end_row;
+  bool start_inclusive, end_inclusive;
+
+  // caller has locked mutex
+  try {
+    while (m_outstanding < m_parallel_ranges && !m_split_done &&
+           !m_split_lookup_pending && m_error == Error::OK &&
+           !is_cancelled()) {
+      if (!next_split_interval(start_row, &start_inclusive, end_row,
+                               &end_inclusive)) {
+        // the lookup counts as outstanding so the scan doesn't complete
+        // while it is in progress
+        m_split_lookup_pending = true;
+        m_outstanding++;
+        m_app_queue->add(new SplitLookupHandler(this));
+        break;
+      }
+      m_scan_spec_builder.get().base_copy(interval_scan_spec);
+      interval_scan_spec.row_intervals.push_back(RowInterval(start_row.c_str(),
+          start_inclusive, end_row.c_str(), end_inclusive));
+      // in ordered mode the scanners following the current one only
+      // buffer their first block until move_to_next_interval_scanner()
+      // gets to them
+      ri_scanner = new IntervalScannerAsync(m_comm, m_app_queue, m_table,
+          m_range_locator, interval_scan_spec, m_timeout_ms,
+          m_unordered || m_interval_scanners.empty(), this,
+          m_interval_scanners.size());
+      m_interval_scanners.push_back(ri_scanner);
+      m_outstanding++;
+    }
+  }
+  catch (Exception &e) {
+    // Scanners already added run to completion and report the error;
+    // if there are none, the caller delivers it once m_outstanding is 0
+    HT_ERROR_OUT << e << HT_END;
+    m_error = e.code();
+    m_error_msg = e.what();
+    m_split_done = true;
+  }
+}
+
+
+void TableScannerAsync::handle_split_lookup() {
+  String lookup_row;
+  RangeLocationInfo range_info;
+  int error = Error::OK;
+  String error_msg;
+
+  {
+    ScopedLock lock(m_mutex);
+    lookup_row = m_split_row;
+    if (!m_split_row_inclusive)
+      lookup_row.append(1, 1);
+  }
+
+  if (!is_cancelled()) {
+    try {
+      Timer timer(m_timeout_ms, true);
+      m_range_locator->find_loop(&m_table_identifier, lookup_row.c_str(),
+                                 &range_info, timer, false);
+    }
+    catch (Exception &e) {
+      error = e.code();
+      error_msg = e.what();
+    }
+  }
+
+  bool cancelled = is_cancelled();
+  ScopedLock lock(m_mutex);
+
+  HT_ASSERT(m_split_lookup_pending && m_outstanding > 0);
+  m_split_lookup_pending = false;
+  m_outstanding--;
+
+  if (error != Error::OK && m_error == Error::OK) {
+    HT_ERROR_OUT << "Problem locating range of row '" << lookup_row
+                 << "' - " << error_msg << HT_END;
+    m_error = error;
+    m_error_msg = error_msg;
+    m_split_done = true;
+  }
+  else if (error == Error::OK && !cancelled) {
+    m_split_range = range_info;
+    m_split_range_found = true;
+  }
+
+  size_t count = m_interval_scanners.size();
+  add_parallel_scanners();
+
+  // In ordered mode the scanner after a finished current one becomes
+  // current; it may have been added just now
+  if (!m_unordered && count > 0 && m_interval_scanners.size() > count &&
+      m_interval_scanners[m_current_scanner] == 0)
+    move_to_next_interval_scanner(m_current_scanner, cancelled);
+
+  if (m_outstanding == 0) {
+    if (m_error != Error::OK)
+      m_cb->scan_error(this, m_error, m_error_msg, true);
+    else {
+      ScanCellsPtr cells = new ScanCells;
+      cells->set_eos();
+      m_cb->scan_ok(this, cells);
+    }
+    m_cb->deregister_scanner(this);
+    m_cb->decrement_outstanding();
+    m_cond.notify_all();
+  }
+}
+
+
+bool TableScannerAsync::next_split_interval(String &start_row,
+    bool *start_inclusive, String &end_row, bool *end_inclusive) {
+  RowIntervals &intervals = m_scan_spec_builder.get().row_intervals;
+  const RowInterval &ri = intervals[m_split_interval];
+  const char *interval_end = (ri.end == 0 || ri.end[0] == 0)
+    ? Key::END_ROW_MARKER : ri.end;
+  RangeLocationInfo range_info;
+  String lookup_row = m_split_row;
+
+  if (!m_split_row_inclusive)
+    lookup_row.append(1, 1);
+
+  // On a location cache miss the range is looked up by a
+  // SplitLookupHandler, which leaves the result in m_split_range
+  if (m_split_range_found) {
+    range_info = m_split_range;
+    m_split_range_found = false;
+  }
+  else if (!m_range_locator->location_cache()->lookup(m_table_identifier.id,
+               lookup_row.c_str(), &range_info))
+    return false;
+
+  start_row = m_split_row;
+  *start_inclusive = m_split_row_inclusive;
+
+  // interval continues past this range, resume at the range end row
+  if (strcmp(range_info.end_row.c_str(), interval_end) < 0) {
+    end_row = range_info.end_row;
+    *end_inclusive = true;
+    m_split_row = range_info.end_row;
+    m_split_row_inclusive = false;
+    return true;
+  }
+
+  end_row = interval_end;
+  *end_inclusive = ri.end_inclusive;
+  if (++m_split_interval < intervals.size()) {
+    const RowInterval &next = intervals[m_split_interval];
+    m_split_row = next.start ? next.start : "";
+    m_split_row_inclusive = next.start_inclusive;
+  }
+  else
+    m_split_done = true;
+  return true;
+}
@@ -53,11 +53,15 @@ namespace Hypertable {
      * @param timeout_ms maximum time in milliseconds to allow scanner
      *        methods to execute before throwing an exception
      * @param cb callback to be notified when results arrive
+     * @param flags scanner flags (Table::SCANNER_FLAG_*)
+     * @param parallel_ranges maximum number of ranges to scan concurrently
+     *        if Table::SCANNER_FLAG_PARALLEL_RANGES is set
      */
     TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue, Table *table,
                       RangeLocatorPtr &range_locator,
                       const ScanSpec &scan_spec, uint32_t timeout_ms,
-                      ResultCallback *cb);
+                      ResultCallback *cb, int32_t flags=0,
+                      int32_t parallel_ranges=0);
 
     ~TableScannerAsync();
 
@@ -125,12 +129,50 @@ namespace Hypertable {
      * Returns scanspec for this scanner
      */
     const ScanSpec &get_scan_spec() { return m_scan_spec_builder.get(); }
+
+    /**
+     * Returns true if row intervals are split at range boundaries and the
+     * ranges are scanned concurrently (Table::SCANNER_FLAG_PARALLEL_RANGES)
+     */
+    bool is_range_parallel() const { return m_parallel; }
+
+    /**
+     * Sets the encoder that results loaded from now on are encoded with,
+     * see ScanCellsEncoder
+     *
+     * @param encoder cell encoder
+     */
+    void set_cells_encoder(ScanCellsEncoderPtr &encoder) {
+      ScopedLock lock(m_mutex);
+      m_encoder = encoder;
+    }
+
+    /**
+     * Returns the cell encoder, or 0 if none is set.  Called by the
+     * interval scanners while they hold the scanner mutex.
+     */
+    ScanCellsEncoder *get_cells_encoder() { return m_encoder.get(); }
+
+    /**
+     * Looks up the location of the range that the next split interval
+     * starts in (range-parallel mode, location cache miss) and continues
+     * adding interval scanners.  Runs from the application queue so that
+     * the METADATA lookup doesn't hold the scanner mutex.
+     */
+    void handle_split_lookup();
+
   private:
     void maybe_callback_ok(int scanner_id, bool next, bool do_callback, ScanCellsPtr &cells);
     void maybe_callback_error(int scanner_id, bool next);
     void wait_for_completion();
     void move_to_next_interval_scanner(int current_scanner, bool cancelled);
+    void add_parallel_scanners();
+    bool next_split_interval(String &start_row, bool *start_inclusive,
+                             String &end_row, bool *end_inclusive);
 
+    Comm               *m_comm;
+    ApplicationQueuePtr m_app_queue;
+    RangeLocatorPtr     m_range_locator;
     std::vector<IntervalScannerAsyncPtr>  m_interval_scanners;
     uint32_t            m_timeout_ms;
     int64_t             m_bytes_scanned;
@@ -147,7 +189,22 @@ namespace Hypertable {
     String              m_table_name;
     Table              *m_table;
     ScanSpecBuilder     m_scan_spec_builder;
+    ScanCellsEncoderPtr m_encoder;
     bool                m_cancelled;
+    bool                m_unordered;
+
+    // Range-parallel mode: row intervals are split at range boundaries
+    // and scanned by up to m_parallel_ranges interval scanners at a time
+    bool                m_parallel;
+    int32_t             m_parallel_ranges;
+    TableIdentifierManaged m_table_identifier;
+    size_t              m_split_interval;
+    String              m_split_row;
+    bool                m_split_row_inclusive;
+    bool                m_split_done;
+    bool                m_split_lookup_pending;
+    bool                m_split_range_found;
+    RangeLocationInfo   m_split_range;
   };
 
   typedef intrusive_ptr<TableScannerAsync> TableScannerAsyncPtr;
@@ -0,0 +1,168 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "BlockCompressionCodecAdaptive.h"
+#include "BlockCompressionHeader.h"
+#include "CompressorFactory.h"
+#include "WireCompressor.h"
+
+using namespace Hypertable;
+
+namespace {
+  const char WIRE_MAGIC[11] = "WireBlock-";
+}
+
+Mutex WireCompressor::ms_mutex;
+WireCompressor *WireCompressor::ms_client = 0;
+
+
+WireCompressor::WireCompressor(const String &codec_spec,
+                               size_t min_payload_size)
+  : m_min_payload_size(min_payload_size) {
+  m_type = CompressorFactory::parse_block_codec_spec(codec_spec, m_args);
+}
+
+
+WireCompressor::~WireCompressor() {
+  foreach (BlockCompressionCodec *codec, m_codecs)
+    delete codec;
+}
+
+
+BlockCompressionCodec *WireCompressor::checkout_codec() {
+  {
+    ScopedLock lock(m_mutex);
+    if (!m_codecs.empty()) {
+      BlockCompressionCodec *codec = m_codecs.back();
+      m_codecs.pop_back();
+      return codec;
+    }
+  }
+  return new BlockCompressionCodecAdaptive(m_type, m_args);
+}
+
+
+void WireCompressor::checkin_codec(BlockCompressionCodec *codec) {
+  ScopedLock lock(m_mutex);
+  m_codecs.push_back(codec);
+}
+
+
+bool WireCompressor::deflate(const uint8_t *data, size_t len,
+                             DynamicBuffer &output) {
+  bool compressed = false;
+
+  if (enabled() && len >= m_min_payload_size) {
+    BlockCompressionHeader header(WIRE_MAGIC);
+    DynamicBuffer input(0, false);
+    BlockCompressionCodec *codec = checkout_codec();
+
+    input.base = (uint8_t *)data;
+    input.ptr = input.base + len;
+    input.size = len;
+
+    try {
+      codec->deflate(input, output, header);
+      compressed = header.get_compression_type() != BlockCompressionCodec::NONE;
+    }
+    catch (Exception &e) {
+      HT_WARN_OUT << "Problem compressing payload - " << e << HT_END;
+    }
+    checkin_codec(codec);
+  }
+
+  ScopedLock lock(m_mutex);
+  m_stats.sent_raw_bytes += len;
+  m_stats.sent_wire_bytes += compressed ? output.fill() : len;
+  return compressed;
+}
+
+
+void WireCompressor::inflate(const uint8_t *data, size_t len,
+                             DynamicBuffer &output) {
+  BlockCompressionHeader header;
+  DynamicBuffer input(0, false);
+  BlockCompressionCodec *codec = checkout_codec();
+
+  input.base = (uint8_t *)data;
+  input.ptr = input.base + len;
+  input.size = len;
+
+  try {
+    codec->inflate(input, output, header);
+  }
+  catch (Exception &e) {
+    checkin_codec(codec);
+    HT_THROW2(e.code(), e, "Problem inflating wire payload");
+  }
+  checkin_codec(codec);
+
+  if (!header.check_magic(WIRE_MAGIC))
+    HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC, "Bad wire payload magic");
+
+  ScopedLock lock(m_mutex);
+  m_stats.received_raw_bytes += output.fill();
+  m_stats.received_wire_bytes += len;
+}
+
+
+bool WireCompressor::deflate_scan_block(const StaticBuffer &ext,
+                                        StaticBuffer &output) {
+  DynamicBuffer zbuf;
+
+  if (ext.size < 4 || !deflate(ext.base + 4, ext.size - 4, zbuf))
+    return false;
+
+  uint8_t *buf = new uint8_t [ zbuf.fill() + 4 ];
+  uint8_t *ptr = buf;
+  Serialization::encode_i32(&ptr, zbuf.fill());
+  memcpy(ptr, zbuf.base, zbuf.fill());
+  output.set(buf, zbuf.fill() + 4, true);
+  return true;
+}
+
+
+void WireCompressor::get_stats(Stats &stats) {
+  ScopedLock lock(m_mutex);
+  stats = m_stats;
+}
+
+
+WireCompressor *WireCompressor::client() {
+  ScopedLock lock(ms_mutex);
+  if (ms_client == 0) {
+    String codec = "none";
+    size_t min_payload_size = 0;
+    if (Config::properties) {
+      codec = Config::properties->get_str("Hypertable.Client.WireCompression");
+      min_payload_size = Config::properties->get_i32(
+          "Hypertable.WireCompression.MinPayloadSize");
+    }
+    ms_client = new WireCompressor(codec, min_payload_size);
+  }
+  return ms_client;
+}
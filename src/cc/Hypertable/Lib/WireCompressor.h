@@ -0,0 +1,129 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_WIRECOMPRESSOR_H
+#define HYPERTABLE_WIRECOMPRESSOR_H
+
+#include <vector>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/StaticBuffer.h"
+#include "Common/String.h"
+
+#include "BlockCompressionCodec.h"
+
+namespace Hypertable {
+
+  /**
+   * Compresses update and scan payloads exchanged between clients and
+   * RangeServers.  A compressed payload is a BlockCompressionHeader followed
+   * by the compressed data and is flagged with
+   * CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED.  Clients ask for compressed
+   * scan results by setting CommHeader::FLAGS_BIT_ACCEPT_COMPRESSION on
+   * CREATE_SCANNER and FETCH_SCANBLOCK requests, so servers only ever send
+   * them to clients that can decode them.  Safe to use from multiple
+   * threads.
+   */
+  class WireCompressor : public ReferenceCount {
+  public:
+
+    /** Byte counts of payloads going through this compressor.  Raw bytes
+     * are payload bytes before compression, wire bytes are the bytes that
+     * were actually sent or received for them.
+     */
+    struct Stats {
+      Stats() : sent_raw_bytes(0), sent_wire_bytes(0),
+                received_raw_bytes(0), received_wire_bytes(0) { }
+      uint64_t sent_raw_bytes;
+      uint64_t sent_wire_bytes;
+      uint64_t received_raw_bytes;
+      uint64_t received_wire_bytes;
+    };
+
+    /**
+     * @param codec_spec codec used for outgoing payloads, "none" disables
+     *        compression
+     * @param min_payload_size payloads smaller than this are sent raw
+     */
+    WireCompressor(const String &codec_spec, size_t min_payload_size);
+    ~WireCompressor();
+
+    bool enabled() const { return m_type != BlockCompressionCodec::NONE; }
+
+    /** Compresses a payload.  Returns false if compression is disabled,
+     * the payload is smaller than the minimum payload size or it does not
+     * compress, in which case the payload should be sent raw.
+     *
+     * @param data payload
+     * @param len length of payload
+     * @param output receives header and compressed payload
+     * @return true if the payload was compressed
+     */
+    bool deflate(const uint8_t *data, size_t len, DynamicBuffer &output);
+
+    /** Decompresses a payload created by #deflate with any codec.
+     *
+     * @param data compressed payload
+     * @param len length of compressed payload
+     * @param output receives the decompressed payload
+     */
+    void inflate(const uint8_t *data, size_t len, DynamicBuffer &output);
+
+    /** Compresses a scan block response buffer, which holds a 32-bit
+     * length followed by that many bytes of key/value pairs.  The output
+     * has the same layout with the key/value pairs compressed.
+     *
+     * @param ext scan block buffer
+     * @param output receives the compressed scan block
+     * @return true if the scan block was compressed
+     */
+    bool deflate_scan_block(const StaticBuffer &ext, StaticBuffer &output);
+
+    void get_stats(Stats &stats);
+
+    /** Returns the compressor used by clients of this process, configured
+     * with Hypertable.Client.WireCompression.  Its stats count the update
+     * payloads sent and the scan blocks received by this process.
+     */
+    static WireCompressor *client();
+
+  private:
+    BlockCompressionCodec *checkout_codec();
+    void checkin_codec(BlockCompressionCodec *codec);
+
+    Mutex m_mutex;
+    BlockCompressionCodec::Type m_type;
+    BlockCompressionCodec::Args m_args;
+    size_t m_min_payload_size;
+    std::vector<BlockCompressionCodec *> m_codecs;
+    Stats m_stats;
+
+    static Mutex ms_mutex;
+    static WireCompressor *ms_client;
+  };
+
+  typedef intrusive_ptr<WireCompressor> WireCompressorPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_WIRECOMPRESSOR_H
@@ -0,0 +1,335 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "lz4.h"
+
+namespace {
+
+  const size_t MINMATCH = 4;
+  const size_t LASTLITERALS = 5;
+  const size_t MFLIMIT = 12;
+  const size_t MAX_DISTANCE = 65535;
+  const size_t ML_MASK = 15;
+  const size_t RUN_MASK = 15;
+  const int SKIP_SHIFT = 6;
+
+  inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  inline uint32_t hash(uint32_t sequence, int log) {
+    return (sequence * 2654435761U) >> (32 - log);
+  }
+
+  // Number of matching bytes at a and b, a is not advanced past limit
+  inline size_t match_length(const uint8_t *a, const uint8_t *b,
+                             const uint8_t *limit) {
+    const uint8_t *start = a;
+    while (a + 8 <= limit && read64(a) == read64(b)) {
+      a += 8;
+      b += 8;
+    }
+    while (a < limit && *a == *b) {
+      a++;
+      b++;
+    }
+    return a - start;
+  }
+
+  inline uint8_t *write_length(uint8_t *op, size_t len) {
+    while (len >= 255) {
+      *op++ = 255;
+      len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+  }
+
+  inline uint8_t *write_literals(uint8_t *op, uint8_t *token,
+                                 const uint8_t *literals, size_t len) {
+    if (len >= RUN_MASK) {
+      *token = (uint8_t)(RUN_MASK << 4);
+      op = write_length(op, len - RUN_MASK);
+    }
+    else
+      *token = (uint8_t)(len << 4);
+    memcpy(op, literals, len);
+    return op + len;
+  }
+
+  inline uint8_t *emit_sequence(uint8_t *op, const uint8_t *literals,
+                                size_t literal_len, size_t offset,
+                                size_t match_len) {
+    uint8_t *token = op++;
+    size_t ml = match_len - MINMATCH;
+
+    op = write_literals(op, token, literals, literal_len);
+    *op++ = (uint8_t)(offset & 0xff);
+    *op++ = (uint8_t)(offset >> 8);
+    if (ml >= ML_MASK) {
+      *token |= (uint8_t)ML_MASK;
+      op = write_length(op, ml - ML_MASK);
+    }
+    else
+      *token |= (uint8_t)ml;
+    return op;
+  }
+
+  inline uint8_t *emit_last_literals(uint8_t *op, const uint8_t *literals,
+                                     size_t len) {
+    uint8_t *token = op++;
+    return write_literals(op, token, literals, len);
+  }
+
+  inline void hc_insert(lz4hc_state *state, const uint8_t *src, size_t pos) {
+    uint32_t h = hash(read32(src + pos), LZ4HC_HASH_LOG);
+    int32_t prev = state->head[h];
+    size_t delta = (prev < 0) ? 0 : pos - (size_t)prev;
+    state->chain[pos & (LZ4HC_WINDOW - 1)] =
+      (delta > MAX_DISTANCE) ? 0 : (uint16_t)delta;
+    state->head[h] = (int32_t)pos;
+  }
+
+  size_t hc_find(lz4hc_state *state, const uint8_t *src, size_t pos,
+                 const uint8_t *matchlimit, int attempts, size_t *ref_pos) {
+    const uint8_t *ip = src + pos;
+    uint32_t sequence = read32(ip);
+    int64_t candidate = state->head[hash(sequence, LZ4HC_HASH_LOG)];
+    size_t best = 0;
+
+    while (candidate >= 0 && attempts-- > 0) {
+      if (pos - (size_t)candidate > MAX_DISTANCE)
+        break;
+      const uint8_t *ref = src + candidate;
+      if (ref[best] == ip[best] && read32(ref) == sequence) {
+        size_t ml = MINMATCH + match_length(ip + MINMATCH, ref + MINMATCH,
+                                            matchlimit);
+        if (ml > best) {
+          best = ml;
+          *ref_pos = (size_t)candidate;
+          if (ip + best == matchlimit)
+            break;
+        }
+      }
+      uint16_t delta = state->chain[candidate & (LZ4HC_WINDOW - 1)];
+      if (delta == 0)
+        break;
+      candidate -= delta;
+    }
+    return best;
+  }
+
+}
+
+
+size_t lz4_compress_bound(size_t len) {
+  return len + (len / 255) + 16;
+}
+
+
+size_t lz4_compress(lz4_state *state, const uint8_t *src, size_t len,
+                    uint8_t *dst) {
+  const uint8_t *ip = src;
+  const uint8_t *anchor = src;
+  const uint8_t *iend = src + len;
+  uint8_t *op = dst;
+
+  if (len > MFLIMIT) {
+    const uint8_t *mflimit = iend - MFLIMIT;
+    const uint8_t *matchlimit = iend - LASTLITERALS;
+    const uint8_t *ref;
+    uint32_t h;
+
+    memset(state->table, 0, sizeof(state->table));
+
+    ip++;
+    while (ip < mflimit) {
+      h = hash(read32(ip), LZ4_HASH_LOG);
+      ref = src + state->table[h];
+      state->table[h] = (uint32_t)(ip - src);
+
+      if ((size_t)(ip - ref) > MAX_DISTANCE || read32(ref) != read32(ip)) {
+        // step faster through data that does not compress
+        ip += 1 + ((ip - anchor) >> SKIP_SHIFT);
+        continue;
+      }
+
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+
+      size_t ml = MINMATCH + match_length(ip + MINMATCH, ref + MINMATCH,
+                                          matchlimit);
+      op = emit_sequence(op, anchor, ip - anchor, ip - ref, ml);
+      ip += ml;
+      anchor = ip;
+
+      if (ip < mflimit)
+        state->table[hash(read32(ip - 2), LZ4_HASH_LOG)] =
+          (uint32_t)(ip - 2 - src);
+    }
+  }
+
+  op = emit_last_literals(op, anchor, iend - anchor);
+  return op - dst;
+}
+
+
+size_t lz4_compress_hc(lz4hc_state *state, const uint8_t *src, size_t len,
+                       uint8_t *dst, int level) {
+  const uint8_t *ip = src;
+  const uint8_t *anchor = src;
+  const uint8_t *iend = src + len;
+  uint8_t *op = dst;
+
+  if (level < 1)
+    level = 1;
+  else if (level > LZ4HC_MAX_LEVEL)
+    level = LZ4HC_MAX_LEVEL;
+
+  if (len > MFLIMIT) {
+    const uint8_t *mflimit = iend - MFLIMIT;
+    const uint8_t *matchlimit = iend - LASTLITERALS;
+    int attempts = 1 << (level - 1);
+    size_t next_insert = 0;
+    size_t pos, ref_pos = 0, ref_pos2 = 0;
+    size_t ml, ml2;
+
+    memset(state->head, 0xff, sizeof(state->head));
+
+    while (ip < mflimit) {
+      pos = ip - src;
+      while (next_insert < pos)
+        hc_insert(state, src, next_insert++);
+
+      ml = hc_find(state, src, pos, matchlimit, attempts, &ref_pos);
+      hc_insert(state, src, next_insert++);
+
+      if (ml < MINMATCH) {
+        ip++;
+        continue;
+      }
+
+      // Lazy evaluation: prefer a longer match starting one byte later
+      if (ip + 1 < mflimit && ip + ml < matchlimit) {
+        ml2 = hc_find(state, src, pos + 1, matchlimit, attempts, &ref_pos2);
+        if (ml2 > ml + 1) {
+          hc_insert(state, src, next_insert++);
+          ip++;
+          pos++;
+          ml = ml2;
+          ref_pos = ref_pos2;
+        }
+      }
+
+      op = emit_sequence(op, anchor, ip - anchor, pos - ref_pos, ml);
+      ip += ml;
+      anchor = ip;
+    }
+  }
+
+  op = emit_last_literals(op, anchor, iend - anchor);
+  return op - dst;
+}
+
+
+int64_t lz4_decompress(const uint8_t *src, size_t zlen, uint8_t *dst,
+                       size_t len) {
+  const uint8_t *ip = src;
+  const uint8_t *iend = src + zlen;
+  uint8_t *op = dst;
+  uint8_t *oend = dst + len;
+  const uint8_t *ref;
+  size_t literal_len, ml, offset;
+  unsigned token, s;
+
+  while (ip < iend) {
+    token = *ip++;
+
+    literal_len = token >> 4;
+    if (literal_len == RUN_MASK) {
+      do {
+        if (ip >= iend)
+          return -1;
+        s = *ip++;
+        literal_len += s;
+      } while (s == 255);
+    }
+    if (literal_len > (size_t)(iend - ip) || literal_len > (size_t)(oend - op))
+      return -1;
+    memcpy(op, ip, literal_len);
+    op += literal_len;
+    ip += literal_len;
+
+    // last sequence has no match
+    if (ip == iend)
+      break;
+
+    if (iend - ip < 2)
+      return -1;
+    offset = ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - dst))
+      return -1;
+
+    ml = token & ML_MASK;
+    if (ml == ML_MASK) {
+      do {
+        if (ip >= iend)
+          return -1;
+        s = *ip++;
+        ml += s;
+      } while (s == 255);
+    }
+    ml += MINMATCH;
+    if (ml > (size_t)(oend - op))
+      return -1;
+
+    ref = op - offset;
+    uint8_t *mend = op + ml;
+    if (offset >= 8 && mend + 8 <= oend) {
+      // 8 byte copies may overrun mend, which is rewritten later
+      while (op < mend) {
+        memcpy(op, ref, 8);
+        op += 8;
+        ref += 8;
+      }
+      op = mend;
+    }
+    else {
+      while (op < mend)
+        *op++ = *ref++;
+    }
+  }
+
+  return op - dst;
+}
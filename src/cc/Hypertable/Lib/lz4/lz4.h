@@ -0,0 +1,74 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_LZ4_H
+#define HYPERTABLE_LZ4_H
+
+// Byte oriented LZ77 compressor producing the LZ4 block format:
+//
+//   sequence := token [literal length bytes] literals
+//               offset(2 bytes, LE) [match length bytes]
+//
+// The high nibble of the token is the literal length and the low nibble
+// is the match length minus 4; a nibble of 15 is continued by bytes that
+// are added until one is less than 255.  The last sequence carries only
+// literals, the last 5 bytes of input are always literals and the last
+// match starts at least 12 bytes before the end of the input.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LZ4_HASH_LOG 14
+#define LZ4HC_HASH_LOG 15
+#define LZ4HC_WINDOW 65536
+#define LZ4HC_DEFAULT_LEVEL 9
+#define LZ4HC_MAX_LEVEL 12
+
+typedef struct {
+  uint32_t table[1 << LZ4_HASH_LOG];
+} lz4_state;
+
+typedef struct {
+  int32_t head[1 << LZ4HC_HASH_LOG];
+  uint16_t chain[LZ4HC_WINDOW];
+} lz4hc_state;
+
+// Maximum compressed size of len bytes of input
+size_t lz4_compress_bound(size_t len);
+
+// Fast single probe compression.  dst must hold lz4_compress_bound(len)
+// bytes.  Returns the compressed length.
+size_t lz4_compress(lz4_state *state, const uint8_t *src, size_t len,
+                    uint8_t *dst);
+
+// Hash chain compression; level (1..LZ4HC_MAX_LEVEL) bounds the number of
+// chain entries searched per position.  Output is decoded by
+// lz4_decompress().
+size_t lz4_compress_hc(lz4hc_state *state, const uint8_t *src, size_t len,
+                       uint8_t *dst, int level);
+
+// Decompresses zlen bytes of src into exactly len bytes of dst.  Never
+// reads or writes out of bounds.  Returns the number of bytes written or
+// -1 if the input is malformed.
+int64_t lz4_decompress(const uint8_t *src, size_t zlen, uint8_t *dst,
+                       size_t len);
+
+#endif // HYPERTABLE_LZ4_H
@@ -20,35 +20,197 @@
  */
 
 #include "Common/Compat.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Common/ByteString.h"
 #include "Common/DynamicBuffer.h"
 #include "Common/FileUtils.h"
 #include "Common/Logger.h"
+#include "Common/Stopwatch.h"
 #include "Common/System.h"
 #include "Common/Usage.h"
 
 #include "Hypertable/Lib/CompressorFactory.h"
 #include "Hypertable/Lib/BlockCompressionHeaderCommitLog.h"
+#include "Hypertable/Lib/Key.h"
 #include "Hypertable/Lib/Types.h"
 
 using namespace Hypertable;
 
 namespace {
+  const char MAGIC[12] = { '-','-','-','-','-','-','-','-','-','-','-','-' };
+
   const char *usage[] = {
     "usage: compressor_test <type>",
+    "       compressor_test --benchmark [--block-size=<n>] [--iterations=<n>]",
+    "                       [<file> ...]",
     "",
     "Validates a block compressor.  The type of compressor to validate",
     "is specified by the <type> argument which can be one of:",
     "",
     "none",
+    "bmz",
     "zlib",
     "lzo",
+    "lz4",
+    "lz4hc",
     "quicklz",
     "",
+    "With --benchmark, the compression ratio and the deflate and inflate",
+    "throughput (MB/s) of every codec are reported.  Input is packed into",
+    "CellStore data blocks (serialized key/value pairs, 64KB by default).",
+    "Each <file> is read as tab delimited LOAD DATA INFILE input",
+    "(row, column, value); without files, synthetic cells are generated.",
+    "",
     0
   };
+
+  const char *codecs[] = {
+    "none", "bmz", "zlib", "lzo", "quicklz", "lz4", "lz4hc", "lz4hc --best", 0
+  };
+
+  typedef std::vector<DynamicBuffer *> Blocks;
+
+  void add_cell(Blocks &blocks, size_t block_size, const char *row,
+                const char *qualifier, const char *value, size_t value_len,
+                int64_t timestamp) {
+    if (blocks.empty() || blocks.back()->fill() >= block_size)
+      blocks.push_back(new DynamicBuffer(block_size + 1024));
+    DynamicBuffer *buf = blocks.back();
+    create_key_and_append(*buf, FLAG_INSERT, row, 1, qualifier, timestamp,
+                          timestamp);
+    append_as_byte_string(*buf, value, value_len);
+  }
+
+  void load_cells(Blocks &blocks, size_t block_size, const char *fname) {
+    std::ifstream in(fname);
+    std::string line;
+    int64_t timestamp = 1300000000000000000LL;
+
+    if (!in)
+      HT_FATALF("Unable to open '%s'", fname);
+
+    // skip header line
+    std::getline(in, line);
+
+    while (std::getline(in, line)) {
+      size_t col = line.find('\t');
+      if (col == std::string::npos)
+        continue;
+      size_t val = line.find('\t', col+1);
+      std::string row = line.substr(0, col);
+      std::string qualifier = (val == std::string::npos) ? "" :
+          line.substr(col+1, val-(col+1));
+      const char *value = (val == std::string::npos) ? "" :
+          line.c_str() + val + 1;
+      add_cell(blocks, block_size, row.c_str(), qualifier.c_str(), value,
+               strlen(value), timestamp++);
+    }
+  }
+
+  void generate_cells(Blocks &blocks, size_t block_size, size_t total) {
+    const char *words[] = { "GET", "POST", "/index.html", "/images/logo.png",
+      "200", "304", "404", "Mozilla/5.0", "(X11; Linux x86_64)", "http://",
+      "www.hypertable.org", "session", "user", "click", "view", "search" };
+    size_t nwords = sizeof(words) / sizeof(const char *);
+    String row, value;
+    char qualifier[16];
+    int64_t timestamp = 1300000000000000000LL;
+    size_t generated = 0;
+
+    srandom(1);
+    for (size_t i=0; generated < total; i++) {
+      row = format("com.example.www/%08u/%04u", (unsigned)(i/8),
+                   (unsigned)(random() % 10000));
+      sprintf(qualifier, "q%u", (unsigned)(i % 8));
+      value.clear();
+      size_t n = 4 + (random() % 24);
+      for (size_t j=0; j<n; j++) {
+        value += words[random() % nwords];
+        value += (j % 5 == 4) ? format(" %u ", (unsigned)random() % 1000) : " ";
+      }
+      add_cell(blocks, block_size, row.c_str(), qualifier, value.c_str(),
+               value.length(), timestamp++);
+      generated += row.length() + value.length() + 24;
+    }
+  }
+
+  int run_benchmark(int argc, char **argv) {
+    size_t block_size = 65536;
+    int iterations = 10;
+    Blocks blocks;
+    std::vector<const char *> files;
+    BlockCompressionHeaderCommitLog header(MAGIC, 0);
+    DynamicBuffer zblock(0), output(0);
+    uint64_t raw_bytes = 0;
+
+    for (int i=2; i<argc; i++) {
+      if (!strncmp(argv[i], "--block-size=", 13))
+        block_size = atoi(&argv[i][13]);
+      else if (!strncmp(argv[i], "--iterations=", 13))
+        iterations = atoi(&argv[i][13]);
+      else
+        files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+      generate_cells(blocks, block_size, 32 * 1024 * 1024);
+    else {
+      for (size_t i=0; i<files.size(); i++)
+        load_cells(blocks, block_size, files[i]);
+    }
+
+    for (size_t i=0; i<blocks.size(); i++)
+      raw_bytes += blocks[i]->fill();
+
+    printf("%lu blocks, %llu bytes, %d iterations\n", (Lu)blocks.size(),
+           (Llu)raw_bytes, iterations);
+    printf("%-14s %8s %12s %12s\n", "codec", "ratio", "deflate MB/s",
+           "inflate MB/s");
+
+    for (size_t c=0; codecs[c]; c++) {
+      BlockCompressionCodec *codec =
+          CompressorFactory::create_block_codec(codecs[c]);
+      Stopwatch deflate_watch(false), inflate_watch(false);
+      uint64_t zbytes = 0;
+
+      for (int iter=0; iter<iterations; iter++) {
+        for (size_t i=0; i<blocks.size(); i++) {
+          deflate_watch.start();
+          codec->deflate(*blocks[i], zblock, header);
+          deflate_watch.stop();
+          if (iter == 0)
+            zbytes += zblock.fill() - header.length();
+          inflate_watch.start();
+          codec->inflate(zblock, output, header);
+          inflate_watch.stop();
+          if (output.fill() != blocks[i]->fill() ||
+              memcmp(output.base, blocks[i]->base, output.fill())) {
+            HT_ERRORF("Input does not match output after %s codec",
+                      codecs[c]);
+            return 1;
+          }
+        }
+      }
+
+      double mb = (double)raw_bytes * iterations / 1000000.0;
+      printf("%-14s %8.2f %12.1f %12.1f\n", codecs[c],
+             (double)raw_bytes / (double)zbytes,
+             mb / deflate_watch.elapsed(), mb / inflate_watch.elapsed());
+      delete codec;
+    }
+
+    for (size_t i=0; i<blocks.size(); i++)
+      delete blocks[i];
+
+    return 0;
+  }
+
 }
 
-const char MAGIC[12] = { '-','-','-','-','-','-','-','-','-','-','-','-' };
 
 int main(int argc, char **argv) {
   off_t len;
@@ -64,6 +226,16 @@ int main(int argc, char **argv) {
 
   System::initialize(System::locate_install_dir(argv[0]));
 
+  if (!strcmp(argv[1], "--benchmark")) {
+    try {
+      return run_benchmark(argc, argv);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
+      return 1;
+    }
+  }
+
   compressor = CompressorFactory::create_block_codec(argv[1]);
 
   if (!compressor)
@@ -21,8 +21,11 @@
 
 #include "Common/Compat.h"
 #include <fstream>
+#include <iostream>
 #include <utility>
 
+#include <boost/thread/thread.hpp>
+
 #include "Common/NumberStream.h"
 #include "Common/StringExt.h"
 #include "Common/Usage.h"
@@ -38,7 +41,8 @@ namespace {
     "",
     "Validates LocationCache class.  Generates output file "
     "'./locationCacheTest.output' and",
-    "diffs it against ./locationCacheTest.golden'.",
+    "diffs it against ./locationCacheTest.golden'.  Then checks lookups",
+    "from several threads against concurrent inserts and invalidations.",
     0
   };
   typedef pair<const char *, const char *> RowRangeSpec;
@@ -204,6 +208,32 @@ namespace {
       outfile << "[NULL]" << endl;
   }
 
+  /** Looks up words and checks that every hit is a consistent entry that
+   * covers the row.  Entries carry "start|end" as their proxy name. */
+  struct ConcurrentReader {
+    ConcurrentReader(LocationCache *cache, bool *failed)
+      : cache(cache), failed(failed) { }
+    void operator()() {
+      RangeLocationInfo info;
+      for (size_t i=0; i<200000 && !*failed; i++) {
+        const char *rowkey = words[i % MAX_WORDS];
+        const char *table_id = (i & 1) ? "1" : "2";
+        if (!cache->lookup(table_id, rowkey, &info))
+          continue;
+        if (info.addr.proxy != info.start_row + "|" + info.end_row ||
+            strcmp(rowkey, info.start_row.c_str()) <= 0 ||
+            (info.end_row != "" && strcmp(rowkey, info.end_row.c_str()) > 0)) {
+          cerr << "Bad concurrent lookup of " << rowkey << " -> ["
+               << info.start_row << ".." << info.end_row << "] "
+               << info.addr.proxy << endl;
+          *failed = true;
+        }
+      }
+    }
+    LocationCache *cache;
+    bool *failed;
+  };
+
 }
 
 
@@ -267,5 +297,31 @@ int main(int argc, char **argv) {
   if (system("diff ./locationCacheTest.output ./locationCacheTest.golden"))
     return 1;
 
+  {
+    LocationCache concurrent_cache(20);
+    bool failed = false;
+    boost::thread_group readers;
+
+    for (size_t i=0; i<4; i++)
+      readers.create_thread(ConcurrentReader(&concurrent_cache, &failed));
+
+    for (size_t i=0; i<20000 && !failed; i++) {
+      rangei = i % MAX_RANGES;
+      table_id = (i & 1) ? "1" : "2";
+      range_loc_info.start_row = ranges[rangei].first;
+      range_loc_info.end_row   = ranges[rangei].second;
+      range_loc_info.addr.set_proxy(range_loc_info.start_row + "|" +
+                                    range_loc_info.end_row);
+      if ((i % 7) == 0)
+        concurrent_cache.invalidate(table_id.c_str(), words[i % MAX_WORDS]);
+      else
+        concurrent_cache.insert(table_id.c_str(), range_loc_info);
+    }
+
+    readers.join_all();
+    if (failed)
+      return 1;
+  }
+
   return 0;
 }
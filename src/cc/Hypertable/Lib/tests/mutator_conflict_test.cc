@@ -0,0 +1,195 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include <cstdlib>
+#include <iostream>
+
+#include "Common/Usage.h"
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/Future.h"
+
+using namespace std;
+using namespace Hypertable;
+
+namespace {
+
+  const char *schema =
+  "<Schema>"
+  "  <AccessGroup name=\"default\">"
+  "    <ColumnFamily>"
+  "      <Name>data</Name>"
+  "    </ColumnFamily>"
+  "  </AccessGroup>"
+  "</Schema>";
+
+  const char *usage[] = {
+    "usage: mutator_conflict_test",
+    "",
+    "Validates that a mutator overlaps flushes of scatter buffers that touch",
+    "disjoint rows, holds back a buffer that touches a row of an outstanding",
+    "buffer, and applies interleaved inserts and deletes in order.",
+    0
+  };
+
+  // large enough to exceed the aggregate flush limit in the .cfg file
+  const int NUM_ROWS = 2000;
+  const size_t VALUE_SIZE = 100;
+
+  void load_rows(TableMutatorAsync *mutator, const char *prefix) {
+    String value(VALUE_SIZE, 'v');
+    for (int i=0; i<NUM_ROWS; i++) {
+      String row = format("%s%06d", prefix, i);
+      mutator->set(KeySpec(row.c_str(), "data", ""), value);
+    }
+  }
+
+  void drain(Future &ff) {
+    ResultPtr result;
+    while (ff.get(result)) {
+      if (result->is_error()) {
+        int error;
+        String error_msg;
+        result->get_error(error, error_msg);
+        HT_THROW(error, error_msg);
+      }
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  if (argc > 1)
+    Usage::dump_and_exit(usage);
+
+  try {
+    Client *hypertable = new Client(argv[0], "./mutator_conflict_test.cfg");
+    NamespacePtr ns = hypertable->open_namespace("/");
+    TablePtr table;
+
+    ns->drop_table("MutatorConflictTest", true);
+    ns->create_table("MutatorConflictTest", schema);
+    table = ns->open_table("MutatorConflictTest");
+
+    /**
+     * A buffer that shares a row with an outstanding buffer must wait.  The
+     * first buffer may complete at any time, so flush_ready() returning true
+     * is only an error if that buffer is still outstanding afterwards.
+     */
+    {
+      Future ff;
+      TableMutatorAsyncPtr mutator = table->create_mutator_async(&ff);
+      load_rows(mutator.get(), "a");
+      mutator->flush(false);
+      mutator->set(KeySpec("a000500", "data", ""), "conflict");
+      if (mutator->flush_ready() && mutator->has_outstanding()) {
+        HT_ERROR("Buffer sharing a row with an outstanding buffer was "
+                 "allowed to flush");
+        _exit(1);
+      }
+      drain(ff);
+      if (!mutator->flush_ready()) {
+        HT_ERROR("Buffer held back with nothing outstanding");
+        _exit(1);
+      }
+      mutator->flush(false);
+      drain(ff);
+    }
+
+    /**
+     * A buffer over the aggregate flush limit with rows disjoint from the
+     * single outstanding buffer may overlap with it
+     */
+    {
+      Future ff;
+      TableMutatorAsyncPtr mutator = table->create_mutator_async(&ff);
+      load_rows(mutator.get(), "b");
+      mutator->flush(false);
+      load_rows(mutator.get(), "c");
+      if (!mutator->flush_ready()) {
+        HT_ERROR("Buffer with disjoint rows not allowed to overlap with the "
+                 "outstanding buffer");
+        _exit(1);
+      }
+      mutator->flush(false);
+      drain(ff);
+    }
+
+    /**
+     * Interleaved inserts and deletes of the same rows spread over many
+     * small buffers must be applied in the order they were made
+     */
+    {
+      TableMutatorPtr mutator = table->create_mutator();
+      for (int i=0; i<NUM_ROWS; i++) {
+        String row = format("d%06d", i);
+        mutator->set(KeySpec(row.c_str(), "data", ""), "v0");
+      }
+      for (int i=0; i<NUM_ROWS; i+=3) {
+        String row = format("d%06d", i);
+        mutator->set_delete(KeySpec(row.c_str(), "data", ""));
+      }
+      for (int i=0; i<NUM_ROWS; i+=2) {
+        String row = format("d%06d", i);
+        mutator->set(KeySpec(row.c_str(), "data", ""), "v2");
+      }
+      mutator->flush();
+    }
+
+    {
+      ScanSpecBuilder ssbuilder;
+      ssbuilder.add_row_interval("d", true, "e", false);
+      TableScannerPtr scanner = table->create_scanner(ssbuilder.get());
+      Cell cell;
+      int next = 0;
+      while (scanner->next(cell)) {
+        // skip rows that were deleted and never reinserted
+        while (next % 3 == 0 && next % 2 != 0)
+          next++;
+        String row = format("d%06d", next);
+        const char *expected = (next % 2 == 0) ? "v2" : "v0";
+        if (row != cell.row_key || cell.value_len != 2 ||
+            memcmp(cell.value, expected, 2)) {
+          HT_ERRORF("Expected %s=%s, got %s=%s", row.c_str(), expected,
+                    cell.row_key, String((const char *)cell.value,
+                                         cell.value_len).c_str());
+          _exit(1);
+        }
+        next++;
+      }
+      while (next < NUM_ROWS && next % 3 == 0 && next % 2 != 0)
+        next++;
+      if (next != NUM_ROWS) {
+        HT_ERRORF("Scan stopped at row %d, expected %d", next, NUM_ROWS);
+        _exit(1);
+      }
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0);
+}
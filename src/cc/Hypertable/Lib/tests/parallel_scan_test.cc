@@ -0,0 +1,226 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+}
+
+#include "Common/Usage.h"
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/Future.h"
+
+using namespace std;
+using namespace Hypertable;
+
+namespace {
+
+  const char *schema =
+  "<Schema>"
+  "  <AccessGroup name=\"default\">"
+  "    <ColumnFamily>"
+  "      <Name>data</Name>"
+  "    </ColumnFamily>"
+  "  </AccessGroup>"
+  "</Schema>";
+
+  const char *usage[] = {
+    "usage: parallel_scan_test",
+    "",
+    "Loads a table until it has split into several ranges and validates",
+    "range-parallel scans: scanners created without the parallel ranges",
+    "flag (including callers passing 'true') scan serially, ordered",
+    "parallel scans return rows in order, unordered parallel scans return",
+    "every row, and asynchronous parallel scans complete.",
+    0
+  };
+
+  const int NUM_ROWS = 20000;
+  const size_t VALUE_SIZE = 200;
+  const size_t MIN_RANGES = 4;
+
+  String row_key(int i) {
+    return format("row%06d", i);
+  }
+
+  /**
+   * Checks that rows [first, last) were returned exactly once each and, if
+   * ordered is set, in ascending order
+   */
+  bool check_rows(const char *label, vector<String> &rows, int first,
+                  int last, bool ordered) {
+    if (!ordered)
+      sort(rows.begin(), rows.end());
+    if (rows.size() != (size_t)(last - first)) {
+      HT_ERRORF("%s: expected %d rows, got %d", label, last - first,
+                (int)rows.size());
+      return false;
+    }
+    for (int i=first; i<last; i++) {
+      if (rows[i-first] != row_key(i)) {
+        HT_ERRORF("%s: expected row %s at position %d, got %s", label,
+                  row_key(i).c_str(), i-first, rows[i-first].c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void scan_sync(TablePtr &table, const ScanSpec &scan_spec, int32_t flags,
+                 vector<String> &rows) {
+    TableScannerPtr scanner = table->create_scanner(scan_spec, 0, flags);
+    Cell cell;
+    rows.clear();
+    while (scanner->next(cell))
+      rows.push_back(cell.row_key);
+  }
+
+  /**
+   * Runs an asynchronous scan to completion and returns whether it was
+   * range-parallel
+   */
+  bool scan_async(TablePtr &table, const ScanSpec &scan_spec, int32_t flags,
+                  vector<String> &rows) {
+    Future ff;
+    ResultPtr result;
+    Cells cells;
+    rows.clear();
+    TableScannerAsyncPtr scanner =
+      table->create_scanner_async(&ff, scan_spec, 0, flags);
+    bool parallel = scanner->is_range_parallel();
+    while (ff.get(result)) {
+      if (result->is_error()) {
+        int error;
+        String error_msg;
+        result->get_error(error, error_msg);
+        HT_THROW(error, error_msg);
+      }
+      result->get_cells(cells);
+      for (size_t i=0; i<cells.size(); i++)
+        rows.push_back(cells[i].row_key);
+    }
+    if (!scanner->is_complete())
+      HT_THROW(Error::FAILED_EXPECTATION, "Asynchronous scan did not complete");
+    return parallel;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  if (argc > 1)
+    Usage::dump_and_exit(usage);
+
+  try {
+    Client *hypertable = new Client(argv[0], "./parallel_scan_test.cfg");
+    NamespacePtr ns = hypertable->open_namespace("/");
+    TablePtr table;
+    ScanSpecBuilder ssbuilder;
+    vector<String> rows;
+
+    ns->drop_table("ParallelScanTest", true);
+    ns->create_table("ParallelScanTest", schema);
+    table = ns->open_table("ParallelScanTest");
+
+    {
+      TableMutatorPtr mutator = table->create_mutator();
+      String value(VALUE_SIZE, 'v');
+      for (int i=0; i<NUM_ROWS; i++) {
+        String row = row_key(i);
+        mutator->set(KeySpec(row.c_str(), "data", ""), value.c_str(),
+                     value.length());
+      }
+      mutator->flush();
+    }
+
+    // wait for the table to split
+    size_t nranges = 0;
+    for (int i=0; i<120; i++) {
+      TableSplitsContainer splits;
+      ns->get_table_splits("ParallelScanTest", splits);
+      nranges = splits.size();
+      if (nranges >= MIN_RANGES)
+        break;
+      poll(0, 0, 1000);
+    }
+    if (nranges < MIN_RANGES) {
+      HT_ERRORF("Table only split into %d ranges", (int)nranges);
+      _exit(1);
+    }
+    HT_INFOF("ParallelScanTest has %d ranges", (int)nranges);
+
+    // Plain scans stay serial, including callers that pass 'true' as flags
+    if (scan_async(table, ssbuilder.get(), 0, rows) ||
+        scan_async(table, ssbuilder.get(), 1, rows)) {
+      HT_ERROR("Scanner without SCANNER_FLAG_PARALLEL_RANGES is parallel");
+      _exit(1);
+    }
+    if (!check_rows("serial", rows, 0, NUM_ROWS, true))
+      _exit(1);
+
+    // Ordered parallel scan over the whole table
+    scan_sync(table, ssbuilder.get(), Table::SCANNER_FLAG_PARALLEL_RANGES,
+              rows);
+    if (!check_rows("parallel", rows, 0, NUM_ROWS, true))
+      _exit(1);
+
+    // Ordered parallel scan over several row intervals
+    ssbuilder.clear();
+    ssbuilder.add_row_interval(row_key(100).c_str(), true,
+                               row_key(5000).c_str(), false);
+    ssbuilder.add_row_interval(row_key(5000).c_str(), true,
+                               row_key(12000).c_str(), false);
+    ssbuilder.add_row_interval(row_key(12000).c_str(), true,
+                               row_key(19000).c_str(), false);
+    scan_sync(table, ssbuilder.get(), Table::SCANNER_FLAG_PARALLEL_RANGES,
+              rows);
+    if (!check_rows("parallel-intervals", rows, 100, 19000, true))
+      _exit(1);
+
+    // Unordered parallel scan
+    ssbuilder.clear();
+    scan_sync(table, ssbuilder.get(), Table::SCANNER_FLAG_PARALLEL_RANGES |
+              Table::SCANNER_FLAG_UNORDERED, rows);
+    if (!check_rows("unordered", rows, 0, NUM_ROWS, false))
+      _exit(1);
+
+    // Asynchronous parallel scan runs to completion
+    if (!scan_async(table, ssbuilder.get(),
+                    Table::SCANNER_FLAG_PARALLEL_RANGES, rows)) {
+      HT_ERROR("Scanner with SCANNER_FLAG_PARALLEL_RANGES is not parallel");
+      _exit(1);
+    }
+    if (!check_rows("parallel-async", rows, 0, NUM_ROWS, true))
+      _exit(1);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0);
+}
@@ -47,6 +47,34 @@ int main(int argc, char *argv[]) {
   stats1->block_cache_hits = Random::number64();
   stats1->tracked_memory = Random::number64();
   stats1->live = (Random::number32() % 2) == 0;
+  stats1->wire_update_raw_bytes = Random::number64();
+  stats1->wire_update_bytes = Random::number64();
+  stats1->wire_scan_raw_bytes = Random::number64();
+  stats1->wire_scan_bytes = Random::number64();
+  stats1->wire_client_update_raw_bytes = Random::number64();
+  stats1->wire_client_update_bytes = Random::number64();
+  stats1->wire_client_scan_raw_bytes = Random::number64();
+  stats1->wire_client_scan_bytes = Random::number64();
+  stats1->cell_cache_memory = Random::number64();
+  stats1->block_index_memory = Random::number64();
+  stats1->bloom_filter_memory = Random::number64();
+  stats1->shadow_cache_memory = Random::number64();
+  stats1->idle_index_memory = Random::number64();
+  stats1->block_cache_limit = Random::number64();
+  stats1->query_cache_limit = Random::number64();
+  stats1->memory_rebalances = Random::number64();
+  stats1->memory_rebalanced_bytes = Random::number64();
+  stats1->memory_governor_decision = "moved 1048576 bytes from indexes to block-cache";
+  stats1->maintenance_passes = Random::number64();
+  stats1->maintenance_time = Random::number64();
+  stats1->maintenance_last_time = Random::number64();
+  stats1->maintenance_last_gather_time = Random::number64();
+  stats1->maintenance_last_prioritize_time = Random::number64();
+  stats1->maintenance_ranges_gathered = Random::number64();
+  stats1->maintenance_ranges_reused = Random::number64();
+  stats1->throttled_updates = Random::number64();
+  stats1->throttle_delay_time = Random::number64();
+  stats1->throttle_drain_rate = Random::number64();
 
   stats1->system.refresh();
 
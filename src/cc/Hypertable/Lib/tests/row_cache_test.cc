@@ -0,0 +1,137 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+extern "C" {
+#include <poll.h>
+}
+
+#include "Hypertable/Lib/RowCache.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  CellsBuilderPtr make_row(const char *row, const char *value) {
+    CellsBuilderPtr cells = new CellsBuilder(1);
+    Cell cell;
+    cell.row_key = row;
+    cell.column_family = "cf";
+    cell.column_qualifier = "qualifier";
+    cell.value = (const uint8_t *)value;
+    cell.value_len = strlen(value);
+    cells->add(cell);
+    return cells;
+  }
+
+}
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  RowCache cache(1024*1024, 200);
+  CellsBuilderPtr cells;
+  Cell cell;
+  RowCache::Stats stats;
+
+  // miss, insert, hit
+  if (cache.lookup("spec-a", cells)) {
+    HT_ERROR("Unexpected hit in empty cache");
+    return 1;
+  }
+  cells = make_row("a", "1");
+  if (!cache.insert("spec-a", "a", cells, cache.generation())) {
+    HT_ERROR("Failed to insert row a");
+    return 1;
+  }
+  cells = 0;
+  if (!cache.lookup("spec-a", cells) || cells->size() != 1) {
+    HT_ERROR("Expected hit for row a");
+    return 1;
+  }
+  cells->get_cell(cell, 0);
+  if (strcmp(cell.row_key, "a") || cell.value_len != 1 || cell.value[0] != '1') {
+    HT_ERROR("Bad cached cell for row a");
+    return 1;
+  }
+
+  // invalidation drops the row and results of scans in flight
+  uint64_t generation = cache.generation();
+  cache.invalidate("a");
+  if (cache.lookup("spec-a", cells)) {
+    HT_ERROR("Hit after invalidation of row a");
+    return 1;
+  }
+  cells = make_row("a", "2");
+  if (cache.insert("spec-a", "a", cells, generation)) {
+    HT_ERROR("Inserted result of scan started before invalidation");
+    return 1;
+  }
+  if (!cache.insert("spec-a", "a", cells, cache.generation())) {
+    HT_ERROR("Failed to insert row a after invalidation");
+    return 1;
+  }
+
+  // entries expire
+  poll(0, 0, 300);
+  if (cache.lookup("spec-a", cells)) {
+    HT_ERROR("Hit on expired entry");
+    return 1;
+  }
+
+  // least recently used entries are evicted first
+  RowCache small(64*1024, 60000);
+  char key[32], row[32];
+  for (int i=0; i<64; i++) {
+    sprintf(key, "spec-%d", i);
+    sprintf(row, "row-%d", i);
+    cells = make_row(row, "value");
+    small.insert(key, row, cells, small.generation());
+    // keep the first row hot
+    small.lookup("spec-0", cells);
+  }
+  if (!small.lookup("spec-0", cells)) {
+    HT_ERROR("Recently used entry evicted");
+    return 1;
+  }
+  if (small.lookup("spec-1", cells)) {
+    HT_ERROR("Least recently used entry not evicted");
+    return 1;
+  }
+
+  small.get_stats(stats);
+  if (stats.available_memory > stats.max_memory || stats.hits < 64) {
+    HT_ERROR("Bad row cache statistics");
+    return 1;
+  }
+
+  small.clear();
+  small.get_stats(stats);
+  if (stats.available_memory != stats.max_memory) {
+    HT_ERROR("Memory not released by clear");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/** -*- c++ -*-
+ * Copyright (C) 2008 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <cstring>
+
+#include "Hypertable/Lib/ScanAggregator.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  // Builds a partial aggregate cell as returned by a RangeServer
+  void add_partial(ScanAggregator &aggregator, const char *row,
+                   const char *family, const AggregateValue &partial) {
+    uint8_t buf[AggregateValue::ENCODED_LENGTH];
+    uint8_t *ptr = buf;
+    Cell cell;
+
+    partial.encode(&ptr);
+    cell.row_key = row;
+    cell.column_family = family;
+    cell.value = buf;
+    cell.value_len = ptr - buf;
+    aggregator.add(cell);
+  }
+
+  AggregateValue make_partial(int64_t count, int64_t v1, int64_t v2) {
+    AggregateValue partial;
+    partial.count = count;
+    partial.add(v1);
+    partial.add(v2);
+    return partial;
+  }
+
+}
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  int64_t value;
+
+  // decimal values
+  if (!AggregateValue::parse((const uint8_t *)"-42", 3, &value) || value != -42) {
+    HT_ERROR("Failed to parse -42");
+    return 1;
+  }
+  if (!AggregateValue::parse((const uint8_t *)"9223372036854775807", 19,
+                             &value) || value != 9223372036854775807LL) {
+    HT_ERROR("Failed to parse INT64_MAX");
+    return 1;
+  }
+  if (AggregateValue::parse((const uint8_t *)"9223372036854775808", 19, &value)) {
+    HT_ERROR("Parsed out of range value");
+    return 1;
+  }
+  if (AggregateValue::parse((const uint8_t *)"12a", 3, &value) ||
+      AggregateValue::parse((const uint8_t *)"-", 1, &value) ||
+      AggregateValue::parse((const uint8_t *)"", 0, &value)) {
+    HT_ERROR("Parsed non-numeric value");
+    return 1;
+  }
+
+  // partials of the same group from two ranges are combined
+  {
+    ScanAggregator aggregator(ScanSpec::AGGREGATE_ROW);
+    add_partial(aggregator, "row1", "a", make_partial(3, 5, -1));
+    add_partial(aggregator, "row1", "b", make_partial(2, 7, 2));
+    add_partial(aggregator, "row2", "a", make_partial(2, 1, 1));
+    const ScanAggregator::GroupMap &groups = aggregator.groups();
+    if (groups.size() != 2) {
+      HT_ERROR("Expected two row groups");
+      return 1;
+    }
+    const AggregateValue &row1 = groups.find("row1")->second;
+    if (row1.count != 5 || row1.values != 4 || row1.sum != 13 ||
+        row1.min != -1 || row1.max != 7) {
+      HT_ERROR("Bad aggregate for row1");
+      return 1;
+    }
+    AggregateValue total = aggregator.total();
+    if (total.count != 7 || total.sum != 15) {
+      HT_ERROR("Bad total of row groups");
+      return 1;
+    }
+  }
+
+  {
+    ScanAggregator aggregator(ScanSpec::AGGREGATE_COLUMN_FAMILY);
+    add_partial(aggregator, "", "a", make_partial(3, 5, -1));
+    add_partial(aggregator, "", "b", make_partial(2, 7, 2));
+    add_partial(aggregator, "", "a", make_partial(2, 1, 1));
+    if (aggregator.groups().size() != 2 ||
+        aggregator.groups().find("a")->second.count != 5) {
+      HT_ERROR("Bad column family groups");
+      return 1;
+    }
+  }
+
+  {
+    ScanAggregator aggregator(ScanSpec::AGGREGATE_TOTAL);
+    add_partial(aggregator, "", "a", make_partial(3, 5, -1));
+    add_partial(aggregator, "", "b", make_partial(2, 7, 2));
+    if (aggregator.groups().size() != 1 ||
+        aggregator.groups().begin()->second.max != 7) {
+      HT_ERROR("Bad total group");
+      return 1;
+    }
+  }
+
+  // the aggregation mode travels with the scan spec
+  {
+    ScanSpecBuilder ssb;
+    ssb.add_row_interval("a", true, "z", false);
+    ssb.set_aggregate(ScanSpec::AGGREGATE_COLUMN_FAMILY);
+    size_t len = ssb.get().encoded_length();
+    uint8_t *buf = new uint8_t [len];
+    uint8_t *ptr = buf;
+    ssb.get().encode(&ptr);
+    if ((size_t)(ptr - buf) != len) {
+      HT_ERROR("Scan spec encoded length mismatch");
+      return 1;
+    }
+    const uint8_t *decode_ptr = buf;
+    size_t remain = len;
+    ScanSpec spec(&decode_ptr, &remain);
+    if (remain != 0 || spec.aggregate != ScanSpec::AGGREGATE_COLUMN_FAMILY) {
+      HT_ERROR("Aggregation mode lost in scan spec encoding");
+      return 1;
+    }
+    delete [] buf;
+  }
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+/** -*- c++ -*-
+ * Copyright (C) 2008 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <cstring>
+
+#include "Common/Serialization.h"
+
+#include "Hypertable/Lib/WireCompressor.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  void fill_payload(DynamicBuffer &buf, size_t len) {
+    const char *row = "http://www.example.com/page/index.html\t{\"visits\": ";
+    buf.clear();
+    buf.reserve(len);
+    while (buf.fill() < len) {
+      size_t n = std::min(strlen(row), len - buf.fill());
+      buf.add_unchecked(row, n);
+    }
+  }
+
+}
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  WireCompressor compressor("lz4", 64);
+  WireCompressor disabled("none", 64);
+  DynamicBuffer payload, zbuf, output;
+  WireCompressor::Stats stats;
+
+  fill_payload(payload, 64*1024);
+
+  // compress and restore a payload
+  if (!compressor.deflate(payload.base, payload.fill(), zbuf)) {
+    HT_ERROR("Compressible payload was not compressed");
+    return 1;
+  }
+  if (zbuf.fill() >= payload.fill()) {
+    HT_ERROR("Compressed payload is not smaller than the original");
+    return 1;
+  }
+  compressor.inflate(zbuf.base, zbuf.fill(), output);
+  if (output.fill() != payload.fill() ||
+      memcmp(output.base, payload.base, payload.fill())) {
+    HT_ERROR("Inflated payload differs from original");
+    return 1;
+  }
+
+  // small payloads and disabled compressors send raw
+  if (compressor.deflate(payload.base, 32, zbuf)) {
+    HT_ERROR("Payload below minimum size was compressed");
+    return 1;
+  }
+  if (disabled.deflate(payload.base, payload.fill(), zbuf)) {
+    HT_ERROR("Disabled compressor compressed payload");
+    return 1;
+  }
+
+  // any compressor inflates any codec
+  output.clear();
+  compressor.deflate(payload.base, payload.fill(), zbuf);
+  disabled.inflate(zbuf.base, zbuf.fill(), output);
+  if (output.fill() != payload.fill() ||
+      memcmp(output.base, payload.base, payload.fill())) {
+    HT_ERROR("Disabled compressor failed to inflate payload");
+    return 1;
+  }
+
+  // scan blocks keep their length prefix
+  {
+    uint8_t *base = new uint8_t [ payload.fill() + 4 ];
+    uint8_t *ptr = base;
+    Serialization::encode_i32(&ptr, payload.fill());
+    memcpy(ptr, payload.base, payload.fill());
+    StaticBuffer ext(base, payload.fill() + 4);
+    StaticBuffer zext;
+    if (!compressor.deflate_scan_block(ext, zext)) {
+      HT_ERROR("Scan block was not compressed");
+      return 1;
+    }
+    const uint8_t *decode_ptr = zext.base;
+    size_t remain = zext.size;
+    uint32_t len = Serialization::decode_i32(&decode_ptr, &remain);
+    if (len != remain) {
+      HT_ERROR("Bad compressed scan block length");
+      return 1;
+    }
+    output.clear();
+    compressor.inflate(decode_ptr, len, output);
+    if (output.fill() != payload.fill() ||
+        memcmp(output.base, payload.base, payload.fill())) {
+      HT_ERROR("Inflated scan block differs from original");
+      return 1;
+    }
+  }
+
+  compressor.get_stats(stats);
+  if (stats.sent_raw_bytes != 3*payload.fill() + 32 ||
+      stats.sent_wire_bytes >= stats.sent_raw_bytes) {
+    HT_ERROR("Bad sent byte counts");
+    return 1;
+  }
+  if (stats.received_raw_bytes != 2*payload.fill() ||
+      stats.received_wire_bytes >= stats.received_raw_bytes) {
+    HT_ERROR("Bad received byte counts");
+    return 1;
+  }
+
+  // the client compressor counts what this process sends and receives
+  {
+    WireCompressor *client = WireCompressor::client();
+    WireCompressor::Stats before, after;
+    client->get_stats(before);
+    client->deflate(payload.base, payload.fill(), output);
+    compressor.deflate(payload.base, payload.fill(), zbuf);
+    output.clear();
+    client->inflate(zbuf.base, zbuf.fill(), output);
+    client->get_stats(after);
+    if (after.sent_raw_bytes - before.sent_raw_bytes != payload.fill() ||
+        after.received_raw_bytes - before.received_raw_bytes
+        != payload.fill() ||
+        after.received_wire_bytes - before.received_wire_bytes
+        != zbuf.fill()) {
+      HT_ERROR("Bad client byte counts");
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -28,6 +28,9 @@
 
 #include "Common/Error.h"
 #include "Common/md5.h"
+#include "Common/Time.h"
+
+#include "Hypertable/Lib/CommitLog.h"
 
 #include "AccessGroup.h"
 #include "CellCache.h"
@@ -44,16 +47,21 @@
 
 using namespace Hypertable;
 
+namespace {
+  const size_t CACHE_LOG_BLOCK_SIZE = 1024 * 1024;
+}
+
 
 AccessGroup::AccessGroup(const TableIdentifier *identifier,
     SchemaPtr &schema, Schema::AccessGroup *ag, const RangeSpec *range)
   : m_outstanding_scanner_count(0), m_identifier(*identifier), m_schema(schema),
-    m_name(ag->name), m_next_cs_id(0), m_disk_usage(0),
+    m_name(ag->name), m_next_cs_id(0), m_disk_usage(0), m_blob_disk_usage(0),
     m_compression_ratio(1.0), m_earliest_cached_revision(TIMESTAMP_MAX),
     m_earliest_cached_revision_saved(TIMESTAMP_MAX),
-    m_latest_stored_revision(TIMESTAMP_MIN), m_collisions(0),
+    m_latest_stored_revision(TIMESTAMP_MIN), m_collisions(0), m_max_ttl(0),
     m_file_tracker(identifier, schema, range, ag->name), m_is_root(false),
-    m_recovering(false), m_needs_merging(false) {
+    m_recovering(false), m_needs_merging(false), m_single_version(false),
+    m_has_counters(false) {
 
   m_table_name = m_identifier.id;
   m_start_row = range->start_row;
@@ -66,11 +74,15 @@ AccessGroup::AccessGroup(const TableIdentifier *identifier,
   foreach(Schema::ColumnFamily *cf, ag->columns)
     m_column_families.insert(cf->id);
 
+  compute_max_ttl(ag);
+  compute_version_limits(ag);
+
   m_garbage_tracker.set_schema(schema, ag);
 
   m_is_root = (m_identifier.is_metadata() && *range->start_row == 0
                && !strcmp(range->end_row, Key::END_ROOT_ROW));
   m_in_memory = ag->in_memory;
+  m_blob_threshold = (m_in_memory || ag->counter) ? 0 : ag->blob_threshold;
 
   m_cellstore_props = new Properties();
   m_cellstore_props->set("compressor", ag->compressor.size() ?
@@ -123,6 +135,9 @@ void AccessGroup::update_schema(SchemaPtr &schema,
       }
     }
 
+    compute_max_ttl(ag);
+    compute_version_limits(ag);
+
     // Update schema ptr
     m_schema = schema;
   }
@@ -181,11 +196,35 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
 
     if (!m_in_memory) {
       bool bloom_filter_disabled;
+      bool blob_references = false;
+
+      /**
+       * Every cell older than the smallest TTL cutoff of the scanned
+       * column families is filtered out by the MergeScanner, so CellStores
+       * whose newest cell is older than that need not be opened
+       */
+      int64_t cutoff = TIMESTAMP_MIN;
+      for (std::set<uint8_t>::iterator iter = m_column_families.begin();
+           iter != m_column_families.end(); ++iter) {
+        if (!scan_context->family_mask[*iter])
+          continue;
+        if (scan_context->family_info[*iter].cutoff_time == TIMESTAMP_MIN) {
+          cutoff = TIMESTAMP_MIN;
+          break;
+        }
+        if (cutoff == TIMESTAMP_MIN ||
+            scan_context->family_info[*iter].cutoff_time < cutoff)
+          cutoff = scan_context->family_info[*iter].cutoff_time;
+      }
 
       for (size_t i=0; i<m_stores.size(); ++i) {
 
-        if (scan_context->time_interval.first > m_stores[i].timestamp_max ||
-            scan_context->time_interval.second < m_stores[i].timestamp_min)
+        if (scan_context->time_interval.second < m_stores[i].timestamp_min)
+          continue;
+
+        if (m_stores[i].timestamp_bounds &&
+            (scan_context->time_interval.first > m_stores[i].timestamp_max ||
+             m_stores[i].timestamp_max < cutoff))
           continue;
 
         bloom_filter_disabled = boost::any_cast<uint8_t>(m_stores[i].cs->get_trailer()->get("bloom_filter_mode")) == BLOOM_FILTER_DISABLED;
@@ -201,8 +240,11 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
             scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_context));
             m_stores[i].shadow_cache_hits++;
           }
-          else
-            scanner->add_scanner(m_stores[i].cs->create_scanner(scan_context));
+          else {
+            scanner->add_scanner(m_stores[i].cs->create_scanner(scan_context),
+                                 m_stores[i].blob_references);
+            blob_references |= m_stores[i].blob_references;
+          }
           callback.add_file(m_stores[i].cs->get_filename());
         }
         else {
@@ -213,8 +255,11 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
               scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_context));
               m_stores[i].shadow_cache_hits++;
             }
-            else
-              scanner->add_scanner(m_stores[i].cs->create_scanner(scan_context));
+            else {
+              scanner->add_scanner(m_stores[i].cs->create_scanner(scan_context),
+                                   m_stores[i].blob_references);
+              blob_references |= m_stores[i].blob_references;
+            }
             callback.add_file(m_stores[i].cs->get_filename());
           }
         }
@@ -223,6 +268,17 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
           scanner->add_disk_read(m_stores[i].cs->bytes_read() - initial_bytes_read);
 
       }
+
+      /**
+       * Pin the blob logs for the lifetime of the scanner and have the
+       * MergeScanner resolve references, unless only keys are wanted
+       */
+      if (blob_references) {
+        foreach(const BlobLogInfoMap::value_type &v, m_blob_files)
+          callback.add_file(v.first);
+        scanner->set_resolve_blobs(scan_context->spec == 0 ||
+                                   !scan_context->spec->keys_only);
+      }
     }
   }
   catch (Exception &e) {
@@ -250,37 +306,27 @@ bool AccessGroup::include_in_scan(ScanContextPtr &scan_context) {
 }
 
 const char *AccessGroup::get_split_row() {
-  std::vector<String> split_rows;
-  get_split_rows(split_rows, true);
-  if (split_rows.size() > 0) {
-    sort(split_rows.begin(), split_rows.end());
-    return (split_rows[split_rows.size()/2]).c_str();
-  }
-  return "";
+  SplitRowSampler::SampleVector samples;
+  get_split_row_samples(samples, true);
+  const char *row = SplitRowSampler::median(samples);
+  ScopedLock lock(m_mutex);
+  m_split_row = row ? row : "";
+  return m_split_row.c_str();
 }
 
 void
-AccessGroup::get_split_rows(std::vector<String> &split_rows,
-                            bool include_cache) {
+AccessGroup::get_split_row_samples(SplitRowSampler::SampleVector &samples,
+                                   bool include_cache) {
   ScopedLock lock(m_mutex);
-  const char *row;
 
-  for (size_t i=0; i<m_stores.size(); i++) {
-    row = m_stores[i].cs->get_split_row();
-    if (row) {
-      split_rows.push_back(row);
-    }
-  }
+  for (size_t i=0; i<m_stores.size(); i++)
+    m_stores[i].cs->get_split_row_samples(samples);
+
   if (include_cache) {
-    if (m_cell_cache) {
-      if (m_immutable_cache &&
-          m_immutable_cache->size() > m_cell_cache->size())
-        m_immutable_cache->get_split_rows(split_rows);
-      else
-        m_cell_cache->get_split_rows(split_rows);
-    }
-    else if (m_immutable_cache)
-      m_immutable_cache->get_split_rows(split_rows);
+    if (m_cell_cache)
+      m_cell_cache->get_split_row_samples(samples);
+    if (m_immutable_cache)
+      m_immutable_cache->get_split_row_samples(samples);
   }
 }
 
@@ -301,7 +347,7 @@ void AccessGroup::get_cached_rows(std::vector<String> &rows) {
 uint64_t AccessGroup::disk_usage() {
   ScopedLock lock(m_mutex);
   uint64_t usage;
-  uint64_t du = (m_in_memory) ? 0 : m_disk_usage;
+  uint64_t du = (m_in_memory) ? 0 : m_disk_usage + m_blob_disk_usage;
   uint64_t mu = m_cell_cache ? m_cell_cache->memory_used() : 0;
   if (m_immutable_cache)
     mu += m_immutable_cache->memory_used();
@@ -326,16 +372,20 @@ void AccessGroup::space_usage(int64_t *memp, int64_t *diskp) {
   *memp = m_cell_cache ? m_cell_cache->memory_used() : 0;
   if (m_immutable_cache)
     *memp += m_immutable_cache->memory_used();
-  *diskp = (m_in_memory) ? 0 : m_disk_usage;
+  *diskp = (m_in_memory) ? 0 : m_disk_usage + m_blob_disk_usage;
   *diskp += (int64_t)(m_compression_ratio * (float)*memp);
 }
 
 
 uint64_t AccessGroup::purge_memory(MaintenanceFlag::Map &subtask_map) {
-  ScopedLock lock(m_outstanding_scanner_mutex);
   uint64_t memory_purged = 0;
   int flags;
 
+  if (MaintenanceFlag::purge_cellcache(subtask_map.flags(this)))
+    memory_purged += compact_cell_cache();
+
+  ScopedLock lock(m_outstanding_scanner_mutex);
+
   {
     ScopedLock lock(m_mutex);
     for (size_t i=0; i<m_stores.size(); i++) {
@@ -354,6 +404,123 @@ uint64_t AccessGroup::purge_memory(MaintenanceFlag::Map &subtask_map) {
   return memory_purged;
 }
 
+
+uint64_t AccessGroup::compact_cell_cache() {
+  Key key;
+  ByteString value;
+  SchemaPtr schema;
+  CellCachePtr compacted_cache;
+  CellListScannerPtr scanner;
+  uint64_t memory_before, memory_after;
+  size_t cells_before;
+  bool in_memory;
+
+  {
+    ScopedLock lock(m_mutex);
+    if (!m_cell_cache || m_immutable_cache || m_has_counters)
+      return 0;
+    m_immutable_cache = m_cell_cache;
+    m_immutable_cache->freeze();
+    m_cell_cache = 0;
+    schema = m_schema;
+    in_memory = m_in_memory;
+  }
+
+  /**
+   * The frozen cache stays visible to scanners as the immutable cache
+   * while it is rebuilt, and m_earliest_cached_revision still covers
+   * every cell since nothing leaves memory.
+   */
+  try {
+    ScanContextPtr scan_context = new ScanContext(schema);
+    MergeScannerPtr mscanner = new MergeScanner(scan_context, !in_memory, true);
+    mscanner->add_scanner(m_immutable_cache->create_scanner(scan_context));
+    compacted_cache = new CellCache();
+    while (mscanner->get(key, value)) {
+      compacted_cache->add(key, value);
+      mscanner->forward();
+    }
+    compacted_cache->mark_compacted();
+  }
+  catch (Exception &e) {
+    ScopedLock lock(m_mutex);
+    merge_caches(false);
+    throw;
+  }
+
+  ScopedLock lock(m_mutex);
+
+  cells_before = m_immutable_cache->size();
+  memory_before = m_immutable_cache->memory_allocated();
+  memory_after = compacted_cache->memory_allocated();
+
+  // Fold in the updates that arrived during the rebuild
+  if (m_cell_cache) {
+    ScanContextPtr scan_context = new ScanContext(m_schema);
+    memory_before += m_cell_cache->memory_allocated();
+    cells_before += m_cell_cache->size();
+    scanner = m_cell_cache->create_scanner(scan_context);
+    while (scanner->get(key, value)) {
+      compacted_cache->add(key, value);
+      scanner->forward();
+    }
+    memory_after = compacted_cache->memory_allocated();
+  }
+
+  HT_INFOF("Compacted CellCache of %s from %llu to %llu cells",
+           m_full_name.c_str(), (Llu)cells_before,
+           (Llu)compacted_cache->size());
+
+  m_cell_cache = compacted_cache;
+  m_immutable_cache = 0;
+
+  return memory_before > memory_after ? memory_before - memory_after : 0;
+}
+
+
+size_t AccessGroup::write_immutable_cache(CommitLog *log) {
+  Key key;
+  ByteString value;
+  DynamicBuffer buf;
+  int64_t revision = TIMESTAMP_MIN;
+  size_t count = 0;
+  int error;
+
+  if (!m_immutable_cache)
+    return 0;
+
+  ScanContextPtr scan_context = new ScanContext(m_schema);
+  CellListScannerPtr scanner = m_immutable_cache->create_scanner(scan_context);
+
+  while (scanner->get(key, value)) {
+    if (buf.empty()) {
+      buf.reserve(m_identifier.encoded_length());
+      m_identifier.encode(&buf.ptr);
+    }
+    buf.ensure(key.length + value.length());
+    buf.add_unchecked(key.serial.ptr, key.length);
+    buf.add_unchecked(value.ptr, value.length());
+    if (key.revision > revision)
+      revision = key.revision;
+    count++;
+    if (buf.fill() >= CACHE_LOG_BLOCK_SIZE) {
+      if ((error = log->write(buf, revision, false)) != Error::OK)
+        HT_THROWF(error, "Problem writing cell cache of %s to '%s'",
+                  m_full_name.c_str(), log->get_log_dir().c_str());
+      buf.clear();
+      revision = TIMESTAMP_MIN;
+    }
+    scanner->forward();
+  }
+
+  if (!buf.empty() && (error = log->write(buf, revision, false)) != Error::OK)
+    HT_THROWF(error, "Problem writing cell cache of %s to '%s'",
+              m_full_name.c_str(), log->get_log_dir().c_str());
+
+  return count;
+}
+
+
 AccessGroup::MaintenanceData *AccessGroup::get_maintenance_data(ByteArena &arena, time_t now) {
   ScopedLock lock(m_mutex);
   MaintenanceData *mdata = (MaintenanceData *)arena.alloc(sizeof(MaintenanceData));
@@ -397,8 +564,8 @@ AccessGroup::MaintenanceData *AccessGroup::get_maintenance_data(ByteArena &arena
   mdata->compression_ratio = (m_compression_ratio == 0.0) ? 1.0 : m_compression_ratio;
   mdata->cell_count = mdata->cached_items + mdata->immutable_items;
 
-  mdata->disk_used = m_disk_usage;
-  int64_t du = m_in_memory ? 0 : m_disk_usage;
+  mdata->disk_used = m_disk_usage + m_blob_disk_usage;
+  int64_t du = m_in_memory ? 0 : mdata->disk_used;
   mdata->disk_estimate = du + (int64_t)(m_compression_ratio * (float)mu);
   mdata->outstanding_scanners = m_outstanding_scanner_count;
   mdata->in_memory = m_in_memory;
@@ -442,6 +609,9 @@ AccessGroup::MaintenanceData *AccessGroup::get_maintenance_data(ByteArena &arena
     (*tailp)->maintenance_flags = 0;
     (*tailp)->next = 0;
 
+    if (cell_store_expired(m_stores[i], (int64_t)now * 1000000000LL))
+      mdata->expired_files++;
+
     mdata->shadow_cache_memory += (*tailp)->shadow_cache_size;
   }
   mdata->file_count = m_stores.size();
@@ -449,6 +619,15 @@ AccessGroup::MaintenanceData *AccessGroup::get_maintenance_data(ByteArena &arena
   mdata->gc_needed = m_garbage_tracker.check_needed(mdata->deletes, mdata->mem_used, now);
   mdata->needs_merging = m_needs_merging;
 
+  if (m_cell_cache && !m_immutable_cache && !m_has_counters &&
+      Global::cell_cache_compaction_threshold > 0 &&
+      mdata->mem_used >= Global::cell_cache_compaction_min_memory &&
+      mdata->cached_items > 0) {
+    int64_t garbage = m_cell_cache->get_garbage_estimate(m_single_version);
+    mdata->cellcache_compaction_needed = garbage * 100 >=
+      (int64_t)Global::cell_cache_compaction_threshold * mdata->cached_items;
+  }
+
   mdata->maintenance_flags = 0;
 
   return mdata;
@@ -487,6 +666,58 @@ void AccessGroup::add_cell_store(CellStorePtr &cellstore) {
   m_file_tracker.add_live_noupdate(cellstore->get_filename());
 }
 
+
+/**
+ * Registers a blob log file listed in the 'Files' column.  Until the next
+ * major compaction measures it, all of its data is assumed to be live.
+ */
+void AccessGroup::add_blob_file(const String &fname) {
+  int64_t length = Global::dfs->length(fname);
+  ScopedLock lock(m_mutex);
+  m_blob_files[fname] = BlobLogInfo(length, length);
+  update_blob_stats();
+  m_file_tracker.add_live_noupdate(fname);
+}
+
+/**
+ * Installs a CellStore that was built outside of the RangeServer (bulk
+ * load).  Returns false if the file already belongs to this access group,
+ * which makes re-adoption after a crash a no-op.
+ */
+bool AccessGroup::adopt_cell_store(CellStorePtr &cellstore,
+                                   bool update_metadata) {
+  {
+    ScopedLock lock(m_mutex);
+    for (size_t i=0; i<m_stores.size(); i++) {
+      if (m_stores[i].cs->get_filename() == cellstore->get_filename())
+        return false;
+    }
+  }
+
+  add_cell_store(cellstore);
+
+  {
+    ScopedLock lock(m_mutex);
+    m_needs_merging = find_merge_run();
+  }
+
+  if (update_metadata)
+    sync_files_column();
+
+  return true;
+}
+
+
+/**
+ * Forces the 'Files' column to be rewritten from the live file set
+ */
+void AccessGroup::sync_files_column() {
+  std::vector<String> removed_files;
+  m_file_tracker.update_live("", removed_files, m_next_cs_id);
+  m_file_tracker.update_files_column();
+}
+
+
 void AccessGroup::compute_garbage_stats(uint64_t *input_bytesp, uint64_t *output_bytesp) {
   ScanContextPtr scan_context = new ScanContext(m_schema);
   MergeScannerPtr mscanner = new MergeScanner(scan_context, false, true);
@@ -498,7 +729,8 @@ void AccessGroup::compute_garbage_stats(uint64_t *input_bytesp, uint64_t *output
   if (!m_in_memory) {
     for (size_t i=0; i<m_stores.size(); i++) {
       HT_ASSERT(m_stores[i].cs);
-      mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context));
+      mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context),
+                            m_stores[i].blob_references);
     }
   }
 
@@ -527,6 +759,9 @@ void AccessGroup::run_compaction(int maintenance_flags) {
   bool garbage_check_performed = false;
   size_t merge_offset=0, merge_length=0;
   String added_file;
+  BlobLogWriterPtr blob_writer;
+  std::vector<CellStorePtr> replaced_stores;
+  CellStore::RowIntervals hot_rows;
 
   while (abort_loop) {
     ScopedLock lock(m_mutex);
@@ -581,7 +816,7 @@ void AccessGroup::run_compaction(int maintenance_flags) {
 
   try {
 
-    String cs_file;
+    String cs_file, blob_file;
 
     int64_t max_num_entries = 0;
 
@@ -593,7 +828,12 @@ void AccessGroup::run_compaction(int maintenance_flags) {
                        Global::toplevel_dir.c_str(),
                        m_identifier.id, m_name.c_str(),
                        m_range_dir.c_str(),
-                       m_next_cs_id++);
+                       m_next_cs_id);
+      blob_file = format("%s/tables/%s/%s/%s/bl%d",
+                         Global::toplevel_dir.c_str(),
+                         m_identifier.id, m_name.c_str(),
+                         m_range_dir.c_str(),
+                         m_next_cs_id++);
 
       /**
        * Check for garbage and if threshold reached, change minor to major
@@ -620,6 +860,26 @@ void AccessGroup::run_compaction(int maintenance_flags) {
         }
       }
 
+      /**
+       * Values at or above the blob threshold are separated into a blob
+       * log written alongside the CellStore.  Major and GC compactions
+       * also relocate the live values out of blob logs with too much
+       * garbage.
+       */
+      if (!m_in_memory && (m_blob_threshold > 0 || !m_blob_files.empty())) {
+        std::set<String> rewrite_files;
+        if (major || gc) {
+          foreach(const BlobLogInfoMap::value_type &v, m_blob_files) {
+            if (v.second.rewrite)
+              rewrite_files.insert(v.first);
+          }
+        }
+        int32_t replication = m_cellstore_props->get_i32("replication", -1);
+        blob_writer = new BlobLogWriter(Global::dfs.get(), m_schema, blob_file,
+                                        m_blob_threshold, replication,
+                                        rewrite_files);
+      }
+
       cellstore = new CellStoreV5(Global::dfs.get(), m_schema.get());
 
       max_num_entries = m_immutable_cache ? m_immutable_cache->size() : 0;
@@ -636,10 +896,12 @@ void AccessGroup::run_compaction(int maintenance_flags) {
         max_num_entries = 0;
         for (size_t i=merge_offset; i<merge_offset+merge_length; i++) {
           HT_ASSERT(m_stores[i].cs);
-          mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context));
+          mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context),
+                                m_stores[i].blob_references);
           int divisor = (boost::any_cast<uint32_t>(m_stores[i].cs->get_trailer()->get("flags")) & CellStoreTrailerV5::SPLIT) ? 2: 1;
           max_num_entries += (boost::any_cast<int64_t>
               (m_stores[i].cs->get_trailer()->get("total_entries")))/divisor;
+          replaced_stores.push_back(m_stores[i].cs);
         }
       }
       else if (major || gc) {
@@ -649,19 +911,43 @@ void AccessGroup::run_compaction(int maintenance_flags) {
           mscanner->add_scanner(m_immutable_cache->create_scanner(scan_context));
         for (size_t i=0; i<m_stores.size(); i++) {
           HT_ASSERT(m_stores[i].cs);
-          mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context));
+          mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_context),
+                                m_stores[i].blob_references);
           int divisor = (boost::any_cast<uint32_t>(m_stores[i].cs->get_trailer()->get("flags")) & CellStoreTrailerV5::SPLIT) ? 2: 1;
           max_num_entries += (boost::any_cast<int64_t>
               (m_stores[i].cs->get_trailer()->get("total_entries")))/divisor;
+          replaced_stores.push_back(m_stores[i].cs);
         }
       }
       else
         scanner = m_immutable_cache->create_scanner(scan_context);
+
+      // Without a blob writer, references must be materialized
+      if (mscanner)
+        mscanner->set_resolve_blobs(!blob_writer);
     }
 
+    /**
+     * Remember which rows of the replaced CellStores are hot in the block
+     * cache so that the corresponding blocks of the new CellStore can be
+     * loaded before it is installed.  Otherwise the first reads after a
+     * merging or major compaction all miss the cache.
+     */
+    if (Global::block_cache && Global::block_cache_warmup_budget > 0) {
+      foreach(CellStorePtr &cs, replaced_stores)
+        cs->get_cached_row_intervals(hot_rows);
+    }
+    replaced_stores.clear();
+
     cellstore->create(cs_file.c_str(), max_num_entries, m_cellstore_props);
 
     while (scanner->get(key, value)) {
+      if (blob_writer) {
+        if (mscanner && mscanner->current_is_blob_reference())
+          value = blob_writer->add_reference(value);
+        else
+          value = blob_writer->add(key, value);
+      }
       cellstore->add(key, value);
       if (m_in_memory)
         filtered_cache->add(key, value);
@@ -676,12 +962,32 @@ void AccessGroup::run_compaction(int maintenance_flags) {
     if (maintenance_flags & MaintenanceFlag::SPLIT)
       trailer->flags |= CellStoreTrailerV5::SPLIT;
 
+    if (blob_writer) {
+      blob_writer->close();
+      if (!blob_writer->get_referenced_bytes().empty())
+        trailer->flags |= CellStoreTrailerV5::BLOB_REFERENCES;
+    }
+
     cellstore->finalize(&m_identifier);
 
+    if (!hot_rows.empty()) {
+      try {
+        int64_t warmed = cellstore->warm_block_cache(hot_rows,
+                                    Global::block_cache_warmup_budget);
+        HT_INFOF("Loaded %lld bytes of %s into block cache (%d hot row intervals)",
+                 (Lld)warmed, cs_file.c_str(), (int)hot_rows.size());
+      }
+      catch (Exception &e) {
+        HT_WARN_OUT << "Problem warming block cache for " << cs_file
+                    << " - " << e << HT_END;
+      }
+    }
+
     /**
      * Install new CellCache and CellStore and update Live file tracker
      */
     std::vector<String> removed_files;
+    std::vector<String> removed_blob_files;
     {
       ScopedLock lock(m_mutex);
 
@@ -765,9 +1071,48 @@ void AccessGroup::run_compaction(int maintenance_flags) {
         }
       }
 
+      if (blob_writer) {
+        std::map<String, int64_t> &referenced = blob_writer->get_referenced_bytes();
+
+        /**
+         * After a major or GC compaction the new CellStore holds every
+         * reference, so live blob bytes are known exactly.  Drop blob logs
+         * that are no longer referenced and schedule the ones with too
+         * much garbage for rewrite.
+         */
+        if ((major || gc) && mscanner) {
+          BlobLogInfoMap::iterator iter = m_blob_files.begin();
+          while (iter != m_blob_files.end()) {
+            std::map<String, int64_t>::iterator refiter = referenced.find(iter->first);
+            if (refiter == referenced.end() || cellstore == 0) {
+              removed_files.push_back(iter->first);
+              removed_blob_files.push_back(iter->first);
+              m_blob_files.erase(iter++);
+              continue;
+            }
+            iter->second.live = refiter->second;
+            iter->second.rewrite = iter->second.size > 0 &&
+              ((double)(iter->second.size - iter->second.live) * 100.0 /
+               (double)iter->second.size) >=
+              (double)Global::access_group_garbage_compaction_threshold;
+            ++iter;
+          }
+        }
+
+        if (blob_writer->created()) {
+          m_blob_files[blob_file] = BlobLogInfo(blob_writer->length(),
+                                                referenced[blob_file]);
+          m_file_tracker.add_live_noupdate(blob_file);
+        }
+        update_blob_stats();
+      }
+
       recompute_compression_ratio();
     }
 
+    foreach(const String &fname, removed_blob_files)
+      BlobLog::close_file(fname);
+
     m_file_tracker.update_live(added_file, removed_files, m_next_cs_id);
     m_file_tracker.update_files_column();
 
@@ -789,6 +1134,44 @@ void AccessGroup::run_compaction(int maintenance_flags) {
 
 
 
+/**
+ * Removes CellStores in which every cell has outlived its column family's
+ * TTL.  Such files are dropped from the store vector and the 'Files'
+ * column directly instead of being rewritten by a GC compaction.
+ */
+void AccessGroup::drop_expired_cell_stores() {
+  std::vector<String> removed_files;
+  int64_t now = get_ts64();
+
+  {
+    ScopedLock lock(m_mutex);
+    std::vector<CellStoreInfo> live_stores;
+
+    for (size_t i=0; i<m_stores.size(); i++) {
+      if (cell_store_expired(m_stores[i], now)) {
+        removed_files.push_back(m_stores[i].cs->get_filename());
+        m_garbage_tracker.accumulate_expirable(-m_stores[i].expirable_data);
+      }
+      else
+        live_stores.push_back(m_stores[i]);
+    }
+
+    if (removed_files.empty())
+      return;
+
+    m_stores.swap(live_stores);
+    recompute_compression_ratio();
+    m_needs_merging = find_merge_run();
+  }
+
+  m_file_tracker.update_live("", removed_files, m_next_cs_id);
+  m_file_tracker.update_files_column();
+
+  HT_INFOF("Dropped %d expired CellStores from %s", (int)removed_files.size(),
+           m_full_name.c_str());
+}
+
+
 /**
  *
  */
@@ -1039,6 +1422,68 @@ void AccessGroup::recompute_compression_ratio() {
 }
 
 
+void AccessGroup::update_blob_stats() {
+  int64_t total = 0;
+  m_blob_disk_usage = 0;
+  foreach(const BlobLogInfoMap::value_type &v, m_blob_files) {
+    total += v.second.size;
+    m_blob_disk_usage += v.second.live;
+  }
+  m_garbage_tracker.set_blob_stats(total, m_blob_disk_usage);
+}
+
+
+/**
+ * Records the largest TTL of the live column families, or zero if any of
+ * them keeps its cells forever, in which case no CellStore can expire
+ */
+void AccessGroup::compute_max_ttl(Schema::AccessGroup *ag) {
+  m_max_ttl = 0;
+  foreach(Schema::ColumnFamily *cf, ag->columns) {
+    if (cf->deleted)
+      continue;
+    if (cf->ttl == 0) {
+      m_max_ttl = 0;
+      return;
+    }
+    if ((int64_t)cf->ttl * 1000000000LL > m_max_ttl)
+      m_max_ttl = (int64_t)cf->ttl * 1000000000LL;
+  }
+}
+
+
+/**
+ * Records whether every live column family keeps a single version, in
+ * which case each overwritten cell in the cell cache is garbage, and
+ * whether any of them is a counter, which rules out rebuilding the cell
+ * cache.  With larger version limits an overwrite is only garbage once the
+ * limit is exceeded, which the cell cache does not track.
+ */
+void AccessGroup::compute_version_limits(Schema::AccessGroup *ag) {
+  m_single_version = true;
+  m_has_counters = ag->counter;
+  foreach(Schema::ColumnFamily *cf, ag->columns) {
+    if (cf->deleted)
+      continue;
+    if (cf->max_versions != 1)
+      m_single_version = false;
+    if (cf->counter)
+      m_has_counters = true;
+  }
+}
+
+
+/**
+ * A CellStore has expired when its newest timestamp is older than the
+ * largest TTL allows.  Only files with exact timestamp bounds qualify.
+ */
+bool AccessGroup::cell_store_expired(const CellStoreInfo &csinfo, int64_t now) {
+  if (m_in_memory || m_max_ttl == 0 || !csinfo.timestamp_bounds ||
+      csinfo.cell_count == 0)
+    return false;
+  return csinfo.timestamp_max < now - m_max_ttl;
+}
+
 bool AccessGroup::find_merge_run(size_t *indexp, size_t *lenp) {
   size_t index = 0;
   size_t count = 0;
@@ -1210,5 +1655,8 @@ std::ostream &Hypertable::operator<<(std::ostream &os, const AccessGroup::Mainte
   os << "in_memory=" << (mdata.in_memory ? "true" : "false") << "\n";
   os << "gc_needed=" << (mdata.gc_needed ? "true" : "false") << "\n";
   os << "needs_merging=" << (mdata.needs_merging ? "true" : "false") << "\n";
+  os << "cellcache_compaction_needed="
+     << (mdata.cellcache_compaction_needed ? "true" : "false") << "\n";
+  os << "expired_files=" << mdata.expired_files << "\n";
   return os;
 }
@@ -41,6 +41,7 @@
 #include "Hypertable/Lib/Types.h"
 
 #include "AccessGroupGarbageTracker.h"
+#include "BlobLog.h"
 #include "CellCache.h"
 #include "CellStore.h"
 #include "CellStoreTrailerV5.h"
@@ -51,6 +52,8 @@
 
 namespace Hypertable {
 
+  class CommitLog;
+
   class AccessGroup : public CellList {
 
   public:
@@ -86,6 +89,7 @@ namespace Hypertable {
       int64_t key_bytes;
       int64_t value_bytes;
       uint32_t file_count;
+      uint32_t expired_files;
       int32_t deletes;
       int32_t outstanding_scanners;
       float    compression_ratio;
@@ -99,6 +103,7 @@ namespace Hypertable {
       bool     in_memory;
       bool     gc_needed;
       bool     needs_merging;
+      bool     cellcache_compaction_needed;
     };
 
     AccessGroup(const TableIdentifier *identifier, SchemaPtr &schema,
@@ -107,8 +112,15 @@ namespace Hypertable {
     virtual void add(const Key &key, const ByteString value);
 
     virtual const char *get_split_row();
-    virtual void get_split_rows(std::vector<String> &split_rows,
-                                bool include_cache);
+    /**
+     * Appends the byte weighted row samples of the cell stores, and
+     * optionally of the cell caches, to <code>samples</code>.
+     *
+     * @param samples vector to append samples to
+     * @param include_cache include samples of the cell caches
+     */
+    virtual void get_split_row_samples(SplitRowSampler::SampleVector &samples,
+                                       bool include_cache);
     virtual void get_cached_rows(std::vector<String> &rows);
 
     virtual int64_t get_total_entries() {
@@ -145,13 +157,43 @@ namespace Hypertable {
     uint64_t memory_usage();
     void space_usage(int64_t *memp, int64_t *diskp);
     void add_cell_store(CellStorePtr &cellstore);
+    void add_blob_file(const String &fname);
+    bool adopt_cell_store(CellStorePtr &cellstore, bool update_metadata);
+    void sync_files_column();
+
+    bool in_memory() { return m_in_memory; }
 
     void compute_garbage_stats(uint64_t *input_bytesp, uint64_t *output_bytesp);
 
     void run_compaction(int maintenance_flags);
 
+    void drop_expired_cell_stores();
+
     uint64_t purge_memory(MaintenanceFlag::Map &subtask_map);
 
+    /**
+     * Rebuilds the cell cache in memory, dropping versions beyond
+     * max_versions, expired cells and cells masked by deletes.  Deletes
+     * themselves are kept unless the access group is in memory, since
+     * they may still mask cells in the CellStores.  Updates that arrive
+     * during the rebuild go to a fresh cell cache and are folded into
+     * the result.
+     *
+     * @return number of bytes of memory freed
+     */
+    uint64_t compact_cell_cache();
+
+    /**
+     * Writes the cells of the immutable (staged) cache to
+     * <code>log</code> in the block format of the transfer log.  This
+     * lets a relinquished range carry its cached cells to the destination
+     * server instead of compacting them into a CellStore.
+     *
+     * @param log commit log to write to
+     * @return number of cells written
+     */
+    size_t write_immutable_cache(CommitLog *log);
+
     MaintenanceData *get_maintenance_data(ByteArena &arena, time_t now);
 
     void stage_compaction();
@@ -204,6 +246,10 @@ namespace Hypertable {
     bool find_merge_run(size_t *indexp=0, size_t *lenp=0);
     bool needs_merging();
     void sort_cellstores_by_timestamp();
+    void update_blob_stats();
+    void compute_max_ttl(Schema::AccessGroup *ag);
+    void compute_version_limits(Schema::AccessGroup *ag);
+    bool cell_store_expired(const CellStoreInfo &csinfo, int64_t now);
 
     Mutex                m_mutex;
     Mutex                m_outstanding_scanner_mutex;
@@ -218,18 +264,23 @@ namespace Hypertable {
     String               m_start_row;
     String               m_end_row;
     String               m_range_name;
+    String               m_split_row;
     std::vector<CellStoreInfo> m_stores;
     PropertiesPtr        m_cellstore_props;
     CellCachePtr         m_cell_cache;
     CellCachePtr         m_immutable_cache;
     uint32_t             m_next_cs_id;
     uint64_t             m_disk_usage;
+    uint64_t             m_blob_disk_usage;
+    uint32_t             m_blob_threshold;
+    BlobLogInfoMap       m_blob_files;
     float                m_compression_ratio;
     int64_t              m_compaction_revision;
     int64_t              m_earliest_cached_revision;
     int64_t              m_earliest_cached_revision_saved;
     int64_t              m_latest_stored_revision;
     uint64_t             m_collisions;
+    int64_t              m_max_ttl;
     LiveFileTracker      m_file_tracker;
     AccessGroupGarbageTracker m_garbage_tracker;
     bool                 m_is_root;
@@ -237,6 +288,8 @@ namespace Hypertable {
     bool                 m_recovering;
     bool                 m_bloom_filter_disabled;
     bool                 m_needs_merging;
+    bool                 m_single_version;
+    bool                 m_has_counters;
 
   };
   typedef boost::intrusive_ptr<AccessGroup> AccessGroupPtr;
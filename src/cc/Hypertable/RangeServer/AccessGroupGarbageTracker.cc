@@ -35,7 +35,8 @@ using namespace Config;
 AccessGroupGarbageTracker::AccessGroupGarbageTracker()
   : m_elapsed_target(0), m_minimum_elapsed_target(0), m_delete_count(0),
     m_expirable_accumulated(0), m_data_accumulated(0), m_min_ttl(0),
-    m_max_ttl(0), m_last_cache_size(-1), m_in_memory(false),
+    m_max_ttl(0), m_last_cache_size(-1), m_blob_total(0), m_blob_live(0),
+    m_in_memory(false),
     m_have_max_versions(false), m_need_collection(false) {
   m_minimum_data_target = properties->get_i64("Hypertable.RangeServer.Range.SplitSize") / 10;
   m_data_target = m_minimum_data_target;
@@ -79,10 +80,19 @@ void AccessGroupGarbageTracker::clear(time_t now) {
 }
 
 
+bool AccessGroupGarbageTracker::blob_collection_needed() {
+  if (m_blob_total <= 0 || m_blob_live >= m_blob_total)
+    return false;
+  double garbage_pct = ((double)(m_blob_total-m_blob_live)/(double)m_blob_total)*100.0;
+  return garbage_pct >= (double)Global::access_group_garbage_compaction_threshold;
+}
+
+
 bool AccessGroupGarbageTracker::check_needed(int64_t cached_data, time_t now) {
   if (now == 0)
     now = time(0);
-  if (((m_have_max_versions || m_delete_count > 0) &&
+  if (blob_collection_needed() ||
+      ((m_have_max_versions || m_delete_count > 0) &&
        m_data_accumulated >= m_data_target) ||
       ((m_expirable_accumulated+cached_data) >= m_minimum_data_target &&
        m_min_ttl > 0 && (now-m_last_clear_time) >= m_elapsed_target))
@@ -100,7 +110,8 @@ bool AccessGroupGarbageTracker::check_needed(uint32_t additional_deletes,
       m_last_cache_size = cached_data;
     additional_data = cached_data - m_last_cache_size;
   }
-  if (((m_have_max_versions || (m_delete_count+additional_deletes) > 0)
+  if (blob_collection_needed() ||
+      ((m_have_max_versions || (m_delete_count+additional_deletes) > 0)
        && additional_data > 0
        && (m_data_accumulated+additional_data) >= m_data_target) ||
       ((m_expirable_accumulated+cached_data) >= m_minimum_data_target 
@@ -72,7 +72,29 @@ namespace Hypertable {
      */
     void set_garbage_stats(int64_t total, int64_t valid, time_t now=0);
 
-    bool need_collection() { return m_need_collection; }
+    /**
+     * Sets the blob log statistics.  <i>total</i> is the combined size
+     * of the blob log files referenced by the access group and
+     * <i>live</i> is the number of those bytes still referenced by
+     * its CellStores.
+     *
+     * @param total total size of blob log files
+     * @param live amount of blob data that is still referenced
+     */
+    void set_blob_stats(int64_t total, int64_t live) {
+      m_blob_total = total;
+      m_blob_live = live;
+    }
+
+    /**
+     * Returns true if the blob log garbage has reached the garbage
+     * compaction threshold
+     */
+    bool blob_collection_needed();
+
+    bool need_collection() {
+      return m_need_collection || blob_collection_needed();
+    }
 
     int64_t current_target() { return m_data_target; }
     
@@ -90,6 +112,8 @@ namespace Hypertable {
     int64_t m_min_ttl;
     int64_t m_max_ttl;
     int64_t m_last_cache_size;
+    int64_t m_blob_total;
+    int64_t m_blob_live;
     bool m_in_memory;
     bool m_have_max_versions;
     bool m_need_collection;
@@ -0,0 +1,344 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Checksum.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+#include "Common/StaticBuffer.h"
+
+#include "BlobLog.h"
+#include "Global.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  /**
+   * Blob reference layout (ByteString payload):
+   *
+   *   magic            5 bytes
+   *   version          1 byte
+   *   data checksum    4 bytes (fletcher32 of the blob)
+   *   offset           8 bytes
+   *   length           4 bytes
+   *   file name        vstr (relative to toplevel dir)
+   *   header checksum  4 bytes (fletcher32 of all preceding bytes)
+   */
+  const uint8_t BLOB_MAGIC[5] = { 0xB7, 0x0B, 'B', 'L', 'B' };
+  const uint8_t BLOB_VERSION = 1;
+  const size_t BLOB_FIXED_LENGTH = 5 + 1 + 4 + 8 + 4 + 4;
+  const size_t BLOB_MAX_REFERENCE_LENGTH = 1024;
+  const size_t BLOB_WRITE_BUFFER_SIZE = 1024 * 1024;
+  const size_t BLOB_FD_CACHE_LIMIT = 256;
+
+  String strip_toplevel(const String &fname) {
+    const String &top = Global::toplevel_dir;
+    if (!top.empty() && fname.compare(0, top.length(), top) == 0) {
+      size_t off = top.length();
+      while (off < fname.length() && fname[off] == '/')
+        off++;
+      return fname.substr(off);
+    }
+    return fname;
+  }
+
+}
+
+Mutex BlobLog::ms_mutex;
+BlobLog::FdMap BlobLog::ms_fd_map;
+std::vector<BlobLog::OpenFile> BlobLog::ms_closing;
+
+
+bool BlobLog::decode_reference(const ByteString value, Reference &ref) {
+  const uint8_t *ptr = value.ptr;
+  size_t len, remain;
+
+  if (ptr == 0)
+    return false;
+
+  len = value.decode_length(&ptr);
+
+  if (len < BLOB_FIXED_LENGTH + 1 || len > BLOB_MAX_REFERENCE_LENGTH)
+    return false;
+
+  if (memcmp(ptr, BLOB_MAGIC, sizeof(BLOB_MAGIC)) ||
+      ptr[sizeof(BLOB_MAGIC)] != BLOB_VERSION)
+    return false;
+
+  const uint8_t *base = ptr;
+  const uint8_t *checksum_ptr = base + len - 4;
+  remain = 4;
+  if (fletcher32(base, len - 4) !=
+      Serialization::decode_i32(&checksum_ptr, &remain))
+    return false;
+
+  ptr += sizeof(BLOB_MAGIC) + 1;
+  remain = len - (sizeof(BLOB_MAGIC) + 1) - 4;
+
+  try {
+    ref.checksum = Serialization::decode_i32(&ptr, &remain);
+    ref.offset = Serialization::decode_i64(&ptr, &remain);
+    ref.length = Serialization::decode_i32(&ptr, &remain);
+    ref.fname = Serialization::decode_vstr(&ptr, &remain, &ref.fname_len);
+  }
+  catch (Exception &e) {
+    return false;
+  }
+
+  return remain == 0;
+}
+
+
+void BlobLog::encode_reference(DynamicBuffer &dst, const String &fname,
+                               uint64_t offset, uint32_t length,
+                               uint32_t checksum) {
+  size_t len = BLOB_FIXED_LENGTH + Serialization::encoded_length_vstr(fname);
+
+  dst.ensure(len + Serialization::encoded_length_vi32(len));
+  Serialization::encode_vi32(&dst.ptr, len);
+  uint8_t *base = dst.ptr;
+  memcpy(dst.ptr, BLOB_MAGIC, sizeof(BLOB_MAGIC));
+  dst.ptr += sizeof(BLOB_MAGIC);
+  *dst.ptr++ = BLOB_VERSION;
+  Serialization::encode_i32(&dst.ptr, checksum);
+  Serialization::encode_i64(&dst.ptr, offset);
+  Serialization::encode_i32(&dst.ptr, length);
+  Serialization::encode_vstr(&dst.ptr, fname);
+  Serialization::encode_i32(&dst.ptr, fletcher32(base, dst.ptr - base));
+}
+
+
+void BlobLog::read(const Reference &ref, DynamicBuffer &dst) {
+  String fname = Global::toplevel_dir + "/" + String(ref.fname, ref.fname_len);
+  size_t nread;
+
+  dst.clear();
+  dst.ensure(ref.length + Serialization::encoded_length_vi32(ref.length));
+  Serialization::encode_vi32(&dst.ptr, ref.length);
+
+  int32_t fd = acquire_fd(fname);
+  try {
+    nread = Global::dfs->pread(fd, dst.ptr, ref.length, ref.offset);
+  }
+  catch (Exception &e) {
+    release_fd(fname, fd);
+    throw;
+  }
+  release_fd(fname, fd);
+
+  if (nread != ref.length)
+    HT_THROWF(Error::RANGESERVER_SHORT_CELLSTORE_READ,
+              "Short read of blob at offset %llu in '%s' (%lu != %lu)",
+              (Llu)ref.offset, fname.c_str(), (Lu)nread, (Lu)ref.length);
+
+  if (fletcher32(dst.ptr, ref.length) != ref.checksum)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+              "Blob checksum mismatch at offset %llu in '%s'",
+              (Llu)ref.offset, fname.c_str());
+
+  dst.ptr += ref.length;
+}
+
+
+void BlobLog::close_file(const String &fname) {
+  ScopedLock lock(ms_mutex);
+  FdMap::iterator iter = ms_fd_map.find(fname);
+  if (iter != ms_fd_map.end()) {
+    if (iter->second.readers == 0)
+      close_fd(fname, iter->second.fd);
+    else {
+      iter->second.closing = true;
+      ms_closing.push_back(iter->second);
+    }
+    ms_fd_map.erase(iter);
+  }
+}
+
+
+int32_t BlobLog::acquire_fd(const String &fname) {
+  ScopedLock lock(ms_mutex);
+  FdMap::iterator iter = ms_fd_map.find(fname);
+
+  if (iter == ms_fd_map.end()) {
+    // Evict idle descriptors; busy ones are closed by their last reader
+    if (ms_fd_map.size() >= BLOB_FD_CACHE_LIMIT) {
+      for (iter = ms_fd_map.begin(); iter != ms_fd_map.end(); ++iter) {
+        if (iter->second.readers == 0)
+          close_fd(iter->first, iter->second.fd);
+        else {
+          iter->second.closing = true;
+          ms_closing.push_back(iter->second);
+        }
+      }
+      ms_fd_map.clear();
+    }
+    OpenFile of;
+    of.fd = Global::dfs->open(fname, 0);
+    iter = ms_fd_map.insert(FdMap::value_type(fname, of)).first;
+  }
+  iter->second.readers++;
+  return iter->second.fd;
+}
+
+
+void BlobLog::release_fd(const String &fname, int32_t fd) {
+  ScopedLock lock(ms_mutex);
+  FdMap::iterator iter = ms_fd_map.find(fname);
+
+  if (iter != ms_fd_map.end() && iter->second.fd == fd) {
+    iter->second.readers--;
+    return;
+  }
+
+  for (size_t i=0; i<ms_closing.size(); i++) {
+    if (ms_closing[i].fd == fd) {
+      if (--ms_closing[i].readers == 0) {
+        close_fd(fname, fd);
+        ms_closing.erase(ms_closing.begin() + i);
+      }
+      return;
+    }
+  }
+}
+
+
+void BlobLog::close_fd(const String &fname, int32_t fd) {
+  try { Global::dfs->close(fd); }
+  catch (Exception &e) {
+    HT_WARNF("Problem closing blob log '%s' - %s", fname.c_str(),
+             Error::get_text(e.code()));
+  }
+}
+
+
+bool BlobLog::is_blob_file(const String &fname) {
+  size_t base = fname.find_last_of('/');
+  base = (base == String::npos) ? 0 : base + 1;
+  return fname.compare(base, 2, "bl") == 0;
+}
+
+
+BlobLogWriter::BlobLogWriter(Filesystem *fs, SchemaPtr &schema,
+                             const String &fname, uint32_t threshold,
+                             int32_t replication,
+                             const std::set<String> &rewrite_files)
+  : m_filesys(fs), m_schema(schema), m_filename(fname),
+    m_threshold(threshold), m_replication(replication), m_fd(-1),
+    m_offset(0), m_rewrite_files(rewrite_files) {
+  m_relative_name = strip_toplevel(m_filename);
+}
+
+
+BlobLogWriter::~BlobLogWriter() {
+  if (m_fd != -1) {
+    try { m_filesys->close(m_fd); }
+    catch (Exception &e) {
+      HT_ERROR_OUT << "Problem closing blob log '" << m_filename << "' - "
+                   << e << HT_END;
+    }
+  }
+}
+
+
+ByteString BlobLogWriter::add(const Key &key, const ByteString value) {
+  size_t len;
+  const uint8_t *ptr;
+
+  if (key.flag != FLAG_INSERT || m_schema->column_is_counter(key.column_family_code))
+    return value;
+
+  ptr = value.ptr;
+  len = value.decode_length(&ptr);
+
+  // Values that happen to look like references are always separated so that
+  // they are never misinterpreted on read
+  if ((m_threshold == 0 || len < m_threshold) &&
+      !BlobLog::is_reference(value))
+    return value;
+
+  return append(ptr, len, fletcher32(ptr, len));
+}
+
+
+ByteString BlobLogWriter::add_reference(const ByteString value) {
+  BlobLog::Reference ref;
+
+  if (!BlobLog::decode_reference(value, ref))
+    return value;
+
+  String fname = Global::toplevel_dir + "/" + String(ref.fname, ref.fname_len);
+
+  if (m_rewrite_files.count(fname)) {
+    BlobLog::read(ref, m_value);
+    ByteString resolved;
+    resolved.ptr = m_value.base;
+    const uint8_t *ptr = resolved.ptr;
+    size_t len = resolved.decode_length(&ptr);
+    return append(ptr, len, ref.checksum);
+  }
+
+  m_referenced[fname] += ref.length;
+  return value;
+}
+
+
+ByteString BlobLogWriter::append(const uint8_t *data, uint32_t len,
+                                 uint32_t checksum) {
+  ByteString reference;
+
+  if (m_fd == -1)
+    m_fd = m_filesys->create(m_filename, Filesystem::OPEN_FLAG_OVERWRITE,
+                             -1, m_replication, -1);
+
+  if (m_buffer.fill() && m_buffer.fill() + len > BLOB_WRITE_BUFFER_SIZE)
+    flush_buffer();
+
+  m_buffer.ensure(len);
+  m_buffer.add_unchecked(data, len);
+
+  m_reference.clear();
+  BlobLog::encode_reference(m_reference, m_relative_name, m_offset, len,
+                            checksum);
+  m_offset += len;
+  m_referenced[m_filename] += len;
+
+  reference.ptr = m_reference.base;
+  return reference;
+}
+
+
+void BlobLogWriter::flush_buffer(uint32_t flags) {
+  if (m_buffer.fill() == 0 && flags == 0)
+    return;
+  StaticBuffer send_buf(m_buffer);
+  m_filesys->append(m_fd, send_buf, flags);
+}
+
+
+void BlobLogWriter::close() {
+  if (m_fd == -1)
+    return;
+  flush_buffer(Filesystem::O_FLUSH);
+  m_filesys->close(m_fd);
+  m_fd = -1;
+}
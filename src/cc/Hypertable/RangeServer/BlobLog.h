@@ -0,0 +1,236 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BLOBLOG_H
+#define HYPERTABLE_BLOBLOG_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Common/ByteString.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Filesystem.h"
+#include "Common/HashMap.h"
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+namespace Hypertable {
+
+  /**
+   * Key/value separation support.  Access groups with a non-zero
+   * blob_threshold move large values out of their CellStores into
+   * append-only blob log files when cells are compacted out of the
+   * CellCache.  The CellStore entry holds a small reference
+   * (file, offset, length) instead of the value, so subsequent merging
+   * and major compactions only rewrite the reference.  CellStores that
+   * may contain references carry the BLOB_REFERENCES trailer flag.
+   */
+  class BlobLog {
+  public:
+
+    class Reference {
+    public:
+      Reference() : fname(0), fname_len(0), offset(0), length(0),
+                    checksum(0) { }
+      const char *fname;   // relative to Global::toplevel_dir
+      uint32_t fname_len;
+      uint64_t offset;
+      uint32_t length;
+      uint32_t checksum;
+    };
+
+    /**
+     * Returns true if the given value is a well-formed blob reference
+     */
+    static bool is_reference(const ByteString value) {
+      Reference ref;
+      return decode_reference(value, ref);
+    }
+
+    /**
+     * Decodes a blob reference.
+     *
+     * @param value value to decode
+     * @param ref reference to decoded reference object
+     * @return true if value is a well-formed blob reference, false otherwise
+     */
+    static bool decode_reference(const ByteString value, Reference &ref);
+
+    /**
+     * Encodes a blob reference as a ByteString (vint length prefixed)
+     * and appends it to the given buffer.
+     */
+    static void encode_reference(DynamicBuffer &dst, const String &fname,
+                                 uint64_t offset, uint32_t length,
+                                 uint32_t checksum);
+
+    /**
+     * Reads the value that the given reference points to and writes it
+     * into dst as a ByteString.  dst is cleared first.
+     *
+     * @param ref blob reference
+     * @param dst buffer to hold resolved value
+     */
+    static void read(const Reference &ref, DynamicBuffer &dst);
+
+    /**
+     * Resolves the value of a blob reference into dst.
+     *
+     * @param value blob reference value
+     * @param dst buffer to hold resolved value
+     * @return resolved value (points into dst)
+     */
+    static ByteString resolve(const ByteString value, DynamicBuffer &dst) {
+      Reference ref;
+      ByteString resolved;
+      if (!decode_reference(value, ref))
+        return value;
+      read(ref, dst);
+      resolved.ptr = dst.base;
+      return resolved;
+    }
+
+    /**
+     * Closes a cached read file descriptor for the given blob file
+     *
+     * @param fname absolute name of blob log file
+     */
+    static void close_file(const String &fname);
+
+    /**
+     * Returns true if the given (absolute or relative) file name refers
+     * to a blob log file, as opposed to a CellStore.
+     */
+    static bool is_blob_file(const String &fname);
+
+  private:
+    class OpenFile {
+    public:
+      OpenFile() : fd(-1), readers(0), closing(false) { }
+      int32_t fd;
+      int32_t readers;
+      bool closing;
+    };
+    typedef hash_map<String, OpenFile> FdMap;
+
+    static int32_t acquire_fd(const String &fname);
+    static void release_fd(const String &fname, int32_t fd);
+    static void close_fd(const String &fname, int32_t fd);
+
+    static Mutex ms_mutex;
+    static FdMap ms_fd_map;
+    static std::vector<OpenFile> ms_closing;
+  };
+
+  /**
+   * Live-data bookkeeping for a blob log file referenced by an access group
+   */
+  class BlobLogInfo {
+  public:
+    BlobLogInfo() : size(0), live(0), rewrite(false) { }
+    BlobLogInfo(int64_t sz, int64_t lv) : size(sz), live(lv), rewrite(false) { }
+    int64_t size;
+    int64_t live;
+    bool rewrite;
+  };
+  typedef std::map<String, BlobLogInfo> BlobLogInfoMap;
+
+  /**
+   * Writes the blob log file that accompanies a CellStore during
+   * compaction.  The file is created lazily on the first separated value.
+   */
+  class BlobLogWriter : public ReferenceCount {
+  public:
+    BlobLogWriter(Filesystem *fs, SchemaPtr &schema, const String &fname,
+                  uint32_t threshold, int32_t replication,
+                  const std::set<String> &rewrite_files);
+    virtual ~BlobLogWriter();
+
+    /**
+     * Separates a value coming from the CellCache.  If it is at least
+     * threshold bytes long, it is appended to the blob log and a reference
+     * to it is returned, otherwise the value is returned unchanged.
+     *
+     * @param key key of cell
+     * @param value value of cell
+     * @return value to write into the CellStore
+     */
+    ByteString add(const Key &key, const ByteString value);
+
+    /**
+     * Accounts for a reference carried over from an existing CellStore.
+     * If the referenced file is scheduled for rewrite, the value is copied
+     * into this blob log and a new reference is returned.
+     *
+     * @param value existing blob reference
+     * @return value to write into the CellStore
+     */
+    ByteString add_reference(const ByteString value);
+
+    /**
+     * Flushes and closes the blob log.  Must be called before the
+     * accompanying CellStore is finalized.
+     */
+    void close();
+
+    /** Returns the absolute file name of this blob log */
+    const String &get_filename() { return m_filename; }
+
+    /** Returns true if at least one value was written to the blob log */
+    bool created() { return m_offset > 0; }
+
+    /** Returns number of bytes written to the blob log */
+    int64_t length() { return m_offset; }
+
+    /**
+     * Returns the number of blob bytes referenced by the CellStore being
+     * written, indexed by absolute file name (this blob log included).
+     */
+    std::map<String, int64_t> &get_referenced_bytes() { return m_referenced; }
+
+  private:
+    ByteString append(const uint8_t *data, uint32_t len, uint32_t checksum);
+    void flush_buffer(uint32_t flags=0);
+
+    Filesystem *m_filesys;
+    SchemaPtr m_schema;
+    String m_filename;
+    String m_relative_name;
+    uint32_t m_threshold;
+    int32_t m_replication;
+    int32_t m_fd;
+    int64_t m_offset;
+    DynamicBuffer m_buffer;
+    DynamicBuffer m_reference;
+    DynamicBuffer m_value;
+    std::set<String> m_rewrite_files;
+    std::map<String, int64_t> m_referenced;
+  };
+  typedef intrusive_ptr<BlobLogWriter> BlobLogWriterPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_BLOBLOG_H
@@ -39,7 +39,8 @@ using namespace std;
 
 CellCache::CellCache()
   : m_arena(), m_cell_map(std::less<const SerializedKey>(), Alloc(m_arena)),
-    m_deletes(0), m_collisions(0), m_key_bytes(0), m_value_bytes(0),
+    m_deletes(0), m_collisions(0), m_overwrites(0), m_retained_deletes(0),
+    m_key_bytes(0), m_value_bytes(0),
     m_frozen(false), m_have_counter_deletes(false) {
   assert(Config::properties); // requires Config::init* first
   m_arena.set_page_size((size_t)
@@ -66,13 +67,30 @@ void CellCache::add(const Key &key, const ByteString value) {
 
   value.write(ptr);
 
-  if (! m_cell_map.insert(CellMap::value_type(new_key, key.length)).second) {
+  std::pair<CellMap::iterator, bool> result =
+    m_cell_map.insert(CellMap::value_type(new_key, key.length));
+
+  if (!result.second) {
     m_collisions++;
     HT_WARNF("Collision detected key insert (row = %s)", new_key.row());
   }
   else {
     if (key.flag <= FLAG_DELETE_CELL_VERSION)
       m_deletes++;
+    else {
+      // Newer versions sort first, so an older version of the same cell
+      // follows the inserted key
+      CellMap::iterator next = result.first;
+      if (++next != m_cell_map.end()) {
+        const uint8_t *next_ptr;
+        size_t cell_len = key.flag_ptr - (const uint8_t *)key.row;
+        size_t next_len = (*next).first.decode_length(&next_ptr);
+        if (next_len > cell_len + 1 &&
+            !memcmp(next_ptr + 1, key.row, cell_len))
+          m_overwrites++;
+      }
+    }
+    m_split_row_sampler.add(key.row, total_len);
   }
 }
 
@@ -161,15 +179,10 @@ const char *CellCache::get_split_row() {
 
 
 
-void CellCache::get_split_rows(std::vector<std::string> &split_rows) {
+void CellCache::get_split_row_samples(SplitRowSampler::SampleVector &samples) {
   ScopedLock lock(m_mutex);
-  if (m_cell_map.size() > 2) {
-    CellMap::const_iterator iter = m_cell_map.begin();
-    size_t i=0, mid = m_cell_map.size() / 2;
-    for (i=0; i<mid; i++)
-      ++iter;
-    split_rows.push_back((*iter).first.row());
-  }
+  if (m_cell_map.size() > 2)
+    m_split_row_sampler.get_samples(samples);
 }
 
 
@@ -33,6 +33,7 @@
 #include "Hypertable/Lib/SerializedKey.h"
 
 #include "CellCacheAllocator.h"
+#include "SplitRowSampler.h"
 
 namespace Hypertable {
 
@@ -69,7 +70,13 @@ namespace Hypertable {
 
     virtual const char *get_split_row();
 
-    virtual void get_split_rows(std::vector<std::string> &split_rows);
+    /**
+     * Appends the byte weighted sample of the rows in this cache to
+     * <code>samples</code>.
+     *
+     * @param samples vector to append samples to
+     */
+    virtual void get_split_row_samples(SplitRowSampler::SampleVector &samples);
 
     virtual void get_rows(std::vector<std::string> &rows);
 
@@ -117,6 +124,31 @@ namespace Hypertable {
 
     int32_t get_delete_count() { return m_deletes; }
 
+    /**
+     * Returns an estimate of the number of cells that an in-memory
+     * compaction could drop: deletes, other than those kept by the last
+     * such compaction, and, if <code>count_overwrites</code> is true,
+     * cells that were superseded by a newer version.
+     *
+     * @param count_overwrites true if every column family keeps a single
+     *        version
+     * @return estimated number of obsolete cells
+     */
+    int32_t get_garbage_estimate(bool count_overwrites) {
+      ScopedLock lock(m_mutex);
+      return (m_deletes - m_retained_deletes) +
+        (count_overwrites ? m_overwrites : 0);
+    }
+
+    /**
+     * Marks the current contents as the result of an in-memory compaction,
+     * so that the deletes it kept do not count as garbage.
+     */
+    void mark_compacted() {
+      m_retained_deletes = m_deletes;
+      m_overwrites = 0;
+    }
+
     void freeze() { m_frozen = true; }
     void unfreeze() { m_frozen = false; }
 
@@ -143,10 +175,13 @@ namespace Hypertable {
     CellMap            m_cell_map;
     int32_t            m_deletes;
     int32_t            m_collisions;
+    int32_t            m_overwrites;
+    int32_t            m_retained_deletes;
     int64_t            m_key_bytes;
     int64_t            m_value_bytes;
     bool               m_frozen;
     bool               m_have_counter_deletes;
+    SplitRowSampler    m_split_row_sampler;
 
   };
 
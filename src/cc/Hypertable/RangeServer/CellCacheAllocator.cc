@@ -20,14 +20,29 @@
 #include "Common/Compat.h"
 // Global.h cannot be used in headers as it'll cause circular inclusion
 #include "Global.h"
+#include "CellCachePagePool.h"
 
 namespace Hypertable {
 
 void *CellCachePageAllocator::allocate(size_t sz) {
   Global::memory_tracker->add(sz);
+  // big allocations get their own page and stay with malloc
+  if (Global::cell_cache_page_pool &&
+      sz == Global::cell_cache_page_pool->page_size()) {
+    void *page = Global::cell_cache_page_pool->allocate();
+    if (page)
+      return page;
+  }
   return std::malloc(sz);
 }
 
+void CellCachePageAllocator::deallocate(void *p) {
+  if (Global::cell_cache_page_pool &&
+      Global::cell_cache_page_pool->deallocate(p))
+    return;
+  std::free(p);
+}
+
 void CellCachePageAllocator::freed(size_t sz) {
   Global::memory_tracker->subtract(sz);
 }
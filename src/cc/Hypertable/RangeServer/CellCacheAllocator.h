@@ -26,6 +26,7 @@ namespace Hypertable {
 
 struct CellCachePageAllocator : DefaultPageAllocator {
   void *allocate(size_t sz);
+  void deallocate(void *p);
   void freed(size_t sz);
 };
 
@@ -0,0 +1,242 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "CellCachePagePool.h"
+
+using namespace Hypertable;
+
+CellCachePagePool::CellCachePagePool(size_t page_size, int mode,
+                                     bool numa_aware)
+  : m_page_size(page_size), m_mode(mode), m_numa_aware(numa_aware),
+    m_explicit_exhausted(false) {
+
+  // power of two, so a page's chunk is found by masking its address
+  m_chunk_size = HUGE_PAGE_SIZE;
+  while (m_chunk_size < m_page_size)
+    m_chunk_size <<= 1;
+  m_slots_per_chunk = m_chunk_size / m_page_size;
+
+  if (m_numa_aware)
+    load_node_map();
+  m_partial_chunks.resize(m_cpu_node.empty() ? 1 :
+      *std::max_element(m_cpu_node.begin(), m_cpu_node.end()) + 1);
+
+  HT_INFOF("CellCache pages served from %s huge pages (page size %llu, "
+           "%u pages per chunk, %d NUMA nodes)",
+           (m_mode == EXPLICIT) ? "explicit" : "transparent",
+           (Llu)m_page_size, (unsigned)m_slots_per_chunk,
+           (int)m_partial_chunks.size());
+}
+
+
+CellCachePagePool::~CellCachePagePool() {
+  for (hash_map<uintptr_t, Chunk *>::iterator iter = m_chunks.begin();
+       iter != m_chunks.end(); ++iter)
+    unmap_chunk(iter->second);
+}
+
+
+void *CellCachePagePool::allocate() {
+  int node = current_node();
+  ScopedLock lock(m_mutex);
+  std::set<Chunk *> &partial = m_partial_chunks[node];
+  Chunk *chunk;
+
+  if (partial.empty()) {
+    if ((chunk = map_chunk(node)) == 0)
+      return 0;
+    m_chunks[(uintptr_t)chunk->base] = chunk;
+    partial.insert(chunk);
+  }
+  else
+    chunk = *partial.begin();
+
+  uint32_t slot = chunk->free_slots.back();
+  chunk->free_slots.pop_back();
+  if (chunk->free_slots.empty())
+    partial.erase(chunk);
+
+  return chunk->base + (size_t)slot * m_page_size;
+}
+
+
+bool CellCachePagePool::deallocate(void *page) {
+  uintptr_t base = (uintptr_t)page & ~(uintptr_t)(m_chunk_size - 1);
+  ScopedLock lock(m_mutex);
+  hash_map<uintptr_t, Chunk *>::iterator iter = m_chunks.find(base);
+
+  if (iter == m_chunks.end())
+    return false;
+
+  Chunk *chunk = iter->second;
+  chunk->free_slots.push_back(((uint8_t *)page - chunk->base) / m_page_size);
+
+  if (chunk->free_slots.size() == m_slots_per_chunk) {
+    m_partial_chunks[chunk->node].erase(chunk);
+    m_chunks.erase(iter);
+    unmap_chunk(chunk);
+  }
+  else if (chunk->free_slots.size() == 1)
+    m_partial_chunks[chunk->node].insert(chunk);
+
+  return true;
+}
+
+
+int CellCachePagePool::parse_mode(const String &str) {
+  if (!strcasecmp(str.c_str(), "none"))
+    return 0;
+  else if (!strcasecmp(str.c_str(), "transparent"))
+    return TRANSPARENT;
+  else if (!strcasecmp(str.c_str(), "explicit"))
+    return EXPLICIT;
+  HT_THROWF(Error::CONFIG_BAD_VALUE, "Invalid huge page mode '%s'",
+            str.c_str());
+}
+
+
+/**
+ * Maps a chunk aligned to its own size.  Huge page mappings are 2MB aligned
+ * by the kernel, anything else is over-allocated and trimmed.
+ */
+CellCachePagePool::Chunk *CellCachePagePool::map_chunk(int node) {
+  uint8_t *base = 0;
+  size_t length = m_chunk_size * 2;
+  void *addr;
+
+#if defined(MAP_HUGETLB)
+  if (m_mode == EXPLICIT && !m_explicit_exhausted) {
+    if (m_chunk_size == HUGE_PAGE_SIZE)
+      length = m_chunk_size;
+    addr = mmap(0, length, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+    if (addr == MAP_FAILED) {
+      HT_WARNF("Unable to map explicit huge pages (%s), falling back to "
+               "transparent huge pages", strerror(errno));
+      m_explicit_exhausted = true;
+    }
+    else
+      base = (uint8_t *)addr;
+  }
+#endif
+
+  if (base == 0) {
+    length = m_chunk_size * 2;
+    addr = mmap(0, length, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+      HT_ERRORF("Unable to map CellCache chunk - %s", strerror(errno));
+      return 0;
+    }
+    base = (uint8_t *)addr;
+  }
+
+  uint8_t *aligned = (uint8_t *)(((uintptr_t)base + m_chunk_size - 1) &
+                                 ~(uintptr_t)(m_chunk_size - 1));
+  if (aligned > base)
+    munmap(base, aligned - base);
+  if (aligned + m_chunk_size < base + length)
+    munmap(aligned + m_chunk_size, (base + length) - (aligned + m_chunk_size));
+
+#if defined(MADV_HUGEPAGE)
+  madvise(aligned, m_chunk_size, MADV_HUGEPAGE);
+#endif
+
+  Chunk *chunk = new Chunk();
+  chunk->base = aligned;
+  chunk->node = node;
+  chunk->free_slots.reserve(m_slots_per_chunk);
+  for (uint32_t i=m_slots_per_chunk; i>0; i--)
+    chunk->free_slots.push_back(i-1);
+  return chunk;
+}
+
+
+void CellCachePagePool::unmap_chunk(Chunk *chunk) {
+  munmap(chunk->base, m_chunk_size);
+  delete chunk;
+}
+
+
+int CellCachePagePool::current_node() {
+  if (m_cpu_node.empty())
+    return 0;
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && (size_t)cpu < m_cpu_node.size())
+    return m_cpu_node[cpu];
+#endif
+  return 0;
+}
+
+
+/**
+ * Builds the CPU to node table from /sys/devices/system/node/node<N>/cpulist
+ */
+void CellCachePagePool::load_node_map() {
+  const char *node_dir = "/sys/devices/system/node";
+  DIR *dirp = opendir(node_dir);
+  struct dirent *dp;
+  int node, lo, hi;
+  char buf[4096];
+
+  if (dirp == 0)
+    return;
+
+  while ((dp = readdir(dirp)) != 0) {
+    if (strncmp(dp->d_name, "node", 4) || sscanf(dp->d_name+4, "%d", &node) != 1)
+      continue;
+    String fname = format("%s/%s/cpulist", node_dir, dp->d_name);
+    FILE *fp = fopen(fname.c_str(), "r");
+    if (fp == 0)
+      continue;
+    if (fgets(buf, sizeof(buf), fp)) {
+      for (char *range = strtok(buf, ",\n"); range; range = strtok(0, ",\n")) {
+        int n = sscanf(range, "%d-%d", &lo, &hi);
+        if (n < 1)
+          continue;
+        if (n == 1)
+          hi = lo;
+        if ((size_t)hi >= m_cpu_node.size())
+          m_cpu_node.resize(hi+1, 0);
+        for (int cpu=lo; cpu<=hi; cpu++)
+          m_cpu_node[cpu] = node;
+      }
+    }
+    fclose(fp);
+  }
+  closedir(dirp);
+}
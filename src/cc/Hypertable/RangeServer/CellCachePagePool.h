@@ -0,0 +1,98 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_CELLCACHEPAGEPOOL_H
+#define HYPERTABLE_CELLCACHEPAGEPOOL_H
+
+#include <set>
+#include <vector>
+
+#include "Common/HashMap.h"
+#include "Common/Mutex.h"
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Serves fixed size CellCache arena pages out of 2MB aligned chunks that
+   * are backed by huge pages, which keeps the TLB footprint of large
+   * CellCaches small.  Chunks come either from transparent huge pages
+   * (madvise) or from the explicit hugetlbfs pool, falling back to the
+   * former when the latter is exhausted.  When NUMA aware, free pages are
+   * kept per node and handed to threads running on that node; new chunks
+   * are first touched by the allocating thread, so they land on its node.
+   * Chunks are unmapped as soon as their last page is returned.
+   */
+  class CellCachePagePool {
+  public:
+    enum Mode { TRANSPARENT = 1, EXPLICIT = 2 };
+
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    CellCachePagePool(size_t page_size, int mode, bool numa_aware);
+    ~CellCachePagePool();
+
+    /** Returns a page of page_size() bytes or 0 if no memory could be
+     * mapped */
+    void *allocate();
+
+    /** Returns page to the pool, false if it was not allocated by it */
+    bool deallocate(void *page);
+
+    size_t page_size() { return m_page_size; }
+
+    /** Bytes currently mapped for chunks */
+    int64_t memory_mapped() {
+      ScopedLock lock(m_mutex);
+      return (int64_t)m_chunks.size() * (int64_t)m_chunk_size;
+    }
+
+    /** Parses "none", "transparent" or "explicit", returns 0 for none */
+    static int parse_mode(const String &str);
+
+  private:
+
+    struct Chunk {
+      uint8_t *base;
+      int node;
+      std::vector<uint32_t> free_slots;
+    };
+
+    Chunk *map_chunk(int node);
+    void unmap_chunk(Chunk *chunk);
+    int current_node();
+    void load_node_map();
+
+    Mutex m_mutex;
+    size_t m_page_size;
+    size_t m_chunk_size;
+    uint32_t m_slots_per_chunk;
+    int m_mode;
+    bool m_numa_aware;
+    bool m_explicit_exhausted;
+    hash_map<uintptr_t, Chunk *> m_chunks;
+    std::vector<std::set<Chunk *> > m_partial_chunks;
+    std::vector<int> m_cpu_node;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_CELLCACHEPAGEPOOL_H
@@ -24,6 +24,7 @@
 
 #include "Common/ByteString.h"
 #include "Common/DynamicBuffer.h"
+#include "Common/PreadFuture.h"
 #include "Common/ReferenceCount.h"
 
 #include "ScanContext.h"
@@ -45,6 +46,12 @@ namespace Hypertable {
     virtual uint64_t get_disk_read() = 0;
     void add_disk_read(uint64_t amount) { m_disk_read += amount; }
 
+    /**
+     * Returns the outstanding read of the block the scan needs next, or
+     * a null pointer if the scan can continue without blocking on one.
+     */
+    virtual PreadFuturePtr get_pending_read() { return PreadFuturePtr(); }
+
   protected:
     uint64_t m_disk_read;
     ScanContextPtr m_scan_context_ptr;
@@ -22,6 +22,7 @@
 #ifndef HYPERTABLE_CELLSTORE_H
 #define HYPERTABLE_CELLSTORE_H
 
+#include <utility>
 #include <vector>
 
 #include "Common/String.h"
@@ -34,6 +35,7 @@
 #include "CellList.h"
 #include "CellStoreTrailer.h"
 #include "KeyDecompressor.h"
+#include "SplitRowSampler.h"
 
 namespace Hypertable {
 
@@ -55,6 +57,9 @@ namespace Hypertable {
       uint64_t block_index_access_counter;
     };
 
+    /** Inclusive row intervals */
+    typedef std::vector<std::pair<String, String> > RowIntervals;
+
     CellStore() : m_bytes_read(0) { }
 
     virtual ~CellStore() { return; }
@@ -63,6 +68,25 @@ namespace Hypertable {
 
     virtual const char *get_split_row() = 0;
 
+    /**
+     * Appends a sample of the rows in this cell store, weighted by
+     * uncompressed bytes, to <code>samples</code>.  The default
+     * implementation contributes the split row weighted by the size of
+     * the store.
+     *
+     * @param samples vector to append samples to
+     */
+    virtual void get_split_row_samples(SplitRowSampler::SampleVector &samples) {
+      const char *row = get_split_row();
+      if (row) {
+        double ratio = compression_ratio();
+        uint64_t weight = disk_usage();
+        if (ratio > 0.0)
+          weight = (uint64_t)((double)weight / ratio);
+        samples.push_back(SplitRowSampler::Sample(row, weight));
+      }
+    }
+
     virtual int64_t get_total_entries() = 0;
 
     virtual CellListScanner *
@@ -203,6 +227,12 @@ namespace Hypertable {
      */
     virtual void display_block_info() = 0;
 
+    /**
+     * Displays the number of data blocks, and their uncompressed and
+     * compressed size, per compression codec to stdout
+     */
+    virtual void display_block_codec_info() { }
+
     /**
      * Return Bloom filter size
      *
@@ -266,6 +296,26 @@ namespace Hypertable {
      */
     virtual bool restricted_range() = 0;
 
+    /**
+     * Appends the row intervals covered by this cell store's blocks that
+     * are currently held in the block cache
+     *
+     * @param intervals vector to append row intervals to
+     */
+    virtual void get_cached_row_intervals(RowIntervals &intervals) { }
+
+    /**
+     * Loads the blocks that overlap the given row intervals into the
+     * block cache, stopping once budget bytes have been loaded
+     *
+     * @param intervals row intervals (need not be sorted)
+     * @param budget maximum number of bytes to load
+     * @return number of bytes loaded
+     */
+    virtual int64_t warm_block_cache(RowIntervals &intervals, int64_t budget) {
+      return 0;
+    }
+
     /**
      * Returns the number of "uncompressed" bytes read from the underlying
      * filesystem.
@@ -30,6 +30,8 @@
 
 #include "Hypertable/Lib/SerializedKey.h"
 
+#include "SplitRowSampler.h"
+
 
 namespace Hypertable {
 
@@ -79,7 +81,9 @@ namespace Hypertable {
               const String &start_row="", const String &end_row="") {
       size_t total_entries = fixed.fill() / sizeof(OffsetT);
       SerializedKey key;
+      SerializedKey last_key;
       OffsetT offset;
+      OffsetT last_offset = 0;
       const uint8_t *key_ptr;
       bool in_scope = (start_row == "") ? true : false;
       bool check_for_end_row = end_row != "";
@@ -111,6 +115,10 @@ namespace Hypertable {
         }
         else if (check_for_end_row &&
                  strcmp(key.row(), end_row.c_str()) > 0) {
+          if (last_key)
+            m_row_sampler.add(last_key.row(), offset - last_offset);
+          last_key = key;
+          last_offset = offset;
           m_map.insert(m_map.end(), value_type(key, offset));
           if (i+1 < m_index_entries) {
             key.ptr = key_ptr;
@@ -120,21 +128,23 @@ namespace Hypertable {
           break;
         }
 
+        // sample the previous block now that its size is known
+        if (last_key)
+          m_row_sampler.add(last_key.row(), offset - last_offset);
+        last_key = key;
+        last_offset = offset;
         m_map.insert(m_map.end(), value_type(key, offset));
       }
 
+      if (last_key)
+        m_row_sampler.add(last_key.row(), m_end_of_last_block - last_offset);
+
       HT_ASSERT(key_ptr <= (m_keydata.base + m_keydata.size));
 
       if (!m_map.empty()) {
 
         /** compute space covered by this index scope **/
         m_disk_used = m_end_of_last_block - (*m_map.begin()).second;
-
-        /** determine split key **/
-        MapIteratorT iter = m_map.begin();
-        for (size_t i=1; i<(m_map.size()+1)/2; ++iter,++i)
-          ;
-        m_middle_key = (*iter).first;
       }
 
     }
@@ -162,7 +172,24 @@ namespace Hypertable {
       std::cout << "sizeof(OffsetT) = " << sizeof(OffsetT) << std::endl;
     }
 
-    const SerializedKey middle_key() { return m_middle_key; }
+    /**
+     * Returns the row that divides the blocks in scope in two by size, or
+     * 0 if there are none.  It is the median of the byte weighted row
+     * sample taken while loading the index.
+     */
+    const char *middle_row() {
+      if (m_middle_row.empty()) {
+        SplitRowSampler::SampleVector samples;
+        m_row_sampler.get_samples(samples);
+        const char *row = SplitRowSampler::median(samples);
+        if (row)
+          m_middle_row = row;
+      }
+      return m_middle_row.empty() ? 0 : m_middle_row.c_str();
+    }
+
+    /** Byte weighted sample of the rows in scope */
+    const SplitRowSampler &row_sampler() { return m_row_sampler; }
 
     size_t memory_used() {
       return m_keydata.size +
@@ -194,14 +221,16 @@ namespace Hypertable {
     void clear() {
       m_map.clear();
       m_keydata.free();
-      m_middle_key.ptr = 0;
+      m_row_sampler.clear();
+      m_middle_row.clear();
       m_index_entries = 0;
     }
 
   private:
     MapT m_map;
     StaticBuffer m_keydata;
-    SerializedKey m_middle_key;
+    SplitRowSampler m_row_sampler;
+    String m_middle_row;
     int64_t m_end_of_last_block;
     int64_t m_disk_used;
     int64_t m_index_entries;
@@ -45,11 +45,17 @@ namespace Hypertable {
       init_from_trailer();
     }
     CellStoreInfo() : cell_count(0), shadow_cache_ecr(TIMESTAMP_MAX), shadow_cache_hits(0),
-                      bloom_filter_accesses(0), bloom_filter_maybes(0), bloom_filter_fps(0) { }
+                      bloom_filter_accesses(0), bloom_filter_maybes(0), bloom_filter_fps(0),
+                      blob_references(false), timestamp_bounds(false) { }
     void init_from_trailer() {
       int divisor = 0;
+      blob_references = false;
+      timestamp_bounds = false;
       try {
-        divisor = (boost::any_cast<uint32_t>(cs->get_trailer()->get("flags")) & CellStoreTrailerV5::SPLIT) ? 2 : 1;
+        uint32_t flags = boost::any_cast<uint32_t>(cs->get_trailer()->get("flags"));
+        blob_references = (flags & CellStoreTrailerV5::BLOB_REFERENCES) != 0;
+        timestamp_bounds = (flags & CellStoreTrailerV5::TIMESTAMP_BOUNDS) != 0;
+        divisor = (flags & CellStoreTrailerV5::SPLIT) ? 2 : 1;
         cell_count = boost::any_cast<int64_t>(cs->get_trailer()->get("total_entries")) / divisor;
         timestamp_min = boost::any_cast<int64_t>(cs->get_trailer()->get("timestamp_min"));
         timestamp_max = boost::any_cast<int64_t>(cs->get_trailer()->get("timestamp_max"));
@@ -61,6 +67,7 @@ namespace Hypertable {
         cell_count = 0;
         timestamp_min = TIMESTAMP_MAX;
         timestamp_max = TIMESTAMP_MIN;
+        timestamp_bounds = false;
         expirable_data = 0;
       }
       try {
@@ -89,6 +96,8 @@ namespace Hypertable {
     int64_t timestamp_max;
     int64_t expirable_data;
     int64_t total_data;
+    bool blob_references;
+    bool timestamp_bounds;
   };
 
 } // namespace Hypertable
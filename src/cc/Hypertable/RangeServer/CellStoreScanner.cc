@@ -193,6 +193,14 @@ uint64_t CellStoreScanner<IndexT>::get_disk_read() {
 }
 
 
+template <typename IndexT>
+PreadFuturePtr CellStoreScanner<IndexT>::get_pending_read() {
+  if (m_eos || m_interval_index >= m_interval_max)
+    return PreadFuturePtr();
+  return m_interval_scanners[m_interval_index]->get_pending_read();
+}
+
+
 
 template <typename IndexT>
 void CellStoreScanner<IndexT>::forward() {
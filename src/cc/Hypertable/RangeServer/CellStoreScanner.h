@@ -43,6 +43,7 @@ namespace Hypertable {
     virtual bool get(Key &key, ByteString &value);
 
     virtual uint64_t get_disk_read();
+    virtual PreadFuturePtr get_pending_read();
 
   private:
     CellStorePtr              m_cellstore;
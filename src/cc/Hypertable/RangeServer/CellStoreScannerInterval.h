@@ -23,6 +23,7 @@
 #define HYPERTABLE_CELLSTORESCANNERINTERVAL_H
 
 #include "Common/ByteString.h"
+#include "Common/PreadFuture.h"
 #include "Hypertable/Lib/Key.h"
 
 namespace Hypertable {
@@ -34,6 +35,7 @@ namespace Hypertable {
     virtual bool get(Key &key, ByteString &value) = 0;
     virtual ~CellStoreScannerInterval() { }
     uint64_t get_disk_read() { return m_disk_read; }
+    virtual PreadFuturePtr get_pending_read() { return PreadFuturePtr(); }
 
   protected:
     struct BlockInfo {
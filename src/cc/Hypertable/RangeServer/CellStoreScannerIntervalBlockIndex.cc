@@ -39,7 +39,7 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
   IndexT *index, SerializedKey start_key, SerializedKey end_key, ScanContextPtr &scan_ctx) :
   m_cellstore(cellstore), m_index(index), m_start_key(start_key),
   m_end_key(end_key), m_fd(-1), m_check_for_range_end(false),
-  m_scan_ctx(scan_ctx), m_rowset(scan_ctx->rowset) {
+  m_scan_ctx(scan_ctx), m_rowset(scan_ctx->rowset), m_last_read_offset(-1) {
 
   memset(&m_block, 0, sizeof(m_block));
   m_file_id = m_cellstore->get_file_id();
@@ -93,6 +93,7 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
 
 template <typename IndexT>
 CellStoreScannerIntervalBlockIndex<IndexT>::~CellStoreScannerIntervalBlockIndex() {
+  m_reads.clear();
   if (m_block.base != 0)
     Global::block_cache->checkin(m_file_id, m_block.offset);
   delete m_zcodec;
@@ -208,22 +209,41 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
      */
     if (!Global::block_cache->checkout(m_file_id, (uint32_t)m_block.offset,
                                       (uint8_t **)&m_block.base, &len)) {
+      PreadFuturePtr future = take_read(m_block.offset);
       bool second_try = false;
+
+      // Keep the reads of the blocks that follow in flight while this
+      // one is inflated and scanned
+      if (Global::cellstore_async_reads > 0 && m_rowset.empty())
+        issue_reads();
+
     try_again:
       try {
-        DynamicBuffer buf(m_block.zlength);
+        DynamicBuffer buf(0);
+        DynamicBuffer *zbufp = &buf;
 
-        if (second_try)
+        if (second_try) {
+          m_reads.clear();
           m_fd = m_cellstore->reopen_fd();
+        }
 
         /** Read compressed block **/
-        Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
+        if (future && !second_try) {
+          zbufp = &future->get();
+          if ((int64_t)zbufp->fill() != m_block.zlength)
+            HT_THROWF(Error::DFSBROKER_EOF, "short read (%lu < %lu)",
+                      (Lu)zbufp->fill(), (Lu)m_block.zlength);
+        }
+        else {
+          buf.reserve(m_block.zlength);
+          Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
+          buf.ptr += m_block.zlength;
+        }
 
-        buf.ptr += m_block.zlength;
         /** inflate compressed block **/
         BlockCompressionHeader header;
 
-        m_zcodec->inflate(buf, expand_buf, header);
+        m_zcodec->inflate(*zbufp, expand_buf, header);
 
         m_disk_read += expand_buf.fill();
 
@@ -271,5 +291,90 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
 }
 
 
+/**
+ * Issues asynchronous reads for the Global::cellstore_async_reads blocks
+ * that follow the current one, skipping blocks that are in the block
+ * cache or already being read and stopping at the last block of the scan.
+ */
+template <typename IndexT>
+void CellStoreScannerIntervalBlockIndex<IndexT>::issue_reads() {
+  IndexIteratorT it = m_iter;
+  IndexIteratorT it_next;
+  PendingRead read;
+  int64_t zlength;
+  int32_t n = 0;
+
+  if (it == m_index->end() || strcmp(it.key().row(), m_end_row) >= 0)
+    return;
+
+  for (++it; it != m_index->end() && n < Global::cellstore_async_reads;
+       it = it_next, n++) {
+    it_next = it;
+    ++it_next;
+
+    if ((int64_t)it.value() > m_last_read_offset &&
+        !Global::block_cache->contains(m_file_id, (uint32_t)it.value())) {
+      if (it_next == m_index->end())
+        zlength = m_index->end_of_last_block() - it.value();
+      else
+        zlength = it_next.value() - it.value();
+
+      read.offset = it.value();
+      read.future = new PreadFuture(zlength);
+      read.future->issue();
+      try {
+        Global::dfs->pread(m_fd, zlength, read.offset, read.future.get());
+      }
+      catch (Exception &e) {
+        read.future->cancel();
+        HT_WARN_OUT << "Problem issuing read ahead of scan - " << e << HT_END;
+        return;
+      }
+      m_reads.push_back(read);
+      m_last_read_offset = read.offset;
+    }
+
+    if (strcmp(it.key().row(), m_end_row) >= 0)
+      break;
+  }
+}
+
+
+/**
+ * Returns the read of the block that follows the current one if it is
+ * still outstanding.
+ */
+template <typename IndexT>
+PreadFuturePtr CellStoreScannerIntervalBlockIndex<IndexT>::get_pending_read() {
+  if (m_iter == m_index->end())
+    return PreadFuturePtr();
+  for (size_t i=0; i<m_reads.size(); i++) {
+    if (m_reads[i].offset > m_block.offset) {
+      if (!m_reads[i].future->is_ready())
+        return m_reads[i].future;
+      break;
+    }
+  }
+  return PreadFuturePtr();
+}
+
+
+/**
+ * Returns the outstanding read of the block at <code>offset</code>, if
+ * there is one, dropping reads of blocks the scan has moved past.
+ */
+template <typename IndexT>
+PreadFuturePtr CellStoreScannerIntervalBlockIndex<IndexT>::take_read(int64_t offset) {
+  PreadFuturePtr future;
+
+  while (!m_reads.empty() && m_reads.front().offset <= offset) {
+    if (m_reads.front().offset == offset)
+      future = m_reads.front().future;
+    m_reads.pop_front();
+  }
+  return future;
+}
+
+
 template class CellStoreScannerIntervalBlockIndex<CellStoreBlockIndexMap<uint32_t> >;
 template class CellStoreScannerIntervalBlockIndex<CellStoreBlockIndexMap<int64_t> >;
@@ -22,7 +22,10 @@
 #ifndef HYPERTABLE_CELLSTORESCANNERINTERVALBLOCKINDEX_H
 #define HYPERTABLE_CELLSTORESCANNERINTERVALBLOCKINDEX_H
 
+#include <deque>
+
 #include "Common/DynamicBuffer.h"
+#include "Common/PreadFuture.h"
 
 #include "CellStore.h"
 #include "CellStoreScannerInterval.h"
@@ -44,11 +47,20 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalBlockIndex();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual PreadFuturePtr get_pending_read();
 
   private:
 
     bool fetch_next_block(bool eob=false);
 
+    struct PendingRead {
+      int64_t offset;
+      PreadFuturePtr future;
+    };
+
+    void issue_reads();
+    PreadFuturePtr take_read(int64_t offset);
+
     CellStorePtr          m_cellstore;
     IndexT               *m_index;
     IndexIteratorT        m_iter;
@@ -67,6 +79,8 @@ namespace Hypertable {
     int                   m_file_id;
     ScanContextPtr        m_scan_ctx;
     ScanContext::CstrRowSet& m_rowset;
+    std::deque<PendingRead> m_reads;
+    int64_t               m_last_read_offset;
   };
 
 }
@@ -198,6 +198,10 @@ void CellStoreTrailerV5::display(std::ostream &os) {
     os << " 64BIT_INDEX";
   if (flags & MAJOR_COMPACTION)
     os << " MAJOR_COMPACTION";
+  if (flags & BLOB_REFERENCES)
+    os << " BLOB_REFERENCES";
+  if (flags & TIMESTAMP_BOUNDS)
+    os << " TIMESTAMP_BOUNDS";
   os << " )";
   os << ", alignment=" << alignment;
   os << ", compression_ratio=" << compression_ratio;
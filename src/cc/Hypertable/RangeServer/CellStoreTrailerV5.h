@@ -76,7 +76,9 @@ namespace Hypertable {
 
     enum Flags { INDEX_64BIT = 1,
                  MAJOR_COMPACTION = 2,
-                 SPLIT = 4
+                 SPLIT = 4,
+                 BLOB_REFERENCES = 8,
+                 TIMESTAMP_BOUNDS = 16
     };
 
     boost::any get(const String& prop) {
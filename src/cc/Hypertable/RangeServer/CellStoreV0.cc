@@ -384,7 +384,7 @@ void CellStoreV0::finalize(TableIdentifier *table_identifier) {
   /** Set up m_index_map32 **/
   m_index_map32.load(m_fix_index_buffer, m_var_index_buffer,
                      m_trailer.fix_index_offset);
-  record_split_row( m_index_map32.middle_key() );
+  record_split_row( m_index_map32.middle_row() );
 
   // deallocate fix index data
   delete [] m_fix_index_buffer.release();
@@ -547,7 +547,7 @@ void CellStoreV0::load_index() {
   /** Set up m_index_map32 **/
   m_index_map32.load(m_fix_index_buffer, m_var_index_buffer,
                      m_trailer.fix_index_offset, m_start_row, m_end_row);
-  record_split_row( m_index_map32.middle_key() );
+  record_split_row( m_index_map32.middle_row() );
 
   // instantiate a bloom filter and read in the bloom filter bits.
   // If num_filter_items in trailer is 0, means bloom_filter is disabled..
@@ -654,9 +654,9 @@ void CellStoreV0::display_block_info() {
 }
 
 
-void CellStoreV0::record_split_row(const SerializedKey key) {
-  if (key.ptr) {
-    std::string split_row = key.row();
+void CellStoreV0::record_split_row(const char *row) {
+  if (row) {
+    std::string split_row = row;
     if (split_row > m_start_row && split_row < m_end_row)
       m_split_row = split_row;
   }
@@ -116,7 +116,7 @@ namespace Hypertable {
 
   protected:
     void add_index_entry(const SerializedKey key, uint32_t offset);
-    void record_split_row(const SerializedKey key);
+    void record_split_row(const char *row);
     void create_bloom_filter(bool is_approx = false);
     void load_index();
 
@@ -535,7 +535,7 @@ void CellStoreV3::finalize(TableIdentifier *table_identifier) {
     m_index_map64.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset);
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
     index_memory = m_index_map64.memory_used();
     m_trailer.flags |= CellStoreTrailerV3::INDEX_64BIT;
   }
@@ -544,7 +544,7 @@ void CellStoreV3::finalize(TableIdentifier *table_identifier) {
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset);
     index_memory = m_index_map32.memory_used();
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
   }
 
   // deallocate fix index data
@@ -766,13 +766,13 @@ void CellStoreV3::load_block_index() {
     m_index_map64.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
   }
   else {
     m_index_map32.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
   }
 
   m_disk_usage = m_index_map32.disk_used();
@@ -852,9 +852,9 @@ void CellStoreV3::display_block_info() {
 
 
 
-void CellStoreV3::record_split_row(const SerializedKey key) {
-  if (key.ptr) {
-    std::string split_row = key.row();
+void CellStoreV3::record_split_row(const char *row) {
+  if (row) {
+    std::string split_row = row;
     if (split_row > m_start_row && split_row < m_end_row)
       m_split_row = split_row;
   }
@@ -131,7 +131,7 @@ namespace Hypertable {
     virtual CellStoreTrailer *get_trailer() { return &m_trailer; }
 
   protected:
-    void record_split_row(const SerializedKey key);
+    void record_split_row(const char *row);
     void create_bloom_filter(bool is_approx = false);
     void load_bloom_filter();
     void load_block_index();
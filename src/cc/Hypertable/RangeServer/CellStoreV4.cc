@@ -556,7 +556,7 @@ void CellStoreV4::finalize(TableIdentifier *table_identifier) {
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset);
     m_trailer.index_entries = m_index_map64.index_entries();
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
     index_memory = m_index_map64.memory_used();
     m_trailer.flags |= CellStoreTrailerV4::INDEX_64BIT;
   }
@@ -566,7 +566,7 @@ void CellStoreV4::finalize(TableIdentifier *table_identifier) {
                        m_trailer.fix_index_offset);
     m_trailer.index_entries = m_index_map32.index_entries();
     index_memory = m_index_map32.memory_used();
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
   }
 
   // deallocate fix index data
@@ -799,13 +799,13 @@ void CellStoreV4::load_block_index() {
     m_index_map64.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
   }
   else {
     m_index_map32.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
   }
 
   m_index_stats.block_index_memory = sizeof(CellStoreV4) + m_index_map32.memory_used();
@@ -880,9 +880,9 @@ void CellStoreV4::display_block_info() {
 
 
 
-void CellStoreV4::record_split_row(const SerializedKey key) {
-  if (key.ptr) {
-    std::string split_row = key.row();
+void CellStoreV4::record_split_row(const char *row) {
+  if (row) {
+    std::string split_row = row;
     if (split_row > m_start_row && split_row < m_end_row)
       m_split_row = split_row;
   }
@@ -20,10 +20,12 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <cassert>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "Common/Config.h"
 #include "Common/Error.h"
@@ -34,6 +36,7 @@
 
 #include "AsyncComm/Protocol.h"
 
+#include "Hypertable/Lib/BlockCompressionCodecAdaptive.h"
 #include "Hypertable/Lib/BlockCompressionHeader.h"
 #include "Hypertable/Lib/CompressorFactory.h"
 #include "Hypertable/Lib/Key.h"
@@ -60,7 +63,9 @@ namespace {
 
 CellStoreV5::CellStoreV5(Filesystem *filesys, Schema *schema)
   : m_filesys(filesys), m_schema(schema), m_fd(-1), m_filename(),
-    m_64bit_index(false), m_compressor(0), m_buffer(0),
+    m_64bit_index(false), m_compressor(0), m_none_compressor(0),
+    m_block_compressor(0), m_blocks_until_sample(0), m_sample_interval(0),
+    m_min_savings(0), m_codec_tolerance(0), m_sample_buf(0), m_buffer(0),
     m_outstanding_appends(0), m_offset(0), m_file_length(0),
     m_disk_usage(0), m_file_id(0), m_uncompressed_blocksize(0),
     m_bloom_filter_mode(BLOOM_FILTER_DISABLED), m_bloom_filter(0),
@@ -74,6 +79,7 @@ CellStoreV5::CellStoreV5(Filesystem *filesys, Schema *schema)
 CellStoreV5::~CellStoreV5() {
   try {
     delete m_compressor;
+    delete_block_compressors();
     delete m_bloom_filter;
     delete m_bloom_filter_items;
     if (m_fd != -1)
@@ -89,8 +95,12 @@ CellStoreV5::~CellStoreV5() {
 }
 
 
+/**
+ * Data blocks may be compressed with a codec other than the one recorded
+ * in the trailer (see compress_block), so inflate per block header
+ */
 BlockCompressionCodec *CellStoreV5::create_block_compression_codec() {
-  return CompressorFactory::create_block_codec(
+  return new BlockCompressionCodecAdaptive(
       (BlockCompressionCodec::Type)m_trailer.compression_type);
 }
 
@@ -109,6 +119,13 @@ const char *CellStoreV5::get_split_row() {
   return 0;
 }
 
+void CellStoreV5::get_split_row_samples(SplitRowSampler::SampleVector &samples) {
+  if (m_split_row_samples.empty() && m_index_stats.block_index_memory == 0)
+    load_block_index();
+  samples.insert(samples.end(), m_split_row_samples.begin(),
+                 m_split_row_samples.end());
+}
+
 CellListScanner *CellStoreV5::create_scanner(ScanContextPtr &scan_ctx) {
   bool need_index =  m_restricted_range || scan_ctx->restricted_range || scan_ctx->single_row;
 
@@ -192,6 +209,8 @@ CellStoreV5::create(const char *fname, size_t max_entries,
       (BlockCompressionCodec::Type)m_trailer.compression_type,
       m_compressor_args);
 
+  setup_block_compressors();
+
   uint32_t oflags = Filesystem::OPEN_FLAG_DIRECTIO|Filesystem::OPEN_FLAG_OVERWRITE;
   m_fd = m_filesys->create(m_filename, oflags, -1, -1, -1);
 
@@ -254,6 +273,112 @@ void CellStoreV5::create_bloom_filter(bool is_approx) {
     << m_filename <<"'"<< HT_END;
 }
 
+void CellStoreV5::setup_block_compressors() {
+  String codecs = Config::get_str("Hypertable.RangeServer.CellStore"
+                                  ".AdaptiveCompression.Codecs", String());
+  std::vector<String> specs;
+
+  m_min_savings = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                  ".AdaptiveCompression.MinSavings", 0);
+  if (m_min_savings > 0 &&
+      m_trailer.compression_type != BlockCompressionCodec::NONE)
+    m_none_compressor =
+      CompressorFactory::create_block_codec(BlockCompressionCodec::NONE);
+
+  boost::trim(codecs);
+  if (codecs.empty())
+    return;
+
+  m_codec_tolerance = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                      ".AdaptiveCompression.Tolerance", 10);
+  m_sample_interval = Config::get_i32("Hypertable.RangeServer.CellStore"
+      ".AdaptiveCompression.SampleInterval", 16);
+  if (m_sample_interval < 1)
+    m_sample_interval = 1;
+
+  boost::split(specs, codecs, boost::is_any_of(","));
+  foreach(String &spec, specs) {
+    boost::trim(spec);
+    if (spec.empty())
+      continue;
+    BlockCompressionCodec *codec = CompressorFactory::create_block_codec(spec);
+    if (codec == 0)
+      HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE, "Bad codec '%s' in "
+                "Hypertable.RangeServer.CellStore.AdaptiveCompression.Codecs",
+                spec.c_str());
+    if (codec->get_type() == (int)m_trailer.compression_type) {
+      delete codec;
+      continue;
+    }
+    m_block_compressors.push_back(codec);
+  }
+
+  // The access group compressor is the last resort, it is owned by
+  // m_compressor and not deleted with the candidates
+  if (!m_block_compressors.empty()) {
+    m_block_compressors.push_back(m_compressor);
+    m_block_compressor = m_block_compressors.size() - 1;
+    m_blocks_until_sample = 0;
+  }
+}
+
+
+/**
+ * Compresses m_buffer into zbuf.  If AdaptiveCompression codecs are
+ * configured, every m_sample_interval blocks each candidate compresses the
+ * block and the first one (i.e. the cheapest) whose output is within
+ * m_codec_tolerance percent of the smallest is used until the next sample.
+ * Blocks that don't shrink by at least m_min_savings percent are stored
+ * uncompressed so reads don't pay inflate cost for them.  The codec is
+ * recorded in each block header.
+ */
+void CellStoreV5::compress_block(DynamicBuffer &zbuf,
+                                 BlockCompressionHeader &header) {
+  BlockCompressionCodec *codec = m_compressor;
+
+  if (!m_block_compressors.empty()) {
+    if (m_blocks_until_sample-- == 0) {
+      std::vector<size_t> zlength(m_block_compressors.size());
+      size_t smallest = (size_t)-1;
+      for (size_t i=0; i<m_block_compressors.size(); i++) {
+        BlockCompressionHeader sample_header(DATA_BLOCK_MAGIC);
+        m_block_compressors[i]->deflate(m_buffer, m_sample_buf, sample_header);
+        zlength[i] = sample_header.get_data_zlength();
+        if (zlength[i] < smallest)
+          smallest = zlength[i];
+      }
+      for (size_t i=0; i<m_block_compressors.size(); i++) {
+        if (zlength[i]*100 <= smallest*(100+m_codec_tolerance)) {
+          m_block_compressor = i;
+          break;
+        }
+      }
+      m_blocks_until_sample = m_sample_interval - 1;
+    }
+    codec = m_block_compressors[m_block_compressor];
+  }
+
+  codec->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+
+  if (m_none_compressor &&
+      header.get_compression_type() != BlockCompressionCodec::NONE &&
+      (uint64_t)header.get_data_zlength() * 100 >
+      (uint64_t)header.get_data_length() * (100 - m_min_savings))
+    m_none_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+}
+
+
+void CellStoreV5::delete_block_compressors() {
+  for (size_t i=0; i<m_block_compressors.size(); i++) {
+    if (m_block_compressors[i] != m_compressor)
+      delete m_block_compressors[i];
+  }
+  m_block_compressors.clear();
+  delete m_none_compressor;
+  m_none_compressor = 0;
+}
+
+
 const std::vector<String> &CellStoreV5::get_replaced_files() {
   if (!m_replaced_files_loaded)
     load_replaced_files();
@@ -388,7 +513,7 @@ void CellStoreV5::add(const Key &key, const ByteString value) {
   if (key.timestamp != TIMESTAMP_NULL) {
     if (key.timestamp < m_trailer.timestamp_min)
       m_trailer.timestamp_min = key.timestamp;
-    else if (key.timestamp > m_trailer.timestamp_max)
+    if (key.timestamp > m_trailer.timestamp_max)
       m_trailer.timestamp_max = key.timestamp;
   }
 
@@ -398,7 +523,7 @@ void CellStoreV5::add(const Key &key, const ByteString value) {
     m_index_builder.add_entry(m_key_compressor, m_offset);
 
     m_uncompressed_data += (float)m_buffer.fill();
-    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    compress_block(zbuf, header);
     m_compressed_data += (float)zbuf.fill();
     m_buffer.clear();
 
@@ -506,7 +631,7 @@ void CellStoreV5::finalize(TableIdentifier *table_identifier) {
     m_index_builder.add_entry(m_key_compressor, m_offset);
 
     m_uncompressed_data += (float)m_buffer.fill();
-    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    compress_block(zbuf, header);
     m_compressed_data += (float)zbuf.fill();
 
     if (!HT_IO_ALIGNED(zbuf.fill())) {
@@ -579,6 +704,7 @@ void CellStoreV5::finalize(TableIdentifier *table_identifier) {
 
   delete m_compressor;
   m_compressor = 0;
+  delete_block_compressors();
 
   if (!HT_IO_ALIGNED(zbuf.fill())) {
     memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
@@ -659,13 +785,17 @@ void CellStoreV5::finalize(TableIdentifier *table_identifier) {
 
   m_64bit_index = m_index_builder.big_int();
 
+  // timestamp_max may be too small in files written without this flag
+  m_trailer.flags |= CellStoreTrailerV5::TIMESTAMP_BOUNDS;
+
   /** Set up index **/
   if (m_64bit_index) {
     m_index_map64.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset);
     m_trailer.index_entries = m_index_map64.index_entries();
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
+    record_split_row_samples( m_index_map64.row_sampler() );
     index_memory = m_index_map64.memory_used();
     m_trailer.flags |= CellStoreTrailerV5::INDEX_64BIT;
   }
@@ -675,7 +805,8 @@ void CellStoreV5::finalize(TableIdentifier *table_identifier) {
                        m_trailer.fix_index_offset);
     m_trailer.index_entries = m_index_map32.index_entries();
     index_memory = m_index_map32.memory_used();
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
+    record_split_row_samples( m_index_map32.row_sampler() );
   }
 
   // deallocate fix index data
@@ -917,14 +1048,16 @@ void CellStoreV5::load_block_index() {
     m_index_map64.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map64.middle_key() );
+    record_split_row( m_index_map64.middle_row() );
+    record_split_row_samples( m_index_map64.row_sampler() );
     m_index_stats.block_index_memory = m_index_map64.memory_used();
   }
   else {
     m_index_map32.load(m_index_builder.fixed_buf(),
                        m_index_builder.variable_buf(),
                        m_trailer.fix_index_offset, m_start_row, m_end_row);
-    record_split_row( m_index_map32.middle_key() );
+    record_split_row( m_index_map32.middle_row() );
+    record_split_row_samples( m_index_map32.row_sampler() );
     m_index_stats.block_index_memory = m_index_map32.memory_used();
   }
 
@@ -997,11 +1130,212 @@ void CellStoreV5::display_block_info() {
 }
 
 
+void CellStoreV5::display_block_codec_info() {
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+  if (m_64bit_index)
+    display_block_codecs(m_index_map64);
+  else
+    display_block_codecs(m_index_map32);
+}
+
+
+/**
+ * Reads the header of each data block and prints the number of blocks,
+ * the uncompressed and compressed bytes and the ratio per codec
+ */
+template <typename IndexT>
+void CellStoreV5::display_block_codecs(IndexT &index) {
+  const uint32_t limit = BlockCompressionCodec::COMPRESSION_TYPE_LIMIT;
+  uint64_t blocks[limit], length[limit], zlength[limit];
+  uint64_t unknown_blocks = 0;
+  DynamicBuffer buf(HT_DIRECT_IO_ALIGNMENT);
+  int32_t fd = get_fd();
+
+  memset(blocks, 0, sizeof(blocks));
+  memset(length, 0, sizeof(length));
+  memset(zlength, 0, sizeof(zlength));
+
+  for (typename IndexT::iterator iter = index.begin();
+       iter != index.end(); ++iter) {
+    BlockCompressionHeader header;
+    const uint8_t *ptr = buf.base;
+    size_t remaining = m_filesys->pread(fd, buf.base, HT_DIRECT_IO_ALIGNMENT,
+                                        iter.value());
+    header.decode(&ptr, &remaining);
+    uint16_t type = header.get_compression_type();
+    if (type >= limit) {
+      std::cout << "unknown compression type " << type << " in block at "
+                << "offset " << iter.value() << "\n";
+      unknown_blocks++;
+      continue;
+    }
+    blocks[type]++;
+    length[type] += header.get_data_length();
+    zlength[type] += header.get_data_zlength();
+  }
+
+  for (uint32_t type=0; type<limit; type++) {
+    if (blocks[type] == 0)
+      continue;
+    std::cout << BlockCompressionCodec::get_compressor_name(type)
+              << ": blocks=" << blocks[type] << " length=" << length[type]
+              << " zlength=" << zlength[type] << " ratio="
+              << (double)zlength[type] / (double)length[type] << "\n";
+  }
+  if (unknown_blocks)
+    std::cout << "unknown: blocks=" << unknown_blocks << "\n";
+  std::cout << std::flush;
+}
+
+
+
+void CellStoreV5::get_cached_row_intervals(RowIntervals &intervals) {
+  std::set<uint32_t> offsets;
 
-void CellStoreV5::record_split_row(const SerializedKey key) {
-  if (key.ptr) {
-    std::string split_row = key.row();
+  Global::block_cache->get_cached_offsets(m_file_id, offsets);
+  if (offsets.empty())
+    return;
+
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+
+  if (m_64bit_index)
+    collect_cached_row_intervals(m_index_map64, offsets, intervals);
+  else
+    collect_cached_row_intervals(m_index_map32, offsets, intervals);
+}
+
+
+int64_t CellStoreV5::warm_block_cache(RowIntervals &intervals, int64_t budget) {
+  RowIntervals merged;
+
+  if (intervals.empty() || budget <= 0)
+    return 0;
+
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+
+  // Coalesce into sorted, disjoint intervals
+  sort(intervals.begin(), intervals.end());
+  for (size_t i=0; i<intervals.size(); i++) {
+    if (!merged.empty() && intervals[i].first <= merged.back().second) {
+      if (intervals[i].second > merged.back().second)
+        merged.back().second = intervals[i].second;
+    }
+    else
+      merged.push_back(intervals[i]);
+  }
+
+  if (m_64bit_index)
+    return load_blocks(m_index_map64, merged, budget);
+  return load_blocks(m_index_map32, merged, budget);
+}
+
+
+/**
+ * Each index entry holds the last key of a block, so a block covers the
+ * rows from the previous entry's row through its own row
+ */
+template <typename IndexT>
+void CellStoreV5::collect_cached_row_intervals(IndexT &index,
+                                               const std::set<uint32_t> &offsets,
+                                               RowIntervals &intervals) {
+  String prev_row, last_row;
+
+  for (typename IndexT::iterator iter = index.begin();
+       iter != index.end(); ++iter) {
+    last_row = iter.key().row();
+    if (offsets.count((uint32_t)iter.value()))
+      intervals.push_back(std::make_pair(prev_row, last_row));
+    prev_row = last_row;
+  }
+}
+
+
+template <typename IndexT>
+int64_t CellStoreV5::load_blocks(IndexT &index, RowIntervals &intervals,
+                                 int64_t budget) {
+  boost::scoped_ptr<BlockCompressionCodec> zcodec(create_block_compression_codec());
+  DynamicBuffer expand_buf(0);
+  typename IndexT::iterator iter, next_iter;
+  String prev_row, last_row;
+  int64_t loaded = 0;
+  int64_t offset, zlength;
+  size_t j = 0;
+  int32_t fd = get_fd();
+
+  for (iter = index.begin(); iter != index.end() && loaded < budget;
+       iter = next_iter) {
+    next_iter = iter;
+    ++next_iter;
+
+    last_row = iter.key().row();
+
+    while (j < intervals.size() && intervals[j].second < prev_row)
+      j++;
+    if (j == intervals.size())
+      break;
+
+    bool overlaps = intervals[j].first <= last_row;
+    prev_row = last_row;
+    if (!overlaps)
+      continue;
+
+    offset = iter.value();
+    if (next_iter == index.end())
+      zlength = index.end_of_last_block() - offset;
+    else
+      zlength = next_iter.value() - offset;
+
+    DynamicBuffer buf(zlength);
+    m_filesys->pread(fd, buf.ptr, zlength, offset);
+    buf.ptr += zlength;
+
+    BlockCompressionHeader header;
+    zcodec->inflate(buf, expand_buf, header);
+
+    if (!header.check_magic(CellStore::DATA_BLOCK_MAGIC))
+      HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
+               "Error inflating cell store block - magic string mismatch");
+
+    size_t fill;
+    uint8_t *block = expand_buf.release(&fill);
+
+    // Stop rather than evict blocks that are in use
+    if (!Global::block_cache->insert(m_file_id, (uint32_t)offset, block, fill)) {
+      delete [] block;
+      break;
+    }
+    loaded += fill;
+  }
+
+  return loaded;
+}
+
+
+void CellStoreV5::record_split_row(const char *row) {
+  if (row) {
+    std::string split_row = row;
     if (split_row > m_start_row && split_row < m_end_row)
       m_split_row = split_row;
   }
 }
+
+
+/**
+ * Keeps the in-range samples of the block index, in uncompressed bytes, so
+ * that they survive the index being purged
+ */
+void CellStoreV5::record_split_row_samples(const SplitRowSampler &sampler) {
+  SplitRowSampler::SampleVector samples;
+  double scale = 1.0;
+  if (m_trailer.compression_ratio > 0.0)
+    scale = 1.0 / m_trailer.compression_ratio;
+  sampler.get_samples(samples, scale);
+  m_split_row_samples.clear();
+  foreach (SplitRowSampler::Sample &sample, samples) {
+    if (sample.row > m_start_row && sample.row < m_end_row)
+      m_split_row_samples.push_back(sample);
+  }
+}
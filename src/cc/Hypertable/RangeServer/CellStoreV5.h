@@ -23,6 +23,7 @@
 #define HYPERTABLE_CELLSTOREV5_H
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -95,6 +96,7 @@ namespace Hypertable {
     virtual uint64_t disk_usage() { return m_disk_usage; }
     virtual float compression_ratio() { return m_trailer.compression_ratio; }
     virtual const char *get_split_row();
+    virtual void get_split_row_samples(SplitRowSampler::SampleVector &samples);
     virtual int64_t get_total_entries() { return m_trailer.total_entries; }
     virtual std::string &get_filename() { return m_filename; }
     virtual int get_file_id() { return m_file_id; }
@@ -102,6 +104,7 @@ namespace Hypertable {
     virtual BlockCompressionCodec *create_block_compression_codec();
     virtual KeyDecompressor *create_key_decompressor();
     virtual void display_block_info();
+    virtual void display_block_codec_info();
     virtual int64_t end_of_last_block() { return m_trailer.fix_index_offset; }
     virtual size_t bloom_filter_size() { return m_bloom_filter ? m_bloom_filter->size() : 0; }
     virtual int64_t bloom_filter_memory_used() { return m_index_stats.bloom_filter_memory; }
@@ -109,6 +112,8 @@ namespace Hypertable {
     virtual uint64_t purge_indexes();
     virtual bool restricted_range() { return m_restricted_range; }
     virtual const std::vector<String> &get_replaced_files();
+    virtual void get_cached_row_intervals(RowIntervals &intervals);
+    virtual int64_t warm_block_cache(RowIntervals &intervals, int64_t budget);
 
     virtual int32_t get_fd() {
       ScopedLock lock(m_mutex);
@@ -126,11 +131,24 @@ namespace Hypertable {
     virtual CellStoreTrailer *get_trailer() { return &m_trailer; }
 
   protected:
-    void record_split_row(const SerializedKey key);
+    void record_split_row(const char *row);
+    void record_split_row_samples(const SplitRowSampler &sampler);
+    void setup_block_compressors();
+    void compress_block(DynamicBuffer &zbuf, BlockCompressionHeader &header);
+    void delete_block_compressors();
     void create_bloom_filter(bool is_approx = false);
     void load_bloom_filter();
     void load_block_index();
     void load_replaced_files();
+    template <typename IndexT>
+    void collect_cached_row_intervals(IndexT &index,
+                                      const std::set<uint32_t> &offsets,
+                                      RowIntervals &intervals);
+    template <typename IndexT>
+    int64_t load_blocks(IndexT &index, RowIntervals &intervals,
+                        int64_t budget);
+    template <typename IndexT>
+    void display_block_codecs(IndexT &index);
 
     typedef BlobHashSet<> BloomFilterItems;
 
@@ -144,6 +162,14 @@ namespace Hypertable {
     bool                   m_64bit_index;
     CellStoreTrailerV5     m_trailer;
     BlockCompressionCodec *m_compressor;
+    BlockCompressionCodec *m_none_compressor;
+    std::vector<BlockCompressionCodec *> m_block_compressors;
+    size_t                 m_block_compressor;
+    int32_t                m_blocks_until_sample;
+    int32_t                m_sample_interval;
+    int32_t                m_min_savings;
+    int32_t                m_codec_tolerance;
+    DynamicBuffer          m_sample_buf;
     DynamicBuffer          m_buffer;
     IndexBuilder           m_index_builder;
     DispatchHandlerSynchronizer  m_sync_handler;
@@ -152,6 +178,7 @@ namespace Hypertable {
     int64_t                m_file_length;
     int64_t                m_disk_usage;
     std::string            m_split_row;
+    SplitRowSampler::SampleVector m_split_row_samples;
     int                    m_file_id;
     float                  m_uncompressed_data;
     float                  m_compressed_data;
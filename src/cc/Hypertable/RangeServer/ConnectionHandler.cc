@@ -58,6 +58,7 @@ extern "C" {
 #include "RequestHandlerClose.h"
 #include "RequestHandlerCommitLogSync.h"
 #include "RequestHandlerWaitForMaintenance.h"
+#include "RequestHandlerAdoptCellStores.h"
 
 #include "ConnectionHandler.h"
 #include "RangeServer.h"
@@ -204,6 +205,10 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new RequestHandlerMetadataSync(m_comm, m_range_server_ptr.get(),
                                                  event);
         break;
+      case RangeServerProtocol::COMMAND_ADOPT_CELLSTORES:
+        handler = new RequestHandlerAdoptCellStores(m_comm, m_range_server_ptr.get(),
+                                                    event);
+        break;
 
       default:
         HT_THROWF(PROTOCOL_ERROR, "Unimplemented command (%llu)",
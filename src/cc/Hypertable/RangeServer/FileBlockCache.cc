@@ -130,6 +130,44 @@ bool FileBlockCache::contains(int file_id, uint32_t file_offset) {
 }
 
 
+bool FileBlockCache::insert(int file_id, uint32_t file_offset,
+                            uint8_t *block, uint32_t length) {
+  ScopedLock lock(m_mutex);
+  HashIndex &hash_index = m_cache.get<1>();
+  int64_t key = ((int64_t)file_id << 32) | file_offset;
+
+  if (hash_index.find(key) != hash_index.end())
+    return false;
+
+  if (m_available < length)
+    make_room(length);
+
+  if (m_available < length)
+    return false;
+
+  BlockCacheEntry entry(file_id, file_offset);
+  entry.block = block;
+  entry.length = length;
+
+  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  assert(insert_result.second);
+
+  m_available -= length;
+
+  return true;
+}
+
+
+void FileBlockCache::get_cached_offsets(int file_id, std::set<uint32_t> &offsets) {
+  ScopedLock lock(m_mutex);
+  FileIndex &index = m_cache.get<2>();
+  std::pair<FileIndex::iterator, FileIndex::iterator> range
+    = index.equal_range(file_id);
+  for (FileIndex::iterator iter = range.first; iter != range.second; ++iter)
+    offsets.insert((*iter).file_offset);
+}
+
+
 void FileBlockCache::increase_limit(int64_t amount) {
   ScopedLock lock(m_mutex);
   int64_t adjusted_amount = amount;
@@ -22,9 +22,13 @@
 #ifndef HYPERTABLE_FILEBLOCKCACHE_H
 #define HYPERTABLE_FILEBLOCKCACHE_H
 
+#include <set>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
 #include "Common/Mutex.h"
@@ -50,6 +54,24 @@ namespace Hypertable {
                              uint8_t *block, uint32_t length);
     bool contains(int file_id, uint32_t file_offset);
 
+    /**
+     * Inserts a block without checking it out.  Unlike insert_and_checkout,
+     * this never raises the limit; if room cannot be made by evicting
+     * unreferenced blocks, the block is not inserted and false is returned
+     * (the caller retains ownership of the block in that case).  Used to
+     * pre-load blocks that are expected to be read soon.
+     */
+    bool insert(int file_id, uint32_t file_offset, uint8_t *block,
+                uint32_t length);
+
+    /**
+     * Collects the offsets of all cached blocks of the given file
+     *
+     * @param file_id file ID
+     * @param offsets set to hold cached block offsets
+     */
+    void get_cached_offsets(int file_id, std::set<uint32_t> &offsets);
+
     void increase_limit(int64_t amount);
 
     /**
@@ -67,6 +89,10 @@ namespace Hypertable {
       return m_limit;
     }
 
+    int64_t get_min_memory() const { return m_min_memory; }
+
+    int64_t get_max_memory() const { return m_max_memory; }
+
     /**
      * Sets limit to memory currently used, it will not reduce the limit
      * below min_memory
@@ -135,12 +161,15 @@ namespace Hypertable {
       indexed_by<
         sequenced<>,
         hashed_unique<const_mem_fun<BlockCacheEntry, int64_t,
-                      &BlockCacheEntry::key>, HashI64>
+                      &BlockCacheEntry::key>, HashI64>,
+        ordered_non_unique<member<BlockCacheEntry, int,
+                           &BlockCacheEntry::file_id> >
       >
     > BlockCache;
 
     typedef BlockCache::nth_index<0>::type Sequence;
     typedef BlockCache::nth_index<1>::type HashIndex;
+    typedef BlockCache::nth_index<2>::type FileIndex;
 
     Mutex         m_mutex;
     BlockCache    m_cache;
@@ -22,8 +22,123 @@
 #include "Common/Compat.h"
 #include "FillScanBlock.h"
 
+#include "Hypertable/Lib/ScanAggregator.h"
+
 namespace Hypertable {
 
+  namespace {
+
+    /**
+     * An aggregate block summarizes at most this many times the scan
+     * buffer size of cells, so that fetch requests over large ranges
+     * return before they time out
+     */
+    const int64_t AGGREGATE_SCAN_FACTOR = 64;
+
+    void flush_aggregates(DynamicBuffer &dbuf, const char *row,
+                          std::vector<uint8_t> &families,
+                          AggregateValue *aggregates) {
+      uint8_t buf[AggregateValue::ENCODED_LENGTH];
+      uint8_t *ptr;
+
+      foreach(uint8_t family, families) {
+        ptr = buf;
+        aggregates[family].encode(&ptr);
+        create_key_and_append(dbuf, FLAG_INSERT, row, family, "",
+                              TIMESTAMP_NULL);
+        append_as_byte_string(dbuf, buf, ptr - buf);
+        aggregates[family] = AggregateValue();
+      }
+      families.clear();
+    }
+
+    /**
+     * Fills the block with partial aggregates of the cells returned by
+     * the scanner, one per (row, column family) for AGGREGATE_ROW and one
+     * per column family, with an empty row, otherwise.
+     */
+    bool
+    fill_aggregate_block(CellListScannerPtr &scanner, DynamicBuffer &dbuf,
+                         int64_t buffer_size) {
+      Key key, last_key;
+      ByteString value;
+      bool more = true;
+      uint8_t *ptr;
+      ScanContext *scan_context = scanner->scan_context();
+      bool per_row = scan_context->spec->aggregate == ScanSpec::AGGREGATE_ROW;
+      AggregateValue aggregates[256];
+      std::vector<uint8_t> families;
+      DynamicBuffer last_serial;
+      String group_row;
+      int64_t scanned = 0;
+      int64_t count;
+
+      dbuf.reserve(4 + 1024);
+      // skip encoded length
+      dbuf.ptr = dbuf.base + 4;
+
+      while ((more = scanner->get(key, value))) {
+        // drop duplicates
+        if (last_serial.fill() &&
+            key.timestamp == last_key.timestamp &&
+            key.row_len == last_key.row_len &&
+            key.column_family_code == last_key.column_family_code &&
+            key.column_qualifier_len == last_key.column_qualifier_len &&
+            !strcmp(key.row, last_key.row) &&
+            !strcmp(key.column_qualifier, last_key.column_qualifier)) {
+          scanner->forward();
+          continue;
+        }
+
+        if (per_row && !families.empty() && strcmp(key.row, group_row.c_str()))
+          flush_aggregates(dbuf, group_row.c_str(), families, aggregates);
+
+        if ((int64_t)dbuf.fill() - 4 >= buffer_size ||
+            scanned >= AGGREGATE_SCAN_FACTOR * buffer_size)
+          break;
+
+        last_serial.clear();
+        last_serial.add(key.serial.ptr, key.length);
+        last_key.load(SerializedKey(last_serial.base));
+
+        if (key.flag == FLAG_INSERT) {
+          AggregateValue &aggregate = aggregates[key.column_family_code];
+          if (aggregate.count == 0) {
+            if (per_row && families.empty())
+              group_row = key.row;
+            families.push_back(key.column_family_code);
+          }
+          aggregate.count++;
+          if (scan_context->family_info[key.column_family_code].counter) {
+            const uint8_t *decode;
+            size_t remain = value.decode_length(&decode);
+            if (remain == 8) {
+              count = Serialization::decode_i64(&decode, &remain);
+              aggregate.add(count);
+            }
+          }
+          else {
+            const uint8_t *decode;
+            size_t len = value.decode_length(&decode);
+            if (AggregateValue::parse(decode, len, &count))
+              aggregate.add(count);
+          }
+        }
+
+        scanned += key.length + value.length();
+        scanner->forward();
+      }
+
+      flush_aggregates(dbuf, group_row.c_str(), families, aggregates);
+
+      ptr = dbuf.base;
+      Serialization::encode_i32(&ptr, dbuf.fill() - 4);
+
+      return more;
+    }
+
+  }
+
   bool
   FillScanBlock(CellListScannerPtr &scanner, DynamicBuffer &dbuf, int64_t buffer_size) {
     Key key, last_key;
@@ -43,6 +158,9 @@ namespace Hypertable {
 
     assert(dbuf.base == 0);
 
+    if (scan_context->spec->aggregate != ScanSpec::AGGREGATE_NONE)
+      return fill_aggregate_block(scanner, dbuf, buffer_size);
+
     memset(&last_key, 0, sizeof(last_key));
 
     while ((more = scanner->get(key, value))) {
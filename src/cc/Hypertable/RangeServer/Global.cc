@@ -47,19 +47,31 @@ namespace Hypertable {
   LocationInitializerPtr Global::location_initializer;
   int64_t                Global::range_split_size = 0;
   int64_t                Global::range_maximum_size = 0;
+  int32_t                Global::range_load_split_cell_rate = 0;
+  int64_t                Global::range_load_split_byte_rate = 0;
+  int32_t                Global::range_load_split_intervals = 0;
+  int64_t                Global::range_load_split_minimum_size = 0;
+  bool                   Global::range_move_ship_cell_caches = false;
   int32_t                Global::access_group_garbage_compaction_threshold = 0;
   int32_t                Global::access_group_max_mem = 0;
   int32_t                Global::cell_cache_scanner_cache_size = 0;
+  int32_t                Global::cell_cache_compaction_threshold = 0;
+  int64_t                Global::cell_cache_compaction_min_memory = 0;
   ScannerMap             Global::scanner_map;
   FileBlockCache        *Global::block_cache = 0;
+  int64_t                Global::block_cache_warmup_budget = 0;
+  WireCompressorPtr      Global::wire_compressor;
   TablePtr               Global::metadata_table = 0;
   TablePtr               Global::rs_metrics_table = 0;
   int64_t                Global::range_metadata_split_size = 0;
   MemoryTracker         *Global::memory_tracker = 0;
+  MemoryGovernor        *Global::memory_governor = 0;
+  CellCachePagePool     *Global::cell_cache_page_pool = 0;
   int64_t                Global::log_prune_threshold_min = 0;
   int64_t                Global::log_prune_threshold_max = 0;
   int64_t                Global::cellstore_target_size_min = 0;
   int64_t                Global::cellstore_target_size_max = 0;
+  int32_t                Global::cellstore_async_reads = 0;
   int64_t                Global::memory_limit = 0;
   int64_t                Global::memory_limit_ensure_unused = 0;
   int64_t                Global::memory_limit_ensure_unused_current = 0;
@@ -39,6 +39,7 @@
 #include "Hypertable/Lib/Schema.h"
 #include "Hypertable/Lib/Client.h"
 #include "Hypertable/Lib/Types.h"
+#include "Hypertable/Lib/WireCompressor.h"
 
 #include "FileBlockCache.h"
 #include "LocationInitializer.h"
@@ -50,6 +51,8 @@
 namespace Hypertable {
 
   class ApplicationQueue;
+  class CellCachePagePool;
+  class MemoryGovernor;
 
   class Global {
   public:
@@ -69,19 +72,31 @@ namespace Hypertable {
     static LocationInitializerPtr location_initializer;
     static int64_t        range_split_size;
     static int64_t        range_maximum_size;
+    static int32_t        range_load_split_cell_rate;
+    static int64_t        range_load_split_byte_rate;
+    static int32_t        range_load_split_intervals;
+    static int64_t        range_load_split_minimum_size;
+    static bool           range_move_ship_cell_caches;
     static int32_t        access_group_garbage_compaction_threshold;
     static int32_t        access_group_max_mem;
     static int32_t        cell_cache_scanner_cache_size;
+    static int32_t        cell_cache_compaction_threshold;
+    static int64_t        cell_cache_compaction_min_memory;
     static ScannerMap     scanner_map;
     static Hypertable::FileBlockCache *block_cache;
+    static int64_t        block_cache_warmup_budget;
+    static WireCompressorPtr wire_compressor;
     static TablePtr       metadata_table;
     static TablePtr       rs_metrics_table;
     static int64_t        range_metadata_split_size;
     static Hypertable::MemoryTracker *memory_tracker;
+    static MemoryGovernor *memory_governor;
+    static CellCachePagePool *cell_cache_page_pool;
     static int64_t        log_prune_threshold_min;
     static int64_t        log_prune_threshold_max;
     static int64_t        cellstore_target_size_min;
     static int64_t        cellstore_target_size_max;
+    static int32_t        cellstore_async_reads;
     static int64_t        memory_limit;
     // amount of unused physical memory to achieve according
     // to the configuration
@@ -44,6 +44,7 @@ void GroupCommit::add(EventPtr &event, SchemaPtr &schema, const TableIdentifier
 
   request->buffer = buffer;
   request->count = count;
+  request->flags = flags;
   request->event = event;
 
   if ((iter = m_table_map.find(*table)) == m_table_map.end()) {
@@ -55,12 +55,15 @@ namespace Hypertable {
 
   class UpdateRequest {
   public:
-    UpdateRequest() : count(0), error(0) { }
+    UpdateRequest() : count(0), flags(0), error(0), capacity_ratio(0.0) { }
     StaticBuffer buffer;
     uint32_t count;
+    uint32_t flags;
     EventPtr event;
     std::vector<SendBackRec> send_back_vector;
     uint32_t error;
+    // largest size/maximum size ratio of the ranges this request updated
+    double capacity_ratio;
   };
 
   class RangeUpdate {
@@ -29,7 +29,8 @@
 using namespace Hypertable;
 
 LoadMetricsRange::LoadMetricsRange(const String &table_id, const String &start_row, const String &end_row)
-  : m_new_rows(false), m_timestamp(time(0)) {
+  : m_new_rows(false), m_timestamp(time(0)), m_load_timestamp(m_timestamp),
+    m_hot_intervals(0) {
   initialize(table_id, start_row, end_row);
 }
 
@@ -127,6 +128,32 @@ void LoadMetricsRange::compute_and_store(TableMutator *mutator, time_t now,
 }
 
 
+int32_t LoadMetricsRange::update_load_rates(time_t now, LoadFactors &load_factors) {
+  ScopedLock lock(m_mutex);
+
+  if ((now - m_load_timestamp) <= 0)
+    return m_hot_intervals;
+
+  double time_interval = (double)(now - m_load_timestamp);
+  double cell_rate = (double)((load_factors.cells_scanned-m_load_split_factors.cells_scanned) +
+                              (load_factors.cells_written-m_load_split_factors.cells_written)) / time_interval;
+  double byte_rate = (double)((load_factors.bytes_scanned-m_load_split_factors.bytes_scanned) +
+                              (load_factors.bytes_written-m_load_split_factors.bytes_written)) / time_interval;
+
+  if ((Global::range_load_split_cell_rate &&
+       cell_rate >= (double)Global::range_load_split_cell_rate) ||
+      (Global::range_load_split_byte_rate &&
+       byte_rate >= (double)Global::range_load_split_byte_rate))
+    m_hot_intervals++;
+  else
+    m_hot_intervals = 0;
+
+  m_load_timestamp = now;
+  m_load_split_factors = load_factors;
+  return m_hot_intervals;
+}
+
+
 void LoadMetricsRange::initialize(const String &table_id, const String &start_row,
     const String &end_row) {
 
@@ -41,12 +41,24 @@ namespace Hypertable {
       m_new_start_row = start_row;
       m_new_end_row = end_row;
       m_new_rows = true;
+      m_hot_intervals = 0;
     }
 
     void compute_and_store(TableMutator *mutator, time_t now,
                            LoadFactors &load_factors,
                            uint64_t disk_used, uint64_t memory_used);
 
+    /**
+     * Computes the cell and byte rates since the previous call and returns
+     * the number of consecutive calls in which either of them exceeded the
+     * load split threshold (Hypertable.RangeServer.Range.LoadSplit.*).
+     *
+     * @param now current time
+     * @param load_factors current load counters of the range
+     * @return number of consecutive hot intervals
+     */
+    int32_t update_load_rates(time_t now, LoadFactors &load_factors);
+
   private:
 
     void initialize(const String &table_id, const String &start_row, const String &end_row);
@@ -61,6 +73,9 @@ namespace Hypertable {
     bool m_new_rows;
     time_t m_timestamp;
     LoadFactors m_load_factors;
+    time_t m_load_timestamp;
+    LoadFactors m_load_split_factors;
+    int32_t m_hot_intervals;
   };
 }
 
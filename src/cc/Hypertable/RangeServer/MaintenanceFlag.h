@@ -35,9 +35,11 @@ namespace Hypertable {
       COMPACT_MERGING           = 0x0204,
       COMPACT_GC                = 0x0208,
       COMPACT_MOVE              = 0x0210,
+      COMPACT_EXPIRED           = 0x0220,
       MEMORY_PURGE              = 0x0400,
       MEMORY_PURGE_SHADOW_CACHE = 0x0401,
       MEMORY_PURGE_CELLSTORE    = 0x0402,
+      MEMORY_PURGE_CELLCACHE    = 0x0404,
       RELINQUISH                = 0x0800
     };
 
@@ -69,6 +71,18 @@ namespace Hypertable {
       return (flags & COMPACT_MOVE) == COMPACT_MOVE;
     }
 
+    inline bool expired_compaction(int flags) {
+      return (flags & COMPACT_EXPIRED) == COMPACT_EXPIRED;
+    }
+
+    /** True if the flags call for a compaction that writes a new CellStore,
+     * as opposed to only dropping expired ones */
+    inline bool rewriting_compaction(int flags) {
+      return (flags & COMPACT) == COMPACT &&
+        (flags & (COMPACT_MINOR|COMPACT_MAJOR|COMPACT_MERGING|COMPACT_GC|
+                  COMPACT_MOVE) & ~COMPACT) != 0;
+    }
+
     inline bool purge_shadow_cache(int flags) {
       return (flags & MEMORY_PURGE_SHADOW_CACHE) == MEMORY_PURGE_SHADOW_CACHE;
     }
@@ -77,6 +91,10 @@ namespace Hypertable {
       return (flags & MEMORY_PURGE_CELLSTORE) == MEMORY_PURGE_CELLSTORE;
     }
 
+    inline bool purge_cellcache(int flags) {
+      return (flags & MEMORY_PURGE_CELLCACHE) == MEMORY_PURGE_CELLCACHE;
+    }
+
     class Hash {
     public:
       size_t operator () (const void *obj) const {
@@ -24,6 +24,7 @@
 #include "Common/ScopeGuard.h"
 #include "Common/StringExt.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -46,6 +47,21 @@ namespace {
     Range::MaintenanceData *rangedata;
   };
 
+  /**
+   * Inverts an ordering for use with the heap algorithms, so that
+   * pop_heap() yields the elements in the order sort() would place them.
+   * The candidates below are only consumed until enough memory has been
+   * freed, so building a heap in linear time and popping what is used is
+   * cheaper than sorting all of them.
+   */
+  template <typename Ordering>
+  struct HeapOrdering {
+    template <typename T>
+    bool operator()(const T &x, const T &y) const {
+      return Ordering()(y, x);
+    }
+  };
+
   struct StatsRecOrderingDescending {
     bool operator()(const StatsRec &x, const StatsRec &y) const {
       if (x.agdata->mem_used == y.agdata->mem_used)
@@ -100,7 +116,8 @@ MaintenancePrioritizer::schedule_inprogress_operations(RangeStatsVector &range_d
       continue;
 
     in_progress = false;
-    if (range_data[i]->state == RangeState::RELINQUISH_LOG_INSTALLED) {
+    if (range_data[i]->state == RangeState::RELINQUISH_LOG_INSTALLED ||
+        range_data[i]->state == RangeState::RELINQUISH_CACHE_SHIPPED) {
       HT_INFOF("Adding maintenance for range %s because mid-relinquish(%d)",
                range_data[i]->range->get_name().c_str(), range_data[i]->state);
       range_data[i]->maintenance_flags |= MaintenanceFlag::RELINQUISH;
@@ -117,6 +134,7 @@ MaintenancePrioritizer::schedule_inprogress_operations(RangeStatsVector &range_d
     if (in_progress) {
       range_data[i]->priority = priority++;
       if (range_data[i]->state == RangeState::RELINQUISH_LOG_INSTALLED ||
+          range_data[i]->state == RangeState::RELINQUISH_CACHE_SHIPPED ||
           range_data[i]->state == RangeState::SPLIT_LOG_INSTALLED) {
 	for (ag_data = range_data[i]->agdata; ag_data; ag_data = ag_data->next) {
           memory_state.decrement_needed( ag_data->mem_allocated );
@@ -185,6 +203,13 @@ MaintenancePrioritizer::schedule_splits_and_relinquishes(RangeStatsVector &range
           range_data[i]->priority = priority++;
 	  range_data[i]->maintenance_flags |= MaintenanceFlag::SPLIT;
         }
+        else if (range_data[i]->load_split) {
+          HT_INFOF("Adding maintenance for range %s because its load exceeds "
+                   "the load split threshold", range_data[i]->range->get_name().c_str());
+          memory_state.decrement_needed(mem_total);
+          range_data[i]->priority = priority++;
+	  range_data[i]->maintenance_flags |= MaintenanceFlag::SPLIT;
+        }
       }
     }
   }
@@ -210,7 +235,15 @@ MaintenancePrioritizer::schedule_necessary_compactions(RangeStatsVector &range_d
     disk_total = 0;
 
     for (ag_data = range_data[i]->agdata; ag_data; ag_data = ag_data->next) {
-      
+
+      // Drop CellStores whose cells have all expired
+      if (ag_data->expired_files > 0) {
+        range_data[i]->maintenance_flags |= MaintenanceFlag::COMPACT;
+        ag_data->maintenance_flags |= MaintenanceFlag::COMPACT_EXPIRED;
+        if (range_data[i]->priority == 0)
+          range_data[i]->priority = priority++;
+      }
+
       // Schedule compaction for AGs that need garbage collection
       if (ag_data->gc_needed) {
         range_data[i]->maintenance_flags |= MaintenanceFlag::COMPACT;
@@ -238,6 +271,16 @@ MaintenancePrioritizer::schedule_necessary_compactions(RangeStatsVector &range_d
 
       disk_total += ag_data->disk_estimate;
 
+      // Rebuild CellCaches dominated by obsolete versions and deletes
+      if (ag_data->cellcache_compaction_needed) {
+        trace_str += String("STAT ") + ag_data->ag->get_full_name() +
+          " cellcache compaction needed\n";
+        range_data[i]->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
+        ag_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_CELLCACHE;
+        if (range_data[i]->priority == 0)
+          range_data[i]->priority = priority++;
+      }
+
       if (ag_data->earliest_cached_revision != TIMESTAMP_MAX && !cumulative_size_map.empty()) {
 
         iter = cumulative_size_map.lower_bound(ag_data->earliest_cached_revision);
@@ -321,20 +364,20 @@ MaintenancePrioritizer::purge_shadow_caches(RangeStatsVector &range_data,
     }
   }
 
-  {
-    struct ShadowCacheSortOrdering ordering;
-    sort(csmd.begin(), csmd.end(), ordering);
-  }
-  
-  for (size_t i=0; i<csmd.size(); i++) {
-    ag_data = (AccessGroup::MaintenanceData *)(csmd[i]->user_data);
+  HeapOrdering<ShadowCacheSortOrdering> ordering;
+  make_heap(csmd.begin(), csmd.end(), ordering);
+
+  for (size_t end=csmd.size(); end>0; end--) {
+    pop_heap(csmd.begin(), csmd.begin()+end, ordering);
+    cs_data = csmd[end-1];
+    ag_data = (AccessGroup::MaintenanceData *)(cs_data->user_data);
     ag_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
     range_maintenance_data = (Range::MaintenanceData *)(ag_data->user_data);
     range_maintenance_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
     if (range_maintenance_data->priority == 0)
       range_maintenance_data->priority = priority++;
-    csmd[i]->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_SHADOW_CACHE;
-    memory_state.decrement_needed(csmd[i]->shadow_cache_size);
+    cs_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_SHADOW_CACHE;
+    memory_state.decrement_needed(cs_data->shadow_cache_size);
     if (!memory_state.need_more())
       return false;
   }
@@ -366,21 +409,21 @@ MaintenancePrioritizer::purge_cellstore_indexes(RangeStatsVector &range_data,
     }
   }
 
-  {
-    CellStoreIndexSortOrdering ordering;
-    sort(csmd.begin(), csmd.end(), ordering);
-  }
+  HeapOrdering<CellStoreIndexSortOrdering> ordering;
+  make_heap(csmd.begin(), csmd.end(), ordering);
 
   int64_t memory_used = 0;
-  for (size_t i=0; i<csmd.size(); i++) {
-    ag_data = (AccessGroup::MaintenanceData *)(csmd[i]->user_data);
+  for (size_t end=csmd.size(); end>0; end--) {
+    pop_heap(csmd.begin(), csmd.begin()+end, ordering);
+    cs_data = csmd[end-1];
+    ag_data = (AccessGroup::MaintenanceData *)(cs_data->user_data);
     ag_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
     range_maintenance_data = (Range::MaintenanceData *)(ag_data->user_data);
     range_maintenance_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
-    memory_used = csmd[i]->index_stats.block_index_memory + csmd[i]->index_stats.bloom_filter_memory;
+    memory_used = cs_data->index_stats.block_index_memory + cs_data->index_stats.bloom_filter_memory;
     if (range_maintenance_data->priority == 0)
       range_maintenance_data->priority = priority++;
-    csmd[i]->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_CELLSTORE;
+    cs_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_CELLSTORE;
     memory_state.decrement_needed(memory_used);
     if (!memory_state.need_more())
       return false;
@@ -423,17 +466,17 @@ MaintenancePrioritizer::compact_cellcaches(RangeStatsVector &range_data,
     }
   }
 
-  {
-    struct CellCacheCompactionSortOrdering ordering;
-    sort(md.begin(), md.end(), ordering);
-  }
-
-  for (size_t i=0; i<md.size(); i++) {
-    if (((Range::MaintenanceData *)md[i]->user_data)->priority == 0)
-      ((Range::MaintenanceData *)md[i]->user_data)->priority = priority++;
-    md[i]->maintenance_flags |= MaintenanceFlag::COMPACT_MINOR|MaintenanceFlag::MEMORY_PURGE_SHADOW_CACHE;
-    ((Range::MaintenanceData *)md[i]->user_data)->maintenance_flags |= MaintenanceFlag::COMPACT|MaintenanceFlag::MEMORY_PURGE;
-    memory_state.decrement_needed(md[i]->mem_allocated);
+  HeapOrdering<CellCacheCompactionSortOrdering> ordering;
+  make_heap(md.begin(), md.end(), ordering);
+
+  for (size_t end=md.size(); end>0; end--) {
+    pop_heap(md.begin(), md.begin()+end, ordering);
+    ag_data = md[end-1];
+    if (((Range::MaintenanceData *)ag_data->user_data)->priority == 0)
+      ((Range::MaintenanceData *)ag_data->user_data)->priority = priority++;
+    ag_data->maintenance_flags |= MaintenanceFlag::COMPACT_MINOR|MaintenanceFlag::MEMORY_PURGE_SHADOW_CACHE;
+    ((Range::MaintenanceData *)ag_data->user_data)->maintenance_flags |= MaintenanceFlag::COMPACT|MaintenanceFlag::MEMORY_PURGE;
+    memory_state.decrement_needed(ag_data->mem_allocated);
     if (!memory_state.need_more())
       return false;
   }
@@ -97,8 +97,12 @@ MaintenancePrioritizerLogCleanup::prioritize(RangeStatsVector &range_data,
 
   /**
    *  If there is no update activity, or there is little update activity and
-   *  scan activity, then increase the block cache size
+   *  scan activity, then increase the block cache size.  The memory governor,
+   *  if enabled, sizes the block cache instead.
    */
+  if (Global::memory_governor)
+    return;
+
   if (m_server_stats->get_update_bytes(collector_id) == 0 ||
       (m_server_stats->get_update_bytes(collector_id) < 1000000 &&
        m_server_stats->get_scan_count(collector_id) > 20)) {
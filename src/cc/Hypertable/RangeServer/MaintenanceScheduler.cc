@@ -21,6 +21,7 @@
 #include "Common/Compat.h"
 #include "Common/Config.h"
 #include "Common/SystemInfo.h"
+#include "Common/Time.h"
 
 #include <algorithm>
 #include <limits>
@@ -35,6 +36,7 @@
 #include "MaintenanceTaskMemoryPurge.h"
 #include "MaintenanceTaskRelinquish.h"
 #include "MaintenanceTaskSplit.h"
+#include "MemoryGovernor.h"
 
 using namespace Hypertable;
 using namespace std;
@@ -143,8 +145,12 @@ void MaintenanceScheduler::schedule() {
 
   Global::maintenance_queue->clear();
 
+  int64_t start_time = get_ts64();
+
   m_stats_gatherer->fetch(range_data);
 
+  int64_t gather_time = (get_ts64() - start_time) / 1000;
+
   if (range_data.empty()) {
     m_scheduling_needed = false;
     return;
@@ -257,6 +263,16 @@ void MaintenanceScheduler::schedule() {
   String dummy_str;
   m_prioritizer->prioritize(range_data, memory_state, priority, dummy_str);
 
+  if (Global::memory_governor) {
+    MemoryGovernor::Stats governor_stats;
+    Global::memory_governor->rebalance(range_data, low_memory, trace_str);
+    Global::memory_governor->get_stats(governor_stats);
+    if (m_query_cache_memory)
+      m_query_cache_memory = governor_stats.query_cache_limit;
+  }
+
+  int64_t prioritize_time = (get_ts64() - start_time) / 1000 - gather_time;
+
   check_file_dump_statistics(now, range_data, trace_str);
 
   boost::xtime schedule_time;
@@ -271,7 +287,8 @@ void MaintenanceScheduler::schedule() {
         RangePtr range(range_data[i]->range);
         Global::maintenance_queue->add(new MaintenanceTaskSplit(schedule_time, range));
       }
-      else if (range_data[i]->state == RangeState::RELINQUISH_LOG_INSTALLED) {
+      else if (range_data[i]->state == RangeState::RELINQUISH_LOG_INSTALLED ||
+               range_data[i]->state == RangeState::RELINQUISH_CACHE_SHIPPED) {
         RangePtr range(range_data[i]->range);
         Global::maintenance_queue->add(new MaintenanceTaskRelinquish(schedule_time, range));
       }
@@ -315,7 +332,11 @@ void MaintenanceScheduler::schedule() {
                 task->add_subtask(ag_data->ag, ag_data->maintenance_flags);
                 merges_created++;
               }
+              else if (MaintenanceFlag::expired_compaction(ag_data->maintenance_flags))
+                task->add_subtask(ag_data->ag, MaintenanceFlag::COMPACT_EXPIRED);
             }
+            else if (MaintenanceFlag::expired_compaction(ag_data->maintenance_flags))
+              task->add_subtask(ag_data->ag, ag_data->maintenance_flags);
           }
         }
         Global::maintenance_queue->add(task);
@@ -343,6 +364,20 @@ void MaintenanceScheduler::schedule() {
   m_scheduling_needed = false;
 
   m_stats_gatherer->clear();
+
+  {
+    size_t gathered, reused;
+    int64_t total_time = (get_ts64() - start_time) / 1000;
+    m_stats_gatherer->get_counts(&gathered, &reused);
+    ScopedLock lock(m_stats_mutex);
+    m_stats.passes++;
+    m_stats.total_time += total_time;
+    m_stats.last_time = total_time;
+    m_stats.last_gather_time = gather_time;
+    m_stats.last_prioritize_time = prioritize_time;
+    m_stats.ranges_gathered = gathered;
+    m_stats.ranges_reused = reused;
+  }
 }
 
 
@@ -22,6 +22,7 @@
 #ifndef HYPERTABLE_MAINTENANCESCHEDULER_H
 #define HYPERTABLE_MAINTENANCESCHEDULER_H
 
+#include "Common/Mutex.h"
 #include "Common/ReferenceCount.h"
 
 #include "MaintenancePrioritizerLogCleanup.h"
@@ -32,6 +33,24 @@ namespace Hypertable {
 
   class MaintenanceScheduler : public ReferenceCount {
   public:
+
+    /**
+     * Time spent scheduling maintenance, in microseconds, and the number of
+     * ranges whose statistics were gathered afresh or reused by the last
+     * pass.
+     */
+    struct Stats {
+      Stats() : passes(0), total_time(0), last_time(0), last_gather_time(0),
+                last_prioritize_time(0), ranges_gathered(0), ranges_reused(0) { }
+      uint64_t passes;
+      uint64_t total_time;
+      uint64_t last_time;
+      uint64_t last_gather_time;
+      uint64_t last_prioritize_time;
+      uint64_t ranges_gathered;
+      uint64_t ranges_reused;
+    };
+
     MaintenanceScheduler(MaintenanceQueuePtr &queue, RSStatsPtr &server_stats,
                          RangeStatsGathererPtr &gatherer);
 
@@ -54,6 +73,11 @@ namespace Hypertable {
       m_scheduling_needed = true;
     }
 
+    void get_stats(Stats &stats) {
+      ScopedLock lock(m_stats_mutex);
+      stats = m_stats;
+    }
+
   private:
 
     bool low_memory_mode() {
@@ -81,6 +105,8 @@ namespace Hypertable {
     int32_t m_merging_delay;
     int32_t m_merges_per_interval;
     int32_t m_move_compactions_per_interval;
+    Mutex m_stats_mutex;
+    Stats m_stats;
   };
 
   typedef intrusive_ptr<MaintenanceScheduler> MaintenanceSchedulerPtr;
@@ -0,0 +1,385 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Properties.h"
+#include "Common/StringExt.h"
+
+#include <algorithm>
+
+#include "Global.h"
+#include "MaintenanceFlag.h"
+#include "MemoryGovernor.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  struct IdleRange {
+    IdleRange(Range::MaintenanceData *rd, int32_t intervals)
+      : range_data(rd), idle_intervals(intervals) { }
+    Range::MaintenanceData *range_data;
+    int32_t idle_intervals;
+  };
+
+  struct IdleRangeOrdering {
+    bool operator()(const IdleRange &x, const IdleRange &y) const {
+      return x.idle_intervals > y.idle_intervals;
+    }
+  };
+
+  uint64_t delta(uint64_t current, uint64_t previous) {
+    return (current >= previous) ? current - previous : current;
+  }
+
+  /** Misses avoided per interval by growing a cache by step */
+  double growth_gain(int64_t limit, int64_t used, int64_t max,
+                     uint64_t accesses, uint64_t hits, int64_t step) {
+    if (limit + step > max || limit - used >= step || accesses <= hits)
+      return -1.0;
+    return (double)(accesses - hits) * (double)step / (double)(limit + step);
+  }
+
+  /** Misses caused per interval by shrinking a cache by step */
+  double shrink_loss(int64_t limit, int64_t used, int64_t min, uint64_t hits,
+                     int64_t step) {
+    if (limit - step < min)
+      return -1.0;
+    if (limit - used >= step || used <= 0)
+      return 0.0;
+    return (double)hits * (double)step / (double)used;
+  }
+
+}
+
+
+MemoryGovernor::MemoryGovernor(FileBlockCache *block_cache,
+                               QueryCache *query_cache, int64_t step,
+                               int32_t idle_intervals)
+  : m_block_cache(block_cache), m_query_cache(query_cache), m_step(step),
+    m_idle_intervals(idle_intervals), m_block_cache_accesses(0),
+    m_block_cache_hits(0), m_query_cache_accesses(0), m_query_cache_hits(0),
+    m_query_cache_initial(0), m_purge_recipient(NONE), m_purge_amount(0),
+    m_purge_index_memory(0) {
+  uint64_t max_memory, available_memory;
+  if (m_query_cache) {
+    m_query_cache->get_stats(&max_memory, &available_memory,
+                             &m_query_cache_accesses, &m_query_cache_hits);
+    m_query_cache_initial = (int64_t)max_memory;
+  }
+}
+
+
+const char *MemoryGovernor::consumer_name(Consumer consumer) {
+  switch (consumer) {
+  case BLOCK_CACHE:
+    return "block-cache";
+  case QUERY_CACHE:
+    return "query-cache";
+  case INDEXES:
+    return "indexes";
+  default:
+    break;
+  }
+  return "none";
+}
+
+
+MemoryGovernor::Decision
+MemoryGovernor::decide(const Inputs &in, int64_t step, double hysteresis) {
+  Decision decision;
+  Consumer donors[3] = { INDEXES, BLOCK_CACHE, QUERY_CACHE };
+  Consumer recipients[2] = { BLOCK_CACHE, QUERY_CACHE };
+  double gain, loss, best = 0.0;
+  int64_t amount;
+
+  if (step <= 0)
+    return decision;
+
+  for (size_t i=0; i<2; i++) {
+    if (recipients[i] == BLOCK_CACHE)
+      gain = growth_gain(in.block_cache_limit, in.block_cache_used,
+                         in.block_cache_max, in.block_cache_accesses,
+                         in.block_cache_hits, step);
+    else
+      gain = growth_gain(in.query_cache_limit, in.query_cache_used,
+                         in.query_cache_max, in.query_cache_accesses,
+                         in.query_cache_hits, step);
+    if (gain <= 0.0)
+      continue;
+
+    for (size_t j=0; j<3; j++) {
+      if (donors[j] == recipients[i])
+        continue;
+      amount = step;
+      if (donors[j] == INDEXES) {
+        if (in.idle_index_memory <= 0)
+          continue;
+        amount = std::min(step, in.idle_index_memory);
+        loss = 0.0;
+      }
+      else if (donors[j] == BLOCK_CACHE)
+        loss = shrink_loss(in.block_cache_limit, in.block_cache_used,
+                           in.block_cache_min, in.block_cache_hits, step);
+      else
+        loss = shrink_loss(in.query_cache_limit, in.query_cache_used,
+                           in.query_cache_min, in.query_cache_hits, step);
+      if (loss < 0.0 || gain <= loss * hysteresis)
+        continue;
+      if (gain - loss > best) {
+        best = gain - loss;
+        decision.from = donors[j];
+        decision.to = recipients[i];
+        decision.amount = amount;
+        decision.gain = gain;
+        decision.loss = loss;
+      }
+    }
+  }
+  return decision;
+}
+
+
+int64_t MemoryGovernor::release(Consumer consumer, int64_t amount) {
+  uint64_t max_memory, available_memory, accesses, hits;
+  int64_t before, after;
+
+  if (consumer == BLOCK_CACHE) {
+    before = m_block_cache->get_limit();
+    m_block_cache->decrease_limit(amount);
+    after = m_block_cache->get_limit();
+  }
+  else if (consumer == QUERY_CACHE) {
+    m_query_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+    before = (int64_t)max_memory;
+    m_query_cache->set_max_memory(std::max((int64_t)0, before - amount));
+    m_query_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+    after = (int64_t)max_memory;
+    Global::memory_tracker->subtract(before - after);
+  }
+  else
+    return 0;
+
+  return std::max((int64_t)0, before - after);
+}
+
+
+void MemoryGovernor::grow(Consumer consumer, int64_t amount) {
+  uint64_t max_memory, available_memory, accesses, hits;
+
+  if (amount <= 0)
+    return;
+
+  if (consumer == BLOCK_CACHE)
+    m_block_cache->increase_limit(amount);
+  else if (consumer == QUERY_CACHE) {
+    m_query_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+    m_query_cache->set_max_memory(max_memory + amount);
+    Global::memory_tracker->add(amount);
+  }
+}
+
+
+int64_t MemoryGovernor::transfer(const Decision &decision,
+                                 int64_t index_memory) {
+  if (decision.from == NONE || decision.amount <= 0)
+    return 0;
+
+  if (decision.from == INDEXES) {
+    // a purge that has not released its memory yet is not credited
+    m_purge_recipient = decision.to;
+    m_purge_amount = decision.amount;
+    m_purge_index_memory = index_memory;
+    return 0;
+  }
+
+  int64_t released = release(decision.from, decision.amount);
+  grow(decision.to, released);
+  return released;
+}
+
+
+int64_t MemoryGovernor::settle_index_purge(int64_t index_memory) {
+  if (m_purge_recipient == NONE)
+    return 0;
+
+  int64_t released = std::min(m_purge_amount,
+                               m_purge_index_memory - index_memory);
+  Consumer recipient = m_purge_recipient;
+
+  m_purge_recipient = NONE;
+  m_purge_amount = 0;
+  m_purge_index_memory = 0;
+
+  if (released <= 0)
+    return 0;
+  grow(recipient, released);
+  return released;
+}
+
+
+void
+MemoryGovernor::rebalance(RangeStatsVector &range_data, bool low_memory,
+                          String &trace_str) {
+  Inputs in;
+  Stats stats;
+  RangeActivityMap activity;
+  std::vector<IdleRange> idle_ranges;
+  AccessGroup::MaintenanceData *ag_data;
+  AccessGroup::CellStoreMaintenanceData *cs_data;
+  uint64_t max_memory, available_memory, accesses, hits;
+
+  /**
+   * Track scans per range and find the ranges whose indexes are idle
+   */
+  for (size_t i=0; i<range_data.size(); i++) {
+    Range::MaintenanceData *rd = range_data[i];
+    RangeActivity &ra = activity[rd->range];
+    RangeActivityMap::iterator iter = m_activity.find(rd->range);
+
+    ra.scans = rd->load_factors.scans;
+    if (iter != m_activity.end() &&
+        delta(rd->load_factors.scans, iter->second.scans) == 0)
+      ra.idle_intervals = iter->second.idle_intervals + 1;
+
+    for (ag_data = rd->agdata; ag_data; ag_data = ag_data->next) {
+      stats.cell_cache_memory += ag_data->mem_allocated;
+      for (cs_data = ag_data->csdata; cs_data; cs_data = cs_data->next)
+        stats.shadow_cache_memory += cs_data->shadow_cache_size;
+    }
+    stats.block_index_memory += rd->block_index_memory;
+    stats.bloom_filter_memory += rd->bloom_filter_memory;
+
+    if (ra.idle_intervals >= m_idle_intervals && !rd->busy &&
+        !rd->is_metadata && rd->maintenance_flags == 0 &&
+        rd->block_index_memory + rd->bloom_filter_memory > 0) {
+      stats.idle_index_memory += rd->block_index_memory + rd->bloom_filter_memory;
+      idle_ranges.push_back(IdleRange(rd, ra.idle_intervals));
+    }
+  }
+  m_activity.swap(activity);
+
+  int64_t index_memory = stats.block_index_memory + stats.bloom_filter_memory;
+  int64_t settled = settle_index_purge(index_memory);
+
+  /**
+   * Gather cache activity over the interval
+   */
+  m_block_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+  in.block_cache_limit = m_block_cache->get_limit();
+  in.block_cache_used = m_block_cache->memory_used();
+  in.block_cache_min = m_block_cache->get_min_memory();
+  in.block_cache_max = m_block_cache->get_max_memory();
+  in.block_cache_accesses = delta(accesses, m_block_cache_accesses);
+  in.block_cache_hits = delta(hits, m_block_cache_hits);
+  m_block_cache_accesses = accesses;
+  m_block_cache_hits = hits;
+
+  if (m_query_cache) {
+    m_query_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+    in.query_cache_limit = (int64_t)max_memory;
+    in.query_cache_used = (int64_t)(max_memory - available_memory);
+    in.query_cache_min = m_query_cache_initial / 4;
+    in.query_cache_max = (int64_t)((double)Global::memory_limit * 0.2);
+    in.query_cache_accesses = delta(accesses, m_query_cache_accesses);
+    in.query_cache_hits = delta(hits, m_query_cache_hits);
+    m_query_cache_accesses = accesses;
+    m_query_cache_hits = hits;
+  }
+
+  in.idle_index_memory = stats.idle_index_memory;
+
+  /**
+   * Move memory to where it is worth most, leave low memory situations to
+   * the low memory prioritizer
+   */
+  Decision decision;
+  if (!low_memory)
+    decision = decide(in, m_step);
+
+  if (decision.from == INDEXES) {
+    int32_t priority = 1;
+    for (size_t i=0; i<range_data.size(); i++)
+      priority = std::max(priority, range_data[i]->priority + 1);
+    std::sort(idle_ranges.begin(), idle_ranges.end(), IdleRangeOrdering());
+    int64_t purged = 0;
+    for (size_t i=0; i<idle_ranges.size() && purged < decision.amount; i++) {
+      Range::MaintenanceData *rd = idle_ranges[i].range_data;
+      for (ag_data = rd->agdata; ag_data; ag_data = ag_data->next) {
+        for (cs_data = ag_data->csdata; cs_data; cs_data = cs_data->next) {
+          int64_t memory = cs_data->index_stats.block_index_memory +
+              cs_data->index_stats.bloom_filter_memory;
+          if (memory == 0)
+            continue;
+          cs_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE_CELLSTORE;
+          ag_data->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
+          rd->maintenance_flags |= MaintenanceFlag::MEMORY_PURGE;
+          purged += memory;
+        }
+      }
+      if (rd->priority == 0)
+        rd->priority = priority++;
+    }
+    decision.amount = std::min(decision.amount, purged);
+  }
+
+  int64_t moved = transfer(decision, index_memory);
+
+  stats.block_cache_limit = m_block_cache->get_limit();
+  if (m_query_cache) {
+    m_query_cache->get_stats(&max_memory, &available_memory, &accesses, &hits);
+    stats.query_cache_limit = (int64_t)max_memory;
+  }
+
+  {
+    ScopedLock lock(m_mutex);
+    stats.rebalances = m_stats.rebalances;
+    stats.bytes_moved = m_stats.bytes_moved;
+    stats.last_decision = m_stats.last_decision;
+    stats.bytes_moved += settled + moved;
+    if (decision.from == INDEXES) {
+      stats.rebalances++;
+      stats.last_decision = format("purging %lld bytes of %s for %s "
+          "(gain=%.1f loss=%.1f misses/interval)", (Lld)decision.amount,
+          consumer_name(decision.from), consumer_name(decision.to),
+          decision.gain, decision.loss);
+      HT_INFOF("MemoryGovernor %s", stats.last_decision.c_str());
+    }
+    else if (decision.from != NONE) {
+      stats.rebalances++;
+      stats.last_decision = format("moved %lld of %lld bytes from %s to %s "
+          "(gain=%.1f loss=%.1f misses/interval)", (Lld)moved,
+          (Lld)decision.amount, consumer_name(decision.from),
+          consumer_name(decision.to), decision.gain, decision.loss);
+      HT_INFOF("MemoryGovernor %s", stats.last_decision.c_str());
+    }
+    if (settled > 0)
+      HT_INFOF("MemoryGovernor credited %lld bytes of purged indexes",
+               (Lld)settled);
+    m_stats = stats;
+  }
+
+  trace_str += String("MemoryGovernor idle_index_memory\t") + stats.idle_index_memory + "\n";
+  trace_str += String("MemoryGovernor block_cache_limit\t") + stats.block_cache_limit + "\n";
+  trace_str += String("MemoryGovernor query_cache_limit\t") + stats.query_cache_limit + "\n";
+  trace_str += String("MemoryGovernor last_decision\t") + stats.last_decision + "\n";
+}
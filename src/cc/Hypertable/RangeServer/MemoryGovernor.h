@@ -0,0 +1,210 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_MEMORYGOVERNOR_H
+#define HYPERTABLE_MEMORYGOVERNOR_H
+
+#include <map>
+
+#include "Common/Mutex.h"
+#include "Common/String.h"
+
+#include "FileBlockCache.h"
+#include "QueryCache.h"
+#include "RangeStatsGatherer.h"
+
+namespace Hypertable {
+
+  /**
+   * Balances memory between the block cache, the query cache and the
+   * CellStore indexes.  Once per maintenance interval the marginal benefit
+   * of each consumer is estimated from its activity during the interval
+   * (cache misses and hits, scans of the ranges holding the indexes) and
+   * one step of memory is moved from the consumer that loses the least by
+   * shrinking to the one that gains the most by growing.  The indexes of
+   * ranges that have not been scanned for a number of intervals are
+   * reclaimed by scheduling index purges.  CellCache memory is accounted
+   * for but left to the maintenance prioritizers, which compact it to free
+   * commit log space.
+   */
+  class MemoryGovernor {
+  public:
+
+    enum Consumer {
+      NONE = 0,
+      BLOCK_CACHE,
+      QUERY_CACHE,
+      INDEXES
+    };
+
+    /** Activity and size of the governed consumers over one interval */
+    struct Inputs {
+      Inputs() : block_cache_limit(0), block_cache_used(0),
+          block_cache_min(0), block_cache_max(0), block_cache_accesses(0),
+          block_cache_hits(0), query_cache_limit(0), query_cache_used(0),
+          query_cache_min(0), query_cache_max(0), query_cache_accesses(0),
+          query_cache_hits(0), idle_index_memory(0) { }
+      int64_t block_cache_limit;
+      int64_t block_cache_used;
+      int64_t block_cache_min;
+      int64_t block_cache_max;
+      uint64_t block_cache_accesses;
+      uint64_t block_cache_hits;
+      int64_t query_cache_limit;
+      int64_t query_cache_used;
+      int64_t query_cache_min;
+      int64_t query_cache_max;
+      uint64_t query_cache_accesses;
+      uint64_t query_cache_hits;
+      int64_t idle_index_memory;
+    };
+
+    /** A transfer of memory from one consumer to another */
+    struct Decision {
+      Decision() : from(NONE), to(NONE), amount(0), gain(0.0), loss(0.0) { }
+      Consumer from;
+      Consumer to;
+      int64_t amount;
+      double gain;
+      double loss;
+    };
+
+    /** Memory and decisions of the governor, reported by rsstat */
+    struct Stats {
+      Stats() : cell_cache_memory(0), block_index_memory(0),
+          bloom_filter_memory(0), shadow_cache_memory(0),
+          idle_index_memory(0), block_cache_limit(0), query_cache_limit(0),
+          rebalances(0), bytes_moved(0) { }
+      int64_t cell_cache_memory;
+      int64_t block_index_memory;
+      int64_t bloom_filter_memory;
+      int64_t shadow_cache_memory;
+      int64_t idle_index_memory;
+      int64_t block_cache_limit;
+      int64_t query_cache_limit;
+      uint64_t rebalances;
+      uint64_t bytes_moved;
+      String last_decision;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param block_cache block cache
+     * @param query_cache query cache, may be 0
+     * @param step amount of memory moved per interval
+     * @param idle_intervals number of intervals without scans after which
+     *        the indexes of a range are reclaimable
+     */
+    MemoryGovernor(FileBlockCache *block_cache, QueryCache *query_cache,
+                   int64_t step, int32_t idle_intervals);
+
+    /**
+     * Reassigns memory among the consumers, called by the maintenance
+     * scheduler once per interval after the prioritizer has run.  Index
+     * purges are scheduled by setting maintenance flags and priorities in
+     * range_data, after those assigned by the prioritizer.
+     *
+     * @param range_data statistics of all ranges
+     * @param low_memory true if the server is in low memory mode, in which
+     *        case only the statistics are updated
+     * @param trace_str scheduler trace output
+     */
+    void rebalance(RangeStatsVector &range_data, bool low_memory,
+                   String &trace_str);
+
+    /**
+     * Chooses the transfer of step bytes with the largest net benefit.
+     * Benefits are measured in cache misses avoided per interval; the gain
+     * of growing a full cache by step is estimated as its misses scaled by
+     * step/(limit+step) and the loss of shrinking it as its hits scaled by
+     * step/used.  Idle indexes are lost at no cost.  A transfer is made
+     * only if the gain exceeds the loss by the hysteresis factor.
+     */
+    static Decision decide(const Inputs &inputs, int64_t step,
+                           double hysteresis=1.5);
+
+    /**
+     * Carries out a decision.  Memory is taken from the donor first and
+     * the recipient is credited only with what the donor actually gave up,
+     * which may be less than decision.amount if the block cache cannot
+     * evict enough blocks.  Index memory is released asynchronously by the
+     * purges rebalance() schedules, so for an INDEXES donor nothing is
+     * credited here; the recipient is credited by settle_index_purge()
+     * once the index memory has gone down.
+     *
+     * @param decision transfer to carry out
+     * @param index_memory current block index and bloom filter memory
+     * @return number of bytes credited to the recipient
+     */
+    int64_t transfer(const Decision &decision, int64_t index_memory);
+
+    /**
+     * Credits the recipient of the last index purge with the index memory
+     * released since then, at most the amount the purge was scheduled for.
+     * Whatever has not been released by the time this is called is not
+     * credited.
+     *
+     * @param index_memory current block index and bloom filter memory
+     * @return number of bytes credited
+     */
+    int64_t settle_index_purge(int64_t index_memory);
+
+    static const char *consumer_name(Consumer consumer);
+
+    void get_stats(Stats &stats) {
+      ScopedLock lock(m_mutex);
+      stats = m_stats;
+    }
+
+  private:
+
+    struct RangeActivity {
+      RangeActivity() : scans(0), idle_intervals(0) { }
+      uint64_t scans;
+      int32_t idle_intervals;
+    };
+    typedef std::map<Range *, RangeActivity> RangeActivityMap;
+
+    int64_t release(Consumer consumer, int64_t amount);
+    void grow(Consumer consumer, int64_t amount);
+
+    Mutex m_mutex;
+    FileBlockCache *m_block_cache;
+    QueryCache *m_query_cache;
+    int64_t m_step;
+    int32_t m_idle_intervals;
+    uint64_t m_block_cache_accesses;
+    uint64_t m_block_cache_hits;
+    uint64_t m_query_cache_accesses;
+    uint64_t m_query_cache_hits;
+    int64_t m_query_cache_initial;
+    // index purge whose memory has not been credited yet
+    Consumer m_purge_recipient;
+    int64_t m_purge_amount;
+    int64_t m_purge_index_memory;
+    RangeActivityMap m_activity;
+    Stats m_stats;
+  };
+
+}
+
+#endif // HYPERTABLE_MEMORYGOVERNOR_H
@@ -48,6 +48,12 @@ namespace Hypertable {
       return m_memory_used + m_block_cache->memory_used();
     }
 
+    /** Memory tracked outside of the block cache */
+    int64_t memory_used() {
+      ScopedLock lock(m_mutex);
+      return m_memory_used;
+    }
+
   private:
     Mutex m_mutex;
     int64_t m_memory_used;
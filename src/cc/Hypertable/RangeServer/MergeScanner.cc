@@ -27,6 +27,7 @@
 
 #include "Hypertable/Lib/Key.h"
 
+#include "BlobLog.h"
 #include "MergeScanner.h"
 
 using namespace Hypertable;
@@ -34,7 +35,8 @@ using namespace Hypertable;
 
 MergeScanner::MergeScanner(ScanContextPtr &scan_ctx, bool return_deletes, bool ag_scanner,
     bool debug) : CellListScanner(scan_ctx), m_done(false), m_initialized(false),
-    m_scanners(), m_queue(), m_delete_present(false), m_deleted_row(0),
+    m_scanners(), m_resolve_blobs(false), m_blob_reference(0), m_blob_value(0),
+    m_queue(), m_delete_present(false), m_deleted_row(0),
     m_deleted_column_family(0), m_deleted_cell(0), m_deleted_cell_version(0),
     m_return_deletes(return_deletes),
     m_no_forward(false), m_count_present(false), m_skip_remaining_counter(false),
@@ -54,8 +56,38 @@ MergeScanner::MergeScanner(ScanContextPtr &scan_ctx, bool return_deletes, bool a
 }
 
 
-void MergeScanner::add_scanner(CellListScanner *scanner) {
+void MergeScanner::add_scanner(CellListScanner *scanner,
+                               bool blob_references) {
   m_scanners.push_back(scanner);
+  m_blob_references.push_back(blob_references);
+}
+
+
+bool MergeScanner::current_is_blob_reference() {
+  if (m_done || m_no_forward || m_queue.empty())
+    return false;
+  const ScannerState &sstate = m_queue.top();
+  return sstate.blobs && sstate.key.flag == FLAG_INSERT &&
+    BlobLog::is_reference(sstate.value);
+}
+
+
+ByteString MergeScanner::resolve_value(const ScannerState &sstate) {
+  if (!sstate.blobs || sstate.key.flag != FLAG_INSERT)
+    return sstate.value;
+  size_t len = sstate.value.length();
+  // the previously resolved reference is cached
+  if (m_blob_reference.fill() != len ||
+      memcmp(m_blob_reference.base, sstate.value.ptr, len)) {
+    if (!BlobLog::is_reference(sstate.value))
+      return sstate.value;
+    BlobLog::resolve(sstate.value, m_blob_value);
+    m_blob_reference.clear();
+    m_blob_reference.add(sstate.value.ptr, len);
+  }
+  ByteString value;
+  value.ptr = m_blob_value.base;
+  return value;
 }
 
 
@@ -333,7 +365,8 @@ void MergeScanner::forward() {
           // filter but value regexp last since its probly the most expensive
           if (m_scan_context_ptr->value_regexp &&
               !m_scan_context_ptr->family_info[sstate.key.column_family_code].counter) {
-            String value(sstate.value.str(), sstate.value.length());
+            ByteString resolved = resolve_value(sstate);
+            String value(resolved.str(), resolved.length());
             if (!RE2::PartialMatch(value, *(m_scan_context_ptr->value_regexp)))
               continue;
           }
@@ -417,7 +450,7 @@ bool MergeScanner::get(Key &key, ByteString &value) {
     const ScannerState &sstate = m_queue.top();
     // check for row or cell limit
     key = sstate.key;
-    value = sstate.value;
+    value = m_resolve_blobs ? resolve_value(sstate) : sstate.value;
     return true;
   }
 
@@ -465,6 +498,7 @@ void MergeScanner::initialize() {
   for (size_t i=0; i<m_scanners.size(); i++) {
     if (m_scanners[i]->get(sstate.key, sstate.value)) {
       sstate.scanner = m_scanners[i];
+      sstate.blobs = m_blob_references[i];
       m_queue.push(sstate);
     }
   }
@@ -640,7 +674,8 @@ void MergeScanner::initialize() {
         // filter but value regexp last since its probly the most expensive
         if (m_scan_context_ptr->value_regexp &&
             !m_scan_context_ptr->family_info[sstate.key.column_family_code].counter) {
-          String value(sstate.value.str(), sstate.value.length());
+          ByteString resolved = resolve_value(sstate);
+          String value(resolved.str(), resolved.length());
           if (!RE2::PartialMatch(value, *(m_scan_context_ptr->value_regexp))) {
             m_queue.pop();
             sstate.scanner->forward();
@@ -684,3 +719,13 @@ uint64_t MergeScanner::get_disk_read() {
     amount += m_scanners[i]->get_disk_read();
   return amount;
 }
+
+
+PreadFuturePtr MergeScanner::get_pending_read() {
+  PreadFuturePtr future;
+  for (size_t i=0; i<m_scanners.size(); i++) {
+    if ((future = m_scanners[i]->get_pending_read()))
+      break;
+  }
+  return future;
+}
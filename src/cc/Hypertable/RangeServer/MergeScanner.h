@@ -42,6 +42,7 @@ namespace Hypertable {
       CellListScanner *scanner;
       Key key;
       ByteString value;
+      bool blobs;
     };
 
     class RegexpInfo {
@@ -95,7 +96,21 @@ namespace Hypertable {
     virtual ~MergeScanner();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
-    void add_scanner(CellListScanner *scanner);
+    void add_scanner(CellListScanner *scanner, bool blob_references=false);
+
+    /**
+     * Controls whether blob references coming from scanners added with
+     * blob_references=true are resolved to their values by get().
+     * Compactions leave references unresolved so that separated values
+     * are not rewritten.
+     */
+    void set_resolve_blobs(bool resolve) { m_resolve_blobs = resolve; }
+
+    /**
+     * Returns true if the cell returned by the last call to get() is an
+     * unresolved blob reference
+     */
+    bool current_is_blob_reference();
     void set_debug(bool debug) { m_debug = debug; }
     void install_release_callback(CellStoreReleaseCallback &cb) {
       m_release_callback = cb;
@@ -112,10 +127,12 @@ namespace Hypertable {
     }
 
     virtual uint64_t get_disk_read();
+    virtual PreadFuturePtr get_pending_read();
 
 
   private:
     void initialize();
+    ByteString resolve_value(const ScannerState &sstate);
     inline bool matches_deleted_row(const Key& key) const {
       size_t len = key.len_row();
 
@@ -194,6 +211,10 @@ namespace Hypertable {
     bool          m_done;
     bool          m_initialized;
     std::vector<CellListScanner *>  m_scanners;
+    std::vector<bool> m_blob_references;
+    bool          m_resolve_blobs;
+    DynamicBuffer m_blob_reference;
+    DynamicBuffer m_blob_value;
     std::priority_queue<ScannerState, std::vector<ScannerState>,
         LtScannerState> m_queue;
     bool          m_delete_present;
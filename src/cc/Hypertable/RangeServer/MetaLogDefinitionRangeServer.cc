@@ -28,11 +28,11 @@ using namespace Hypertable;
 using namespace Hypertable::MetaLog;
 
 uint16_t DefinitionRangeServer::version() {
-  return 2;
+  return 3;
 }
 
 bool DefinitionRangeServer::supported_version(uint16_t ver) {
-  return ver <= 2;
+  return ver <= 3;
 }
 
 const char *DefinitionRangeServer::name() {
@@ -38,8 +38,12 @@ EntityRange::EntityRange(const TableIdentifier &identifier,
 
 
 size_t EntityRange::encoded_length() const {
-  return table.encoded_length() + spec.encoded_length() +
-    state.encoded_length() + 2;
+  size_t length = table.encoded_length() + spec.encoded_length() +
+    state.encoded_length() + 2 + 4;
+  for (size_t i=0; i<adopted_files.size(); i++)
+    length += Serialization::encoded_length_vstr(adopted_access_groups[i]) +
+      Serialization::encoded_length_vstr(adopted_files[i]);
+  return length;
 }
 
 
@@ -49,6 +53,11 @@ void EntityRange::encode(uint8_t **bufp) const {
   state.encode(bufp);
   Serialization::encode_bool(bufp, needs_compaction);
   Serialization::encode_bool(bufp, load_acknowledged);
+  Serialization::encode_i32(bufp, adopted_files.size());
+  for (size_t i=0; i<adopted_files.size(); i++) {
+    Serialization::encode_vstr(bufp, adopted_access_groups[i]);
+    Serialization::encode_vstr(bufp, adopted_files[i]);
+  }
 }
 
 void EntityRange::decode(const uint8_t **bufp, size_t *remainp) {
@@ -57,6 +66,16 @@ void EntityRange::decode(const uint8_t **bufp, size_t *remainp) {
   state.decode(bufp, remainp);
   needs_compaction = Serialization::decode_bool(bufp, remainp);
   load_acknowledged = Serialization::decode_bool(bufp, remainp);
+  adopted_access_groups.clear();
+  adopted_files.clear();
+  // Entities written before version 3 of the rsml end here
+  if (*remainp > 0) {
+    size_t count = Serialization::decode_i32(bufp, remainp);
+    for (size_t i=0; i<count; i++) {
+      adopted_access_groups.push_back(Serialization::decode_vstr(bufp, remainp));
+      adopted_files.push_back(Serialization::decode_vstr(bufp, remainp));
+    }
+  }
 }
 
 const String EntityRange::name() {
@@ -67,5 +86,7 @@ void EntityRange::display(std::ostream &os) {
   os << " " << table << " " << spec << " " << state << " ";
   os << "needs_compaction=" << (needs_compaction ? "true" : "false") << " ";
   os << "load_acknowledged=" << (load_acknowledged ? "true" : "false") << " ";
+  for (size_t i=0; i<adopted_files.size(); i++)
+    os << "adopted=" << adopted_access_groups[i] << ":" << adopted_files[i] << " ";
 }
 
@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_METALOGENTITYRANGE_H
 #define HYPERTABLE_METALOGENTITYRANGE_H
 
+#include <vector>
+
 #include "Hypertable/Lib/MetaLogEntity.h"
 #include "Hypertable/Lib/RangeState.h"
 #include "Hypertable/Lib/Types.h"
@@ -47,6 +49,9 @@ namespace Hypertable {
       RangeStateManaged state;
       bool needs_compaction;
       bool load_acknowledged;
+      /** Bulk loaded CellStores (access group, file) not yet in METADATA */
+      std::vector<String> adopted_access_groups;
+      std::vector<String> adopted_files;
     };
     typedef intrusive_ptr<EntityRange> EntityRangePtr;
 
@@ -104,6 +104,19 @@ bool QueryCache::lookup(Key *key, boost::shared_array<uint8_t> &result,
   return true;
 }
 
+void QueryCache::set_max_memory(uint64_t max_memory) {
+  ScopedLock lock(m_mutex);
+  uint64_t used = m_max_memory - m_avail_memory;
+  Cache::iterator iter = m_cache.begin();
+
+  while (used > max_memory && iter != m_cache.end()) {
+    used -= (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
+    iter = m_cache.erase(iter);
+  }
+  m_max_memory = max_memory;
+  m_avail_memory = max_memory - used;
+}
+
 void QueryCache::get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                            uint64_t *total_lookupsp, uint64_t *total_hitsp)
 {
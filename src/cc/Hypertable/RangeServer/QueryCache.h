@@ -79,6 +79,12 @@ namespace Hypertable {
 
     uint64_t available_memory() { return m_avail_memory; }
 
+    /**
+     * Changes the memory limit, evicting least recently used entries if
+     * the cache holds more than max_memory
+     */
+    void set_max_memory(uint64_t max_memory);
+
     void get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                    uint64_t *total_lookupsp, uint64_t *total_hitsp);
 
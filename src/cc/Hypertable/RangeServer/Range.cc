@@ -21,6 +21,7 @@
 
 #include "Common/Compat.h"
 #include <cassert>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -37,10 +38,12 @@ extern "C" {
 #include "Common/FileUtils.h"
 #include "Common/md5.h"
 #include "Common/StringExt.h"
+#include "Common/Time.h"
 
 #include "Hypertable/Lib/CommitLog.h"
 #include "Hypertable/Lib/CommitLogReader.h"
 
+#include "BlobLog.h"
 #include "CellStoreFactory.h"
 #include "Global.h"
 #include "MergeScanner.h"
@@ -62,8 +65,11 @@ Range::Range(MasterClientPtr &master_client,
     m_schema(schema), m_revision(TIMESTAMP_MIN), m_latest_revision(TIMESTAMP_MIN),
     m_split_off_high(false), m_added_inserts(0), m_range_set(range_set),
     m_error(Error::OK), m_dropped(false), m_capacity_exceeded_throttle(false),
+    m_capacity_ratio(0.0),
     m_relinquish(false), m_maintenance_generation(0),
-    m_load_metrics(identifier->id, range->start_row, range->end_row) {
+    m_load_metrics(identifier->id, range->start_row, range->end_row),
+    m_sample_load(false), m_load_split(false), m_maintenance_dirty(true),
+    m_maintenance_completions(0) {
   m_metalog_entity = new MetaLog::EntityRange(*identifier, *range, *state, needs_compaction);
   initialize();
 }
@@ -76,8 +82,11 @@ Range::Range(MasterClientPtr &master_client, SchemaPtr &schema,
     m_schema(schema), m_revision(TIMESTAMP_MIN), m_latest_revision(TIMESTAMP_MIN),
     m_split_off_high(false), m_added_inserts(0), m_range_set(range_set),
     m_error(Error::OK), m_dropped(false), m_capacity_exceeded_throttle(false),
+    m_capacity_ratio(0.0),
     m_relinquish(false), m_maintenance_generation(0),
-    m_load_metrics(range_entity->table.id, range_entity->spec.start_row, range_entity->spec.end_row) {
+    m_load_metrics(range_entity->table.id, range_entity->spec.start_row, range_entity->spec.end_row),
+    m_sample_load(false), m_load_split(false), m_maintenance_dirty(true),
+    m_maintenance_completions(0) {
   initialize();
 }
 
@@ -199,6 +208,8 @@ void Range::update_schema(SchemaPtr &schema) {
   if(schema->get_generation() <= m_schema->get_generation())
     return;
 
+  m_maintenance_dirty = true;
+
   // resize column family vector if needed
   if (max_column_family_id > m_column_family_vector.size()-1)
     m_column_family_vector.resize(max_column_family_id+1);
@@ -294,10 +305,17 @@ void Range::load_cell_stores(Metadata *metadata) {
 
     bool skip_not_found = Config::properties->get_bool("Hypertable.RangeServer.CellStore.SkipNotFound");
 
+    std::vector<String> blob_files;
+
     for (size_t i=0; i<csvec.size(); i++) {
 
       files += csvec[i] + ";\n";
 
+      if (BlobLog::is_blob_file(csvec[i])) {
+        blob_files.push_back(csvec[i]);
+        continue;
+      }
+
       HT_INFOF("Loading CellStore %s", csvec[i].c_str());
 
       try {
@@ -322,6 +340,23 @@ void Range::load_cell_stores(Metadata *metadata) {
       ag->add_cell_store(cellstore);
     }
 
+    for (size_t i=0; i<blob_files.size(); i++) {
+      HT_INFOF("Loading blob log %s", blob_files[i].c_str());
+      try {
+        ag->add_blob_file(file_basename + blob_files[i]);
+      }
+      catch (Exception &e) {
+        if (skip_not_found &&
+            (e.code() == Error::DFSBROKER_FILE_NOT_FOUND ||
+             e.code() == Error::DFSBROKER_BAD_FILENAME)) {
+          HT_WARNF("Blob log file '%s' not found, skipping", blob_files[i].c_str());
+          continue;
+        }
+        HT_FATALF("Problem opening blob log file '%s' - %s", blob_files[i].c_str(),
+                  Error::get_text(e.code()));
+      }
+    }
+
     /** this causes startup deadlock (and is not needed) ..
     if (need_update)
       metadata->write_files(ag_name, files);
@@ -329,6 +364,222 @@ void Range::load_cell_stores(Metadata *metadata) {
 
   }
 
+  /**
+   * Install bulk loaded CellStores whose adoption was recorded in the RSML
+   * but may not have reached METADATA.  The 'Files' column is brought up
+   * to date by the next compaction (see flush_adopted_cell_stores)
+   */
+  for (size_t i=0; i<m_metalog_entity->adopted_files.size(); i++) {
+    const String &fname = m_metalog_entity->adopted_files[i];
+
+    if ((ag = m_access_group_map[m_metalog_entity->adopted_access_groups[i]]) == 0) {
+      HT_ERRORF("Unrecognized access group '%s' for adopted CellStore '%s'",
+                m_metalog_entity->adopted_access_groups[i].c_str(), fname.c_str());
+      continue;
+    }
+
+    HT_INFOF("Loading adopted CellStore %s", fname.c_str());
+
+    try {
+      cellstore = CellStoreFactory::open(fname, m_metalog_entity->spec.start_row,
+                                         m_metalog_entity->spec.end_row);
+    }
+    catch (Exception &e) {
+      HT_FATALF("Problem opening adopted CellStore file '%s' - %s",
+                fname.c_str(), Error::get_text(e.code()));
+    }
+
+    if (ag->adopt_cell_store(cellstore, false)) {
+      int64_t revision = boost::any_cast<int64_t>
+        (cellstore->get_trailer()->get("revision"));
+      if (revision > m_latest_revision)
+        m_latest_revision = revision;
+    }
+  }
+
+}
+
+
+void Range::adopt_cell_stores(const std::vector<String> &access_groups,
+                              const std::vector<String> &files) {
+  RangeMaintenanceGuard::Activator activator(m_maintenance_guard);
+  String table_dir = Global::toplevel_dir + "/tables/" +
+    m_metalog_entity->table.id + "/";
+  std::vector<AccessGroup *> ags;
+  std::vector<CellStorePtr> cellstores;
+  std::set<AccessGroup *> targets;
+  int64_t now = get_ts64();
+
+  if (access_groups.size() != files.size() || files.empty())
+    HT_THROWF(Error::PROTOCOL_ERROR, "Bad adopt request for range %s (%u "
+              "access groups, %u files)", m_name.c_str(),
+              (unsigned)access_groups.size(), (unsigned)files.size());
+
+  if (m_metalog_entity->state.state != RangeState::STEADY || m_relinquish)
+    HT_THROWF(Error::RANGESERVER_RANGE_BUSY, "Range %s is being split or "
+              "relinquished", m_name.c_str());
+
+  {
+    ScopedLock lock(m_schema_mutex);
+    for (size_t i=0; i<files.size(); i++) {
+      AccessGroupMap::iterator iter = m_access_group_map.find(access_groups[i]);
+      if (iter == m_access_group_map.end() || iter->second->in_memory())
+        HT_THROWF(Error::RANGESERVER_INVALID_COLUMNFAMILY, "Cannot adopt "
+                  "CellStores into access group '%s' of range %s",
+                  access_groups[i].c_str(), m_name.c_str());
+      ags.push_back(iter->second);
+      targets.insert(iter->second);
+    }
+  }
+
+  /**
+   * Validate the files before touching any state
+   */
+  for (size_t i=0; i<files.size(); i++) {
+    String ag_dir = table_dir + access_groups[i] + "/";
+
+    if (files[i].compare(0, ag_dir.length(), ag_dir) ||
+        files[i].find("/../") != String::npos ||
+        BlobLog::is_blob_file(files[i]))
+      HT_THROWF(Error::RANGESERVER_BAD_CELLSTORE_FILENAME,
+                "Adopted CellStore '%s' is not under %s", files[i].c_str(),
+                ag_dir.c_str());
+
+    CellStorePtr cellstore = CellStoreFactory::open(files[i],
+        m_metalog_entity->spec.start_row, m_metalog_entity->spec.end_row);
+    CellStoreTrailer *trailer = cellstore->get_trailer();
+
+    if (boost::any_cast<uint16_t>(trailer->get("version")) < 5)
+      HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE, "Adopted CellStore '%s' "
+                "has unsupported version %u", files[i].c_str(),
+                (unsigned)boost::any_cast<uint16_t>(trailer->get("version")));
+
+    if (boost::any_cast<uint32_t>(trailer->get("table_id")) !=
+        m_metalog_entity->table.index())
+      HT_THROWF(Error::RANGESERVER_UNEXPECTED_TABLE_ID, "Adopted CellStore "
+                "'%s' was built for table ID %u, not %s", files[i].c_str(),
+                (unsigned)boost::any_cast<uint32_t>(trailer->get("table_id")),
+                m_metalog_entity->table.id);
+
+    if (boost::any_cast<uint32_t>(trailer->get("table_generation")) !=
+        m_metalog_entity->table.generation)
+      HT_THROWF(Error::RANGESERVER_GENERATION_MISMATCH, "Adopted CellStore "
+                "'%s' has table generation %u, expected %u", files[i].c_str(),
+                (unsigned)boost::any_cast<uint32_t>(trailer->get("table_generation")),
+                (unsigned)m_metalog_entity->table.generation);
+
+    /**
+     * Commit log replay skips updates at or below the latest stored
+     * revision, so adopted data must predate everything still in memory
+     */
+    if (boost::any_cast<int64_t>(trailer->get("revision")) >= now)
+      HT_THROWF(Error::RANGESERVER_REVISION_ORDER_ERROR, "Adopted CellStore "
+                "'%s' has revision %lld from the future", files[i].c_str(),
+                (Lld)boost::any_cast<int64_t>(trailer->get("revision")));
+
+    cellstores.push_back(cellstore);
+  }
+
+  /**
+   * Persist the cell caches of the target access groups
+   */
+  {
+    Barrier::ScopedActivator block_updates(m_update_barrier);
+    ScopedLock lock(m_mutex);
+    foreach(AccessGroup *ag, targets)
+      ag->stage_compaction();
+  }
+
+  foreach(AccessGroup *ag, targets) {
+    try {
+      ag->run_compaction(MaintenanceFlag::COMPACT_MINOR);
+    }
+    catch (Exception &e) {
+      ag->unstage_compaction();
+      throw;
+    }
+  }
+
+  /**
+   * Record the adoption in the RSML so that it survives a crash before
+   * the 'Files' column is updated
+   */
+  {
+    ScopedLock lock(m_mutex);
+    for (size_t i=0; i<files.size(); i++) {
+      m_metalog_entity->adopted_access_groups.push_back(access_groups[i]);
+      m_metalog_entity->adopted_files.push_back(files[i]);
+    }
+  }
+
+  try {
+    Global::rsml_writer->record_state(m_metalog_entity.get());
+  }
+  catch (Exception &e) {
+    ScopedLock lock(m_mutex);
+    m_metalog_entity->adopted_access_groups.resize(
+        m_metalog_entity->adopted_access_groups.size() - files.size());
+    m_metalog_entity->adopted_files.resize(
+        m_metalog_entity->adopted_files.size() - files.size());
+    throw;
+  }
+
+  for (size_t i=0; i<cellstores.size(); i++) {
+    HT_INFOF("Adopting CellStore %s into %s(%s)", files[i].c_str(),
+             m_name.c_str(), access_groups[i].c_str());
+    if (ags[i]->adopt_cell_store(cellstores[i], true)) {
+      int64_t revision = boost::any_cast<int64_t>
+        (cellstores[i]->get_trailer()->get("revision"));
+      ScopedLock lock(m_mutex);
+      if (revision > m_latest_revision)
+        m_latest_revision = revision;
+    }
+  }
+
+  flush_adopted_cell_stores();
+
+  {
+    ScopedLock lock(m_mutex);
+    m_maintenance_generation++;
+  }
+}
+
+
+/**
+ * Writes the 'Files' column of every access group with pending adopted
+ * CellStores and then clears the pending list from the RSML
+ */
+void Range::flush_adopted_cell_stores() {
+  std::set<String> ag_names;
+
+  {
+    ScopedLock lock(m_mutex);
+    if (m_metalog_entity->adopted_files.empty())
+      return;
+    ag_names.insert(m_metalog_entity->adopted_access_groups.begin(),
+                    m_metalog_entity->adopted_access_groups.end());
+  }
+
+  foreach(const String &name, ag_names) {
+    AccessGroupMap::iterator iter = m_access_group_map.find(name);
+    if (iter != m_access_group_map.end())
+      iter->second->sync_files_column();
+  }
+
+  {
+    ScopedLock lock(m_mutex);
+    m_metalog_entity->adopted_access_groups.clear();
+    m_metalog_entity->adopted_files.clear();
+  }
+
+  try {
+    Global::rsml_writer->record_state(m_metalog_entity.get());
+  }
+  catch (Exception &e) {
+    // Harmless, pending files are re-adopted idempotently on reload
+    HT_ERRORF("Problem updating meta log entry for %s - %s", m_name.c_str(),
+              Error::get_text(e.code()));
+  }
 }
 
 
@@ -355,6 +606,9 @@ void Range::add(const Key &key, const ByteString value) {
 
   if (key.revision > m_revision)
     m_revision = key.revision;
+
+  if (m_sample_load)
+    m_load_sampler.add(key.row);
 }
 
 
@@ -367,6 +621,9 @@ CellListScanner *Range::create_scanner(ScanContextPtr &scan_ctx) {
     ScopedLock lock(m_schema_mutex);
     ag_vector = m_access_group_vector;
     m_scans++;
+    m_maintenance_dirty = true;
+    if (m_sample_load && !scan_ctx->start_row.empty())
+      m_load_sampler.add(scan_ctx->start_row.c_str());
   }
 
   try {
@@ -440,6 +697,9 @@ Range::MaintenanceData *Range::get_maintenance_data(ByteArena &arena, time_t now
     mdata->load_factors.bytes_written = m_bytes_written;
     mdata->load_factors.cells_written = m_cells_written;
     mdata->schema_generation = m_metalog_entity->table.generation;
+    // changes from here on are picked up by the next pass
+    m_maintenance_dirty = false;
+    m_maintenance_completions = m_maintenance_guard.completions();
   }
 
   mdata->range = this;
@@ -496,9 +756,11 @@ Range::MaintenanceData *Range::get_maintenance_data(ByteArena &arena, time_t now
   if (tailp)
     (*tailp)->next = 0;
 
-  if (size > (uint64_t)Global::range_maximum_size) {
+  {
     ScopedLock lock(m_mutex);
-    if (starting_maintenance_generation == m_maintenance_generation)
+    m_capacity_ratio = (double)size / (double)Global::range_maximum_size;
+    if (size > (uint64_t)Global::range_maximum_size &&
+        starting_maintenance_generation == m_maintenance_generation)
       m_capacity_exceeded_throttle = true;
   }
 
@@ -506,6 +768,23 @@ Range::MaintenanceData *Range::get_maintenance_data(ByteArena &arena, time_t now
 
   mdata->needs_major_compaction = m_metalog_entity->needs_compaction;
 
+  /**
+   * Ranges that stay above the load split rates start sampling the rows
+   * they serve, so that a split divides the load rather than the data
+   */
+  if (!mdata->is_metadata && !mdata->is_system &&
+      (Global::range_load_split_cell_rate || Global::range_load_split_byte_rate)) {
+    int32_t hot_intervals = m_load_metrics.update_load_rates(now, mdata->load_factors);
+    ScopedLock lock(m_schema_mutex);
+    m_sample_load = hot_intervals > 0;
+    if (!m_sample_load)
+      m_load_sampler.clear();
+    m_load_split = hot_intervals >= Global::range_load_split_intervals &&
+      mdata->disk_estimate >= (uint64_t)Global::range_load_split_minimum_size &&
+      m_load_sampler.size() > 0;
+    mdata->load_split = m_load_split;
+  }
+
   if (mutator)
     m_load_metrics.compute_and_store(mutator, now, mdata->load_factors,
                                      mdata->disk_used, mdata->memory_used);
@@ -514,6 +793,54 @@ Range::MaintenanceData *Range::get_maintenance_data(ByteArena &arena, time_t now
 }
 
 
+Range::MaintenanceData *
+Range::copy_maintenance_data(ByteArena &arena, const MaintenanceData *previous) {
+  MaintenanceData *mdata = (MaintenanceData *)arena.alloc( sizeof(MaintenanceData) );
+  AccessGroup::MaintenanceData **ag_tailp = &mdata->agdata;
+  AccessGroup::CellStoreMaintenanceData **cs_tailp;
+
+  memcpy(mdata, previous, sizeof(MaintenanceData));
+
+  for (const AccessGroup::MaintenanceData *ag_data = previous->agdata;
+       ag_data; ag_data = ag_data->next) {
+    *ag_tailp = (AccessGroup::MaintenanceData *)arena.alloc( sizeof(AccessGroup::MaintenanceData) );
+    memcpy(*ag_tailp, ag_data, sizeof(AccessGroup::MaintenanceData));
+    (*ag_tailp)->user_data = 0;
+    (*ag_tailp)->maintenance_flags = 0;
+    cs_tailp = &(*ag_tailp)->csdata;
+    for (const AccessGroup::CellStoreMaintenanceData *cs_data = ag_data->csdata;
+         cs_data; cs_data = cs_data->next) {
+      *cs_tailp = (AccessGroup::CellStoreMaintenanceData *)arena.alloc( sizeof(AccessGroup::CellStoreMaintenanceData) );
+      memcpy(*cs_tailp, cs_data, sizeof(AccessGroup::CellStoreMaintenanceData));
+      (*cs_tailp)->user_data = 0;
+      (*cs_tailp)->maintenance_flags = 0;
+      cs_tailp = &(*cs_tailp)->next;
+    }
+    *cs_tailp = 0;
+    ag_tailp = &(*ag_tailp)->next;
+  }
+  *ag_tailp = 0;
+
+  mdata->priority = 0;
+  mdata->maintenance_flags = 0;
+  mdata->purgeable_index_memory = 0;
+  mdata->compact_memory = 0;
+  // load rates are zero for a range that has not been touched
+  mdata->load_split = false;
+
+  mdata->relinquish = m_relinquish;
+  {
+    ScopedLock lock(m_mutex);
+    mdata->state = m_metalog_entity->state.state;
+    mdata->soft_limit = m_metalog_entity->state.soft_limit;
+  }
+  mdata->busy = m_maintenance_guard.in_progress() || !m_metalog_entity->load_acknowledged;
+  mdata->needs_major_compaction = m_metalog_entity->needs_compaction;
+
+  return mdata;
+}
+
+
 void Range::relinquish() {
   RangeMaintenanceGuard::Activator activator(m_maintenance_guard);
 
@@ -522,7 +849,12 @@ void Range::relinquish() {
     case (RangeState::STEADY):
       relinquish_install_log();
     case (RangeState::RELINQUISH_LOG_INSTALLED):
-      relinquish_compact_and_finish();
+      if (Global::range_move_ship_cell_caches)
+        relinquish_ship_cell_caches();
+      else
+        relinquish_compact();
+    case (RangeState::RELINQUISH_CACHE_SHIPPED):
+      relinquish_finish();
     }
   }
   catch (Exception &e) {
@@ -534,6 +866,7 @@ void Range::relinquish() {
   {
     ScopedLock lock(m_mutex);
     m_capacity_exceeded_throttle = false;
+    m_capacity_ratio = 0.0;
     m_maintenance_generation++;
   }
 
@@ -609,7 +942,7 @@ void Range::relinquish_install_log() {
 }
 
 
-void Range::relinquish_compact_and_finish() {
+void Range::relinquish_compact() {
   AccessGroupVector ag_vector(0);
 
   {
@@ -625,6 +958,81 @@ void Range::relinquish_compact_and_finish() {
    */
   for (size_t i=0; i<ag_vector.size(); i++)
     ag_vector[i]->run_compaction(MaintenanceFlag::COMPACT_MINOR);
+}
+
+
+/**
+ * Writes the staged cell caches to a log next to the transfer log instead
+ * of compacting them.  The destination replays that log ahead of the
+ * transfer log and so starts out with the cells in memory.  The caches go
+ * to their own log, rather than the transfer log, because a recovery of
+ * this server replays the transfer log on top of the commit log, which
+ * already holds these cells.
+ */
+void Range::relinquish_ship_cell_caches() {
+  AccessGroupVector ag_vector(0);
+  String log_dir = get_cache_log_dir(m_metalog_entity->state.transfer_log);
+  size_t count = 0;
+  int error;
+
+  {
+    ScopedLock lock(m_schema_mutex);
+    ag_vector = m_access_group_vector;
+  }
+
+  if (cancel_maintenance())
+    HT_THROW(Error::CANCELLED, "");
+
+  // Discard what an interrupted attempt may have written
+  if (Global::log_dfs->exists(log_dir))
+    Global::log_dfs->rmdir(log_dir);
+  Global::log_dfs->mkdirs(log_dir);
+
+  CommitLogPtr cache_log = new CommitLog(Global::log_dfs, log_dir);
+  for (size_t i=0; i<ag_vector.size(); i++)
+    count += ag_vector[i]->write_immutable_cache(cache_log.get());
+  if ((error = cache_log->close()) != Error::OK)
+    HT_THROWF(error, "Problem closing cell cache log '%s'", log_dir.c_str());
+
+  if (count == 0)
+    Global::log_dfs->rmdir(log_dir);
+  else
+    HT_INFOF("Wrote %llu cached cells of %s to '%s'", (Llu)count,
+             m_name.c_str(), log_dir.c_str());
+
+  /**
+   * Persist RELINQUISH_CACHE_SHIPPED Metalog state
+   */
+  {
+    ScopedLock lock(m_mutex);
+    m_metalog_entity->state.state = RangeState::RELINQUISH_CACHE_SHIPPED;
+  }
+  for (int i=0; true; i++) {
+    try {
+      Global::rsml_writer->record_state(m_metalog_entity.get());
+      break;
+    }
+    catch (Exception &e) {
+      if (i<3) {
+        HT_WARNF("%s - %s", Error::get_text(e.code()), e.what());
+        poll(0, 0, 5000);
+        continue;
+      }
+      HT_ERRORF("Problem updating meta log entry with RELINQUISH_CACHE_SHIPPED state for %s",
+                m_name.c_str());
+      HT_FATAL_OUT << e << HT_END;
+    }
+  }
+}
+
+
+void Range::relinquish_finish() {
+
+  if (cancel_maintenance())
+    HT_THROW(Error::CANCELLED, "");
+
+  // The destination loads from METADATA, so it must list adopted files
+  flush_adopted_cell_stores();
 
   // VERIFY
   // update the latest generation, this should probably be protected
@@ -734,6 +1142,7 @@ void Range::split() {
   {
     ScopedLock lock(m_mutex);
     m_capacity_exceeded_throttle = false;
+    m_capacity_ratio = 0.0;
     m_maintenance_generation++;
   }
 
@@ -746,45 +1155,60 @@ void Range::split() {
  */
 void Range::split_install_log() {
   std::vector<String> split_rows;
+  SplitRowSampler::SampleVector samples;
+  const char *split_row;
   char md5DigestStr[33];
   AccessGroupVector  ag_vector(0);
 
   {
     ScopedLock lock(m_schema_mutex);
     ag_vector = m_access_group_vector;
+    // Split hot ranges at the median of the rows they recently served
+    if (m_load_split)
+      m_load_sampler.get_rows(m_metalog_entity->spec.start_row,
+                              m_metalog_entity->spec.end_row, split_rows);
   }
 
   if (cancel_maintenance())
     HT_THROW(Error::CANCELLED, "");
 
-  for (size_t i=0; i<ag_vector.size(); i++)
-    ag_vector[i]->get_split_rows(split_rows, false);
-
-  /**
-   * If we didn't get at least one row from each Access Group, then try again
-   * the hard way (scans CellCache for middle row)
-   */
+  if (!split_rows.empty()) {
+    HT_INFOF("Splitting range %s at median of %d sampled rows because of load",
+             m_name.c_str(), (int)split_rows.size());
+    foreach (const String &row, split_rows)
+      samples.push_back(SplitRowSampler::Sample(row, 1));
+  }
+  else {
+    bool sampled_all = true;
+    for (size_t i=0; i<ag_vector.size(); i++) {
+      size_t count = samples.size();
+      ag_vector[i]->get_split_row_samples(samples, false);
+      if (samples.size() == count)
+        sampled_all = false;
+    }
 
-  if (split_rows.size() < ag_vector.size()) {
-    for (size_t i=0; i<ag_vector.size(); i++)
-      ag_vector[i]->get_split_rows(split_rows, true);
+    /**
+     * If we didn't get samples from each Access Group, then include the
+     * samples of the CellCaches
+     */
+    if (!sampled_all) {
+      samples.clear();
+      for (size_t i=0; i<ag_vector.size(); i++)
+        ag_vector[i]->get_split_row_samples(samples, true);
+    }
   }
-  sort(split_rows.begin(), split_rows.end());
 
-  //HT_INFO_OUT << "thelma Dumping split rows for range " << m_name << HT_END;
-  //for (size_t i=0; i<split_rows.size(); i++)
-  //  HT_INFO_OUT << "thelma Range::get_split_row [" << i << "] = " << split_rows[i]
-  //              << HT_END;
-  //HT_INFO_OUT << "thelma Done calculating split rows for range " << m_name << HT_END;
+  // Pick the row that divides the sampled bytes in two
+  split_row = SplitRowSampler::median(samples);
 
   /**
    * If we still didn't get a good split row, try again the *really* hard way
    * by collecting all of the cached rows, sorting them and then taking the
    * middle.
    */
-  if (split_rows.size() > 0) {
+  if (split_row) {
     ScopedLock lock(m_mutex);
-    m_split_row = split_rows[split_rows.size()/2];
+    m_split_row = split_row;
     if (strcmp(m_split_row.c_str(), m_metalog_entity->spec.start_row) < 0 ||
         strcmp(m_split_row.c_str(), m_metalog_entity->spec.end_row) >= 0) {
       split_rows.clear();
@@ -1009,6 +1433,13 @@ void Range::split_compact_and_shrink() {
     }
   }
 
+  {
+    ScopedLock lock(m_schema_mutex);
+    m_load_sampler.clear();
+    m_sample_load = false;
+    m_load_split = false;
+  }
+
   if (m_split_off_high) {
     /** Create DFS directories for this range **/
     {
@@ -1162,7 +1593,7 @@ void Range::compact(MaintenanceFlag::Map &subtask_map) {
       ScopedLock lock(m_mutex);
       for (size_t i=0; i<ag_vector.size(); i++) {
 	if (m_metalog_entity->needs_compaction ||
-            subtask_map.compaction(ag_vector[i].get()))
+            MaintenanceFlag::rewriting_compaction(subtask_map.flags(ag_vector[i].get())))
 	  ag_vector[i]->stage_compaction();
       }
     }
@@ -1175,7 +1606,10 @@ void Range::compact(MaintenanceFlag::Map &subtask_map) {
       else
         flags = subtask_map.flags(ag_vector[i].get());
 
-      if (flags & MaintenanceFlag::COMPACT) {
+      if (MaintenanceFlag::expired_compaction(flags))
+        ag_vector[i]->drop_expired_cell_stores();
+
+      if (MaintenanceFlag::rewriting_compaction(flags)) {
 	try {
 	  ag_vector[i]->run_compaction(flags);
 	}
@@ -1192,6 +1626,8 @@ void Range::compact(MaintenanceFlag::Map &subtask_map) {
     throw;
   }
 
+  flush_adopted_cell_stores();
+
   if (m_metalog_entity->needs_compaction) {
     try {
       m_metalog_entity->needs_compaction = false;
@@ -1206,6 +1642,7 @@ void Range::compact(MaintenanceFlag::Map &subtask_map) {
   {
     ScopedLock lock(m_mutex);
     m_capacity_exceeded_throttle = false;
+    m_capacity_ratio = 0.0;
     m_maintenance_generation++;
   }
 }
@@ -1251,7 +1688,8 @@ void Range::purge_memory(MaintenanceFlag::Map &subtask_map) {
 void Range::recovery_finalize() {
 
   if (m_metalog_entity->state.state == RangeState::SPLIT_LOG_INSTALLED ||
-      m_metalog_entity->state.state == RangeState::RELINQUISH_LOG_INSTALLED) {
+      m_metalog_entity->state.state == RangeState::RELINQUISH_LOG_INSTALLED ||
+      m_metalog_entity->state.state == RangeState::RELINQUISH_CACHE_SHIPPED) {
     CommitLogReaderPtr commit_log_reader =
       new CommitLogReader(Global::dfs, m_metalog_entity->state.transfer_log);
 
@@ -1261,15 +1699,20 @@ void Range::recovery_finalize() {
 
     m_transfer_log = new CommitLog(Global::dfs, m_metalog_entity->state.transfer_log);
 
-    // re-initiate compaction
-    for (size_t i=0; i<m_access_group_vector.size(); i++)
-      m_access_group_vector[i]->stage_compaction();
+    // re-initiate compaction, shipped caches are already in the cache log
+    if (m_metalog_entity->state.state != RangeState::RELINQUISH_CACHE_SHIPPED) {
+      for (size_t i=0; i<m_access_group_vector.size(); i++)
+        m_access_group_vector[i]->stage_compaction();
+    }
 
     if (m_metalog_entity->state.state == RangeState::SPLIT_LOG_INSTALLED) {
       HT_INFOF("Restored range state to SPLIT_LOG_INSTALLED (split point='%s' "
                "xfer log='%s')", m_metalog_entity->state.split_point, m_metalog_entity->state.transfer_log);
       m_split_row = m_metalog_entity->state.split_point;
     }
+    else if (m_metalog_entity->state.state == RangeState::RELINQUISH_CACHE_SHIPPED)
+      HT_INFOF("Restored range state to RELINQUISH_CACHE_SHIPPED (xfer log='%s')",
+               m_metalog_entity->state.transfer_log);
     else
       HT_INFOF("Restored range state to RELINQUISH_LOG_INSTALLED (xfer log='%s')",
                m_metalog_entity->state.transfer_log);
@@ -1277,12 +1720,15 @@ void Range::recovery_finalize() {
 
   for (size_t i=0; i<m_access_group_vector.size(); i++)
     m_access_group_vector[i]->recovery_finalize();
+
+  m_maintenance_dirty = true;
 }
 
 
 void Range::lock() {
   m_schema_mutex.lock();
   m_updates++;  // assumes this method is called for updates only
+  m_maintenance_dirty = true;
   for (size_t i=0; i<m_access_group_vector.size(); ++i)
     m_access_group_vector[i]->lock();
   m_revision = TIMESTAMP_MIN;
@@ -1411,5 +1857,6 @@ std::ostream &Hypertable::operator<<(std::ostream &os, const Range::MaintenanceD
   os << "is_metadata=" << (mdata.is_metadata ? "true" : "false") << "\n";
   os << "is_system=" << (mdata.is_system ? "true" : "false") << "\n";
   os << "relinquish=" << (mdata.relinquish ? "true" : "false") << "\n";
+  os << "load_split=" << (mdata.load_split ? "true" : "false") << "\n";
   return os;
 }
@@ -47,6 +47,7 @@
 #include "RangeMaintenanceGuard.h"
 #include "RangeSet.h"
 #include "RangeTransferInfo.h"
+#include "RowLoadSampler.h"
 
 namespace Hypertable {
 
@@ -98,6 +99,7 @@ namespace Hypertable {
       bool     is_system;
       bool     relinquish;
       bool     needs_major_compaction;
+      bool     load_split;
     };
 
     typedef std::map<String, AccessGroup *> AccessGroupMap;
@@ -150,8 +152,39 @@ namespace Hypertable {
 
     void replay_transfer_log(CommitLogReader *commit_log_reader);
 
+    /**
+     * Returns the directory of the log that holds the cell caches shipped
+     * along with the given transfer log when a range is relinquished.
+     */
+    static String get_cache_log_dir(const String &transfer_log) {
+      return transfer_log + "-cache";
+    }
+
     MaintenanceData *get_maintenance_data(ByteArena &arena, time_t now, TableMutator *mutator);
 
+    /**
+     * Returns true if updates, scans or maintenance may have changed this
+     * range since get_maintenance_data() last ran.
+     */
+    bool maintenance_data_changed() {
+      return m_maintenance_dirty ||
+        m_maintenance_completions != m_maintenance_guard.completions();
+    }
+
+    /**
+     * Copies maintenance data gathered in an earlier pass into
+     * <code>arena</code> without locking the access groups.  Fields that
+     * change without touching the access groups (state, busy, ...) are
+     * refreshed and the flags and priorities set by the prioritizers are
+     * cleared.
+     *
+     * @param arena arena to allocate the copy from
+     * @param previous maintenance data previously returned for this range
+     * @return copy of maintenance data
+     */
+    MaintenanceData *copy_maintenance_data(ByteArena &arena,
+                                           const MaintenanceData *previous);
+
     void wait_for_maintenance_to_complete() {
       m_maintenance_guard.wait_for_complete();
     }
@@ -164,6 +197,18 @@ namespace Hypertable {
 
     void compact(MaintenanceFlag::Map &subtask_map);
 
+    /**
+     * Adopts bulk loaded CellStores into the given access groups.  The
+     * files must live under the table's directory in the DFS and must
+     * have been built against this table with revisions older than any
+     * update this range has yet to persist.
+     *
+     * @param access_groups access group of each file
+     * @param files absolute pathnames of CellStore files
+     */
+    void adopt_cell_stores(const std::vector<String> &access_groups,
+                           const std::vector<String> &files);
+
     void purge_memory(MaintenanceFlag::Map &subtask_map);
 
     void schedule_relinquish() { m_relinquish = true; }
@@ -211,10 +256,13 @@ namespace Hypertable {
      * @param wait_for_maintenance true if this range has exceeded its capacity and
      *        future requests to this range need to be throttled till split/compaction reduces
      *        range size
+     * @param capacity_ratiop address of variable to hold the range size, as of
+     *        the last maintenance pass, divided by the maximum range size
      * @return true if transfer log installed
      */
     bool get_transfer_info(RangeTransferInfo &transfer_info, CommitLogPtr &transfer_log,
-                           int64_t *latest_revisionp, bool &wait_for_maintenance) {
+                           int64_t *latest_revisionp, bool &wait_for_maintenance,
+                           double *capacity_ratiop) {
       bool retval = false;
       ScopedLock lock(m_mutex);
 
@@ -233,6 +281,7 @@ namespace Hypertable {
 
       if (m_capacity_exceeded_throttle == true)
         wait_for_maintenance = true;
+      *capacity_ratiop = m_capacity_ratio;
 
       return retval;
     }
@@ -245,6 +294,7 @@ namespace Hypertable {
       m_bytes_scanned += bytes_scanned;
       m_bytes_returned += bytes_returned;
       m_disk_bytes_read += disk_bytes_read;
+      m_maintenance_dirty = true;
     }
 
     void add_bytes_written(uint64_t n) {
@@ -310,10 +360,14 @@ namespace Hypertable {
 
     void load_cell_stores(Metadata *metadata);
 
+    void flush_adopted_cell_stores();
+
     bool cancel_maintenance();
 
     void relinquish_install_log();
-    void relinquish_compact_and_finish();
+    void relinquish_compact();
+    void relinquish_ship_cell_caches();
+    void relinquish_finish();
 
     void split_install_log();
     void split_compact_and_shrink();
@@ -356,9 +410,15 @@ namespace Hypertable {
     int32_t          m_error;
     bool             m_dropped;
     bool             m_capacity_exceeded_throttle;
+    double           m_capacity_ratio;
     bool             m_relinquish;
     int64_t          m_maintenance_generation;
     LoadMetricsRange m_load_metrics;
+    RowLoadSampler   m_load_sampler;
+    bool             m_sample_load;
+    bool             m_load_split;
+    bool             m_maintenance_dirty;
+    uint32_t         m_maintenance_completions;
   };
 
   typedef intrusive_ptr<Range> RangePtr;
@@ -31,7 +31,7 @@ namespace Hypertable {
   class RangeMaintenanceGuard {
   public:
 
-    RangeMaintenanceGuard() : m_in_progress(false) {}
+    RangeMaintenanceGuard() : m_in_progress(false), m_completions(0) {}
 
     void activate() {
       ScopedLock lock(m_mutex);
@@ -43,6 +43,7 @@ namespace Hypertable {
     void deactivate() {
       ScopedLock lock(m_mutex);
       m_in_progress = false;
+      m_completions++;
       m_cond.notify_all();
     }
 
@@ -57,6 +58,16 @@ namespace Hypertable {
       return m_in_progress;
     }
 
+    /**
+     * Returns the number of maintenance operations that have completed,
+     * which tells whether the range may have changed since it was last
+     * looked at.
+     */
+    uint32_t completions() {
+      ScopedLock lock(m_mutex);
+      return m_completions;
+    }
+
     class Activator {
     public:
       Activator(RangeMaintenanceGuard &guard) : m_guard(&guard) {
@@ -73,6 +84,7 @@ namespace Hypertable {
     Mutex m_mutex;
     boost::condition m_cond;
     bool m_in_progress;
+    uint32_t m_completions;
   };
 
 }
@@ -28,6 +28,7 @@
 #include <fstream>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
 
 extern "C" {
 #include <fcntl.h>
@@ -62,6 +63,7 @@ extern "C" {
 
 #include "DfsBroker/Lib/Client.h"
 
+#include "CellCachePagePool.h"
 #include "FillScanBlock.h"
 #include "Global.h"
 #include "GroupCommit.h"
@@ -71,11 +73,13 @@ extern "C" {
 #include "MaintenanceScheduler.h"
 #include "MaintenanceTaskCompaction.h"
 #include "MaintenanceTaskSplit.h"
+#include "MemoryGovernor.h"
 #include "MergeScanner.h"
 #include "MetaLogDefinitionRangeServer.h"
 #include "MetaLogEntityRange.h"
 #include "RangeServer.h"
 #include "RangeStatsGatherer.h"
+#include "RequestHandlerFetchScanblock.h"
 #include "ScanContext.h"
 
 using namespace std;
@@ -89,7 +93,8 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
     m_system_replay_finished(false), m_replay_finished(false), m_props(props),
     m_verbose(false), m_comm(conn_mgr->get_comm()), m_conn_manager(conn_mgr),
     m_app_queue(app_queue), m_hyperspace(hyperspace), m_timer_handler(0),
-    m_group_commit_timer_handler(0), m_query_cache(0),
+    m_group_commit_timer_handler(0), m_query_cache(0), m_update_throttle(0),
+    m_update_response_timer_handler(0),
     m_last_revision(TIMESTAMP_MIN), m_last_metrics_update(0), m_loadavg_accum(0.0),
     m_page_in_accum(0), m_page_out_accum(0), m_metric_samples(0),
     m_pending_metrics_updates(0)
@@ -105,12 +110,18 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   Global::range_metadata_split_size = cfg.get_i64("Range.MetadataSplitSize", 0);
   Global::range_split_size = cfg.get_i64("Range.SplitSize");
   Global::range_maximum_size = cfg.get_i64("Range.MaximumSize");
+  Global::range_load_split_cell_rate = cfg.get_i32("Range.LoadSplit.CellRate");
+  Global::range_load_split_byte_rate = cfg.get_i64("Range.LoadSplit.ByteRate");
+  Global::range_load_split_intervals = cfg.get_i32("Range.LoadSplit.Intervals");
+  Global::range_load_split_minimum_size = cfg.get_i64("Range.LoadSplit.MinimumSize");
+  Global::range_move_ship_cell_caches = cfg.get_bool("Range.Move.ShipCellCaches");
   Global::access_group_garbage_compaction_threshold = cfg.get_i32("AccessGroup.GarbageThreshold.Percentage");
   Global::access_group_max_mem = cfg.get_i64("AccessGroup.MaxMemory");
   Global::enable_shadow_cache = cfg.get_bool("AccessGroup.ShadowCache");
   Global::cellstore_target_size_min = cfg.get_i64("CellStore.TargetSize.Minimum");
   Global::cellstore_target_size_max = 
     Global::cellstore_target_size_min + cfg.get_i64("CellStore.TargetSize.Window");
+  Global::cellstore_async_reads = cfg.get_i32("CellStore.AsyncReads");
   m_scanner_buffer_size = cfg.get_i64("Scanner.BufferSize");
   maintenance_threads = cfg.get_i32("MaintenanceThreads", maintenance_threads);
   port = cfg.get_i16("Port");
@@ -144,6 +155,10 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
 
   Global::cell_cache_scanner_cache_size =
     cfg.get_i32("AccessGroup.CellCache.ScannerCacheSize");
+  Global::cell_cache_compaction_threshold =
+    cfg.get_i32("AccessGroup.CellCache.Compaction.Threshold");
+  Global::cell_cache_compaction_min_memory =
+    cfg.get_i64("AccessGroup.CellCache.Compaction.MinimumMemory");
 
   if (m_scanner_ttl < (time_t)10000) {
     HT_WARNF("Value %u for Hypertable.RangeServer.Scanner.ttl is too small, "
@@ -199,6 +214,10 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   }
 
   Global::block_cache = new FileBlockCache(block_cache_min, block_cache_max);
+  Global::block_cache_warmup_budget = cfg.get_i64("BlockCache.CompactionWarmupBudget");
+
+  Global::wire_compressor = new WireCompressor(cfg.get_str("WireCompression"),
+      props->get_i32("Hypertable.WireCompression.MinPayloadSize"));
 
   int64_t query_cache_memory = cfg.get_i64("QueryCache.MaxMemory");
   if (query_cache_memory > 0) {
@@ -214,6 +233,19 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   Global::memory_tracker = new MemoryTracker(Global::block_cache);
   Global::memory_tracker->add(query_cache_memory);
 
+  int huge_pages = CellCachePagePool::parse_mode(cfg.get_str("AccessGroup.CellCache.HugePages"));
+  if (huge_pages)
+    Global::cell_cache_page_pool = new CellCachePagePool(
+        cfg.get_i32("AccessGroup.CellCache.PageSize"), huge_pages,
+        cfg.get_bool("AccessGroup.CellCache.NumaAware"));
+
+  if (cfg.get_bool("MemoryGovernor.Enable")) {
+    int64_t step = (Global::memory_limit *
+                    cfg.get_i32("MemoryGovernor.StepPercentage")) / 100;
+    Global::memory_governor = new MemoryGovernor(Global::block_cache,
+        m_query_cache, step, cfg.get_i32("MemoryGovernor.IdleIntervals"));
+  }
+
   Global::protocol = new Hypertable::RangeServerProtocol();
 
   DfsBroker::Client *dfsclient = new DfsBroker::Client(conn_mgr, props);
@@ -261,7 +293,8 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   /**
    * Create maintenance scheduler
    */
-  m_maintenance_stats_gatherer = new RangeStatsGatherer(m_live_map);
+  m_maintenance_stats_gatherer = new RangeStatsGatherer(m_live_map,
+      cfg.get_i32("Maintenance.StatsRefreshInterval"));
   m_maintenance_scheduler = new MaintenanceScheduler(Global::maintenance_queue, m_server_stats, m_maintenance_stats_gatherer);
 
   /**
@@ -313,6 +346,16 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   HT_INFOF("Prune thresholds - min=%lld, max=%lld", (Lld)Global::log_prune_threshold_min,
            (Lld)Global::log_prune_threshold_max);
 
+  if (cfg.get_bool("UpdateThrottle.Enable")) {
+    m_update_throttle = new UpdateThrottle(Global::memory_limit,
+        cfg.get_i32("UpdateThrottle.MemoryThreshold"),
+        cfg.get_i32("UpdateThrottle.MaxDelay"),
+        cfg.get_i64("UpdateThrottle.MinimumRate"));
+    m_update_throttle_blocking_ratio =
+      (double)cfg.get_i32("UpdateThrottle.BlockingPercentage") / 100.0;
+    m_update_response_timer_handler = new UpdateResponseTimerHandler(m_comm);
+  }
+
 }
 
 void RangeServer::shutdown() {
@@ -330,6 +373,9 @@ void RangeServer::shutdown() {
     if (m_group_commit_timer_handler)
       m_group_commit_timer_handler->shutdown();
 
+    if (m_update_response_timer_handler)
+      m_update_response_timer_handler->shutdown();
+
     // stop maintenance queue
     Global::maintenance_queue->shutdown();
 #if defined(CLEAN_SHUTDOWN)
@@ -337,6 +383,8 @@ void RangeServer::shutdown() {
 #endif
 
     Global::range_locator = 0;
+    delete Global::memory_governor;
+    Global::memory_governor = 0;
     delete Global::block_cache;
 
     if (Global::rsml_writer) {
@@ -1173,6 +1221,16 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
       HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
                "can only scan one cell interval");
 
+    if (scan_spec->aggregate < ScanSpec::AGGREGATE_NONE ||
+        scan_spec->aggregate > ScanSpec::AGGREGATE_TOTAL)
+      HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC,
+                "bad aggregation mode %d", (int)scan_spec->aggregate);
+
+    if (scan_spec->aggregate != ScanSpec::AGGREGATE_NONE &&
+        scan_spec->return_deletes)
+      HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
+               "aggregate scans can't return deletes");
+
     m_live_map->get(table, table_info);
 
     if (!table_info->get_range(range_spec, range))
@@ -1226,6 +1284,15 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
     range->decrement_scan_counter();
     decrement_needed = false;
 
+    // If the scan is about to block on a block that is still being read,
+    // give the worker back and re-queue the request once the read is in
+    if (Global::cellstore_async_reads > 0) {
+      PreadFuturePtr pending = scanner->get_pending_read();
+      if (pending && pending->when_ready(boost::bind(
+              &RangeServer::resume_fetch_scanblock, this, cb->get_event())))
+        return;
+    }
+
     uint64_t cells_scanned, cells_returned, bytes_scanned, bytes_returned;
 
     more = FillScanBlock(scanner, rbuf, m_scanner_buffer_size);
@@ -1382,6 +1449,11 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
 }
 
 
+void RangeServer::resume_fetch_scanblock(EventPtr event) {
+  m_app_queue->add(new RequestHandlerFetchScanblock(m_comm, this, event));
+}
+
+
 void
 RangeServer::load_range(ResponseCallback *cb, const TableIdentifier *table,
     const RangeSpec *range_spec, const char *transfer_log_dir,
@@ -1571,24 +1643,34 @@ RangeServer::load_range(ResponseCallback *cb, const TableIdentifier *table,
        * concurrently access it.
        */
       if (transfer_log_dir && *transfer_log_dir) {
-        CommitLogReaderPtr commit_log_reader =
-          new CommitLogReader(Global::log_dfs, transfer_log_dir, true);
-        if (!commit_log_reader->empty()) {
-          CommitLog *log;
-          if (is_root)
-            log = Global::root_log;
-          else if (table->is_metadata())
-            log = Global::metadata_log;
-          else if (table->is_system())
-            log = Global::system_log;
-          else
-            log = Global::user_log;
+        std::vector<String> log_dirs;
+        CommitLog *log;
+        if (is_root)
+          log = Global::root_log;
+        else if (table->is_metadata())
+          log = Global::metadata_log;
+        else if (table->is_system())
+          log = Global::system_log;
+        else
+          log = Global::user_log;
+
+        // Cell caches shipped by the source precede the transfer log
+        String cache_log_dir = Range::get_cache_log_dir(transfer_log_dir);
+        if (Global::log_dfs->exists(cache_log_dir))
+          log_dirs.push_back(cache_log_dir);
+        log_dirs.push_back(transfer_log_dir);
+
+        foreach(const String &log_dir, log_dirs) {
+          CommitLogReaderPtr commit_log_reader =
+            new CommitLogReader(Global::log_dfs, log_dir, true);
+          if (commit_log_reader->empty())
+            continue;
 
           range->replay_transfer_log(commit_log_reader.get());
 
           if ((error = log->link_log(commit_log_reader.get())) != Error::OK)
             HT_THROWF(error, "Unable to link transfer log (%s) into commit log(%s)",
-                      transfer_log_dir, log->get_log_dir().c_str());
+                      log_dir.c_str(), log->get_log_dir().c_str());
 
           // transfer the in-memory log fragments
           log->stitch_in(commit_log_reader.get());
@@ -1953,6 +2035,7 @@ RangeServer::update(ResponseCallbackUpdate *cb, const TableIdentifier *table,
 
   request.buffer = buffer;
   request.count = count;
+  request.flags = flags;
   request.event = cb->get_event();
   table_update.requests.push_back(&request);
 
@@ -1975,6 +2058,7 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
   RangeUpdateList *rulist = 0;
   int error = Error::OK;
   bool wait_for_maintenance;
+  double capacity_ratio = 0.0;
   int64_t latest_range_revision;
   RangeTransferInfo transfer_info;
   bool transfer_pending;
@@ -2171,8 +2255,16 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
 
         /** Fetch range transfer information **/
         transfer_pending = rulist->range->get_transfer_info(transfer_info, transfer_log,
-                                                            &latest_range_revision, wait_for_maintenance);
-        if (wait_for_maintenance)
+                                                            &latest_range_revision, wait_for_maintenance,
+                                                            &capacity_ratio);
+        if (capacity_ratio > request->capacity_ratio)
+          request->capacity_ratio = capacity_ratio;
+
+        // With the update throttle enabled, over-capacity ranges are paced
+        // when the response is sent and only block at the hard limit
+        if (wait_for_maintenance &&
+            (m_update_throttle == 0 ||
+             capacity_ratio >= m_update_throttle_blocking_ratio))
           table_update->wait_ranges.insert(rulist->range.get());
 
         if (rulist->transfer_log.get() == 0)
@@ -2496,6 +2588,9 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
   if (Global::verbose && misses)
     HT_INFOF("Sent back %d updates because out-of-range", misses);
 
+  if (m_update_throttle)
+    m_update_throttle->record_update(total_bytes_added);
+
 
   // decrement usage counters for all referenced ranges
   foreach (TableUpdate *table_update, updates) {
@@ -2544,29 +2639,36 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
       }
 
       if (request->error == Error::OK) {
+
         /**
-         * Send back response
+         * Pace the client, either by handing back a throttle hint or by
+         * deferring the response
          */
-        if (!request->send_back_vector.empty()) {
-          StaticBuffer ext(new uint8_t [request->send_back_vector.size() * 16],
-                           request->send_back_vector.size() * 16);
-          uint8_t *ptr = ext.base;
-          for (size_t i=0; i<request->send_back_vector.size(); i++) {
-            encode_i32(&ptr, request->send_back_vector[i].error);
-            encode_i32(&ptr, request->send_back_vector[i].count);
-            encode_i32(&ptr, request->send_back_vector[i].offset);
-            encode_i32(&ptr, request->send_back_vector[i].len);
-            HT_INFOF("Sending back error %x, count %d, offset %d, len %d",
-                     request->send_back_vector[i].error, request->send_back_vector[i].count,
-                     request->send_back_vector[i].offset, request->send_back_vector[i].len);
+        if (m_update_throttle && !table_update->id.is_metadata() &&
+            !table_update->id.is_system() && request->buffer.size) {
+          uint32_t delay =
+            m_update_throttle->admit(get_ts64() / 1000000LL, request->event->addr,
+                                     request->buffer.size, request->capacity_ratio);
+          if (delay) {
+            if (request->flags & RangeServerProtocol::UPDATE_FLAG_THROTTLE_HINTS) {
+              memset(&send_back, 0, sizeof(send_back));
+              send_back.error = Error::RANGESERVER_UPDATE_THROTTLED;
+              send_back.count = delay;
+              request->send_back_vector.push_back(send_back);
+            }
+            else {
+              m_update_response_timer_handler->defer(request->event,
+                  request->send_back_vector, delay);
+              continue;
+            }
           }
-          if ((error = cb.response(ext)) != Error::OK)
-            HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
-        }
-        else {
-          if ((error = cb.response_ok()) != Error::OK)
-            HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
         }
+
+        /**
+         * Send back response
+         */
+        UpdateResponseTimerHandler::send_response(m_comm, request->event,
+                                                  request->send_back_vector);
       }
       else {
         if ((error = cb.error(request->error, "")) != Error::OK)
@@ -2794,8 +2896,54 @@ void RangeServer::get_statistics(ResponseCallbackGetStatistics *cb) {
   m_stats->updated_bytes = m_server_stats->get_update_bytes(collector_id);
   m_stats->sync_count = m_server_stats->get_sync_count(collector_id);
   m_stats->tracked_memory = Global::memory_tracker->balance();
+  {
+    WireCompressor::Stats wire_stats;
+    Global::wire_compressor->get_stats(wire_stats);
+    m_stats->wire_update_raw_bytes = wire_stats.received_raw_bytes;
+    m_stats->wire_update_bytes = wire_stats.received_wire_bytes;
+    m_stats->wire_scan_raw_bytes = wire_stats.sent_raw_bytes;
+    m_stats->wire_scan_bytes = wire_stats.sent_wire_bytes;
+    WireCompressor::client()->get_stats(wire_stats);
+    m_stats->wire_client_update_raw_bytes = wire_stats.sent_raw_bytes;
+    m_stats->wire_client_update_bytes = wire_stats.sent_wire_bytes;
+    m_stats->wire_client_scan_raw_bytes = wire_stats.received_raw_bytes;
+    m_stats->wire_client_scan_bytes = wire_stats.received_wire_bytes;
+  }
   m_stats->live = m_replay_finished;
 
+  if (Global::memory_governor) {
+    MemoryGovernor::Stats governor_stats;
+    Global::memory_governor->get_stats(governor_stats);
+    m_stats->cell_cache_memory = governor_stats.cell_cache_memory;
+    m_stats->block_index_memory = governor_stats.block_index_memory;
+    m_stats->bloom_filter_memory = governor_stats.bloom_filter_memory;
+    m_stats->shadow_cache_memory = governor_stats.shadow_cache_memory;
+    m_stats->idle_index_memory = governor_stats.idle_index_memory;
+    m_stats->block_cache_limit = governor_stats.block_cache_limit;
+    m_stats->query_cache_limit = governor_stats.query_cache_limit;
+    m_stats->memory_rebalances = governor_stats.rebalances;
+    m_stats->memory_rebalanced_bytes = governor_stats.bytes_moved;
+    m_stats->memory_governor_decision = governor_stats.last_decision;
+  }
+
+  if (m_maintenance_scheduler) {
+    MaintenanceScheduler::Stats maintenance_stats;
+    m_maintenance_scheduler->get_stats(maintenance_stats);
+    m_stats->maintenance_passes = maintenance_stats.passes;
+    m_stats->maintenance_time = maintenance_stats.total_time;
+    m_stats->maintenance_last_time = maintenance_stats.last_time;
+    m_stats->maintenance_last_gather_time = maintenance_stats.last_gather_time;
+    m_stats->maintenance_last_prioritize_time = maintenance_stats.last_prioritize_time;
+    m_stats->maintenance_ranges_gathered = maintenance_stats.ranges_gathered;
+    m_stats->maintenance_ranges_reused = maintenance_stats.ranges_reused;
+  }
+
+  if (m_update_throttle) {
+    m_update_throttle->get_counts(&m_stats->throttled_updates,
+                                  &m_stats->throttle_delay_time);
+    m_stats->throttle_drain_rate = (uint64_t)m_update_throttle->drain_rate();
+  }
+
   if (m_query_cache)
     m_query_cache->get_stats(&m_stats->query_cache_max_memory,
                              &m_stats->query_cache_available_memory,
@@ -3360,6 +3508,65 @@ RangeServer::relinquish_range(ResponseCallback *cb, const TableIdentifier *table
 }
 
 
+void
+RangeServer::adopt_cellstores(ResponseCallback *cb, const TableIdentifier *table,
+                              const RangeSpec *range_spec,
+                              const std::vector<String> &access_groups,
+                              const std::vector<String> &files) {
+  TableInfoPtr table_info;
+  RangePtr range;
+
+  HT_INFO_OUT << "adopt_cellstores (" << files.size() << " files)\n"
+              << *table << *range_spec << HT_END;
+
+  if (!m_replay_finished) {
+    if (!RangeServer::wait_for_recovery_finish(cb->get_event()->expiration_time()))
+      return;
+  }
+
+  try {
+
+    if (table->is_system())
+      HT_THROWF(Error::NOT_ALLOWED, "Cannot adopt CellStores into system "
+                "table %s", table->id);
+
+    if (!m_live_map->get(table->id, table_info)) {
+      cb->error(Error::TABLE_NOT_FOUND, table->id);
+      return;
+    }
+
+    if (!table_info->get_range(range_spec, range))
+      HT_THROW(Error::RANGESERVER_RANGE_NOT_FOUND,
+               format("%s[%s..%s]", table->id, range_spec->start_row, range_spec->end_row));
+
+    if (table->generation != table_info->get_schema()->get_generation())
+      HT_THROWF(Error::RANGESERVER_GENERATION_MISMATCH,
+                "Bulk load built against generation %u, current is %u",
+                (unsigned)table->generation,
+                (unsigned)table_info->get_schema()->get_generation());
+
+    range->adopt_cell_stores(access_groups, files);
+
+    // Wake up maintenance scheduler
+    {
+      ScopedLock lock(m_mutex);
+      m_maintenance_scheduler->need_scheduling();
+      if (m_timer_handler)
+        m_timer_handler->schedule_maintenance();
+    }
+
+    cb->response_ok();
+  }
+  catch (Hypertable::Exception &e) {
+    int error = 0;
+    HT_ERROR_OUT << e << HT_END;
+    if (cb && (error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+
+}
+
+
 void RangeServer::close(ResponseCallback *cb) {
   std::vector<TableInfoPtr> table_vec;
   std::vector<RangePtr> range_vec;
@@ -3478,6 +3685,13 @@ void RangeServer::do_maintenance() {
     // Recompute stats
     m_server_stats->recompute(RSStats::STATS_COLLECTOR_MAINTENANCE);
 
+    // Refresh update throttle estimates
+    if (m_update_throttle)
+      m_update_throttle->update_estimates(get_ts64() / 1000000LL,
+          Global::memory_tracker->memory_used(),
+          Global::user_log ? Global::user_log->size() : 0,
+          Global::log_prune_threshold_max);
+
     // Schedule maintenance
     m_maintenance_scheduler->schedule();
 
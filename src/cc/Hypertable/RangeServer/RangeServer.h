@@ -59,6 +59,8 @@
 #include "TableInfo.h"
 #include "TableInfoMap.h"
 #include "TimerInterface.h"
+#include "UpdateResponseTimerHandler.h"
+#include "UpdateThrottle.h"
 
 namespace Hypertable {
   using namespace Hyperspace;
@@ -107,6 +109,11 @@ namespace Hypertable {
 
     void relinquish_range(ResponseCallback *, const TableIdentifier *,
                           const RangeSpec *);
+
+    void adopt_cellstores(ResponseCallback *, const TableIdentifier *,
+                          const RangeSpec *,
+                          const std::vector<String> &access_groups,
+                          const std::vector<String> &files);
     void heapcheck(ResponseCallback *, const char *);
 
     void metadata_sync(ResponseCallback *, const char *, uint32_t flags, std::vector<const char *> columns);
@@ -155,6 +162,7 @@ namespace Hypertable {
     void verify_schema(TableInfoPtr &, uint32_t generation);
     void transform_key(ByteString &bskey, DynamicBuffer *dest_bufp,
                        int64_t revision, int64_t *revisionp);
+    void resume_fetch_scanblock(EventPtr event);
 
     Mutex                  m_mutex;
     Mutex                  m_drop_table_mutex;
@@ -202,6 +210,9 @@ namespace Hypertable {
     GroupCommitTimerHandler *m_group_commit_timer_handler;
     uint32_t               m_update_delay;
     QueryCache            *m_query_cache;
+    UpdateThrottle        *m_update_throttle;
+    double                 m_update_throttle_blocking_ratio;
+    UpdateResponseTimerHandler *m_update_response_timer_handler;
     int64_t                m_last_revision;
     int64_t                m_scanner_buffer_size;
     time_t                 m_last_metrics_update;
@@ -30,17 +30,27 @@ using namespace Hypertable;
 void RangeStatsGatherer::fetch(RangeStatsVector &range_stats,
                                size_t *lenp, TableMutator *mutator) {
   std::vector<TableInfoPtr> table_vec;
+  CacheMap previous;
+  CacheMap::iterator iter;
+  Range::MaintenanceData *mdata;
 
   range_stats.clear();
 
   clear();
 
+  // The data of the last fetch is only read from here on
+  m_previous_arena.swap(m_arena);
+  previous.swap(m_cache);
+  m_gathered = m_reused = 0;
+
   m_table_info_map->get_all(table_vec);
 
   m_range_vec.reserve( m_table_info_map->get_range_count() );
 
-  if (table_vec.empty())
+  if (table_vec.empty()) {
+    m_previous_arena.free();
     return;
+  }
 
   time_t now = time(0);
 
@@ -49,14 +59,40 @@ void RangeStatsGatherer::fetch(RangeStatsVector &range_stats,
 
   for (size_t i=0,j=0; i<table_vec.size(); i++) {
     table_vec[i]->get_range_vector(m_range_vec);
-    for (; j<m_range_vec.size(); j++)
-      range_stats.push_back(m_range_vec[j]->get_maintenance_data(m_arena, now, mutator));
+    for (; j<m_range_vec.size(); j++) {
+      Range *range = m_range_vec[j].get();
+      time_t gathered = now;
+      if ((iter = previous.find(range)) != previous.end() &&
+          reusable((*iter).second.gathered, now,
+                   range->maintenance_data_changed(), mutator)) {
+        mdata = range->copy_maintenance_data(m_arena, (*iter).second.data);
+        gathered = (*iter).second.gathered;
+        m_reused++;
+      }
+      else {
+        mdata = range->get_maintenance_data(m_arena, now, mutator);
+        m_gathered++;
+      }
+      if (m_refresh_interval) {
+        CachedData &cached = m_cache[range];
+        cached.range = m_range_vec[j];
+        cached.data = mdata;
+        cached.gathered = gathered;
+      }
+      range_stats.push_back(mdata);
+    }
   }
 
+  previous.clear();
+  m_previous_arena.free();
 }
 
 
 void RangeStatsGatherer::clear() {
-  m_arena.free();
+  // with a refresh interval, the arena holds the data for the next fetch
+  if (m_refresh_interval == 0) {
+    m_arena.free();
+    m_cache.clear();
+  }
   m_range_vec.clear();
 }
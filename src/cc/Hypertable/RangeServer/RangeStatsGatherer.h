@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_RANGESTATSGATHERER_H
 #define HYPERTABLE_RANGESTATSGATHERER_H
 
+#include <map>
+
 #include "Common/PageArena.h"
 #include "Common/ReferenceCount.h"
 
@@ -35,9 +37,19 @@ namespace Hypertable {
 
   typedef std::vector<Range::MaintenanceData *> RangeStatsVector;
 
+  /**
+   * Gathers the maintenance data of all live ranges.  With a refresh
+   * interval, the data of the previous fetch is kept and copied for ranges
+   * that have not changed since then (see Range::maintenance_data_changed),
+   * so that idle ranges are neither walked nor locked on every pass.  The
+   * data of every range is gathered afresh at least once per refresh
+   * interval.
+   */
   class RangeStatsGatherer : public ReferenceCount {
   public:
-    RangeStatsGatherer(TableInfoMapPtr &table_info_map) : m_table_info_map(table_info_map) { }
+    RangeStatsGatherer(TableInfoMapPtr &table_info_map, int32_t refresh_interval=0)
+      : m_table_info_map(table_info_map), m_refresh_interval(refresh_interval),
+        m_gathered(0), m_reused(0) { }
 
     virtual ~RangeStatsGatherer() { }
 
@@ -45,11 +57,51 @@ namespace Hypertable {
 
     void clear();
 
+    /**
+     * Returns the number of ranges gathered afresh and the number of ranges
+     * whose data was reused by the last fetch.
+     */
+    void get_counts(size_t *gatheredp, size_t *reusedp) {
+      *gatheredp = m_gathered;
+      *reusedp = m_reused;
+    }
+
+    /**
+     * Returns true if maintenance data gathered at <code>gathered</code>
+     * may be reused at <code>now</code>.  Data is never reused without a
+     * refresh interval, when a mutator is given (RS_METRICS needs fresh
+     * data), when the range has changed or once it is a refresh interval
+     * old.
+     *
+     * @param gathered time the data was gathered
+     * @param now current time
+     * @param changed true if the range changed since it was gathered
+     * @param mutator mutator passed to fetch()
+     * @return true if the data can be copied instead of gathered
+     */
+    bool reusable(time_t gathered, time_t now, bool changed,
+                  TableMutator *mutator) const {
+      return m_refresh_interval && mutator == 0 && !changed &&
+        (now - gathered) * 1000 < m_refresh_interval;
+    }
+
   private:
+
+    struct CachedData {
+      RangePtr range;
+      Range::MaintenanceData *data;
+      time_t gathered;
+    };
+    typedef std::map<Range *, CachedData> CacheMap;
+
     ByteArena m_arena;
+    ByteArena m_previous_arena;
     TableInfoMapPtr  m_table_info_map;
     std::vector<RangePtr> m_range_vec;
-
+    CacheMap m_cache;
+    int32_t m_refresh_interval;
+    size_t m_gathered;
+    size_t m_reused;
   };
   typedef intrusive_ptr<RangeStatsGatherer> RangeStatsGathererPtr;
 
@@ -28,6 +28,7 @@
 
 #include "Hypertable/Lib/Types.h"
 
+#include "Global.h"
 #include "RangeServer.h"
 #include "RequestHandlerUpdate.h"
 
@@ -48,9 +49,16 @@ void RequestHandlerUpdate::run() {
     uint32_t count = Serialization::decode_i32(&decode_ptr, &decode_remain);
     uint32_t flags = Serialization::decode_i32(&decode_ptr, &decode_remain);
 
-    mods.base = (uint8_t *)decode_ptr;
-    mods.size = decode_remain;
-    mods.own = false;
+    if (m_event_ptr->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED) {
+      DynamicBuffer dbuf;
+      Global::wire_compressor->inflate(decode_ptr, decode_remain, dbuf);
+      mods = dbuf;
+    }
+    else {
+      mods.base = (uint8_t *)decode_ptr;
+      mods.size = decode_remain;
+      mods.own = false;
+    }
 
     m_range_server->update(&cb, &table, count, mods, flags);
   }
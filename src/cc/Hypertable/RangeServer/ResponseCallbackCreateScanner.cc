@@ -20,6 +20,8 @@
  */
 
 #include "Common/Compat.h"
+
+#include "Global.h"
 #include "ResponseCallbackCreateScanner.h"
 
 using namespace Hypertable;
@@ -28,8 +30,13 @@ int
 ResponseCallbackCreateScanner::response(short moreflag, int32_t id,
                                         StaticBuffer &ext) {
   CommHeader header;
+  StaticBuffer zext;
   header.initialize_from_request_header(m_event_ptr->header);
-  CommBufPtr cbp(new CommBuf( header, 10, ext));
+  if ((m_event_ptr->header.flags & CommHeader::FLAGS_BIT_ACCEPT_COMPRESSION) &&
+      Global::wire_compressor &&
+      Global::wire_compressor->deflate_scan_block(ext, zext))
+    header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED;
+  CommBufPtr cbp(new CommBuf(header, 10, zext.base ? zext : ext));
   cbp->append_i32(Error::OK);
   cbp->append_i16(moreflag);
   cbp->append_i32(id);   // scanner ID
@@ -43,8 +50,16 @@ ResponseCallbackCreateScanner::response(short moreflag, int32_t id,
 					boost::shared_array<uint8_t> &ext_buffer,
 					uint32_t ext_len) {
   CommHeader header;
+  StaticBuffer zext;
   header.initialize_from_request_header(m_event_ptr->header);
-  CommBufPtr cbp(new CommBuf( header, 10, ext_buffer, ext_len));
+  if ((m_event_ptr->header.flags & CommHeader::FLAGS_BIT_ACCEPT_COMPRESSION) &&
+      Global::wire_compressor) {
+    StaticBuffer ext(ext_buffer.get(), ext_len, false);
+    if (Global::wire_compressor->deflate_scan_block(ext, zext))
+      header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_COMPRESSED;
+  }
+  CommBufPtr cbp(zext.base ? new CommBuf(header, 10, zext)
+                           : new CommBuf(header, 10, ext_buffer, ext_len));
   cbp->append_i32(Error::OK);
   cbp->append_i16(moreflag);
   cbp->append_i32(id);   // scanner ID
@@ -0,0 +1,98 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_ROWLOADSAMPLER_H
+#define HYPERTABLE_ROWLOADSAMPLER_H
+
+#include <cstring>
+#include <vector>
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Keeps a fixed size sample of the rows most recently read or written in
+   * a range.  Every <i>interval</i>-th access is recorded, overwriting the
+   * oldest sample once the buffer is full, so the median of the samples
+   * divides the recent load of the range in two.  Not thread safe, the
+   * owning Range serializes access.
+   */
+  class RowLoadSampler {
+  public:
+    RowLoadSampler(size_t capacity=128, uint32_t interval=8)
+      : m_capacity(capacity), m_interval(interval), m_accesses(0),
+        m_next(0) { }
+
+    /**
+     * Counts an access to <code>row</code>, recording it if it falls on the
+     * sampling interval.
+     *
+     * @param row row key read or written
+     */
+    void add(const char *row) {
+      if (++m_accesses % m_interval)
+        return;
+      if (m_samples.size() < m_capacity)
+        m_samples.push_back(row);
+      else
+        m_samples[m_next] = row;
+      m_next = (m_next + 1) % m_capacity;
+    }
+
+    /**
+     * Appends the sampled rows that lie strictly between
+     * <code>start_row</code> and <code>end_row</code> to <code>rows</code>.
+     * Rows are appended once per sample, so a row that is accessed often
+     * appears often.
+     *
+     * @param start_row start row of range
+     * @param end_row end row of range
+     * @param rows vector to append rows to
+     */
+    void get_rows(const char *start_row, const char *end_row,
+                  std::vector<String> &rows) const {
+      for (size_t i=0; i<m_samples.size(); i++) {
+        if (strcmp(m_samples[i].c_str(), start_row) > 0 &&
+            strcmp(m_samples[i].c_str(), end_row) < 0)
+          rows.push_back(m_samples[i]);
+      }
+    }
+
+    size_t size() const { return m_samples.size(); }
+
+    void clear() {
+      m_samples.clear();
+      m_accesses = 0;
+      m_next = 0;
+    }
+
+  private:
+    size_t m_capacity;
+    uint32_t m_interval;
+    uint32_t m_accesses;
+    size_t m_next;
+    std::vector<String> m_samples;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_ROWLOADSAMPLER_H
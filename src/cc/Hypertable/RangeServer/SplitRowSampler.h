@@ -0,0 +1,144 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_SPLITROWSAMPLER_H
+#define HYPERTABLE_SPLITROWSAMPLER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Keeps a fixed size, byte weighted sample of the rows added to a
+   * CellCache or CellStore.  A row is recorded each time another
+   * <i>stride</i> bytes have been added; once the sample is full every
+   * other sample is dropped and the stride doubles.  Each sample therefore
+   * stands for the same number of bytes, and the median of the samples
+   * divides the data, rather than the number of cells or index entries,
+   * in two.  For sorted input the samples are evenly spaced quantiles.
+   * Not thread safe, the owner serializes access.
+   */
+  class SplitRowSampler {
+  public:
+
+    /** Sampled row and the number of bytes it stands for */
+    struct Sample {
+      Sample(const String &row_, uint64_t weight_)
+        : row(row_), weight(weight_) { }
+      bool operator<(const Sample &other) const { return row < other.row; }
+      String row;
+      uint64_t weight;
+    };
+    typedef std::vector<Sample> SampleVector;
+
+    SplitRowSampler(size_t max_samples=64)
+      : m_max_samples(max_samples), m_stride(1), m_accumulated(0),
+        m_total(0) { }
+
+    /**
+     * Accounts for <code>bytes</code> bytes of data in <code>row</code>.
+     *
+     * @param row row key
+     * @param bytes size of the cell, or block, added
+     */
+    void add(const char *row, uint64_t bytes) {
+      m_total += bytes;
+      m_accumulated += bytes;
+      while (m_accumulated >= m_stride) {
+        m_accumulated -= m_stride;
+        if (m_rows.size() == m_max_samples)
+          downsample();
+        m_rows.push_back(row);
+      }
+    }
+
+    /**
+     * Appends the samples, each weighted by the stride, to
+     * <code>samples</code>.
+     *
+     * @param samples vector to append samples to
+     * @param scale factor applied to the sample weights
+     */
+    void get_samples(SampleVector &samples, double scale=1.0) const {
+      uint64_t weight = (uint64_t)((double)m_stride * scale);
+      if (weight == 0)
+        weight = 1;
+      for (size_t i=0; i<m_rows.size(); i++)
+        samples.push_back(Sample(m_rows[i], weight));
+    }
+
+    /**
+     * Returns the weighted median row of the samples, or 0 if there are
+     * none.  The samples are sorted by row and the returned pointer is
+     * valid until they are modified.
+     *
+     * @param samples samples to select the median from
+     * @return weighted median row
+     */
+    static const char *median(SampleVector &samples) {
+      uint64_t total = 0, cumulative = 0;
+      if (samples.empty())
+        return 0;
+      std::sort(samples.begin(), samples.end());
+      for (size_t i=0; i<samples.size(); i++)
+        total += samples[i].weight;
+      for (size_t i=0; i<samples.size(); i++) {
+        cumulative += samples[i].weight;
+        if (2 * cumulative >= total)
+          return samples[i].row.c_str();
+      }
+      return samples.back().row.c_str();
+    }
+
+    size_t size() const { return m_rows.size(); }
+
+    uint64_t total_bytes() const { return m_total; }
+
+    void clear() {
+      m_rows.clear();
+      m_stride = 1;
+      m_accumulated = 0;
+      m_total = 0;
+    }
+
+  private:
+
+    void downsample() {
+      size_t j = 0;
+      for (size_t i=1; i<m_rows.size(); i+=2)
+        m_rows[j++].swap(m_rows[i]);
+      m_rows.resize(j);
+      m_stride *= 2;
+    }
+
+    size_t m_max_samples;
+    uint64_t m_stride;
+    uint64_t m_accumulated;
+    uint64_t m_total;
+    std::vector<String> m_rows;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_SPLITROWSAMPLER_H
@@ -0,0 +1,99 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Serialization.h"
+#include "Common/Time.h"
+
+#include "ResponseCallbackUpdate.h"
+#include "UpdateResponseTimerHandler.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Serialization;
+
+
+void
+UpdateResponseTimerHandler::defer(EventPtr &event,
+                                  std::vector<SendBackRec> &send_back_vector,
+                                  uint32_t delay_ms) {
+  ScopedLock lock(m_mutex);
+  int64_t due = get_ts64() / 1000000LL + delay_ms;
+  PendingMap::iterator iter =
+    m_pending.insert(PendingMap::value_type(due, PendingResponse()));
+  (*iter).second.event = event;
+  (*iter).second.send_back_vector.swap(send_back_vector);
+  int error;
+  if ((error = m_comm->set_timer(delay_ms, this)) != Error::OK)
+    HT_FATALF("Problem setting timer - %s", Error::get_text(error));
+}
+
+
+/**
+ * Timers expire in order of their due time and each one belongs to a
+ * single deferred response, so the earliest pending response is the one
+ * to send.
+ */
+void UpdateResponseTimerHandler::handle(EventPtr &event_ptr) {
+  PendingResponse response;
+
+  {
+    ScopedLock lock(m_mutex);
+    if (m_shutdown || m_pending.empty())
+      return;
+    response.event = (*m_pending.begin()).second.event;
+    response.send_back_vector.swap((*m_pending.begin()).second.send_back_vector);
+    m_pending.erase(m_pending.begin());
+  }
+
+  send_response(m_comm, response.event, response.send_back_vector);
+}
+
+
+void
+UpdateResponseTimerHandler::send_response(Comm *comm, EventPtr &event,
+                                  std::vector<SendBackRec> &send_back_vector) {
+  ResponseCallbackUpdate cb(comm, event);
+  int error;
+
+  if (!send_back_vector.empty()) {
+    StaticBuffer ext(new uint8_t [send_back_vector.size() * 16],
+                     send_back_vector.size() * 16);
+    uint8_t *ptr = ext.base;
+    for (size_t i=0; i<send_back_vector.size(); i++) {
+      encode_i32(&ptr, send_back_vector[i].error);
+      encode_i32(&ptr, send_back_vector[i].count);
+      encode_i32(&ptr, send_back_vector[i].offset);
+      encode_i32(&ptr, send_back_vector[i].len);
+      if (send_back_vector[i].error == Error::RANGESERVER_UPDATE_THROTTLED)
+        continue;
+      HT_INFOF("Sending back error %x, count %d, offset %d, len %d",
+               send_back_vector[i].error, send_back_vector[i].count,
+               send_back_vector[i].offset, send_back_vector[i].len);
+    }
+    if ((error = cb.response(ext)) != Error::OK)
+      HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+  }
+  else {
+    if ((error = cb.response_ok()) != Error::OK)
+      HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+  }
+}
@@ -0,0 +1,79 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_UPDATERESPONSETIMERHANDLER_H
+#define HYPERTABLE_UPDATERESPONSETIMERHANDLER_H
+
+#include <map>
+#include <vector>
+
+#include "Common/Mutex.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/DispatchHandler.h"
+
+#include "GroupCommitInterface.h"
+
+namespace Hypertable {
+
+  /**
+   * Holds back update responses for clients that do not understand
+   * throttle hints.  Each deferred response arms a timer, so no thread
+   * sleeps while the client is paced.
+   */
+  class UpdateResponseTimerHandler : public DispatchHandler {
+  public:
+    UpdateResponseTimerHandler(Comm *comm) : m_comm(comm), m_shutdown(false) { }
+
+    /**
+     * Sends the response to an update request delay_ms milliseconds from
+     * now
+     */
+    void defer(EventPtr &event, std::vector<SendBackRec> &send_back_vector,
+               uint32_t delay_ms);
+
+    virtual void handle(EventPtr &event_ptr);
+
+    void shutdown() { ScopedLock lock(m_mutex); m_shutdown = true; }
+
+    /**
+     * Sends an update response, encoding the send back records if there
+     * are any
+     */
+    static void send_response(Comm *comm, EventPtr &event,
+                              std::vector<SendBackRec> &send_back_vector);
+
+  private:
+    struct PendingResponse {
+      EventPtr event;
+      std::vector<SendBackRec> send_back_vector;
+    };
+    typedef std::multimap<int64_t, PendingResponse> PendingMap;
+
+    Mutex       m_mutex;
+    Comm       *m_comm;
+    PendingMap  m_pending;
+    bool        m_shutdown;
+  };
+
+}
+
+#endif // HYPERTABLE_UPDATERESPONSETIMERHANDLER_H
@@ -0,0 +1,111 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+
+#include "UpdateThrottle.h"
+
+using namespace Hypertable;
+
+UpdateThrottle::UpdateThrottle(int64_t memory_limit,
+                               int32_t threshold_percentage,
+                               int32_t max_delay_ms, int64_t minimum_rate)
+  : m_memory_limit(memory_limit), m_max_delay(max_delay_ms),
+    m_minimum_rate((double)minimum_rate), m_bytes_added(0), m_last_memory(0),
+    m_last_time(0), m_drain_rate(0.0), m_overload(0.0), m_active_clients(0),
+    m_throttled(0), m_total_delay(0) {
+  m_memory_threshold = (memory_limit * threshold_percentage) / 100;
+}
+
+
+void UpdateThrottle::update_estimates(int64_t now_ms, int64_t memory_used,
+                                      int64_t log_size, int64_t log_limit) {
+  ScopedLock lock(m_mutex);
+
+  if (m_last_time && now_ms > m_last_time) {
+    // whatever was added but did not show up as memory growth was drained
+    int64_t drained = m_bytes_added - (memory_used - m_last_memory);
+    double rate = (double)std::max(drained, (int64_t)0) * 1000.0 /
+      (double)(now_ms - m_last_time);
+    if (m_drain_rate == 0.0)
+      m_drain_rate = rate;
+    else
+      m_drain_rate = 0.7 * m_drain_rate + 0.3 * rate;
+  }
+  m_bytes_added = 0;
+  m_last_memory = memory_used;
+  m_last_time = now_ms;
+
+  m_overload = 0.0;
+  if (memory_used > m_memory_threshold && m_memory_limit > m_memory_threshold)
+    m_overload = (double)(memory_used - m_memory_threshold) /
+      (double)(m_memory_limit - m_memory_threshold);
+  if (log_limit > 0 && log_size > log_limit)
+    m_overload = std::max(m_overload,
+                          (double)(log_size - log_limit) / (double)log_limit);
+  m_overload = std::min(m_overload, 1.0);
+
+  // clients idle since the last pass and without backlog are forgotten
+  m_active_clients = 0;
+  for (ClientMap::iterator iter = m_clients.begin(); iter != m_clients.end(); ) {
+    if (iter->second.updates == 0 && iter->second.next_admit <= (double)now_ms)
+      m_clients.erase(iter++);
+    else {
+      if (iter->second.updates)
+        m_active_clients++;
+      iter->second.updates = 0;
+      ++iter;
+    }
+  }
+}
+
+
+uint32_t UpdateThrottle::admit(int64_t now_ms, const InetAddr &client,
+                               int64_t bytes, double range_ratio) {
+  ScopedLock lock(m_mutex);
+  ClientPacing &pacing = m_clients[client];
+  double delay = 0.0;
+
+  pacing.updates++;
+
+  if (m_overload > 0.0) {
+    // per client virtual clock; each admitted update occupies bytes / rate
+    // of it, where rate is the client's share of the admitted rate
+    double rate = std::max(m_drain_rate * (1.0 - m_overload), m_minimum_rate)
+      / (double)std::max(m_active_clients, (size_t)1);
+    double admit_time = std::max(pacing.next_admit, (double)now_ms);
+    pacing.next_admit = std::min(admit_time + ((double)bytes * 1000.0) / rate,
+                                 (double)(now_ms + m_max_delay));
+    delay = admit_time - (double)now_ms;
+  }
+
+  if (range_ratio > 1.0)
+    delay = std::max(delay, (range_ratio - 1.0) * (double)m_max_delay);
+
+  uint32_t delay_ms = (uint32_t)std::min(delay, (double)m_max_delay);
+  if (delay_ms) {
+    m_throttled++;
+    m_total_delay += delay_ms;
+  }
+  return delay_ms;
+}
@@ -0,0 +1,123 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_UPDATETHROTTLE_H
+#define HYPERTABLE_UPDATETHROTTLE_H
+
+#include <map>
+
+#include "Common/InetAddr.h"
+#include "Common/Mutex.h"
+
+namespace Hypertable {
+
+  /**
+   * Admission control for updates.  The rate at which maintenance drains
+   * CellCache memory is estimated from the bytes added by updates and the
+   * change in tracked memory between maintenance passes.  Once memory use
+   * passes the threshold, or the commit log grows past its prune threshold,
+   * updates are paced so that the admitted rate shrinks towards the drain
+   * rate in proportion to the overload.  The admitted rate is shared
+   * evenly by the clients that sent updates during the last maintenance
+   * interval, and each client is paced on a virtual clock of its own, so
+   * a client is only delayed for the bandwidth it used.  Ranges that have
+   * grown beyond the maximum range size get an additional delay
+   * proportional to the excess.
+   * Delays are returned to clients as hints, or served by the RangeServer
+   * for clients that do not understand them.
+   */
+  class UpdateThrottle {
+  public:
+    UpdateThrottle(int64_t memory_limit, int32_t threshold_percentage,
+                   int32_t max_delay_ms, int64_t minimum_rate);
+
+    /** Accounts for bytes added to CellCaches by updates */
+    void record_update(int64_t bytes) {
+      ScopedLock lock(m_mutex);
+      m_bytes_added += bytes;
+    }
+
+    /**
+     * Refreshes the drain rate and overload estimates, called once per
+     * maintenance pass.
+     *
+     * @param now_ms current time in milliseconds
+     * @param memory_used memory tracked for CellCaches and other caches,
+     *        excluding the block cache
+     * @param log_size size of the commit log
+     * @param log_limit commit log size beyond which the log counts as
+     *        overloaded, zero to ignore the log
+     */
+    void update_estimates(int64_t now_ms, int64_t memory_used,
+                          int64_t log_size, int64_t log_limit);
+
+    /**
+     * Returns the number of milliseconds an update of bytes should be
+     * delayed.
+     *
+     * @param now_ms current time in milliseconds
+     * @param client address of the connection the update came from
+     * @param bytes size of the update
+     * @param range_ratio size of the largest updated range divided by the
+     *        maximum range size
+     */
+    uint32_t admit(int64_t now_ms, const InetAddr &client, int64_t bytes,
+                   double range_ratio);
+
+    /** Estimated drain rate in bytes per second */
+    double drain_rate() { ScopedLock lock(m_mutex); return m_drain_rate; }
+
+    /** Overload between 0 (none) and 1 (memory at its limit) */
+    double overload() { ScopedLock lock(m_mutex); return m_overload; }
+
+    void get_counts(uint64_t *throttled, uint64_t *delay_ms) {
+      ScopedLock lock(m_mutex);
+      *throttled = m_throttled;
+      *delay_ms = m_total_delay;
+    }
+
+  private:
+    struct ClientPacing {
+      ClientPacing() : next_admit(0.0), updates(0) { }
+      double next_admit;
+      uint64_t updates;
+    };
+    typedef std::map<InetAddr, ClientPacing> ClientMap;
+
+    Mutex m_mutex;
+    int64_t m_memory_limit;
+    int64_t m_memory_threshold;
+    int32_t m_max_delay;
+    double m_minimum_rate;
+    int64_t m_bytes_added;
+    int64_t m_last_memory;
+    int64_t m_last_time;
+    double m_drain_rate;
+    double m_overload;
+    ClientMap m_clients;
+    size_t m_active_clients;
+    uint64_t m_throttled;
+    uint64_t m_total_delay;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_UPDATETHROTTLE_H
@@ -0,0 +1,552 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+}
+
+#include <boost/algorithm/string.hpp>
+
+#include "AsyncComm/Comm.h"
+
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/PageArena.h"
+#include "Common/Serialization.h"
+#include "Common/Time.h"
+#include "Common/Timer.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/KeySpec.h"
+#include "Hypertable/Lib/LoadDataSourceFactory.h"
+#include "Hypertable/Lib/RangeServerClient.h"
+
+#include "Config.h"
+#include "CellStoreFactory.h"
+#include "CellStoreV5.h"
+#include "Global.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  struct MyPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc("Usage: %s [options] <table> <input-file>\n\n"
+        "  Builds CellStore files for <table> directly from <input-file>\n"
+        "  (LOAD DATA INFILE format, '-' for stdin), bypassing the commit\n"
+        "  log.  Cells are sorted in memory, partitioned on the table's\n"
+        "  current range boundaries and written under the table's directory\n"
+        "  in the DFS.  The files are then adopted by the RangeServers that\n"
+        "  hold the ranges.\n\nOptions").add_options()
+        ("namespace", str()->default_value("/"), "Namespace of <table>")
+        ("buffer-size", i64()->default_value(256*M),
+         "Amount of input to sort in memory before writing CellStores")
+        ("header-file", str(), "File containing the input header line")
+        ("build-only", "Write the CellStores but do not adopt them; the "
+         "files are listed on stdout")
+        ("adopt-retries", i32()->default_value(10),
+         "Number of times to retry adopting into a busy or moved range")
+        ;
+      cmdline_hidden_desc().add_options()
+        ("table", str(), "name of the table to load")
+        ("input-file", str(), "input file")
+        ;
+      cmdline_positional_desc().add("table", 1).add("input-file", 1);
+    }
+  };
+
+  typedef Cons<MyPolicy, DefaultClientPolicy> AppPolicy;
+
+  struct Split {
+    String start_row;
+    String end_row;
+    String location;
+  };
+
+  struct RangeFiles {
+    Split split;
+    std::vector<String> access_groups;
+    std::vector<String> files;
+  };
+
+  typedef std::pair<SerializedKey, ByteString> KeyValueT;
+
+  struct LtKeyValue {
+    bool operator()(const KeyValueT &kv1, const KeyValueT &kv2) const {
+      return kv1.first < kv2.first;
+    }
+  };
+
+  void load_splits(NamespacePtr &ns, const String &table_name,
+                   std::vector<Split> &splits) {
+    TableSplitsContainer container;
+    ns->get_table_splits(table_name, container);
+    splits.clear();
+    foreach(const TableSplit &ts, container) {
+      Split split;
+      split.start_row = ts.start_row ? ts.start_row : "";
+      split.end_row = ts.end_row ? ts.end_row : Key::END_ROW_MARKER;
+      split.location = ts.location ? ts.location : "";
+      splits.push_back(split);
+    }
+  }
+
+  /**
+   * A sorted run of cells for one (range, access group), written to a
+   * temporary CellStore when the input buffer fills up
+   */
+  struct SpillRun {
+    String fname;
+    int64_t cell_count;
+  };
+
+  /**
+   * Builds one CellStore per (range, access group).  Input is sorted in
+   * memory and spilled to sorted runs whenever the buffer fills up; finish()
+   * then merges the runs of each (range, access group) into the final
+   * CellStore.  Cells with identical keys come from duplicate input lines;
+   * the last one wins, both within a spill and across spills.
+   */
+  class BulkBuilder {
+  public:
+    BulkBuilder(Filesystem *fs, SchemaPtr &schema, TableIdentifierManaged &tid,
+                std::vector<Split> &splits, int64_t revision)
+      : m_fs(fs), m_schema(schema), m_tid(tid), m_splits(splits),
+        m_revision(revision), m_cell_count(0), m_file_count(0),
+        m_run_count(0) {
+      foreach(Schema::AccessGroup *ag, m_schema->get_access_groups()) {
+        PropertiesPtr props = new Properties();
+        props->set("compressor", ag->compressor.size() ?
+                   ag->compressor : m_schema->get_compressor());
+        props->set("blocksize", ag->blocksize);
+        if (ag->replication != -1)
+          props->set("replication", (int32_t)ag->replication);
+        if (ag->bloom_filter.size())
+          Schema::parse_bloom_filter(ag->bloom_filter, props);
+        else
+          Schema::parse_bloom_filter(get_str("Hypertable.RangeServer"
+              ".CellStore.DefaultBloomFilter"), props);
+        m_ag_names.push_back(ag->name);
+        m_ag_props.push_back(props);
+        m_cells.push_back(std::vector<KeyValueT>());
+      }
+      memset(m_cf_to_ag, 0xff, sizeof(m_cf_to_ag));
+      for (size_t i=0; i<m_schema->get_access_groups().size(); i++) {
+        foreach(Schema::ColumnFamily *cf,
+                m_schema->get_access_groups()[i]->columns)
+          m_cf_to_ag[cf->id] = i;
+      }
+      m_range_files.resize(m_splits.size());
+      for (size_t i=0; i<m_splits.size(); i++)
+        m_range_files[i].split = m_splits[i];
+      m_runs.resize(m_splits.size());
+      for (size_t i=0; i<m_splits.size(); i++)
+        m_runs[i].resize(m_ag_names.size());
+    }
+
+    void add(const Schema::ColumnFamily *cf, const String &row,
+             const String &qualifier, int64_t timestamp,
+             const uint8_t *value, uint32_t value_len) {
+      size_t ag_index = m_cf_to_ag[cf->id];
+      HT_ASSERT(ag_index < m_cells.size());
+
+      m_key_buf.clear();
+      create_key_and_append(m_key_buf, FLAG_INSERT, row.c_str(), cf->id,
+                            qualifier.c_str(), timestamp, m_revision);
+      uint8_t *key = m_arena.alloc(m_key_buf.fill());
+      memcpy(key, m_key_buf.base, m_key_buf.fill());
+
+      uint8_t *ptr, *base;
+      ptr = base = m_arena.alloc(Serialization::encoded_length_vi32(value_len)
+                                 + value_len);
+      Serialization::encode_vi32(&ptr, value_len);
+      memcpy(ptr, value, value_len);
+
+      m_cells[ag_index].push_back(KeyValueT(SerializedKey(key),
+                                            ByteString(base)));
+      m_cell_count++;
+    }
+
+    int64_t memory_used() { return m_arena.used(); }
+
+    /**
+     * Sorts the buffered cells and writes them out as one run per
+     * (range, access group)
+     */
+    void spill() {
+      for (size_t ag_index=0; ag_index<m_cells.size(); ag_index++) {
+        std::vector<KeyValueT> &cells = m_cells[ag_index];
+        if (cells.empty())
+          continue;
+
+        std::stable_sort(cells.begin(), cells.end(), LtKeyValue());
+
+        size_t i = 0;
+        size_t range = 0;
+        while (i < cells.size()) {
+          const char *row = cells[i].first.row();
+          while (strcmp(row, m_splits[range].end_row.c_str()) > 0)
+            range++;
+
+          // Find the end of this range's run
+          size_t end = i;
+          while (end < cells.size() &&
+                 strcmp(cells[end].first.row(), m_splits[range].end_row.c_str()) <= 0)
+            end++;
+
+          SpillRun run;
+          run.fname = format("%s/run%u", get_dir(ag_index).c_str(),
+                             (unsigned)m_run_count++);
+          run.cell_count = 0;
+
+          CellStorePtr cellstore = new CellStoreV5(m_fs, m_schema.get());
+          cellstore->create(run.fname.c_str(), end - i, m_ag_props[ag_index]);
+          Key key;
+          for (; i<end; i++) {
+            // skip duplicates, keeping the last one added
+            if (i+1 < end && cells[i].first == cells[i+1].first)
+              continue;
+            key.load(cells[i].first);
+            cellstore->add(key, cells[i].second);
+            run.cell_count++;
+          }
+          cellstore->finalize(&m_tid);
+
+          m_runs[range][ag_index].push_back(run);
+        }
+        cells.clear();
+      }
+      m_arena.free();
+    }
+
+    /**
+     * Spills what is left in memory and produces the final CellStore of
+     * each (range, access group).  A single run becomes the CellStore as
+     * is; multiple runs are merged, keeping the cell from the latest run
+     * when the same key appears in more than one.
+     */
+    void finish() {
+      spill();
+      for (size_t range=0; range<m_runs.size(); range++) {
+        for (size_t ag_index=0; ag_index<m_ag_names.size(); ag_index++) {
+          std::vector<SpillRun> &runs = m_runs[range][ag_index];
+          if (runs.empty())
+            continue;
+          String fname = format("%s/cs%u", get_dir(ag_index).c_str(),
+                                (unsigned)m_file_count++);
+          if (runs.size() == 1)
+            m_fs->rename(runs[0].fname, fname);
+          else {
+            merge_runs(range, ag_index, runs, fname);
+            foreach(const SpillRun &run, runs)
+              m_fs->remove(run.fname);
+          }
+          runs.clear();
+          m_range_files[range].access_groups.push_back(m_ag_names[ag_index]);
+          m_range_files[range].files.push_back(fname);
+        }
+      }
+    }
+
+    std::vector<RangeFiles> &get_range_files() { return m_range_files; }
+    int64_t get_cell_count() { return m_cell_count; }
+    uint32_t get_file_count() { return m_file_count; }
+
+  private:
+
+    String get_dir(size_t ag_index) {
+      String dir = Global::toplevel_dir + "/tables/" + m_tid.id + "/" +
+        m_ag_names[ag_index] + format("/bulk-%lld", (Lld)m_revision);
+      if (!m_dirs_created.count(dir)) {
+        m_fs->mkdirs(dir);
+        m_dirs_created.insert(dir);
+      }
+      return dir;
+    }
+
+    void merge_runs(size_t range, size_t ag_index,
+                    std::vector<SpillRun> &runs, const String &fname) {
+      const char *start_row = m_splits[range].start_row.c_str();
+      const char *end_row = m_splits[range].end_row.c_str();
+      ScanContextPtr scan_ctx = new ScanContext(m_schema);
+      std::vector<CellStorePtr> stores;
+      std::vector<CellListScannerPtr> scanners;
+      std::vector<Key> keys(runs.size());
+      std::vector<ByteString> values(runs.size());
+      std::vector<bool> valid(runs.size());
+      int64_t estimate = 0;
+
+      for (size_t i=0; i<runs.size(); i++) {
+        stores.push_back(CellStoreFactory::open(runs[i].fname, start_row,
+                                                end_row));
+        scanners.push_back(stores.back()->create_scanner(scan_ctx));
+        valid[i] = scanners[i]->get(keys[i], values[i]);
+        estimate += runs[i].cell_count;
+      }
+
+      CellStorePtr cellstore = new CellStoreV5(m_fs, m_schema.get());
+      cellstore->create(fname.c_str(), estimate, m_ag_props[ag_index]);
+
+      while (true) {
+        // Find the smallest key; on ties the latest run wins
+        int winner = -1;
+        for (size_t i=0; i<runs.size(); i++) {
+          if (!valid[i])
+            continue;
+          if (winner == -1 || !(keys[winner].serial < keys[i].serial))
+            winner = i;
+        }
+        if (winner == -1)
+          break;
+
+        cellstore->add(keys[winner], values[winner]);
+
+        // Advance every run positioned on this key, the winner last since
+        // the others are compared against its key
+        for (size_t i=0; i<runs.size(); i++) {
+          if (valid[i] && (int)i != winner &&
+              keys[i].serial == keys[winner].serial) {
+            scanners[i]->forward();
+            valid[i] = scanners[i]->get(keys[i], values[i]);
+          }
+        }
+        scanners[winner]->forward();
+        valid[winner] = scanners[winner]->get(keys[winner], values[winner]);
+      }
+
+      cellstore->finalize(&m_tid);
+    }
+
+    Filesystem *m_fs;
+    SchemaPtr m_schema;
+    TableIdentifierManaged m_tid;
+    std::vector<Split> m_splits;
+    int64_t m_revision;
+    ByteArena m_arena;
+    DynamicBuffer m_key_buf;
+    uint8_t m_cf_to_ag[256];
+    std::vector<String> m_ag_names;
+    std::vector<PropertiesPtr> m_ag_props;
+    std::vector< std::vector<KeyValueT> > m_cells;
+    std::vector< std::vector< std::vector<SpillRun> > > m_runs;
+    std::vector<RangeFiles> m_range_files;
+    std::set<String> m_dirs_created;
+    int64_t m_cell_count;
+    uint32_t m_file_count;
+    uint32_t m_run_count;
+  };
+
+  /**
+   * Adopts the files built for one range.  If the range has split or moved
+   * since the build started, the files are adopted by every range that
+   * now overlaps the original one; each range only sees its own rows.
+   */
+  void adopt(NamespacePtr &ns, const String &table_name,
+             RangeServerClient &rs_client, TableIdentifierManaged &tid,
+             RangeFiles &rf, int retries, uint32_t timeout_ms) {
+    std::vector<Split> targets;
+    targets.push_back(rf.split);
+
+    for (int attempt=0; true; attempt++) {
+      try {
+        foreach(const Split &split, targets) {
+          CommAddress addr;
+          addr.set_proxy(split.location);
+          RangeSpec range(split.start_row.c_str(), split.end_row.c_str());
+          Timer timer(timeout_ms, true);
+          rs_client.adopt_cellstores(addr, tid, range, rf.access_groups,
+                                     rf.files, timer);
+          HT_INFOF("Adopted %u files into %s[%s..%s] on %s",
+                   (unsigned)rf.files.size(), tid.id, split.start_row.c_str(),
+                   split.end_row.c_str(), split.location.c_str());
+        }
+        return;
+      }
+      catch (Exception &e) {
+        if (attempt >= retries ||
+            (e.code() != Error::RANGESERVER_RANGE_NOT_FOUND &&
+             e.code() != Error::RANGESERVER_RANGE_BUSY &&
+             e.code() != Error::TABLE_NOT_FOUND &&
+             e.code() != Error::COMM_NOT_CONNECTED &&
+             e.code() != Error::REQUEST_TIMEOUT))
+          throw;
+        HT_WARN_OUT << e << " - retrying" << HT_END;
+      }
+
+      poll(0, 0, 3000);
+
+      // Re-read range boundaries; adoption is idempotent per range
+      std::vector<Split> splits;
+      ns->refresh_table(table_name);
+      load_splits(ns, table_name, splits);
+      targets.clear();
+      foreach(const Split &split, splits) {
+        if (strcmp(split.end_row.c_str(), rf.split.start_row.c_str()) > 0 &&
+            strcmp(split.start_row.c_str(), rf.split.end_row.c_str()) < 0)
+          targets.push_back(split);
+      }
+    }
+  }
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policy<AppPolicy>(argc, argv);
+
+    String table_name = get("table", String());
+    String input_file = get("input-file", String());
+    String header_file = get("header-file", String());
+    int64_t buffer_size = get_i64("buffer-size");
+    bool build_only = has("build-only");
+    int retries = get_i32("adopt-retries");
+    int timeout = get_i32("DfsBroker.Timeout");
+
+    if (table_name.empty() || input_file.empty()) {
+      HT_ERROR_OUT << "table and input file are required" << HT_END;
+      cout << cmdline_desc() << endl;
+      return 1;
+    }
+
+    // Create Hypertable client object
+    ClientPtr hypertable_client = new Hypertable::Client(argv[0]);
+    NamespacePtr ns = hypertable_client->open_namespace(get_str("namespace"));
+    ConnectionManagerPtr conn_mgr = new ConnectionManager();
+    DfsBroker::ClientPtr dfs = new DfsBroker::Client(conn_mgr, properties);
+
+    Global::dfs = dfs;
+
+    if (!dfs->wait_for_connection(timeout)) {
+      cerr << "error: timed out waiting for DFS broker" << endl;
+      exit(1);
+    }
+
+    Global::toplevel_dir = properties->get_str("Hypertable.Directory");
+    boost::trim_if(Global::toplevel_dir, boost::is_any_of("/"));
+    Global::toplevel_dir = String("/") + Global::toplevel_dir;
+
+    Global::block_cache = new FileBlockCache(200000000LL, 200000000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    TablePtr table = ns->open_table(table_name);
+    TableIdentifierManaged tid;
+    SchemaPtr schema;
+    table->get(tid, schema);
+
+    std::vector<Split> splits;
+    load_splits(ns, table_name, splits);
+
+    /**
+     * Every cell gets the same revision.  It is taken before any file is
+     * written so that RangeServers can verify it predates their cell caches
+     */
+    int64_t revision = get_ts64();
+
+    BulkBuilder builder(dfs.get(), schema, tid, splits, revision);
+
+    int src = (input_file == "-") ? STDIN : LOCAL_FILE;
+    int header_src = header_file.empty() ? src : LOCAL_FILE;
+    std::vector<String> key_columns;
+    LoadDataSourcePtr lds = LoadDataSourceFactory::create(dfs, input_file, src,
+        header_file, header_src, key_columns, "");
+
+    KeySpec key;
+    uint8_t *value;
+    uint32_t value_len;
+    uint32_t consumed;
+    bool is_delete;
+    int64_t skipped_deletes = 0, skipped_counters = 0, skipped_unknown = 0;
+    Schema::ColumnFamily *cf;
+
+    while (lds->next(&key, &value, &value_len, &is_delete, &consumed)) {
+      if (is_delete) {
+        skipped_deletes++;
+        continue;
+      }
+      if ((cf = schema->get_column_family(key.column_family)) == 0) {
+        skipped_unknown++;
+        continue;
+      }
+      if (cf->counter) {
+        skipped_counters++;
+        continue;
+      }
+      int64_t timestamp = (key.timestamp == AUTO_ASSIGN) ? revision : key.timestamp;
+      builder.add(cf, String((const char *)key.row, key.row_len),
+                  String(key.column_qualifier ? key.column_qualifier : "",
+                         key.column_qualifier_len),
+                  timestamp, value, value_len);
+      if (builder.memory_used() >= buffer_size)
+        builder.spill();
+    }
+    builder.finish();
+
+    if (skipped_deletes)
+      HT_WARNF("Skipped %lld deletes", (Lld)skipped_deletes);
+    if (skipped_counters)
+      HT_WARNF("Skipped %lld counter cells (not supported by bulk load)",
+               (Lld)skipped_counters);
+    if (skipped_unknown)
+      HT_WARNF("Skipped %lld cells of unknown column families",
+               (Lld)skipped_unknown);
+
+    std::vector<RangeFiles> &range_files = builder.get_range_files();
+
+    if (build_only) {
+      foreach(const RangeFiles &rf, range_files) {
+        for (size_t i=0; i<rf.files.size(); i++)
+          cout << rf.split.start_row << "\t" << rf.split.end_row << "\t"
+               << rf.access_groups[i] << "\t" << rf.files[i] << "\n";
+      }
+      cout << flush;
+    }
+    else {
+      RangeServerClient rs_client(Comm::instance());
+      uint32_t timeout_ms = get_i32("Hypertable.Request.Timeout");
+      foreach(RangeFiles &rf, range_files) {
+        if (!rf.files.empty())
+          adopt(ns, table_name, rs_client, tid, rf, retries, timeout_ms);
+      }
+    }
+
+    cout << "Loaded " << builder.get_cell_count() << " cells into "
+         << builder.get_file_count() << " CellStores" << endl;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
@@ -223,6 +223,13 @@ int main(int argc, char **argv) {
     cout << "BLOCK INDEX:" << endl;
     cellstore->display_block_info();
 
+    /**
+     * Dump codec mix
+     */
+    cout << endl;
+    cout << "BLOCK CODECS:" << endl;
+    cellstore->display_block_codec_info();
+
     /**
      * Dump bloom filter size
      */
@@ -195,6 +195,18 @@ int main(int argc, char **argv) {
     tracker.clear(1);
     HT_ASSERT(!tracker.check_needed(0, 361));
 
+    tracker.set_blob_stats(1000000LL, 900000LL);
+    HT_ASSERT(!tracker.blob_collection_needed());
+    HT_ASSERT(!tracker.check_needed(0, 361));
+
+    tracker.set_blob_stats(1000000LL, 100000LL);
+    HT_ASSERT(tracker.blob_collection_needed());
+    HT_ASSERT(tracker.check_needed(0, 2));
+    HT_ASSERT(tracker.need_collection());
+
+    tracker.set_blob_stats(0, 0);
+    HT_ASSERT(!tracker.blob_collection_needed());
+
   }
 
   return 0;
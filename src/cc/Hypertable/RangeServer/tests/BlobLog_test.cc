@@ -0,0 +1,219 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+#include "Common/Usage.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../BlobLog.h"
+#include "../Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: BlobLog_test",
+    "",
+    "  This program writes values of various sizes through a BlobLogWriter",
+    "  and checks that values at or above the threshold come back as blob",
+    "  references that resolve to the original bytes.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const uint32_t THRESHOLD = 1024;
+
+  void make_value(DynamicBuffer &buf, size_t len, int seed) {
+    buf.clear();
+    buf.ensure(len + 5);
+    Serialization::encode_vi32(&buf.ptr, len);
+    for (size_t i=0; i<len; i++)
+      *buf.ptr++ = (uint8_t)('a' + ((i + seed) % 26));
+  }
+
+  bool same_value(const ByteString a, const ByteString b) {
+    const uint8_t *pa = a.ptr, *pb = b.ptr;
+    size_t la = a.decode_length(&pa);
+    size_t lb = b.decode_length(&pb);
+    return la == lb && memcmp(pa, pb, la) == 0;
+  }
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::toplevel_dir = "/BlobLog_test";
+    client->mkdirs(Global::toplevel_dir);
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      return 1;
+    }
+
+    String fname = Global::toplevel_dir + "/bl0";
+    std::set<String> rewrite_files;
+    BlobLogWriterPtr writer = new BlobLogWriter(Global::dfs.get(), schema,
+                                                fname, THRESHOLD, -1,
+                                                rewrite_files);
+    Key key;
+    key.flag = FLAG_INSERT;
+    key.column_family_code = 1;
+
+    size_t sizes[] = { 10, THRESHOLD - 1, THRESHOLD, 5000, 200000, 17 };
+    size_t nsizes = sizeof(sizes) / sizeof(size_t);
+    vector<DynamicBuffer *> originals;
+    vector<DynamicBuffer *> stored;
+    ByteString value, result;
+
+    for (size_t i=0; i<nsizes; i++) {
+      DynamicBuffer *orig = new DynamicBuffer();
+      make_value(*orig, sizes[i], (int)i);
+      value.ptr = orig->base;
+      result = writer->add(key, value);
+      // the writer reuses its reference buffer, so copy the result out
+      DynamicBuffer *copy = new DynamicBuffer(result.length());
+      copy->add_unchecked(result.ptr, result.length());
+      originals.push_back(orig);
+      stored.push_back(copy);
+    }
+
+    // deletes are never separated
+    {
+      DynamicBuffer big;
+      make_value(big, 4 * THRESHOLD, 99);
+      Key delete_key;
+      delete_key.flag = FLAG_DELETE_CELL;
+      delete_key.column_family_code = 1;
+      value.ptr = big.base;
+      if (writer->add(delete_key, value).ptr != big.base) {
+        HT_ERROR("Delete value was separated into the blob log");
+        return 1;
+      }
+    }
+
+    writer->close();
+
+    if (!writer->created()) {
+      HT_ERROR("Blob log was not created");
+      return 1;
+    }
+
+    if (client->length(fname) != writer->length()) {
+      HT_ERRORF("Blob log length mismatch (%lld != %lld)",
+                (Lld)client->length(fname), (Lld)writer->length());
+      return 1;
+    }
+
+    DynamicBuffer resolved;
+    for (size_t i=0; i<nsizes; i++) {
+      ByteString orig, ref;
+      orig.ptr = originals[i]->base;
+      ref.ptr = stored[i]->base;
+      bool expect_reference = sizes[i] >= THRESHOLD;
+      if (BlobLog::is_reference(ref) != expect_reference) {
+        HT_ERRORF("Value of size %lu %s a reference", (Lu)sizes[i],
+                  expect_reference ? "is not" : "is unexpectedly");
+        return 1;
+      }
+      result = BlobLog::resolve(ref, resolved);
+      if (!same_value(orig, result)) {
+        HT_ERRORF("Value of size %lu did not survive the round trip",
+                  (Lu)sizes[i]);
+        return 1;
+      }
+    }
+
+    // a damaged reference must not decode
+    {
+      DynamicBuffer damaged(stored[3]->fill());
+      damaged.add_unchecked(stored[3]->base, stored[3]->fill());
+      damaged.base[damaged.fill() - 6] ^= 0xff;
+      ByteString bs;
+      bs.ptr = damaged.base;
+      if (BlobLog::is_reference(bs)) {
+        HT_ERROR("Damaged blob reference decoded successfully");
+        return 1;
+      }
+    }
+
+    BlobLog::close_file(fname);
+    client->rmdir(Global::toplevel_dir);
+
+    for (size_t i=0; i<nsizes; i++) {
+      delete originals[i];
+      delete stored[i];
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,268 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/PageArena.h"
+#include "Common/Serialization.h"
+#include "Common/Usage.h"
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../AccessGroup.h"
+#include "../FileBlockCache.h"
+#include "../Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: CellCacheCompaction_test",
+    "",
+    "  This program overwrites cells in the CellCache of access groups with",
+    "  different version limits.  It checks that the garbage estimate only",
+    "  counts overwrites when a single version is kept and that an",
+    "  in-memory compaction drops the superseded versions but keeps the",
+    "  newest version of every cell and any deletes.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"single\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>a</Name>\n"
+  "      <MaxVersions>1</MaxVersions>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "  <AccessGroup name=\"multi\">\n"
+  "    <ColumnFamily id=\"2\">\n"
+  "      <Name>b</Name>\n"
+  "      <MaxVersions>3</MaxVersions>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const int NUM_ROWS = 100;
+  const int NUM_VERSIONS = 4;
+  const int NUM_DELETES = 5;
+
+  String row_key(int i) {
+    return format("row%04d", i);
+  }
+
+  String value_of(int row, int version) {
+    return format("value-%d-%d", row, version);
+  }
+
+  /**
+   * Writes NUM_VERSIONS versions of one cell per row, oldest first, and
+   * deletes the first NUM_DELETES rows
+   */
+  void load(AccessGroup *ag, uint8_t family, int64_t *revisionp) {
+    DynamicBuffer key_buf;
+    DynamicBuffer value_buf;
+    Key key;
+    ByteString value;
+
+    for (int v=0; v<NUM_VERSIONS; v++) {
+      for (int i=0; i<NUM_ROWS; i++) {
+        String row = row_key(i);
+        String data = value_of(i, v);
+        ++*revisionp;
+        key_buf.clear();
+        create_key_and_append(key_buf, FLAG_INSERT, row.c_str(), family, "",
+                              *revisionp, *revisionp);
+        key.load(SerializedKey(key_buf.base));
+        value_buf.clear();
+        value_buf.ensure(data.length() + 5);
+        Serialization::encode_vi32(&value_buf.ptr, data.length());
+        value_buf.add_unchecked(data.c_str(), data.length());
+        value.ptr = value_buf.base;
+        ag->add(key, value);
+      }
+    }
+
+    value_buf.clear();
+    value_buf.ensure(5);
+    Serialization::encode_vi32(&value_buf.ptr, 0);
+    value.ptr = value_buf.base;
+    for (int i=0; i<NUM_DELETES; i++) {
+      String row = row_key(i);
+      ++*revisionp;
+      key_buf.clear();
+      create_key_and_append(key_buf, FLAG_DELETE_ROW, row.c_str(), 0, "",
+                            *revisionp, *revisionp);
+      key.load(SerializedKey(key_buf.base));
+      ag->add(key, value);
+    }
+  }
+
+  bool compaction_needed(AccessGroup *ag) {
+    ByteArena arena;
+    AccessGroup::MaintenanceData *mdata =
+      ag->get_maintenance_data(arena, time(0));
+    return mdata->cellcache_compaction_needed;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(1000000LL, 1000000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    Global::toplevel_dir = "/CellCacheCompaction_test";
+    client->mkdirs(Global::toplevel_dir);
+
+    // small pages, so that the freed memory shows in memory_allocated()
+    Config::properties->set("Hypertable.RangeServer.AccessGroup.CellCache"
+                            ".PageSize", (int32_t)4096);
+
+    // compact once a quarter of the cached cells is garbage
+    Global::cell_cache_compaction_threshold = 25;
+    Global::cell_cache_compaction_min_memory = 0;
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      return 1;
+    }
+
+    TableIdentifier table_id("1");
+    RangeSpec range("", Key::END_ROW_MARKER);
+    int64_t revision = 0;
+
+    AccessGroupPtr single = new AccessGroup(&table_id, schema,
+        schema->get_access_group("single"), &range);
+    AccessGroupPtr multi = new AccessGroup(&table_id, schema,
+        schema->get_access_group("multi"), &range);
+
+    load(single.get(), 1, &revision);
+    load(multi.get(), 2, &revision);
+
+    /**
+     * With a single version every overwrite is garbage.  With three
+     * versions kept, overwrites are not counted, and the few deletes stay
+     * below the threshold.
+     */
+    if (!compaction_needed(single.get())) {
+      HT_ERROR("Overwritten single version CellCache not flagged for "
+               "compaction");
+      return 1;
+    }
+    if (compaction_needed(multi.get())) {
+      HT_ERROR("Versions within MaxVersions counted as garbage");
+      return 1;
+    }
+
+    if (single->compact_cell_cache() == 0) {
+      HT_ERROR("CellCache compaction freed no memory");
+      return 1;
+    }
+
+    // The deletes kept by the compaction are not garbage again
+    if (compaction_needed(single.get())) {
+      HT_ERROR("Compacted CellCache still flagged for compaction");
+      return 1;
+    }
+
+    /**
+     * Only the newest version of every cell survives, and the deletes are
+     * kept since they may still mask cells in CellStores
+     */
+    {
+      ScanContextPtr scan_ctx = new ScanContext(schema);
+      CellListScannerPtr scanner = single->create_scanner(scan_ctx);
+      Key key;
+      ByteString value;
+      int cells = 0, deletes = 0;
+      while (scanner->get(key, value)) {
+        if (key.flag == FLAG_DELETE_ROW)
+          deletes++;
+        else {
+          int row = atoi(key.row + 3);
+          String expected = value_of(row, NUM_VERSIONS - 1);
+          const uint8_t *ptr;
+          size_t len = value.decode_length(&ptr);
+          if (len != expected.length() ||
+              memcmp(ptr, expected.c_str(), len)) {
+            HT_ERRORF("Cell %s is not the newest version", key.row);
+            return 1;
+          }
+          cells++;
+        }
+        scanner->forward();
+      }
+      if (cells != NUM_ROWS - NUM_DELETES) {
+        HT_ERRORF("Expected %d cells after compaction, got %d",
+                  NUM_ROWS - NUM_DELETES, cells);
+        return 1;
+      }
+      if (deletes != NUM_DELETES) {
+        HT_ERRORF("Expected %d deletes after compaction, got %d",
+                  NUM_DELETES, deletes);
+        return 1;
+      }
+    }
+
+    client->rmdir(Global::toplevel_dir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
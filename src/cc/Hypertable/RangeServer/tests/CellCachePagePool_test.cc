@@ -0,0 +1,117 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <cstring>
+#include <vector>
+
+#include "Hypertable/RangeServer/CellCachePagePool.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  size_t page_size = 512 * 1024;
+  CellCachePagePool pool(page_size, CellCachePagePool::TRANSPARENT, false);
+  vector<void *> pages;
+
+  if (pool.page_size() != page_size) {
+    HT_ERROR("wrong page size");
+    return 1;
+  }
+
+  // four pages fill the first 2MB chunk, the fifth maps a second one
+  for (int i=0; i<5; i++) {
+    void *page = pool.allocate();
+    if (page == 0) {
+      HT_ERROR("allocation failed");
+      return 1;
+    }
+    memset(page, i, page_size);
+    pages.push_back(page);
+  }
+  if (pool.memory_mapped() != 2 * (int64_t)CellCachePagePool::HUGE_PAGE_SIZE) {
+    HT_ERROR("expected two chunks");
+    return 1;
+  }
+  if (((uintptr_t)pages[0] & (CellCachePagePool::HUGE_PAGE_SIZE - 1)) !=
+      ((uintptr_t)pages[0] & (page_size - 1))) {
+    HT_ERROR("chunk not aligned");
+    return 1;
+  }
+  for (int i=0; i<5; i++) {
+    for (int j=i+1; j<5; j++)
+      if (pages[i] == pages[j]) {
+        HT_ERROR("page handed out twice");
+        return 1;
+      }
+  }
+
+  // pages that did not come from the pool are rejected
+  void *foreign = malloc(page_size);
+  if (pool.deallocate(foreign)) {
+    HT_ERROR("foreign page accepted");
+    return 1;
+  }
+  free(foreign);
+
+  // a freed slot is reused before another chunk is mapped
+  pool.deallocate(pages[1]);
+  pages[1] = pool.allocate();
+  if (pool.memory_mapped() != 2 * (int64_t)CellCachePagePool::HUGE_PAGE_SIZE) {
+    HT_ERROR("freed page not reused");
+    return 1;
+  }
+
+  // chunks are unmapped once all of their pages are returned
+  for (int i=0; i<5; i++) {
+    if (!pool.deallocate(pages[i])) {
+      HT_ERROR("pool page rejected");
+      return 1;
+    }
+  }
+  if (pool.memory_mapped() != 0) {
+    HT_ERROR("chunks not unmapped");
+    return 1;
+  }
+
+  // pages larger than a huge page get chunks of their own
+  CellCachePagePool big_pool(3 * 1024 * 1024, CellCachePagePool::TRANSPARENT,
+                             true);
+  void *big_page = big_pool.allocate();
+  memset(big_page, 0, 3 * 1024 * 1024);
+  if (big_pool.memory_mapped() != 4 * 1024 * 1024) {
+    HT_ERROR("expected a 4MB chunk");
+    return 1;
+  }
+  big_pool.deallocate(big_page);
+
+  return 0;
+}
@@ -0,0 +1,221 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+#include "Common/Usage.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../CellStoreFactory.h"
+#include "../CellStoreV5.h"
+#include "../FileBlockCache.h"
+#include "../Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: CellStoreCodecs_test",
+    "",
+    "  This program writes a CellStore whose data blocks alternate between",
+    "  compressible and incompressible values, so that some blocks are",
+    "  stored uncompressed and others with the access group codec.  It",
+    "  verifies that both kinds of blocks are present and that every cell",
+    "  reads back unchanged.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const size_t NUM_CELLS = 4000;
+  const size_t VALUE_SIZE = 200;
+  // number of consecutive cells that share the same kind of value
+  const size_t RUN_LENGTH = 500;
+
+  void make_value(DynamicBuffer &buf, size_t i) {
+    buf.clear();
+    buf.ensure(VALUE_SIZE + 5);
+    Serialization::encode_vi32(&buf.ptr, VALUE_SIZE);
+    if ((i / RUN_LENGTH) % 2 == 0) {
+      for (size_t j=0; j<VALUE_SIZE; j++)
+        *buf.ptr++ = (uint8_t)('a' + (j % 4));
+    }
+    else {
+      for (size_t j=0; j<VALUE_SIZE; j++)
+        *buf.ptr++ = (uint8_t)random();
+    }
+  }
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+    CellStorePtr cs;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(1000000LL, 1000000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    String testdir = "/CellStoreCodecs_test";
+    client->mkdirs(testdir);
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      return 1;
+    }
+
+    Config::properties->set("Hypertable.RangeServer.CellStore"
+                            ".AdaptiveCompression.MinSavings", (int32_t)10);
+
+    String csname = testdir + "/cs0";
+    PropertiesPtr cs_props = new Properties();
+    cs_props->set("blocksize", uint32_t(4096));
+    cs_props->set("compressor", String("zlib"));
+    cs = new CellStoreV5(Global::dfs.get(), schema.get());
+    HT_TRY("creating cellstore", cs->create(csname.c_str(), NUM_CELLS,
+                                            cs_props));
+
+    srandom(1);
+
+    DynamicBuffer key_buf;
+    DynamicBuffer value_buf;
+    vector<DynamicBuffer *> values;
+    char row[32];
+    Key key;
+    ByteString bsvalue;
+
+    for (size_t i=0; i<NUM_CELLS; i++) {
+      sprintf(row, "row%06u", (unsigned)i);
+      key_buf.clear();
+      create_key_and_append(key_buf, FLAG_INSERT, row, 1, "", i+1, i+1);
+      key.load(SerializedKey(key_buf.base));
+      DynamicBuffer *value = new DynamicBuffer();
+      make_value(*value, i);
+      bsvalue.ptr = value->base;
+      cs->add(key, bsvalue);
+      values.push_back(value);
+    }
+
+    TableIdentifier table_id("0");
+    cs->finalize(&table_id);
+
+    cs = CellStoreFactory::open(csname, "", Key::END_ROW_MARKER);
+
+    // Both uncompressed and zlib blocks must be present
+    {
+      stringstream codec_info;
+      streambuf *saved = cout.rdbuf(codec_info.rdbuf());
+      cs->display_block_codec_info();
+      cout.rdbuf(saved);
+      String info = codec_info.str();
+      cout << info << flush;
+      if (info.find("none:") == String::npos ||
+          info.find("zlib:") == String::npos) {
+        HT_ERROR("Expected a mix of uncompressed and zlib data blocks");
+        return 1;
+      }
+      if (info.find("unknown") != String::npos) {
+        HT_ERROR("Unknown compression type in data blocks");
+        return 1;
+      }
+    }
+
+    // Every cell must read back unchanged
+    {
+      ScanContextPtr scan_ctx = new ScanContext(schema);
+      CellListScannerPtr scanner = cs->create_scanner(scan_ctx);
+      size_t i = 0;
+      while (scanner->get(key, bsvalue)) {
+        sprintf(row, "row%06u", (unsigned)i);
+        if (i >= NUM_CELLS || strcmp(key.row, row) ||
+            bsvalue.length() != values[i]->fill() ||
+            memcmp(bsvalue.ptr, values[i]->base, values[i]->fill())) {
+          HT_ERRORF("Cell %u does not match what was written", (unsigned)i);
+          return 1;
+        }
+        scanner->forward();
+        i++;
+      }
+      if (i != NUM_CELLS) {
+        HT_ERRORF("Read %u cells, expected %u", (unsigned)i,
+                  (unsigned)NUM_CELLS);
+        return 1;
+      }
+    }
+
+    client->rmdir(testdir);
+
+    for (size_t i=0; i<values.size(); i++)
+      delete values[i];
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <iostream>
 #include <list>
+#include <set>
 #include <vector>
 
 extern "C" {
@@ -172,6 +173,27 @@ int main(int argc, char **argv) {
     ++history_iter;
   }
 
+  /**
+   * Verify non-checkout insert and cached offset enumeration
+   */
+  {
+    set<uint32_t> offsets;
+    block = new uint8_t [ 16 ];
+    HT_EXPECT(cache->insert(MAX_FILE_ID, 7, block, 16),
+              Error::FAILED_EXPECTATION);
+    block = new uint8_t [ 16 ];
+    if (cache->insert(MAX_FILE_ID, 7, block, 16)) {
+      HT_ERROR("duplicate insert unexpectedly succeeded");
+      return 1;
+    }
+    delete [] block;
+    cache->get_cached_offsets(MAX_FILE_ID, offsets);
+    if (offsets.size() != 1 || *offsets.begin() != 7) {
+      HT_ERROR("cached offsets do not match inserted block");
+      return 1;
+    }
+  }
+
   delete cache;
 
   return 0;
@@ -0,0 +1,240 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "../MaintenanceFlag.h"
+#include "../MaintenancePrioritizer.h"
+#include "../RangeMaintenanceGuard.h"
+#include "../RangeStatsGatherer.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const size_t NUM_RANGES = 200;
+
+  /** Exposes the low memory steps of the prioritizer */
+  class TestPrioritizer : public MaintenancePrioritizer {
+  public:
+    TestPrioritizer(RSStatsPtr &stats) : MaintenancePrioritizer(stats) { }
+    virtual void prioritize(RangeStatsVector &range_data,
+                            MemoryState &memory_state, int32_t priority,
+                            String &trace_str) { }
+    using MaintenancePrioritizer::purge_cellstore_indexes;
+    using MaintenancePrioritizer::compact_cellcaches;
+  };
+
+  /**
+   * One range per element, each with a single access group holding a
+   * single CellStore
+   */
+  struct TestData {
+    TestData() : ranges(NUM_RANGES), ags(NUM_RANGES), stores(NUM_RANGES) {
+      for (size_t i=0; i<NUM_RANGES; i++) {
+        ranges[i] = Range::MaintenanceData();
+        ags[i] = AccessGroup::MaintenanceData();
+        stores[i] = AccessGroup::CellStoreMaintenanceData();
+        ranges[i].agdata = &ags[i];
+        ags[i].csdata = &stores[i];
+        range_data.push_back(&ranges[i]);
+      }
+    }
+    vector<Range::MaintenanceData> ranges;
+    vector<AccessGroup::MaintenanceData> ags;
+    vector<AccessGroup::CellStoreMaintenanceData> stores;
+    RangeStatsVector range_data;
+  };
+
+  // distinct pseudo random sizes
+  int64_t size_of(size_t i) {
+    return 1000 + (int64_t)((i * 7919) % NUM_RANGES) * 10;
+  }
+
+  struct BySizeDescending {
+    bool operator()(size_t x, size_t y) const {
+      return size_of(x) > size_of(y);
+    }
+  };
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  vector<int64_t> compute_periods(1, 30000);
+  RSStatsPtr stats = new RSStats(compute_periods);
+  TestPrioritizer prioritizer(stats);
+  String trace_str;
+  const size_t NEEDED = 10;
+
+  vector<size_t> order;
+  for (size_t i=0; i<NUM_RANGES; i++)
+    order.push_back(i);
+  sort(order.begin(), order.end(), BySizeDescending());
+
+  /**
+   * CellCaches are compacted largest first, only until enough memory is
+   * freed, in the order a full sort would give
+   */
+  {
+    TestData data;
+    MaintenancePrioritizer::MemoryState memory_state;
+    int32_t priority = 1;
+    for (size_t i=0; i<NUM_RANGES; i++) {
+      data.ags[i].mem_used = size_of(i);
+      data.ags[i].mem_allocated = size_of(i);
+    }
+    for (size_t i=0; i<NEEDED; i++)
+      memory_state.needed += size_of(order[i]);
+
+    if (prioritizer.compact_cellcaches(data.range_data, memory_state,
+                                       priority, trace_str)) {
+      HT_ERROR("compact_cellcaches reported that more memory is needed");
+      return 1;
+    }
+    for (size_t i=0; i<NUM_RANGES; i++) {
+      size_t r = order[i];
+      bool picked = (data.ags[r].maintenance_flags &
+                     MaintenanceFlag::COMPACT_MINOR) != 0;
+      if (picked != (i < NEEDED)) {
+        HT_ERRORF("CellCache of size %lld %s", (Lld)size_of(r),
+                  picked ? "compacted unnecessarily" : "not compacted");
+        return 1;
+      }
+      if (picked && data.ranges[r].priority != (int32_t)i + 1) {
+        HT_ERRORF("CellCache of size %lld compacted out of order",
+                  (Lld)size_of(r));
+        return 1;
+      }
+    }
+  }
+
+  /**
+   * CellStore indexes are purged least recently accessed first, only
+   * until enough memory is freed
+   */
+  {
+    TestData data;
+    MaintenancePrioritizer::MemoryState memory_state;
+    int32_t priority = 1;
+    for (size_t i=0; i<NUM_RANGES; i++) {
+      data.stores[i].index_stats.block_index_memory = 100;
+      // the smaller the size, the longer ago the index was accessed
+      data.stores[i].index_stats.block_index_access_counter = size_of(i);
+    }
+    memory_state.needed = NEEDED * 100;
+
+    if (prioritizer.purge_cellstore_indexes(data.range_data, memory_state,
+                                            priority, trace_str)) {
+      HT_ERROR("purge_cellstore_indexes reported that more memory is needed");
+      return 1;
+    }
+    for (size_t i=0; i<NUM_RANGES; i++) {
+      size_t r = order[NUM_RANGES - 1 - i];
+      bool picked = (data.stores[r].maintenance_flags &
+                     MaintenanceFlag::MEMORY_PURGE_CELLSTORE) != 0;
+      if (picked != (i < NEEDED)) {
+        HT_ERRORF("Index with access counter %lld %s", (Lld)size_of(r),
+                  picked ? "purged unnecessarily" : "not purged");
+        return 1;
+      }
+      if (picked && data.ranges[r].priority != (int32_t)i + 1) {
+        HT_ERRORF("Index with access counter %lld purged out of order",
+                  (Lld)size_of(r));
+        return 1;
+      }
+    }
+  }
+
+  /**
+   * Every completed maintenance operation is counted, so that ranges are
+   * gathered again afterwards
+   */
+  {
+    RangeMaintenanceGuard guard;
+    uint32_t completions = guard.completions();
+    {
+      RangeMaintenanceGuard::Activator activator(guard);
+      try {
+        RangeMaintenanceGuard::Activator second(guard);
+        HT_ERROR("Second maintenance operation activated");
+        return 1;
+      }
+      catch (Exception &e) {
+        if (e.code() != Error::RANGESERVER_RANGE_BUSY) {
+          HT_ERROR_OUT << e << HT_END;
+          return 1;
+        }
+      }
+      if (guard.completions() != completions) {
+        HT_ERROR("Operation counted before it completed");
+        return 1;
+      }
+    }
+    if (guard.completions() != completions + 1) {
+      HT_ERROR("Completed maintenance operation not counted");
+      return 1;
+    }
+  }
+
+  /**
+   * Gathered data is only reused for unchanged ranges, within the refresh
+   * interval and never for RS_METRICS passes
+   */
+  {
+    TableInfoMapPtr table_info_map = new TableInfoMap();
+    RangeStatsGatherer incremental(table_info_map, 60000);
+    RangeStatsGatherer full(table_info_map);
+    TableMutator *mutator = (TableMutator *)1;
+    time_t now = time(0);
+
+    if (!incremental.reusable(now - 10, now, false, 0)) {
+      HT_ERROR("Unchanged range gathered again within the refresh interval");
+      return 1;
+    }
+    if (incremental.reusable(now - 10, now, true, 0)) {
+      HT_ERROR("Data of changed range reused");
+      return 1;
+    }
+    if (incremental.reusable(now - 60, now, false, 0)) {
+      HT_ERROR("Data reused past the refresh interval");
+      return 1;
+    }
+    if (incremental.reusable(now - 10, now, false, mutator)) {
+      HT_ERROR("Data reused for an RS_METRICS pass");
+      return 1;
+    }
+    if (full.reusable(now - 10, now, false, 0)) {
+      HT_ERROR("Data reused without a refresh interval");
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,276 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/md5.h"
+
+
+#include "Hypertable/RangeServer/FileBlockCache.h"
+#include "Hypertable/RangeServer/Global.h"
+#include "Hypertable/RangeServer/MemoryGovernor.h"
+#include "Hypertable/RangeServer/MemoryTracker.h"
+#include "Hypertable/RangeServer/QueryCache.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const int64_t MB = 1024 * 1024;
+  const int64_t STEP = 16 * MB;
+
+  MemoryGovernor::Inputs busy_inputs() {
+    MemoryGovernor::Inputs in;
+    // full block cache with many misses
+    in.block_cache_limit = 128 * MB;
+    in.block_cache_used = 128 * MB;
+    in.block_cache_min = 32 * MB;
+    in.block_cache_max = 1024 * MB;
+    in.block_cache_accesses = 100000;
+    in.block_cache_hits = 50000;
+    // full query cache with many hits
+    in.query_cache_limit = 64 * MB;
+    in.query_cache_used = 64 * MB;
+    in.query_cache_min = 16 * MB;
+    in.query_cache_max = 256 * MB;
+    in.query_cache_accesses = 10000;
+    in.query_cache_hits = 9000;
+    return in;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  MemoryGovernor::Inputs in;
+  MemoryGovernor::Decision decision;
+
+  // nothing happens without activity
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::NONE) {
+    HT_ERROR("decision made without activity");
+    return 1;
+  }
+
+  // idle indexes are reclaimed for a block cache that misses
+  in = busy_inputs();
+  in.idle_index_memory = 100 * MB;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::INDEXES ||
+      decision.to != MemoryGovernor::BLOCK_CACHE || decision.amount != STEP) {
+    HT_ERROR("idle indexes not moved to block cache");
+    return 1;
+  }
+
+  // only as much as the idle indexes hold is moved
+  in.idle_index_memory = MB;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::INDEXES || decision.amount != MB) {
+    HT_ERROR("more than the idle index memory moved");
+    return 1;
+  }
+
+  // a block cache with spare room does not grow
+  in = busy_inputs();
+  in.idle_index_memory = 100 * MB;
+  in.block_cache_used = 64 * MB;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.to == MemoryGovernor::BLOCK_CACHE) {
+    HT_ERROR("block cache with spare room grown");
+    return 1;
+  }
+
+  // nor does one at its maximum
+  in = busy_inputs();
+  in.idle_index_memory = 100 * MB;
+  in.block_cache_max = in.block_cache_limit;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.to == MemoryGovernor::BLOCK_CACHE) {
+    HT_ERROR("block cache grown past its maximum");
+    return 1;
+  }
+
+  // an unused query cache gives way to a missing block cache
+  in = busy_inputs();
+  in.query_cache_accesses = 0;
+  in.query_cache_hits = 0;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::QUERY_CACHE ||
+      decision.to != MemoryGovernor::BLOCK_CACHE) {
+    HT_ERROR("unused query cache not shrunk");
+    return 1;
+  }
+
+  // but not below its minimum
+  in.query_cache_limit = in.query_cache_min;
+  in.query_cache_used = in.query_cache_min;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from == MemoryGovernor::QUERY_CACHE) {
+    HT_ERROR("query cache shrunk below its minimum");
+    return 1;
+  }
+
+  // a query cache with many hits per byte is not given up for a block
+  // cache with few misses
+  in = busy_inputs();
+  in.block_cache_accesses = 1000;
+  in.block_cache_hits = 990;
+  in.query_cache_hits = in.query_cache_accesses;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::NONE) {
+    HT_ERROR("moved memory for a marginal gain");
+    return 1;
+  }
+
+  // a query cache that misses grows at the expense of a block cache that
+  // hardly hits
+  in = busy_inputs();
+  in.block_cache_accesses = 100;
+  in.block_cache_hits = 10;
+  in.query_cache_accesses = 100000;
+  in.query_cache_hits = 10000;
+  decision = MemoryGovernor::decide(in, STEP);
+  if (decision.from != MemoryGovernor::BLOCK_CACHE ||
+      decision.to != MemoryGovernor::QUERY_CACHE) {
+    HT_ERROR("query cache not grown");
+    return 1;
+  }
+
+  /**
+   * QueryCache::set_max_memory
+   */
+  QueryCache cache(1000000);
+  boost::shared_array<uint8_t> result(new uint8_t [1000]);
+  QueryCache::Key key;
+  char keybuf[32];
+  uint32_t length;
+
+  for (int i=0; i<100; i++) {
+    sprintf(keybuf, "key-%d", i);
+    md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
+    if (!cache.insert(&key, "/1", "row", result, 1000)) {
+      HT_ERROR("query cache insert failed");
+      return 1;
+    }
+  }
+
+  cache.set_max_memory(50000);
+  if (cache.available_memory() > 50000) {
+    HT_ERROR("query cache available memory exceeds its limit");
+    return 1;
+  }
+
+  sprintf(keybuf, "key-%d", 0);
+  md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
+  if (cache.lookup(&key, result, &length)) {
+    HT_ERROR("least recently used entry survived shrinking");
+    return 1;
+  }
+  sprintf(keybuf, "key-%d", 99);
+  md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
+  if (!cache.lookup(&key, result, &length)) {
+    HT_ERROR("most recently used entry evicted by shrinking");
+    return 1;
+  }
+
+  cache.set_max_memory(1000000);
+  if (cache.available_memory() < 1000000 - 50000) {
+    HT_ERROR("query cache did not grow");
+    return 1;
+  }
+
+  /**
+   * MemoryGovernor::transfer credits only the memory actually released
+   */
+  {
+    FileBlockCache block_cache(0, 10 * MB);
+    QueryCache query_cache(MB);
+    MemoryGovernor governor(&block_cache, &query_cache, 4 * MB, 4);
+    uint64_t max_memory, available_memory, accesses, hits;
+
+    Global::memory_tracker = new MemoryTracker(&block_cache);
+
+    // eight checked out blocks leave 2MB that can be released
+    for (int i=0; i<8; i++) {
+      if (!block_cache.insert_and_checkout(1, i, new uint8_t [MB], MB)) {
+        HT_ERROR("block cache insert failed");
+        return 1;
+      }
+    }
+
+    decision = MemoryGovernor::Decision();
+    decision.from = MemoryGovernor::BLOCK_CACHE;
+    decision.to = MemoryGovernor::QUERY_CACHE;
+    decision.amount = 4 * MB;
+    if (governor.transfer(decision, 0) != 2 * MB) {
+      HT_ERROR("partial block cache release not reported");
+      return 1;
+    }
+    if (block_cache.get_limit() != 8 * MB) {
+      HT_ERROR("block cache limit not lowered by the released amount");
+      return 1;
+    }
+    query_cache.get_stats(&max_memory, &available_memory, &accesses, &hits);
+    if ((int64_t)max_memory != 3 * MB) {
+      HT_ERROR("query cache credited more than was released");
+      return 1;
+    }
+    if (Global::memory_tracker->memory_used() != 2 * MB) {
+      HT_ERROR("memory tracker not adjusted by the released amount");
+      return 1;
+    }
+
+    // index purges are credited once their memory is gone
+    decision.from = MemoryGovernor::INDEXES;
+    decision.to = MemoryGovernor::BLOCK_CACHE;
+    decision.amount = 4 * MB;
+    if (governor.transfer(decision, 10 * MB) != 0) {
+      HT_ERROR("pending index purge credited");
+      return 1;
+    }
+    if (block_cache.get_limit() != 8 * MB) {
+      HT_ERROR("block cache grown before index memory was released");
+      return 1;
+    }
+    if (governor.settle_index_purge(9 * MB) != MB) {
+      HT_ERROR("partially released index memory not credited");
+      return 1;
+    }
+    if (block_cache.get_limit() != 9 * MB) {
+      HT_ERROR("block cache not grown by the released index memory");
+      return 1;
+    }
+    if (governor.settle_index_purge(0) != 0) {
+      HT_ERROR("index purge credited twice");
+      return 1;
+    }
+
+    for (int i=0; i<8; i++)
+      block_cache.checkin(1, i);
+    delete Global::memory_tracker;
+    Global::memory_tracker = 0;
+  }
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <algorithm>
+
+#include "Hypertable/RangeServer/RowLoadSampler.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  String median(RowLoadSampler &sampler, const char *start_row,
+                const char *end_row) {
+    vector<String> rows;
+    sampler.get_rows(start_row, end_row, rows);
+    if (rows.empty())
+      return "";
+    sort(rows.begin(), rows.end());
+    return rows[rows.size()/2];
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  RowLoadSampler sampler(100, 4);
+  char row[32];
+
+  // only every fourth access is sampled
+  for (int i=0; i<40; i++) {
+    sprintf(row, "row%03d", i);
+    sampler.add(row);
+  }
+  if (sampler.size() != 10) {
+    HT_ERROR("wrong number of samples");
+    return 1;
+  }
+
+  // capacity bounds the number of samples
+  for (int i=0; i<1000; i++) {
+    sprintf(row, "row%03d", i);
+    sampler.add(row);
+  }
+  if (sampler.size() != 100) {
+    HT_ERROR("sample exceeds capacity");
+    return 1;
+  }
+
+  // the oldest samples are overwritten by the most recent accesses
+  sampler.clear();
+  for (int i=0; i<400; i++)
+    sampler.add("aaa");
+  for (int i=0; i<400; i++) {
+    sprintf(row, "row%03d", i % 10);
+    sampler.add(row);
+  }
+  if (median(sampler, "", "\xff\xff") < "row000") {
+    HT_ERROR("old samples not overwritten");
+    return 1;
+  }
+
+  // a hot row pulls the median towards it
+  RowLoadSampler hot_sampler(100, 1);
+  for (int i=0; i<100; i++) {
+    if (i % 2)
+      hot_sampler.add("row900");
+    else {
+      sprintf(row, "row%03d", i * 8);
+      hot_sampler.add(row);
+    }
+  }
+  if (median(hot_sampler, "", "\xff\xff") != "row900") {
+    HT_ERROR("median not at hot row");
+    return 1;
+  }
+
+  // rows outside of the range, and its boundaries, are skipped
+  vector<String> rows;
+  hot_sampler.get_rows("row100", "row900", rows);
+  foreach (const String &r, rows) {
+    if (r <= "row100" || r >= "row900") {
+      HT_ERROR("row outside of range returned");
+      return 1;
+    }
+  }
+  if (rows.empty()) {
+    HT_ERROR("no rows returned within range");
+    return 1;
+  }
+
+  return 0;
+}
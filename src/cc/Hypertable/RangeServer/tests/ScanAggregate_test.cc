@@ -0,0 +1,343 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+#include "Common/Usage.h"
+
+#include <map>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanAggregator.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../AccessGroup.h"
+#include "../FileBlockCache.h"
+#include "../FillScanBlock.h"
+#include "../Global.h"
+#include "../MergeScanner.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: ScanAggregate_test",
+    "",
+    "  This program loads an access group with several versions of numeric",
+    "  cells, row and column family deletes, and runs aggregate scans over",
+    "  it through FillScanBlock.  It checks the partial aggregates of every",
+    "  (row, column family) and the totals against the aggregates computed",
+    "  from the live cells, with and without a row limit.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>a</Name>\n"
+  "      <MaxVersions>2</MaxVersions>\n"
+  "    </ColumnFamily>\n"
+  "    <ColumnFamily id=\"2\">\n"
+  "      <Name>b</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const int NUM_ROWS = 50;
+  const int NUM_VERSIONS = 3;
+  const int MAX_VERSIONS = 2;
+  const int ROW_LIMIT = 7;
+
+  /** Every DELETED_ROW_MOD'th row is deleted */
+  const int DELETED_ROW_MOD = 4;
+  /** Column family a is deleted in every DELETED_FAMILY_MOD'th row */
+  const int DELETED_FAMILY_MOD = 5;
+
+  /** Aggregates keyed by "<row>:<column family code>" */
+  typedef std::map<String, AggregateValue> AggregateMap;
+
+  String row_key(int i) {
+    return format("row%04d", i);
+  }
+
+  int64_t value_of(int row, int version) {
+    return (int64_t)row * 100 - version;
+  }
+
+  bool row_deleted(int i) {
+    return (i % DELETED_ROW_MOD) == 1;
+  }
+
+  bool family_deleted(int i) {
+    return (i % DELETED_FAMILY_MOD) == 2;
+  }
+
+  void add_cell(AccessGroup *ag, uint8_t flag, const String &row,
+                uint8_t family, const char *qualifier, int64_t timestamp,
+                const String &data, int64_t *revisionp) {
+    DynamicBuffer key_buf;
+    DynamicBuffer value_buf;
+    Key key;
+    ByteString value;
+
+    ++*revisionp;
+    create_key_and_append(key_buf, flag, row.c_str(), family, qualifier,
+                          timestamp, *revisionp);
+    key.load(SerializedKey(key_buf.base));
+    value_buf.ensure(data.length() + 5);
+    Serialization::encode_vi32(&value_buf.ptr, data.length());
+    value_buf.add_unchecked(data.c_str(), data.length());
+    value.ptr = value_buf.base;
+    ag->add(key, value);
+  }
+
+  /**
+   * Writes NUM_VERSIONS versions of a numeric cell in column family a and
+   * a non-numeric cell in column family b, with two qualifiers, to every
+   * row, and then deletes rows and column families
+   */
+  void load(AccessGroup *ag, int64_t *revisionp) {
+    for (int v=NUM_VERSIONS-1; v>=0; v--) {
+      for (int i=0; i<NUM_ROWS; i++) {
+        int64_t timestamp = (NUM_VERSIONS - v) * 1000000LL + i;
+        add_cell(ag, FLAG_INSERT, row_key(i), 1, "",
+                 timestamp, format("%lld", (Lld)value_of(i, v)), revisionp);
+      }
+    }
+    for (int i=0; i<NUM_ROWS; i++) {
+      add_cell(ag, FLAG_INSERT, row_key(i), 2, "x", 1000000LL, "text",
+               revisionp);
+      add_cell(ag, FLAG_INSERT, row_key(i), 2, "y", 1000000LL, "-", revisionp);
+    }
+    for (int i=0; i<NUM_ROWS; i++) {
+      if (row_deleted(i))
+        add_cell(ag, FLAG_DELETE_ROW, row_key(i), 0, "",
+                 NUM_VERSIONS * 1000000LL + NUM_ROWS, "", revisionp);
+      else if (family_deleted(i))
+        add_cell(ag, FLAG_DELETE_COLUMN_FAMILY, row_key(i), 1, "",
+                 NUM_VERSIONS * 1000000LL + NUM_ROWS, "", revisionp);
+    }
+  }
+
+  /**
+   * Computes the aggregates of the live cells: the MAX_VERSIONS newest
+   * versions in column family a and both cells in column family b of the
+   * first row_limit rows that were not deleted
+   */
+  void expected_aggregates(int32_t mode, int row_limit, AggregateMap &map) {
+    int rows = 0;
+    for (int i=0; i<NUM_ROWS; i++) {
+      if (row_deleted(i))
+        continue;
+      if (row_limit && ++rows > row_limit)
+        break;
+      String row = (mode == ScanSpec::AGGREGATE_ROW) ? row_key(i) : String();
+      if (!family_deleted(i)) {
+        AggregateValue &a = map[row + ":1"];
+        for (int v=0; v<MAX_VERSIONS; v++) {
+          a.count++;
+          a.add(value_of(i, v));
+        }
+      }
+      map[row + ":2"].count += 2;
+    }
+  }
+
+  /**
+   * Runs an aggregate scan over the access group, filling scan blocks of
+   * buffer_size bytes, and merges the partial aggregates it returns
+   */
+  void scan_aggregates(AccessGroup *ag, SchemaPtr &schema, int32_t mode,
+                       int row_limit, int64_t buffer_size, AggregateMap &map,
+                       size_t *blocksp) {
+    ScanSpec spec;
+    RangeSpec range("", Key::END_ROW_MARKER);
+
+    spec.aggregate = mode;
+    spec.row_limit = row_limit;
+
+    ScanContextPtr scan_ctx = new ScanContext(TIMESTAMP_MAX, &spec, &range,
+                                              schema);
+    MergeScanner *mscanner = new MergeScanner(scan_ctx, false);
+    mscanner->add_scanner(ag->create_scanner(scan_ctx));
+    CellListScannerPtr scanner = mscanner;
+
+    bool more = true;
+    *blocksp = 0;
+    while (more) {
+      DynamicBuffer dbuf;
+      more = FillScanBlock(scanner, dbuf, buffer_size);
+      (*blocksp)++;
+
+      const uint8_t *ptr = dbuf.base;
+      size_t remain = 4;
+      uint32_t len = Serialization::decode_i32(&ptr, &remain);
+      const uint8_t *end = ptr + len;
+      Key key;
+      while (ptr < end) {
+        key.load(SerializedKey(ptr));
+        ptr += key.length;
+        ByteString value(ptr);
+        ptr += value.length();
+
+        const uint8_t *decode;
+        remain = value.decode_length(&decode);
+        if (remain != AggregateValue::ENCODED_LENGTH)
+          HT_THROWF(Error::FAILED_EXPECTATION, "Bad aggregate length %u",
+                    (unsigned)remain);
+        AggregateValue partial;
+        partial.decode(&decode, &remain);
+        map[format("%s:%d", key.row, (int)key.column_family_code)].merge(partial);
+      }
+    }
+  }
+
+  bool equal(const AggregateValue &a, const AggregateValue &b) {
+    return a.count == b.count && a.values == b.values && a.sum == b.sum &&
+      a.min == b.min && a.max == b.max;
+  }
+
+  bool check(const char *label, AggregateMap &expected, AggregateMap &result) {
+    if (expected.size() != result.size()) {
+      HT_ERRORF("%s: expected %d groups, got %d", label, (int)expected.size(),
+                (int)result.size());
+      return false;
+    }
+    for (AggregateMap::iterator iter = expected.begin();
+         iter != expected.end(); ++iter) {
+      AggregateMap::iterator riter = result.find(iter->first);
+      if (riter == result.end()) {
+        HT_ERRORF("%s: group %s missing", label, iter->first.c_str());
+        return false;
+      }
+      if (!equal(iter->second, riter->second)) {
+        HT_ERRORF("%s: group %s got count=%lld values=%lld sum=%lld min=%lld "
+                  "max=%lld, expected count=%lld values=%lld sum=%lld "
+                  "min=%lld max=%lld", label, iter->first.c_str(),
+                  (Lld)riter->second.count, (Lld)riter->second.values,
+                  (Lld)riter->second.sum, (Lld)riter->second.min,
+                  (Lld)riter->second.max, (Lld)iter->second.count,
+                  (Lld)iter->second.values, (Lld)iter->second.sum,
+                  (Lld)iter->second.min, (Lld)iter->second.max);
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(1000000LL, 1000000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    Global::toplevel_dir = "/ScanAggregate_test";
+    client->mkdirs(Global::toplevel_dir);
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      return 1;
+    }
+
+    TableIdentifier table_id("1");
+    RangeSpec range("", Key::END_ROW_MARKER);
+    int64_t revision = 0;
+
+    AccessGroupPtr ag = new AccessGroup(&table_id, schema,
+        schema->get_access_group("default"), &range);
+
+    load(ag.get(), &revision);
+
+    struct {
+      const char *label;
+      int32_t mode;
+      int row_limit;
+      int64_t buffer_size;
+    } scans[] = {
+      { "row", ScanSpec::AGGREGATE_ROW, 0, 65536 },
+      { "row, small blocks", ScanSpec::AGGREGATE_ROW, 0, 256 },
+      { "row, row limit", ScanSpec::AGGREGATE_ROW, ROW_LIMIT, 256 },
+      { "total", ScanSpec::AGGREGATE_TOTAL, 0, 65536 },
+      { "total, small blocks", ScanSpec::AGGREGATE_TOTAL, 0, 32 },
+      { "total, row limit", ScanSpec::AGGREGATE_TOTAL, ROW_LIMIT, 65536 }
+    };
+
+    for (size_t i=0; i<sizeof(scans)/sizeof(scans[0]); i++) {
+      AggregateMap expected, result;
+      size_t blocks;
+      expected_aggregates(scans[i].mode, scans[i].row_limit, expected);
+      scan_aggregates(ag.get(), schema, scans[i].mode, scans[i].row_limit,
+                      scans[i].buffer_size, result, &blocks);
+      if (!check(scans[i].label, expected, result))
+        return 1;
+      // small blocks must split the scan, so partial aggregates get merged
+      if (scans[i].buffer_size < 1024 && !scans[i].row_limit && blocks < 2) {
+        HT_ERRORF("%s: expected several scan blocks, got %d", scans[i].label,
+                  (int)blocks);
+        return 1;
+      }
+    }
+
+    client->rmdir(Global::toplevel_dir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
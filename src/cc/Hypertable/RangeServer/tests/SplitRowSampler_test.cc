@@ -0,0 +1,134 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+
+#include "Hypertable/RangeServer/SplitRowSampler.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  String median(const SplitRowSampler &sampler) {
+    SplitRowSampler::SampleVector samples;
+    sampler.get_samples(samples);
+    const char *row = SplitRowSampler::median(samples);
+    return row ? row : "";
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  SplitRowSampler sampler(64);
+  char row[32];
+
+  if (median(sampler) != "") {
+    HT_ERROR("median of empty sample");
+    return 1;
+  }
+
+  // the sample size is bounded, however much data is added
+  for (int i=0; i<100000; i++) {
+    sprintf(row, "row%05d", i);
+    sampler.add(row, 100);
+  }
+  if (sampler.size() > 64 || sampler.size() < 32) {
+    HT_ERROR("bad sample size");
+    return 1;
+  }
+  if (sampler.total_bytes() != 10000000) {
+    HT_ERROR("bad total bytes");
+    return 1;
+  }
+
+  // sorted input of equal sized cells splits near the middle
+  String mid = median(sampler);
+  if (mid < "row47000" || mid > "row53000") {
+    HT_ERROR("median of sorted input not near the middle");
+    return 1;
+  }
+
+  // the median divides bytes, not cells: the first 1000 rows hold as much
+  // data as the following 99000
+  SplitRowSampler weighted(64);
+  for (int i=0; i<100000; i++) {
+    sprintf(row, "row%05d", i);
+    weighted.add(row, i < 1000 ? 9900 : 100);
+  }
+  mid = median(weighted);
+  if (mid < "row00900" || mid > "row02000") {
+    HT_ERROR("median not weighted by bytes");
+    return 1;
+  }
+
+  // insertion order does not matter for unsorted input
+  SplitRowSampler unsorted(64);
+  for (int i=0; i<100000; i++) {
+    sprintf(row, "row%05d", (int)(((int64_t)i * 7919) % 100000));
+    unsorted.add(row, 100);
+  }
+  mid = median(unsorted);
+  if (mid < "row40000" || mid > "row60000") {
+    HT_ERROR("median of unsorted input not near the middle");
+    return 1;
+  }
+
+  // samples of different samplers are combined by weight
+  SplitRowSampler::SampleVector samples;
+  SplitRowSampler big(64), small(64);
+  for (int i=0; i<10000; i++) {
+    sprintf(row, "a%05d", i);
+    big.add(row, 1000);
+    sprintf(row, "b%05d", i);
+    small.add(row, 10);
+  }
+  big.get_samples(samples);
+  small.get_samples(samples);
+  const char *split_row = SplitRowSampler::median(samples);
+  if (split_row == 0 || split_row[0] != 'a') {
+    HT_ERROR("samples not combined by weight");
+    return 1;
+  }
+
+  // a scale converts the weights, e.g. compressed to uncompressed bytes
+  samples.clear();
+  big.get_samples(samples);
+  small.get_samples(samples, 1000.0);
+  split_row = SplitRowSampler::median(samples);
+  if (split_row == 0 || split_row[0] != 'b') {
+    HT_ERROR("scaled samples not weighted");
+    return 1;
+  }
+
+  sampler.clear();
+  if (sampler.size() != 0 || sampler.total_bytes() != 0) {
+    HT_ERROR("sampler not cleared");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+
+#include "Hypertable/RangeServer/UpdateThrottle.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const int64_t MB = 1024 * 1024;
+  const int64_t LIMIT = 1000 * MB;
+  const int32_t MAX_DELAY = 2000;
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  UpdateThrottle throttle(LIMIT, 80, MAX_DELAY, MB);
+  InetAddr client(0x0a000001, 38060);
+  int64_t now = 1000000;
+
+  // no delay below the memory threshold
+  throttle.update_estimates(now, 100 * MB, 0, 0);
+  throttle.record_update(200 * MB);
+  now += 1000;
+  // 200MB added, memory grew by 100MB, so 100MB/s was drained
+  throttle.update_estimates(now, 200 * MB, 0, 0);
+  if (throttle.drain_rate() < 99.0 * MB || throttle.drain_rate() > 101.0 * MB) {
+    HT_ERROR("bad drain rate estimate");
+    return 1;
+  }
+  if (throttle.overload() != 0.0) {
+    HT_ERROR("overload reported below threshold");
+    return 1;
+  }
+  for (int i=0; i<100; i++)
+    if (throttle.admit(now, client, 10 * MB, 0.5)) {
+      HT_ERROR("update delayed below threshold");
+      return 1;
+    }
+
+  // half way between threshold and limit, admitted rate is halved
+  throttle.record_update(100 * MB);
+  now += 1000;
+  throttle.update_estimates(now, 900 * MB, 0, 0);
+  if (throttle.overload() < 0.49 || throttle.overload() > 0.51) {
+    HT_ERROR("bad overload estimate");
+    return 1;
+  }
+  uint32_t delay = 0;
+  for (int i=0; i<10; i++)
+    delay = throttle.admit(now, client, 10 * MB, 0.5);
+  if (delay == 0) {
+    HT_ERROR("update not delayed when overloaded");
+    return 1;
+  }
+  if (delay > MAX_DELAY) {
+    HT_ERROR("delay exceeds maximum");
+    return 1;
+  }
+
+  // delays never exceed the maximum, however large the burst
+  for (int i=0; i<10000; i++)
+    if (throttle.admit(now, client, 100 * MB, 0.5) > (uint32_t)MAX_DELAY) {
+      HT_ERROR("delay exceeds maximum under burst");
+      return 1;
+    }
+
+  // the virtual clock drains as time passes
+  now += 10 * MAX_DELAY;
+  if (throttle.admit(now, client, 1, 0.5)) {
+    HT_ERROR("delay persisted after backlog drained");
+    return 1;
+  }
+
+  // commit log growth counts as overload
+  UpdateThrottle log_throttle(LIMIT, 80, MAX_DELAY, MB);
+  log_throttle.update_estimates(now, 0, 300 * MB, 200 * MB);
+  if (log_throttle.overload() < 0.49 || log_throttle.overload() > 0.51) {
+    HT_ERROR("commit log overload not detected");
+    return 1;
+  }
+
+  // over-capacity ranges are delayed in proportion to the excess
+  UpdateThrottle range_throttle(LIMIT, 80, MAX_DELAY, MB);
+  if (range_throttle.admit(now, client, MB, 1.0)) {
+    HT_ERROR("range at capacity delayed");
+    return 1;
+  }
+  delay = range_throttle.admit(now, client, MB, 1.5);
+  if (delay != (uint32_t)MAX_DELAY / 2) {
+    HT_ERROR("bad over-capacity range delay");
+    return 1;
+  }
+  if (range_throttle.admit(now, client, MB, 5.0) != (uint32_t)MAX_DELAY) {
+    HT_ERROR("over-capacity range delay not capped");
+    return 1;
+  }
+
+  /**
+   * Each client is paced on its own clock: a client that sent a burst is
+   * delayed, while another one that used little bandwidth is not
+   */
+  UpdateThrottle fair_throttle(LIMIT, 80, MAX_DELAY, MB);
+  InetAddr heavy(0x0a000002, 38060);
+  InetAddr light(0x0a000003, 38060);
+  fair_throttle.update_estimates(now, 100 * MB, 0, 0);
+  fair_throttle.admit(now, heavy, MB, 0.5);
+  fair_throttle.admit(now, light, MB, 0.5);
+  fair_throttle.record_update(200 * MB);
+  now += 1000;
+  fair_throttle.update_estimates(now, 200 * MB, 0, 0);
+  fair_throttle.admit(now, heavy, MB, 0.5);
+  fair_throttle.admit(now, light, MB, 0.5);
+  fair_throttle.record_update(100 * MB);
+  now += 1000;
+  fair_throttle.update_estimates(now, 900 * MB, 0, 0);
+  for (int i=0; i<10; i++)
+    delay = fair_throttle.admit(now, heavy, 10 * MB, 0.5);
+  if (delay == 0) {
+    HT_ERROR("client sending a burst not delayed");
+    return 1;
+  }
+  if (fair_throttle.admit(now, light, MB, 0.5)) {
+    HT_ERROR("client delayed for the bandwidth of another client");
+    return 1;
+  }
+
+  uint64_t throttled, delay_ms;
+  range_throttle.get_counts(&throttled, &delay_ms);
+  if (throttled != 2 || delay_ms != (uint64_t)MAX_DELAY + MAX_DELAY / 2) {
+    HT_ERROR("bad throttle counts");
+    return 1;
+  }
+
+  return 0;
+}
@@ -54,8 +54,11 @@ void init_thrift_broker_options() {
     ("pidfile", str(), "File to contain the process id")
     ("log-api", boo()->default_value(false), "Enable or disable API logging")
     ("workers", i32()->default_value(50), "Worker threads")
+    ("server", str()->default_value("threaded"), "Server type: threaded "
+        "(thread per connection) or nonblocking (worker pool)")
     ;
   alias("port", "ThriftBroker.Port");
+  alias("server", "ThriftBroker.Server");
   alias("log-api", "ThriftBroker.API.Logging");
   alias("workers", "ThriftBroker.Workers");
   // hidden aliases
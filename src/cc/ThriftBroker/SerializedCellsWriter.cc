@@ -38,56 +38,79 @@ bool SerializedCellsWriter::add(const char *row, const char *column_family,
   int32_t column_family_length = column_family ? strlen(column_family) : 0;
   int32_t column_qualifier_length = column_qualifier ? strlen(column_qualifier) : 0;
   int32_t length = 9 + row_length + column_family_length + column_qualifier_length + value_length + 1; 
+
+  if (timestamp != AUTO_ASSIGN && timestamp != TIMESTAMP_NULL)
+    length += 8;
+
+  // need to leave room for the termination byte
+  if (!m_grow && length > m_size - (int32_t)m_buf.size()) {
+    if (!m_buf.empty())
+      return false;
+    m_size = length;
+  }
+
+  append(m_buf, row, row_length, column_family, column_family_length,
+         column_qualifier, column_qualifier_length, timestamp, value,
+         value_length, cell_flag);
+  return true;
+}
+
+
+void SerializedCellsWriter::encode(String &buf, const Cell &cell) {
+  int32_t value_length = cell.value ? cell.value_len : 0;
+
+  append(buf, cell.row_key, strlen(cell.row_key), cell.column_family,
+         cell.column_family ? strlen(cell.column_family) : 0,
+         cell.column_qualifier,
+         cell.column_qualifier ? strlen(cell.column_qualifier) : 0,
+         cell.timestamp, cell.value, value_length, cell.flag);
+}
+
+
+void SerializedCellsWriter::append(String &buf, const char *row,
+    int32_t row_length, const char *column_family,
+    int32_t column_family_length, const char *column_qualifier,
+    int32_t column_qualifier_length, int64_t timestamp, const void *value,
+    int32_t value_length, uint8_t cell_flag) {
   uint8_t flag = 0;
 
   if (timestamp == AUTO_ASSIGN)
     flag |= SerializedCellsFlag::AUTO_TIMESTAMP;
-  else if (timestamp != TIMESTAMP_NULL) {
+  else if (timestamp != TIMESTAMP_NULL)
     flag |= SerializedCellsFlag::HAVE_TIMESTAMP;
-    length += 8;
-  }
 
-  // need to leave room for the termination byte
-  if (length > (int32_t)m_buf.remaining()) {
-    if (m_grow)
-      m_buf.ensure(length);
-    else {
-      if (!m_buf.empty())
-        return false;
-      m_buf.grow(length);
-    }
-  }
+  uint8_t header[17];
+  uint8_t *ptr = header;
 
   // flag byte
-  *m_buf.ptr++ = flag;
+  *ptr++ = flag;
 
   // timestamp
   if ((flag & SerializedCellsFlag::HAVE_TIMESTAMP) != 0)
-    Serialization::encode_i64(&m_buf.ptr, timestamp);
+    Serialization::encode_i64(&ptr, timestamp);
 
   // revision
   if ((flag & SerializedCellsFlag::HAVE_REVISION) &&
       (flag & SerializedCellsFlag::REV_IS_TS) == 0)
-    Serialization::encode_i64(&m_buf.ptr, 0);
+    Serialization::encode_i64(&ptr, 0);
+
+  buf.append((const char *)header, ptr - header);
 
   // row
-  memcpy(m_buf.ptr, row, row_length);
-  m_buf.ptr += row_length;
-  *m_buf.ptr++ = 0;
+  buf.append(row, row_length);
+  buf.push_back(0);
 
   // column_family
-  if( column_family ) memcpy(m_buf.ptr, column_family, column_family_length);
-  m_buf.ptr += column_family_length;
-  *m_buf.ptr++ = 0;
+  if( column_family ) buf.append(column_family, column_family_length);
+  buf.push_back(0);
 
   // column_qualifier
-  if( column_qualifier ) memcpy(m_buf.ptr, column_qualifier, column_qualifier_length);
-  m_buf.ptr += column_qualifier_length;
-  *m_buf.ptr++ = 0;
-
-  Serialization::encode_i32(&m_buf.ptr, value_length);
-  if( value ) memcpy(m_buf.ptr, value, value_length);
-  m_buf.ptr += value_length;
-  Serialization::encode_i8(&m_buf.ptr, cell_flag);
-  return true;
+  if( column_qualifier ) buf.append(column_qualifier, column_qualifier_length);
+  buf.push_back(0);
+
+  ptr = header;
+  Serialization::encode_i32(&ptr, value_length);
+  buf.append((const char *)header, 4);
+  if( value ) buf.append((const char *)value, value_length);
+  buf.push_back((char)cell_flag);
 }
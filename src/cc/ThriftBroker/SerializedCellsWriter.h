@@ -20,7 +20,7 @@
 #ifndef HYPERTABLE_SERIALIZEDCELLSWRITER_H
 #define HYPERTABLE_SERIALIZEDCELLSWRITER_H
 
-#include "Common/DynamicBuffer.h"
+#include "Common/String.h"
 
 #include "Hypertable/Lib/Cell.h"
 #include "Hypertable/Lib/KeySpec.h"
@@ -29,11 +29,20 @@
 
 namespace Hypertable {
 
+  /**
+   * Serializes cells for the *_serialized Thrift calls.  Cells are
+   * appended to a string that swap() hands over to the Thrift result
+   * without another copy.  Scan results can also be encoded with #encode
+   * while they are loaded from their scan blocks (see ScanCellsEncoder)
+   * and appended as a whole to #get_buffer_string.
+   */
   class SerializedCellsWriter {
   public:
-  
+
     SerializedCellsWriter(int32_t size, bool grow=false) :
-      m_buf(size), m_finalized(false), m_grow(grow) { }
+      m_size(size), m_finalized(false), m_grow(grow) {
+      m_buf.reserve(size);
+    }
 
     bool add(Cell &cell) {
       return add(cell.row_key, cell.column_family, cell.column_qualifier,
@@ -45,29 +54,58 @@ namespace Hypertable {
              const void *value, int32_t value_length,
 			 uint8_t cell_flag = FLAG_INSERT);
 
+    /**
+     * Appends a cell to a buffer in the serialized cells format, without
+     * a size limit
+     *
+     * @param buf buffer to append to
+     * @param cell cell to serialize
+     */
+    static void encode(String &buf, const Cell &cell);
+
     void finalize(uint8_t flag) {
-      if (m_grow)
-        m_buf.ensure(1);
-      *m_buf.ptr++ = SerializedCellsFlag::EOB | flag;
+      m_buf.push_back((char)(SerializedCellsFlag::EOB | flag));
       m_finalized = true;
     }
 
-    uint8_t *get_buffer() { return m_buf.base; }
-    int32_t get_buffer_length() { return m_buf.fill(); }
+    uint8_t *get_buffer() { return (uint8_t *)m_buf.data(); }
+    String &get_buffer_string() { return m_buf; }
+    int32_t get_buffer_length() { return m_buf.size(); }
 
     void get_buffer(const uint8_t **bufp, int32_t *lenp) {
       if (!m_finalized)
         finalize(SerializedCellsFlag::EOB);
-      *bufp = m_buf.base;
-      *lenp = m_buf.fill();
+      *bufp = (const uint8_t *)m_buf.data();
+      *lenp = m_buf.size();
     }
 
-    bool empty() { return m_buf.empty(); }    
-    
-    void clear() { m_buf.clear(); }
+    /**
+     * Moves the serialized cells into out without copying them and
+     * leaves the writer empty
+     *
+     * @param out string to receive the serialized cells
+     */
+    void swap(String &out) {
+      if (!m_finalized)
+        finalize(SerializedCellsFlag::EOB);
+      out.swap(m_buf);
+      clear();
+    }
+
+    bool empty() { return m_buf.empty(); }
+
+    void clear() { m_buf.clear(); m_finalized = false; }
 
   private:
-    DynamicBuffer m_buf;
+    static void append(String &buf, const char *row, int32_t row_length,
+                       const char *column_family, int32_t column_family_length,
+                       const char *column_qualifier,
+                       int32_t column_qualifier_length, int64_t timestamp,
+                       const void *value, int32_t value_length,
+                       uint8_t cell_flag);
+
+    String m_buf;
+    int32_t m_size;
     bool m_finalized;
     bool m_grow;
   };
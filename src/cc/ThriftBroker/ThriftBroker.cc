@@ -24,8 +24,10 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <concurrency/PosixThreadFactory.h>
 #include <concurrency/ThreadManager.h>
 #include <protocol/TBinaryProtocol.h>
+#include <server/TNonblockingServer.h>
 #include <server/TThreadedServer.h>
 #include <transport/TBufferTransports.h>
 #include <transport/TServerSocket.h>
@@ -132,18 +134,93 @@ inline bool operator < (const SharedMutatorMapKey &skey1, const SharedMutatorMap
   return skey1.compare(skey2) < 0;
 }
 
+/**
+ * Encodes scan results into the serialized cells format while they are
+ * loaded from the RangeServer scan blocks
+ */
+class SerializedCellsEncoder : public ScanCellsEncoder {
+public:
+  virtual void encode(String &buf, const Hypertable::Cell &cell) {
+    SerializedCellsWriter::encode(buf, cell);
+  }
+};
+
 
 typedef Meta::list<ThriftBrokerPolicy, DefaultCommPolicy> Policies;
 
+/**
+ * Maps object ids handed out to clients to the objects.  The map is split
+ * into shards with a mutex each, so that requests on different scanners,
+ * mutators, etc. don't serialize on one lock.
+ */
+template <class ObjectT>
+class ObjectMap {
+public:
+  ObjectMap() : m_next_id(1) { }
+
+  void insert(::int64_t id, const ObjectT &obj) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    shard.map.insert(make_pair(id, obj)); // no overwrite
+  }
+
+  // returned id is guaranteed to be unique and non-zero
+  ::int64_t insert_next(const ObjectT &obj) {
+    ::int64_t id;
+    {
+      ScopedLock lock(m_id_mutex);
+      id = m_next_id++;
+    }
+    insert(id, obj);
+    return id;
+  }
+
+  bool get(::int64_t id, ObjectT &obj) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    typename Map::iterator it = shard.map.find(id);
+    if (it == shard.map.end())
+      return false;
+    obj = it->second;
+    return true;
+  }
+
+  bool remove(::int64_t id) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    return shard.map.erase(id) != 0;
+  }
+
+private:
+  enum { SHARD_BITS = 5 };
+
+  typedef hash_map< ::int64_t, ObjectT> Map;
+
+  struct Shard {
+    Mutex mutex;
+    Map   map;
+  };
+
+  // ids are either object addresses or sequence numbers, multiply to get
+  // both well distributed in the top bits
+  Shard &get_shard(::int64_t id) {
+    return m_shards[((::uint64_t)id * 0x9E3779B97F4A7C15ULL)
+                    >> (64 - SHARD_BITS)];
+  }
+
+  Shard     m_shards[1 << SHARD_BITS];
+  Mutex     m_id_mutex;
+  ::int64_t m_next_id;
+};
+
 typedef std::map<SharedMutatorMapKey, TableMutatorPtr> SharedMutatorMap;
-typedef hash_map< ::int64_t, TableScannerPtr> ScannerMap;
-typedef hash_map< ::int64_t, TableScannerAsyncPtr> ScannerAsyncMap;
-typedef hash_map< ::int64_t, ::int64_t> ReverseScannerAsyncMap;
-typedef hash_map< ::int64_t, TableMutatorPtr> MutatorMap;
-typedef hash_map< ::int64_t, TableMutatorAsyncPtr> MutatorAsyncMap;
-typedef hash_map< ::int64_t, NamespacePtr> NamespaceMap;
-typedef hash_map< ::int64_t, FuturePtr> FutureMap;
-typedef hash_map< ::int64_t, HqlInterpreterPtr> HqlInterpreterMap;
+typedef ObjectMap<TableScannerPtr> ScannerMap;
+typedef ObjectMap<TableScannerAsyncPtr> ScannerAsyncMap;
+typedef ObjectMap<TableMutatorPtr> MutatorMap;
+typedef ObjectMap<TableMutatorAsyncPtr> MutatorAsyncMap;
+typedef ObjectMap<NamespacePtr> NamespaceMap;
+typedef ObjectMap<FuturePtr> FutureMap;
+typedef ObjectMap<HqlInterpreterPtr> HqlInterpreterMap;
 typedef std::vector<ThriftGen::Cell> ThriftCells;
 typedef std::vector<CellAsArray> ThriftCellsAsArrays;
 
@@ -344,7 +421,7 @@ int32_t convert_cells(Hypertable::Cells &hcells, CellsSerialized &tcells) {
     writer.add(hcells[ii]);
   }
   writer.finalize(SerializedCellsFlag::EOS);
-  tcells = String((char *)writer.get_buffer(), writer.get_buffer_length());
+  writer.swap(tcells);
   amount = tcells.size();
   return amount;
 }
@@ -438,9 +515,8 @@ public:
   ServerHandler() {
     m_log_api = Config::get_bool("ThriftBroker.API.Logging");
     m_next_threshold = Config::get_i32("ThriftBroker.NextThreshold");
+    m_cells_encoder = new SerializedCellsEncoder();
     m_client = new Hypertable::Client();
-    m_next_namespace_id = 1;
-    m_next_future_id = 1;
     m_future_queue_size = Config::get_i32("ThriftBroker.Future.QueueSize");
   }
 
@@ -590,25 +666,17 @@ public:
 
     try {
       SerializedCellsWriter writer(m_next_threshold);
-      Hypertable::Cell cell;
-
       TableScannerPtr scanner = get_scanner(scanner_id);
 
-      while (1) {
-        if (scanner->next(cell)) {
-          if (!writer.add(cell)) {
-            writer.finalize(SerializedCellsFlag::EOB);
-            scanner->unget(cell);
-            break;
-          }
-        }
-        else {
-          writer.finalize(SerializedCellsFlag::EOS);
-          break;
-        }
-      }
+      // leave room for the termination byte
+      scanner->set_cells_encoder(m_cells_encoder);
+      if (scanner->next_encoded(writer.get_buffer_string(),
+                                m_next_threshold - 1))
+        writer.finalize(SerializedCellsFlag::EOB);
+      else
+        writer.finalize(SerializedCellsFlag::EOS);
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.swap(result);
       LOG_API("scanner="<< scanner_id <<" result.size="<< result.size());
     } RETHROW()
   }
@@ -669,7 +737,7 @@ public:
         }
       }
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.swap(result);
       LOG_API("scanner="<< scanner_id <<" result.size="<< result.size());
     } RETHROW()
   }
@@ -715,7 +783,7 @@ public:
         writer.add(cell);
       writer.finalize(SerializedCellsFlag::EOS);
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.swap(result);
       LOG_API("namespace=" << ns << " table="<< table <<" result.size="<< result.size());
     } RETHROW()
 
@@ -736,7 +804,7 @@ public:
       ss.max_versions = 1;
 
       Hypertable::Cell cell;
-      TableScannerPtr scanner = t->create_scanner(ss, 0, true);
+      TableScannerPtr scanner = t->create_scanner(ss);
 
       if (scanner->next(cell))
         result = String((char *)cell.value, cell.value_len);
@@ -777,13 +845,13 @@ public:
     try {
       SerializedCellsWriter writer(0, true);
       TableScannerPtr scanner = _open_scanner(ns, table, ss);
-      Hypertable::Cell cell;
 
-      while (scanner->next(cell))
-        writer.add(cell);
+      scanner->set_cells_encoder(m_cells_encoder);
+      while (scanner->next_encoded(writer.get_buffer_string(), SIZE_MAX))
+        ;
       writer.finalize(SerializedCellsFlag::EOS);
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.swap(result);
       LOG_API("namespace=" << ns << " table="<< table <<" result.size="<< result.size());
     } RETHROW()
 
@@ -1518,18 +1586,19 @@ public:
     TableScannerPtr scanner = t->create_scanner(ss);
     _next(result, scanner, INT32_MAX);
   }
-  HqlInterpreterPtr &get_hql_interp(const ThriftGen::Namespace ns) {
-    ScopedLock lock(m_interp_mutex);
-    HqlInterpreterMap::iterator iter = m_hql_interp_map.find(ns);
+  HqlInterpreterPtr get_hql_interp(const ThriftGen::Namespace ns) {
+    HqlInterpreterPtr interp;
 
-    if (iter == m_hql_interp_map.end()){
+    if (!m_hql_interp_map.get(ns, interp)) {
       NamespacePtr namespace_ptr = get_namespace(ns);
-      HqlInterpreterPtr interp = m_client->create_hql_interpreter(true);
+      interp = m_client->create_hql_interpreter(true);
       interp->set_namespace(namespace_ptr->get_name());
-      m_hql_interp_map[ns] = interp;
+      // a concurrent request may have won the race, use its interpreter
+      m_hql_interp_map.insert(ns, interp);
+      m_hql_interp_map.get(ns, interp);
     }
 
-    return m_hql_interp_map.find(ns)->second;
+    return interp;
   }
 
   template <class CellT>
@@ -1583,11 +1652,10 @@ public:
   }
 
   FuturePtr get_future(::int64_t id) {
-    ScopedLock lock(m_future_mutex);
-    FutureMap::iterator it = m_future_map.find(id);
+    FuturePtr future;
 
-    if (it != m_future_map.end())
-      return it->second;
+    if (m_future_map.get(id, future))
+      return future;
 
     HT_ERROR_OUT << "Bad future id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_FUTURE_ID,
@@ -1596,12 +1664,11 @@ public:
   }
 
 
-  NamespacePtr& get_namespace(::int64_t id) {
-    ScopedLock lock(m_namespace_mutex);
-    NamespaceMap::iterator it = m_namespace_map.find(id);
+  NamespacePtr get_namespace(::int64_t id) {
+    NamespacePtr ns;
 
-    if (it != m_namespace_map.end())
-      return it->second;
+    if (m_namespace_map.get(id, ns))
+      return ns;
 
     HT_ERROR_OUT << "Bad namespace id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_NAMESPACE_ID,
@@ -1611,52 +1678,30 @@ public:
 
   // returned id is guaranteed to be unique and non-zero
   ::int64_t get_future_id(FuturePtr *ff) {
-    ScopedLock lock(m_future_mutex);
-    ::int64_t id = m_next_future_id;
-    m_next_future_id++;
-    m_future_map.insert(make_pair(id, *ff)); // no overwrite
-    return id;
+    return m_future_map.insert_next(*ff);
   }
 
 
   // returned id is guaranteed to be unique and non-zero
   ::int64_t get_namespace_id(NamespacePtr *ns) {
-    ScopedLock lock(m_namespace_mutex);
-    // generate unique random 64 bit int id
     // TODO make id random for security reasons
     //::int64_t id = Random::number64();
-    ::int64_t id = m_next_namespace_id++;
-
-    // TODO make id random for security reasons
-    //while (m_namespace_map.find(id) != m_namespace_map.end() || id == 0) {
-    //  id = Random::number64();
-    //}
-    m_namespace_map.insert(make_pair(id, *ns)); // no overwrite
-    return id;
+    return m_namespace_map.insert_next(*ns);
   }
 
+  // the id is the scanner address, so a scanner that is already in the
+  // map gets the same id again
   ::int64_t get_scanner_async_id(TableScannerAsync *scanner) {
-    ScopedLock lock(m_scanner_async_mutex);
     ::int64_t id = (::int64_t)scanner;
-
-    // if scanner is already in map then return id by reverse lookup
-    ReverseScannerAsyncMap::iterator it =
-        m_reverse_scanner_async_map.find((::int64_t)scanner);
-    if (it != m_reverse_scanner_async_map.end())
-      id = it->second;
-    else {
-      m_scanner_async_map.insert(make_pair(id, scanner)); // no overwrite
-      m_reverse_scanner_async_map.insert(make_pair((::int64_t)scanner, id));
-    }
+    m_scanner_async_map.insert(id, scanner); // no overwrite
     return id;
   }
 
   TableScannerAsyncPtr get_scanner_async(::int64_t id) {
-    ScopedLock lock(m_scanner_async_mutex);
-    ScannerAsyncMap::iterator it = m_scanner_async_map.find(id);
+    TableScannerAsyncPtr scanner;
 
-    if (it != m_scanner_async_map.end())
-      return it->second;
+    if (m_scanner_async_map.get(id, scanner))
+      return scanner;
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1664,18 +1709,16 @@ public:
   }
 
   ::int64_t get_scanner_id(TableScanner *scanner) {
-    ScopedLock lock(m_scanner_mutex);
     ::int64_t id = (::int64_t)scanner;
-    m_scanner_map.insert(make_pair(id, scanner)); // no overwrite
+    m_scanner_map.insert(id, scanner); // no overwrite
     return id;
   }
 
   TableScannerPtr get_scanner(::int64_t id) {
-    ScopedLock lock(m_scanner_mutex);
-    ScannerMap::iterator it = m_scanner_map.find(id);
+    TableScannerPtr scanner;
 
-    if (it != m_scanner_map.end())
-      return it->second;
+    if (m_scanner_map.get(id, scanner))
+      return scanner;
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1683,13 +1726,8 @@ public:
   }
 
   void remove_scanner(::int64_t id) {
-    ScopedLock lock(m_scanner_mutex);
-    ScannerMap::iterator it = m_scanner_map.find(id);
-
-    if (it != m_scanner_map.end()) {
-      m_scanner_map.erase(it);
+    if (m_scanner_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1697,16 +1735,8 @@ public:
   }
 
   void remove_scanner_async(::int64_t id) {
-    ScopedLock lock(m_scanner_async_mutex);
-    ScannerAsyncMap::iterator it = m_scanner_async_map.find(id);
-    ::int64_t scanner_async=0;
-
-    if (it != m_scanner_async_map.end()) {
-      scanner_async = (::int64_t)(it->second.get());
-      m_scanner_async_map.erase(it);
-      m_reverse_scanner_async_map.erase(scanner_async);
+    if (m_scanner_async_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1714,16 +1744,14 @@ public:
   }
 
   ::int64_t get_mutator_id(TableMutator *mutator) {
-    ScopedLock lock(m_mutator_mutex);
     ::int64_t id = (::int64_t)mutator;
-    m_mutator_map.insert(make_pair(id, mutator)); // no overwrite
+    m_mutator_map.insert(id, mutator); // no overwrite
     return id;
   }
 
   ::int64_t get_mutator_async_id(TableMutatorAsync *mutator) {
-    ScopedLock lock(m_mutator_async_mutex);
     ::int64_t id = (::int64_t)mutator;
-    m_mutator_async_map.insert(make_pair(id, mutator)); // no overwrite
+    m_mutator_async_map.insert(id, mutator); // no overwrite
     return id;
   }
 
@@ -1777,11 +1805,10 @@ public:
   }
 
   TableMutatorPtr get_mutator(::int64_t id) {
-    ScopedLock lock(m_mutator_mutex);
-    MutatorMap::iterator it = m_mutator_map.find(id);
+    TableMutatorPtr mutator;
 
-    if (it != m_mutator_map.end())
-      return it->second;
+    if (m_mutator_map.get(id, mutator))
+      return mutator;
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1789,11 +1816,10 @@ public:
   }
 
   TableMutatorAsyncPtr get_mutator_async(::int64_t id) {
-    ScopedLock lock(m_mutator_async_mutex);
-    MutatorAsyncMap::iterator it = m_mutator_async_map.find(id);
+    TableMutatorAsyncPtr mutator;
 
-    if (it != m_mutator_async_map.end())
-      return it->second;
+    if (m_mutator_async_map.get(id, mutator))
+      return mutator;
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1801,13 +1827,8 @@ public:
   }
 
   void remove_future_from_map(::int64_t id) {
-    ScopedLock lock(m_future_mutex);
-    FutureMap::iterator it = m_future_map.find(id);
-
-    if (it != m_future_map.end()) {
-      m_future_map.erase(it);
+    if (m_future_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad future id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_FUTURE_ID,
@@ -1815,13 +1836,8 @@ public:
   }
 
   void remove_namespace_from_map(::int64_t id) {
-    ScopedLock lock(m_namespace_mutex);
-    NamespaceMap::iterator it = m_namespace_map.find(id);
-
-    if (it != m_namespace_map.end()) {
-      m_namespace_map.erase(it);
+    if (m_namespace_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad namespace id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_NAMESPACE_ID,
@@ -1830,13 +1846,8 @@ public:
 
 
   void remove_mutator(::int64_t id) {
-    ScopedLock lock(m_mutator_mutex);
-    MutatorMap::iterator it = m_mutator_map.find(id);
-
-    if (it != m_mutator_map.end()) {
-      m_mutator_map.erase(it);
+    if (m_mutator_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1844,13 +1855,8 @@ public:
   }
 
   void remove_mutator_async(::int64_t id) {
-    ScopedLock lock(m_mutator_async_mutex);
-    MutatorAsyncMap::iterator it = m_mutator_async_map.find(id);
-
-    if (it != m_mutator_async_map.end()) {
-      m_mutator_async_map.erase(it);
+    if (m_mutator_async_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1859,27 +1865,18 @@ public:
 
 private:
   bool             m_log_api;
-  Mutex            m_scanner_mutex;
   ScannerMap       m_scanner_map;
-  Mutex            m_mutator_mutex;
-  Mutex            m_mutator_async_mutex;
   MutatorMap       m_mutator_map;
   MutatorAsyncMap  m_mutator_async_map;
   Mutex            m_shared_mutator_mutex;
-  ::int64_t        m_next_namespace_id;
   NamespaceMap     m_namespace_map;
-  Mutex            m_namespace_mutex;
   ScannerAsyncMap  m_scanner_async_map;
-  ReverseScannerAsyncMap m_reverse_scanner_async_map;
-  Mutex            m_scanner_async_mutex;
-  ::int64_t        m_next_future_id;
   FutureMap        m_future_map;
-  Mutex            m_future_mutex;
   ::int32_t        m_future_queue_size;
   SharedMutatorMap m_shared_mutator_map;
   ::int32_t        m_next_threshold;
+  ScanCellsEncoderPtr m_cells_encoder;
   ClientPtr        m_client;
-  Mutex            m_interp_mutex;
   HqlInterpreterMap m_hql_interp_map;
 };
 
@@ -1933,10 +1930,37 @@ int main(int argc, char **argv) {
       properties->set("Hyperspace.Session.Reconnect", true);
 
     ::uint16_t port = get_i16("port");
+    String server_type = get_str("ThriftBroker.Server");
     boost::shared_ptr<TProtocolFactory> protocolFactory(new TBinaryProtocolFactory());
     boost::shared_ptr<ServerHandler> handler(new ServerHandler());
     boost::shared_ptr<TProcessor> processor(new HqlServiceProcessor(handler));
 
+    if (server_type == "nonblocking") {
+      // Connections are multiplexed on a libevent loop and requests are
+      // handed to a fixed pool of workers, rather than tying up a thread
+      // for the lifetime of each connection.  Clients already use framed
+      // transport, which is what this server speaks.
+      int workers = get_i32("workers");
+      boost::shared_ptr<ThreadManager> threadManager =
+          ThreadManager::newSimpleThreadManager(workers);
+      threadManager->threadFactory(
+          boost::shared_ptr<PosixThreadFactory>(new PosixThreadFactory()));
+      threadManager->start();
+
+      if (has("thrift-timeout"))
+        HT_WARN("thrift-timeout is ignored by the nonblocking server");
+
+      TNonblockingServer server(processor, protocolFactory, port, threadManager);
+
+      HT_INFOF("Starting the nonblocking server with %d workers...", workers);
+      server.serve();
+      HT_INFO("Exiting.\n");
+      return 0;
+    }
+    else if (server_type != "threaded")
+      HT_THROWF(Error::CONFIG_BAD_VALUE, "Invalid ThriftBroker.Server type "
+                "'%s', expected 'threaded' or 'nonblocking'", server_type.c_str());
+
     boost::shared_ptr<TServerTransport> serverTransport;
 
     if (has("thrift-timeout")) {
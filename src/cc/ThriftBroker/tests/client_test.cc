@@ -367,6 +367,7 @@ struct BasicTest : HqlServiceIf {
       test_put();
       test_scan(out);
       test_async(out);
+      test_scan_serialized(out);
       test_rename_alter(out);
     }
     catch (ClientException &e) {
@@ -404,6 +405,118 @@ struct BasicTest : HqlServiceIf {
     close_namespace(ns);
   }
 
+  static void append_cell(std::vector<std::string> &result, const char *row,
+                          const char *cf, const char *cq, int64_t ts,
+                          const void *value, size_t value_len) {
+    result.push_back(format("%s %s:%s %lld ", row, cf, cq ? cq : "",
+                            (Lld)ts) + std::string((const char *)value, value_len));
+  }
+
+  static void append_serialized(std::vector<std::string> &result,
+                                CellsSerialized &serialized, bool *eos) {
+    SerializedCellsReader reader((void *)serialized.c_str(),
+                                 (uint32_t)serialized.length());
+    while (reader.next())
+      append_cell(result, reader.row(), reader.column_family(),
+                  reader.column_qualifier(), reader.timestamp(),
+                  reader.value(), reader.value_len());
+    if (eos)
+      *eos = reader.eos();
+  }
+
+  void check_cells(std::ostream &out, const char *label,
+                   const std::vector<std::string> &expected,
+                   const std::vector<std::string> &result) {
+    if (result.size() != expected.size()) {
+      out << label << ": expected " << expected.size() << " cells, received "
+          << result.size() << std::endl;
+      _exit(1);
+    }
+    for (size_t i=0; i<expected.size(); i++) {
+      if (result[i] != expected[i]) {
+        out << label << ": cell " << i << " mismatch, expected '" << expected[i]
+            << "' received '" << result[i] << "'" << std::endl;
+        _exit(1);
+      }
+    }
+  }
+
+  void test_scan_serialized(std::ostream &out) {
+    HqlResult result;
+    Namespace ns = open_namespace("test");
+    hql_query(result, ns, "drop table if exists thrift_serialized");
+    hql_query(result, ns, "create table thrift_serialized ( a, b )");
+
+    // enough data to span several next_cells_serialized() chunks
+    std::vector<Cell> cells;
+    std::string value(200, 'x');
+    char row[32], cq[32];
+    Mutator m = open_mutator(ns, "thrift_serialized", 0);
+    for (int i=0; i<4000; i++) {
+      sprintf(row, "row%05d", i/2);
+      sprintf(cq, "q%d", i%3);
+      value[0] = 'a' + (i % 26);
+      cells.push_back(make_cell(row, (i%2) ? "a" : "b", (i%3) ? cq : 0, value));
+    }
+    set_cells(m, cells);
+    close_mutator(m, true);
+
+    std::vector<std::string> expected, serialized;
+    ScanSpec ss;
+    Scanner s = open_scanner(ns, "thrift_serialized", ss);
+    do {
+      next_cells(cells, s);
+      foreach(const Cell &cell, cells)
+        append_cell(expected, cell.key.row.c_str(),
+                    cell.key.column_family.c_str(),
+                    cell.key.column_qualifier.c_str(), cell.key.timestamp,
+                    cell.value.data(), cell.value.size());
+    } while (cells.size());
+    close_scanner(s);
+
+    CellsSerialized buf;
+    bool eos = false;
+    s = open_scanner(ns, "thrift_serialized", ss);
+    while (!eos) {
+      next_cells_serialized(buf, s);
+      append_serialized(serialized, buf, &eos);
+    }
+    close_scanner(s);
+    check_cells(out, "next_cells_serialized", expected, serialized);
+
+    serialized.clear();
+    get_cells_serialized(buf, ns, "thrift_serialized", ss);
+    append_serialized(serialized, buf, 0);
+    check_cells(out, "get_cells_serialized", expected, serialized);
+
+    // alternate between the Cell and serialized paths on one scanner
+    serialized.clear();
+    eos = false;
+    s = open_scanner(ns, "thrift_serialized", ss);
+    for (size_t i=0; !eos; i++) {
+      if (i % 2) {
+        next_cells_serialized(buf, s);
+        append_serialized(serialized, buf, &eos);
+      }
+      else {
+        next_cells(cells, s);
+        foreach(const Cell &cell, cells)
+          append_cell(serialized, cell.key.row.c_str(),
+                      cell.key.column_family.c_str(),
+                      cell.key.column_qualifier.c_str(), cell.key.timestamp,
+                      cell.value.data(), cell.value.size());
+      }
+    }
+    close_scanner(s);
+    check_cells(out, "mixed next_cells/next_cells_serialized", expected,
+                serialized);
+
+    out << "Serialized scans returned " << expected.size() << " cells"
+        << std::endl;
+    hql_query(result, ns, "drop table thrift_serialized");
+    close_namespace(ns);
+  }
+
   void test_hql(std::ostream &out) {
     HqlResult result;
     if (!exists_namespace("test"))
@@ -55,14 +55,52 @@ int main(int argc, char **argv) {
 
     RangeServerClient *client = new RangeServerClient(comm, timeout);
     StatsRangeServer stats;
-    String stats_str;
 
     client->get_statistics(addr, stats);
-    /** FIXME!!
-    stats->dump_str(stats_str);
 
-    std::cout << stats_str << std::endl;
-    */
+    std::cout << "location=" << stats.location << "\n";
+    std::cout << "range_count=" << stats.range_count << "\n";
+    std::cout << "scanner_count=" << stats.scanner_count << "\n";
+    std::cout << "file_count=" << stats.file_count << "\n";
+    std::cout << "scan_count=" << stats.scan_count << "\n";
+    std::cout << "update_count=" << stats.update_count << "\n";
+    std::cout << "tracked_memory=" << stats.tracked_memory << "\n";
+    std::cout << "block_cache_max_memory=" << stats.block_cache_max_memory << "\n";
+    std::cout << "block_cache_available_memory=" << stats.block_cache_available_memory << "\n";
+    std::cout << "block_cache_accesses=" << stats.block_cache_accesses << "\n";
+    std::cout << "block_cache_hits=" << stats.block_cache_hits << "\n";
+    std::cout << "query_cache_max_memory=" << stats.query_cache_max_memory << "\n";
+    std::cout << "query_cache_available_memory=" << stats.query_cache_available_memory << "\n";
+    std::cout << "query_cache_accesses=" << stats.query_cache_accesses << "\n";
+    std::cout << "query_cache_hits=" << stats.query_cache_hits << "\n";
+    std::cout << "wire_update_raw_bytes=" << stats.wire_update_raw_bytes << "\n";
+    std::cout << "wire_update_bytes=" << stats.wire_update_bytes << "\n";
+    std::cout << "wire_scan_raw_bytes=" << stats.wire_scan_raw_bytes << "\n";
+    std::cout << "wire_scan_bytes=" << stats.wire_scan_bytes << "\n";
+    std::cout << "wire_client_update_raw_bytes=" << stats.wire_client_update_raw_bytes << "\n";
+    std::cout << "wire_client_update_bytes=" << stats.wire_client_update_bytes << "\n";
+    std::cout << "wire_client_scan_raw_bytes=" << stats.wire_client_scan_raw_bytes << "\n";
+    std::cout << "wire_client_scan_bytes=" << stats.wire_client_scan_bytes << "\n";
+    std::cout << "cell_cache_memory=" << stats.cell_cache_memory << "\n";
+    std::cout << "block_index_memory=" << stats.block_index_memory << "\n";
+    std::cout << "bloom_filter_memory=" << stats.bloom_filter_memory << "\n";
+    std::cout << "shadow_cache_memory=" << stats.shadow_cache_memory << "\n";
+    std::cout << "idle_index_memory=" << stats.idle_index_memory << "\n";
+    std::cout << "memory_governor_block_cache_limit=" << stats.block_cache_limit << "\n";
+    std::cout << "memory_governor_query_cache_limit=" << stats.query_cache_limit << "\n";
+    std::cout << "memory_governor_rebalances=" << stats.memory_rebalances << "\n";
+    std::cout << "memory_governor_rebalanced_bytes=" << stats.memory_rebalanced_bytes << "\n";
+    std::cout << "memory_governor_last_decision=" << stats.memory_governor_decision << "\n";
+    std::cout << "maintenance_passes=" << stats.maintenance_passes << "\n";
+    std::cout << "maintenance_time_us=" << stats.maintenance_time << "\n";
+    std::cout << "maintenance_last_time_us=" << stats.maintenance_last_time << "\n";
+    std::cout << "maintenance_last_gather_time_us=" << stats.maintenance_last_gather_time << "\n";
+    std::cout << "maintenance_last_prioritize_time_us=" << stats.maintenance_last_prioritize_time << "\n";
+    std::cout << "maintenance_ranges_gathered=" << stats.maintenance_ranges_gathered << "\n";
+    std::cout << "maintenance_ranges_reused=" << stats.maintenance_ranges_reused << "\n";
+    std::cout << "update_throttle_updates=" << stats.throttled_updates << "\n";
+    std::cout << "update_throttle_delay_ms=" << stats.throttle_delay_time << "\n";
+    std::cout << "update_throttle_drain_rate=" << stats.throttle_drain_rate << std::endl;
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
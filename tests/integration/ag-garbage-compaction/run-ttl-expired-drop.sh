@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+HYPERTABLE_HOME=${HT_HOME}
+PIDFILE=$HT_HOME/run/Hypertable.RangeServer.pid
+HT_SHELL=$HT_HOME/bin/hypertable
+SCRIPT_DIR=`dirname $0`
+TTL=30
+
+. $HT_HOME/bin/ht-env.sh
+
+# Prints cells in .tsv form: gen_cells <timestamp> <row-prefix> <count>
+gen_cells() {
+  local value=`printf "%01000d" 0`
+  for ((i=0; i<$3; i++)) ; do
+    printf "%s\t%s%06d\tField\t%s\n" "$1" $2 $i $value
+  done
+}
+
+$HT_HOME/bin/start-test-servers.sh --no-rangeserver --no-thriftbroker --clear
+
+# Keep GC compactions out of the way so that only the drop path can remove
+# the CellStore
+$HT_HOME/bin/Hypertable.RangeServer --verbose --pidfile=$PIDFILE \
+    --Hypertable.RangeServer.Range.SplitSize=10000000 \
+    --Hypertable.RangeServer.AccessGroup.GarbageThreshold.Percentage=90 \
+    --Hypertable.RangeServer.Maintenance.Interval=100 \
+    --Hypertable.RangeServer.Timer.Interval=100 \
+    --Hypertable.RangeServer.AccessGroup.MaxMemory=250000 \
+    $@ > rangeserver.output 2>&1 &
+
+echo "use '/'; create table LoadTest ( Field TTL=$TTL);" | $HT_SHELL --batch
+
+# Every cell is long past the TTL, so the CellStore written by the minor
+# compaction has expired as a whole
+echo -e "#timestamp\trow\tcolumn\tvalue" > expired.tsv
+gen_cells "2001-01-01 00:00:00" old 400 >> expired.tsv
+
+echo "use '/'; load data infile 'expired.tsv' into table LoadTest;" | \
+    $HT_SHELL --batch
+
+sleep 10
+
+fgrep "Dropped" rangeserver.output | fgrep "expired CellStores"
+if [ $? != 0 ] ; then
+  echo "Expired CellStore was not dropped"
+  exit 1
+fi
+
+lines=`echo "use 'sys'; select Files from METADATA where ROW =^ '1:' REVS=1;" | $HT_SHELL --batch | fgrep "/cs" | wc -l`
+n=`echo $lines | tr -d " "`
+if [ $n != "0" ] ; then
+  echo "Expired CellStore still listed in the Files column ($n)"
+  exit 1
+fi
+
+lines=`echo "use '/'; select * from LoadTest;" | $HT_SHELL --batch | wc -l`
+n=`echo $lines | tr -d " "`
+if [ $n != "0" ] ; then
+  echo "Data ($n cells) still remaining in LoadTest"
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+HYPERTABLE_HOME=${HT_HOME}
+PIDFILE=$HT_HOME/run/Hypertable.RangeServer.pid
+HT_SHELL=$HT_HOME/bin/hypertable
+SCRIPT_DIR=`dirname $0`
+TTL=30
+
+. $HT_HOME/bin/ht-env.sh
+
+# Prints cells in .tsv form: gen_cells <timestamp> <row-prefix> <count>
+gen_cells() {
+  local value=`printf "%01000d" 0`
+  for ((i=0; i<$3; i++)) ; do
+    printf "%s\t%s%06d\tField\t%s\n" "$1" $2 $i $value
+  done
+}
+
+$HT_HOME/bin/start-test-servers.sh --no-rangeserver --no-thriftbroker --clear
+
+# Keep GC compactions out of the way so that only the drop path can remove
+# the CellStore
+$HT_HOME/bin/Hypertable.RangeServer --verbose --pidfile=$PIDFILE \
+    --Hypertable.RangeServer.Range.SplitSize=10000000 \
+    --Hypertable.RangeServer.AccessGroup.GarbageThreshold.Percentage=90 \
+    --Hypertable.RangeServer.Maintenance.Interval=100 \
+    --Hypertable.RangeServer.Timer.Interval=100 \
+    --Hypertable.RangeServer.AccessGroup.MaxMemory=250000 \
+    $@ > rangeserver.output 2>&1 &
+
+echo "use '/'; create table LoadTest ( Field TTL=$TTL);" | $HT_SHELL --batch
+
+# The CellStore written by the minor compaction holds cells long past the
+# TTL as well as fresh ones, so it has only partially expired
+now=`date "+%Y-%m-%d %H:%M:%S"`
+echo -e "#timestamp\trow\tcolumn\tvalue" > partial.tsv
+gen_cells "2001-01-01 00:00:00" old 200 >> partial.tsv
+gen_cells "$now" new 200 >> partial.tsv
+
+echo "use '/'; load data infile 'partial.tsv' into table LoadTest;" | \
+    $HT_SHELL --batch
+
+sleep 10
+
+fgrep "Dropped" rangeserver.output | fgrep "expired CellStores"
+if [ $? == 0 ] ; then
+  echo "Partially expired CellStore was dropped"
+  exit 1
+fi
+
+lines=`echo "use 'sys'; select Files from METADATA where ROW =^ '1:' REVS=1;" | $HT_SHELL --batch | fgrep "/cs" | wc -l`
+n=`echo $lines | tr -d " "`
+if [ $n == "0" ] ; then
+  echo "Partially expired CellStore missing from the Files column"
+  exit 1
+fi
+
+# Only the fresh cells are returned
+lines=`echo "use '/'; select * from LoadTest;" | $HT_SHELL --batch | wc -l`
+n=`echo $lines | tr -d " "`
+if [ $n != "200" ] ; then
+  echo "Expected 200 cells in LoadTest, got $n"
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+NUM_ROWS=${NUM_ROWS:-"50000"}
+
+$HT_HOME/bin/start-test-servers.sh --clear --no-thriftbroker
+
+$HT_HOME/bin/ht shell --no-prompt < $SCRIPT_DIR/create-table.hql
+
+# Every row is written once with value "old" and the first half of the
+# rows again with value "new".  The small buffer size puts the second copy
+# in a later spill than the first, so the final merge must drop the old one.
+awk -v n=$NUM_ROWS 'BEGIN {
+  print "#row\tcolumn\tvalue";
+  for (i=0; i<n; i++) {
+    printf("row%08d\ta\told-%d\n", i, i);
+    printf("row%08d\tb\told-%d\n", i, i);
+  }
+  for (i=0; i<n/2; i++) {
+    printf("row%08d\ta\tnew-%d\n", i, i);
+    printf("row%08d\tb\tnew-%d\n", i, i);
+  }
+}' > bulk-load.tsv
+
+awk -v n=$NUM_ROWS 'BEGIN {
+  for (i=0; i<n; i++) {
+    v = (i < n/2) ? "new" : "old";
+    printf("row%08d\ta\t%s-%d\n", i, v, i);
+    printf("row%08d\tb\t%s-%d\n", i, v, i);
+  }
+}' > bulk-load.golden
+
+$HT_HOME/bin/ht csbuild --buffer-size=200000 BulkLoad bulk-load.tsv
+
+if [ $? != 0 ] ; then
+  echo "csbuild failed"
+  exit 1
+fi
+
+echo "USE '/'; SELECT * FROM BulkLoad;" | $HT_HOME/bin/ht shell --batch \
+    > bulk-load.output
+
+diff bulk-load.output bulk-load.golden > /dev/null
+if [ $? != 0 ] ; then
+  echo "Bulk loaded cells differ from the expected cells"
+  exit 1
+fi
+
+# The adopted cells must survive a compaction and a restart
+echo "USE '/'; COMPACT TABLE BulkLoad;" | $HT_HOME/bin/ht shell --batch
+sleep 5
+$HT_HOME/bin/start-test-servers.sh --no-thriftbroker
+
+echo "USE '/'; SELECT * FROM BulkLoad;" | $HT_HOME/bin/ht shell --batch \
+    > bulk-load.output
+
+diff bulk-load.output bulk-load.golden > /dev/null
+if [ $? != 0 ] ; then
+  echo "Bulk loaded cells differ from the expected cells after restart"
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+NUM_ROWS=${NUM_ROWS:-"20000"}
+DUMP_DIR=`pwd`/dump-table-parallel
+
+# A small split size, so that the table has several ranges to dump
+$HT_HOME/bin/start-test-servers.sh --clear --no-thriftbroker \
+   --Hypertable.RangeServer.Maintenance.Interval 100 \
+   --Hypertable.RangeServer.Range.SplitSize=300K
+
+$HT_HOME/bin/ht shell --no-prompt < $SCRIPT_DIR/create-table.hql
+
+awk -v n=$NUM_ROWS 'BEGIN {
+  print "#timestamp\trow\tcolumn\tvalue";
+  for (i=0; i<n; i++) {
+    printf("2012-01-01 00:00:01\trow%08d\ta:x\tvalue-%d-%s\n", i, i,
+           "abcdefghijklmnopqrstuvwxyz0123456789");
+    printf("2012-01-01 00:00:02\trow%08d\tb\tvalue-%d\n", i, i);
+  }
+}' > dump-source.tsv
+
+echo "USE '/'; LOAD DATA INFILE 'dump-source.tsv' INTO TABLE DumpSource;" | \
+    $HT_HOME/bin/ht shell --batch
+
+# wait for the splits
+sleep 10
+
+rm -rf $DUMP_DIR
+echo "USE '/'; DUMP TABLE DumpSource PARALLEL 4 INTO FILE 'file://$DUMP_DIR';" | \
+    $HT_HOME/bin/ht shell --batch
+
+if [ $? != 0 ] ; then
+  echo "DUMP TABLE ... PARALLEL into a local directory failed"
+  exit 1
+fi
+
+PARTS=`grep -c '^part-' $DUMP_DIR/MANIFEST`
+if [ -z "$PARTS" ] || [ $PARTS -lt 2 ] ; then
+  echo "Expected the dump to have several parts, manifest lists '$PARTS'"
+  exit 1
+fi
+
+echo "USE '/'; DUMP TABLE DumpSource PARALLEL 4 INTO FILE 'dfs:///dump-table-parallel.gz';" | \
+    $HT_HOME/bin/ht shell --batch
+
+if [ $? != 0 ] ; then
+  echo "DUMP TABLE ... PARALLEL into the DFS failed"
+  exit 1
+fi
+
+# Restore from the manifests, each in a new shell
+echo "USE '/'; LOAD DATA INFILE '$DUMP_DIR/MANIFEST' INTO TABLE DumpRestore;" | \
+    $HT_HOME/bin/ht shell --batch \
+    --Hypertable.HqlInterpreter.LoadData.Threads=4
+
+if [ $? != 0 ] ; then
+  echo "Restore from the local manifest failed"
+  exit 1
+fi
+
+echo "USE '/'; LOAD DATA INFILE 'dfs:///dump-table-parallel/MANIFEST' INTO TABLE DumpRestoreDfs;" | \
+    $HT_HOME/bin/ht shell --batch
+
+if [ $? != 0 ] ; then
+  echo "Restore from the DFS manifest failed"
+  exit 1
+fi
+
+for table in DumpSource DumpRestore DumpRestoreDfs ; do
+  echo "USE '/'; SELECT * FROM $table DISPLAY_TIMESTAMPS;" | \
+      $HT_HOME/bin/ht shell --batch > $table.output
+done
+
+CELLS=`cat DumpSource.output | wc -l`
+if [ $CELLS != $((NUM_ROWS * 2)) ] ; then
+  echo "Source table has $CELLS cells, expected $((NUM_ROWS * 2))"
+  exit 1
+fi
+
+diff DumpSource.output DumpRestore.output > /dev/null
+if [ $? != 0 ] ; then
+  echo "Cells restored from the local dump differ from the source table"
+  exit 1
+fi
+
+diff DumpSource.output DumpRestoreDfs.output > /dev/null
+if [ $? != 0 ] ; then
+  echo "Cells restored from the DFS dump differ from the source table"
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+NUM_ROWS=${NUM_ROWS:-"20000"}
+
+$HT_HOME/bin/start-test-servers.sh --clear --no-thriftbroker
+
+$HT_HOME/bin/ht shell --no-prompt < $SCRIPT_DIR/create-table.hql
+
+# Every row gets two qualified cells in column a and one cell in column b.
+# Every seventh row also gets an older version of its column b cell,
+# written at the end of the file so that it lands in a different chunk.
+# The explicit timestamps keep the result independent of the order in
+# which the loader threads apply the chunks.
+awk -v n=$NUM_ROWS 'BEGIN {
+  print "#timestamp\trow\tcolumn\tvalue";
+  for (i=0; i<n; i++) {
+    printf("2012-01-01 00:00:02\trow%08d\ta:x\tvalue-x-%d-%s\n", i, i,
+           "abcdefghijklmnopqrstuvwxyz");
+    printf("2012-01-01 00:00:02\trow%08d\ta:y\tvalue-y-%d\n", i, i);
+    printf("2012-01-01 00:00:02\trow%08d\tb\tnew-%d\n", i, i);
+  }
+  for (i=0; i<n; i+=7)
+    printf("2012-01-01 00:00:01\trow%08d\tb\told-%d\n", i, i);
+}' > load-data.tsv
+
+EXPECTED_CELLS=`tail -n +2 load-data.tsv | wc -l`
+
+echo "USE '/'; LOAD DATA INFILE 'load-data.tsv' INTO TABLE LoadSerial;" | \
+    $HT_HOME/bin/ht shell --batch \
+    --Hypertable.HqlInterpreter.LoadData.Threads=1
+
+if [ $? != 0 ] ; then
+  echo "Serial LOAD DATA INFILE failed"
+  exit 1
+fi
+
+# Small chunks, so that every thread loads many of them
+echo "USE '/'; LOAD DATA INFILE 'load-data.tsv' INTO TABLE LoadParallel;" | \
+    $HT_HOME/bin/ht shell --batch \
+    --Hypertable.HqlInterpreter.LoadData.Threads=4 \
+    --Hypertable.HqlInterpreter.LoadData.ChunkSize=65536
+
+if [ $? != 0 ] ; then
+  echo "Parallel LOAD DATA INFILE failed"
+  exit 1
+fi
+
+echo "USE '/'; SELECT * FROM LoadSerial DISPLAY_TIMESTAMPS;" | \
+    $HT_HOME/bin/ht shell --batch > load-serial.output
+echo "USE '/'; SELECT * FROM LoadParallel DISPLAY_TIMESTAMPS;" | \
+    $HT_HOME/bin/ht shell --batch > load-parallel.output
+
+CELLS=`cat load-serial.output | wc -l`
+if [ $CELLS != $EXPECTED_CELLS ] ; then
+  echo "Serial load returned $CELLS cells, expected $EXPECTED_CELLS"
+  exit 1
+fi
+
+CELLS=`cat load-parallel.output | wc -l`
+if [ $CELLS != $EXPECTED_CELLS ] ; then
+  echo "Parallel load returned $CELLS cells, expected $EXPECTED_CELLS"
+  exit 1
+fi
+
+ROWS=`echo "USE '/'; SELECT b FROM LoadParallel KEYS_ONLY MAX_VERSIONS 1;" | \
+    $HT_HOME/bin/ht shell --batch | wc -l`
+if [ $ROWS != $NUM_ROWS ] ; then
+  echo "Parallel load returned $ROWS rows, expected $NUM_ROWS"
+  exit 1
+fi
+
+diff load-serial.output load-parallel.output > /dev/null
+if [ $? != 0 ] ; then
+  echo "Cells loaded with several threads differ from the serial load"
+  exit 1
+fi
+
+exit 0
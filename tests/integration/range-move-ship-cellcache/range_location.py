@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+
+import sys
+from hypertable.thriftclient import *
+from hyperthrift.gen.ttypes import *
+
+if (len(sys.argv) < 2):
+  print sys.argv[0], "<table> [<destination>]"
+  sys.exit(1);
+
+table = sys.argv[1]
+
+try:
+  client = ThriftClient("localhost", 38080)
+
+  namespace = client.open_namespace("/")
+  table_id = client.get_table_id(namespace, table)
+  client.close_namespace(namespace)
+
+  namespace = client.open_namespace("/sys")
+  scanner = client.open_scanner(namespace, "METADATA",
+                                ScanSpec([RowInterval(table_id + ":", True,
+                                                      table_id + ":\xff\xff", True)],
+                                         None, None, 1, 0, None, None,
+                                         ["Location"]));
+  cells = client.next_cells(scanner)
+  client.close_scanner(scanner)
+  client.close_namespace(namespace)
+
+  if len(cells) != 1:
+    print "Expected a single range for %s, found %d" % (table, len(cells))
+    sys.exit(1)
+
+  location = cells[0].value
+  end_row = cells[0].key.row[len(table_id)+1:]
+
+  # Without a destination, print where the range lives, otherwise print the
+  # HQL that moves it there
+  if len(sys.argv) < 3:
+    print location
+  else:
+    print 'balance (\"%s\"[..\"%s\"], \"%s\", \"%s\") duration=2;' % (table_id, end_row, location, sys.argv[2])
+
+except ClientException, e:
+  print '%s' % (e.message)
+  sys.exit(1)
@@ -0,0 +1,104 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+NUM_ROWS=2000
+RS1_PIDFILE=$HT_HOME/run/Hypertable.RangeServer.rs1.pid
+RS2_PIDFILE=$HT_HOME/run/Hypertable.RangeServer.rs2.pid
+
+# The range neither splits nor compacts, so all of its cells are in the
+# CellCache when it is relinquished
+start_rangeservers() {
+  for rs in 1 2 ; do
+    $HT_HOME/bin/ht Hypertable.RangeServer --verbose \
+       --pidfile=$HT_HOME/run/Hypertable.RangeServer.rs$rs.pid \
+       --Hypertable.RangeServer.ProxyName=rs$rs \
+       --Hypertable.RangeServer.Port=3806$1 \
+       --Hypertable.RangeServer.Range.Move.ShipCellCaches=true \
+       --Hypertable.RangeServer.Range.SplitSize=100M \
+       --Hypertable.RangeServer.AccessGroup.MaxMemory=100M \
+       >> rangeserver.rs$rs.output 2>&1 &
+    shift
+  done
+}
+
+stop_rangeservers() {
+  kill -9 `cat $HT_HOME/run/Hypertable.RangeServer.rs?.pid`
+}
+
+# Fails unless LoadTest holds exactly the loaded cells
+check_cells() {
+  echo "use '/'; select * from LoadTest;" | $HT_HOME/bin/ht shell --batch \
+      | sort > dump.output
+  diff dump.output dump.golden > /dev/null
+  if [ $? != 0 ] ; then
+    echo "Cells differ from the loaded cells $1"
+    stop_rangeservers
+    $HT_HOME/bin/clean-database.sh
+    exit 1
+  fi
+}
+
+rm -f rangeserver.rs?.output
+
+$HT_HOME/bin/start-test-servers.sh --clear --no-rangeserver
+
+start_rangeservers 0 1
+
+echo "use '/'; create table LoadTest ( Field );" | $HT_HOME/bin/ht shell --batch
+
+echo -e "#row\tcolumn\tvalue" > data.tsv
+for ((i=0; i<$NUM_ROWS; i++)) ; do
+  printf "row%06d\tField\tvalue%06d\n" $i $i >> data.tsv
+done
+tail -n +2 data.tsv | sort > dump.golden
+
+echo "use '/'; load data infile 'data.tsv' into table LoadTest;" | \
+    $HT_HOME/bin/ht shell --batch
+
+source=`$SCRIPT_DIR/range_location.py LoadTest`
+if [ "$source" == "rs1" ] ; then
+  destination=rs2
+else
+  destination=rs1
+fi
+
+HQL_COMMAND=`$SCRIPT_DIR/range_location.py LoadTest $destination`
+echo "Issuing HQL: $HQL_COMMAND"
+echo "$HQL_COMMAND" | $HT_HOME/bin/ht shell --batch
+
+for ((i=0; i<30; i++)) ; do
+  if [ "`$SCRIPT_DIR/range_location.py LoadTest`" == "$destination" ] ; then
+    break
+  fi
+  sleep 1
+done
+if [ "`$SCRIPT_DIR/range_location.py LoadTest`" != "$destination" ] ; then
+  echo "Range was not moved to $destination"
+  stop_rangeservers
+  $HT_HOME/bin/clean-database.sh
+  exit 1
+fi
+
+# The cell cache was shipped rather than compacted into a CellStore
+fgrep "cached cells of" rangeserver.$source.output
+if [ $? != 0 ] ; then
+  echo "$source did not ship the cell cache of the relinquished range"
+  stop_rangeservers
+  $HT_HOME/bin/clean-database.sh
+  exit 1
+fi
+
+check_cells "after the move"
+
+# The shipped cells were linked into the destination's commit log
+stop_rangeservers
+start_rangeservers 2 3
+sleep 10
+
+check_cells "after restarting the RangeServers"
+
+stop_rangeservers
+$HT_HOME/bin/clean-database.sh
+
+exit 0
@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+
+cd ${TEST_BIN_DIR}
+
+$HT_HOME/bin/start-test-servers.sh --clear --no-thriftbroker \
+    --config ${TEST_BIN_DIR}/parallel_scan_test.cfg
+
+./parallel_scan_test